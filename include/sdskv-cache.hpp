@@ -0,0 +1,559 @@
+#ifndef __SDSKV_CACHE_HPP
+#define __SDSKV_CACHE_HPP
+
+#include <chrono>
+#include <cstring>
+#include <iterator>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <abt.h>
+#include <sdskv-client.hpp>
+
+namespace sdskv {
+
+/**
+ * @brief Eviction policy of a cached_database.
+ */
+enum class cache_eviction
+{
+    lru,    /* evict the least recently used entry */
+    tinylfu /* LRU, but only admit a new entry if it is accessed more
+               frequently than the entry it would evict */
+};
+
+/**
+ * @brief Options of a cached_database.
+ */
+struct cache_options {
+    /* maximum number of bytes used by cached keys and values */
+    size_t capacity = 64 * 1024 * 1024;
+    /* eviction policy */
+    cache_eviction eviction = cache_eviction::tinylfu;
+    /* whether to remember that a key does not exist */
+    bool negative_caching = true;
+    /* time after which an entry is refetched, 0 for no expiration */
+    std::chrono::milliseconds ttl{0};
+    /* size of the buffer used to fetch a value whose size is unknown;
+     * larger values take a second round trip */
+    hg_size_t value_size_hint = 1024;
+    /* if not empty, key whose value changes whenever the cached data
+     * should be dropped (e.g. a version number maintained by writers) */
+    std::string version_key;
+    /* how often reads compare the version key with its last value */
+    std::chrono::milliseconds version_check_interval{1000};
+};
+
+/**
+ * @brief Counters of a cached_database.
+ */
+struct cache_stats {
+    uint64_t hits          = 0; /* lookups answered from the cache */
+    uint64_t negative_hits = 0; /* hits on keys known not to exist */
+    uint64_t misses        = 0; /* lookups that needed an RPC */
+    uint64_t evictions     = 0; /* entries evicted to make room */
+    uint64_t rejections    = 0; /* entries not admitted by TinyLFU */
+    uint64_t invalidations = 0; /* times the whole cache was dropped */
+};
+
+/**
+ * @brief The cached_database class adds a client-side read cache in front
+ * of a database. Reads that hit the cache are answered locally; misses
+ * of a get_multi are fetched with a single batch RPC. Writes issued
+ * through the cached_database update the cache, but writes from other
+ * clients are only seen once the corresponding entries are invalidated,
+ * either explicitly, by expiration (ttl), or when the version key changes.
+ * Copies of a cached_database share the same cache. Safe to use from
+ * concurrent ULTs.
+ */
+class cached_database {
+
+    using clock = std::chrono::steady_clock;
+
+    /* Argobots mutex usable with std::lock_guard, so that a ULT blocked
+     * on the cache yields instead of blocking its execution stream */
+    class abt_mutex {
+        ABT_mutex m_mutex = ABT_MUTEX_NULL;
+
+      public:
+        abt_mutex() { ABT_mutex_create(&m_mutex); }
+        ~abt_mutex() { ABT_mutex_free(&m_mutex); }
+        abt_mutex(const abt_mutex&) = delete;
+        abt_mutex& operator=(const abt_mutex&) = delete;
+        void       lock() { ABT_mutex_lock(m_mutex); }
+        void       unlock() { ABT_mutex_unlock(m_mutex); }
+    };
+    using lock_guard = std::lock_guard<abt_mutex>;
+
+    /* number of generation counters keys are spread over (see state) */
+    static const size_t num_generations = 256;
+
+    struct entry {
+        std::string       key;
+        std::string       value;
+        bool              present;
+        clock::time_point fetched;
+        size_t            bytes() const
+        {
+            return key.size() + value.size() + sizeof(entry);
+        }
+    };
+
+    /* count-min sketch with 4-bit saturating counters, halved
+     * periodically so that old accesses are forgotten */
+    class frequency_sketch {
+        std::vector<uint8_t> m_counters;
+        size_t               m_mask;
+        size_t               m_additions = 0;
+
+        size_t index(size_t h, unsigned row) const
+        {
+            h ^= (h >> 17) + row * 0x9e3779b97f4a7c15ULL;
+            h *= 0xff51afd7ed558ccdULL;
+            h ^= h >> 32;
+            return row * (m_mask + 1) + (h & m_mask);
+        }
+
+      public:
+        explicit frequency_sketch(size_t width)
+        {
+            size_t w = 1024;
+            while (w < width) w <<= 1;
+            m_mask = w - 1;
+            m_counters.assign(4 * w, 0);
+        }
+
+        void add(size_t h)
+        {
+            for (unsigned r = 0; r < 4; r++) {
+                auto& c = m_counters[index(h, r)];
+                if (c < 15) c++;
+            }
+            if (++m_additions >= 10 * (m_mask + 1)) {
+                for (auto& c : m_counters) c >>= 1;
+                m_additions /= 2;
+            }
+        }
+
+        unsigned estimate(size_t h) const
+        {
+            unsigned e = 15;
+            for (unsigned r = 0; r < 4; r++)
+                e = std::min<unsigned>(e, m_counters[index(h, r)]);
+            return e;
+        }
+    };
+
+    /* Fetches happen outside the mutex, so a write or an invalidation
+     * may happen while a value is being fetched. Each of them bumps the
+     * generation of the key's stripe (or the global generation, for the
+     * whole cache), and a fetched value is only inserted if the
+     * generations it was fetched under did not change. */
+    struct state {
+        database                                                    db;
+        cache_options                                               opts;
+        abt_mutex                                                   mutex;
+        uint64_t                                                    generation = 0;
+        uint64_t key_generations[num_generations] = {};
+        std::list<entry>                                            lru;
+        std::unordered_map<std::string, std::list<entry>::iterator> index;
+        size_t                                                      bytes = 0;
+        frequency_sketch                                            sketch;
+        cache_stats                                                 stats;
+        std::string                                                 version;
+        bool              version_known = false;
+        clock::time_point version_checked;
+
+        state(const database& d, const cache_options& o)
+            : db(d), opts(o), sketch(o.capacity / 256)
+        {}
+    };
+
+    std::shared_ptr<state> m_state;
+
+    static size_t hash(const std::string& key)
+    {
+        return std::hash<std::string>()(key);
+    }
+
+    /* must be called with the mutex held */
+    uint64_t& key_generation(const std::string& key)
+    {
+        return m_state->key_generations[hash(key) % num_generations];
+    }
+
+    /* must be called with the mutex held; generation under which a value
+     * of key fetched from now on may be inserted */
+    uint64_t generation_of(const std::string& key)
+    {
+        return m_state->generation + key_generation(key);
+    }
+
+    /* must be called with the mutex held */
+    void drop(std::list<entry>::iterator it)
+    {
+        auto& s = *m_state;
+        s.bytes -= it->bytes();
+        s.index.erase(it->key);
+        s.lru.erase(it);
+    }
+
+    /* must be called with the mutex held */
+    void clear_locked()
+    {
+        auto& s = *m_state;
+        s.lru.clear();
+        s.index.clear();
+        s.bytes = 0;
+        s.generation += 1;
+    }
+
+    /* must be called with the mutex held; returns the entry if it is
+     * cached and has not expired */
+    const entry* lookup(const std::string& key)
+    {
+        auto& s = *m_state;
+        s.sketch.add(hash(key));
+        auto it = s.index.find(key);
+        if (it == s.index.end()) return nullptr;
+        if (s.opts.ttl.count() != 0
+            && clock::now() - it->second->fetched > s.opts.ttl) {
+            drop(it->second);
+            return nullptr;
+        }
+        s.lru.splice(s.lru.begin(), s.lru, it->second);
+        return &*it->second;
+    }
+
+    /* must be called with the mutex held */
+    void insert(const std::string& key, const std::string* value)
+    {
+        auto& s = *m_state;
+        if (!value && !s.opts.negative_caching) {
+            auto it = s.index.find(key);
+            if (it != s.index.end()) drop(it->second);
+            return;
+        }
+        entry e{key, value ? *value : std::string(), value != nullptr,
+                clock::now()};
+        auto  it = s.index.find(key);
+        if (it != s.index.end()) drop(it->second);
+        if (e.bytes() > s.opts.capacity) return;
+        while (s.bytes + e.bytes() > s.opts.capacity) {
+            auto victim = std::prev(s.lru.end());
+            if (s.opts.eviction == cache_eviction::tinylfu
+                && s.sketch.estimate(hash(key))
+                       <= s.sketch.estimate(hash(victim->key))) {
+                s.stats.rejections += 1;
+                return;
+            }
+            drop(victim);
+            s.stats.evictions += 1;
+        }
+        s.bytes += e.bytes();
+        s.lru.push_front(std::move(e));
+        s.index[key] = s.lru.begin();
+    }
+
+    /* drops everything if the version key changed since last time */
+    void maybe_check_version()
+    {
+        auto& s = *m_state;
+        if (s.opts.version_key.empty()) return;
+        {
+            lock_guard lock(s.mutex);
+            if (s.version_known
+                && clock::now() - s.version_checked
+                       < s.opts.version_check_interval)
+                return;
+        }
+        check_version();
+    }
+
+    /* fetches the given keys with a single batch RPC; values that do not
+     * fit their buffer are fetched again with their actual size */
+    void fetch(const std::vector<std::string>& keys,
+               std::vector<std::string>&       values,
+               std::vector<int>&               found) const
+    {
+        auto&  s = *m_state;
+        size_t n = keys.size();
+        values.assign(n, std::string());
+        found.assign(n, 0);
+        std::vector<sdskv_batch_op_t> ops(n);
+        std::vector<size_t>           pending(n);
+        for (size_t i = 0; i < n; i++) {
+            pending[i] = i;
+            values[i].resize(s.opts.value_size_hint);
+        }
+        while (!pending.empty()) {
+            ops.resize(pending.size());
+            for (size_t j = 0; j < pending.size(); j++) {
+                size_t i     = pending[j];
+                ops[j].type  = SDSKV_BATCH_GET;
+                ops[j].db_id = s.db.m_db_id;
+                ops[j].key   = keys[i].data();
+                ops[j].ksize = keys[i].size();
+                ops[j].value = &values[i][0];
+                ops[j].vsize = values[i].size();
+                ops[j].ret   = SDSKV_SUCCESS;
+            }
+            int ret = sdskv_batch(s.db.m_ph.m_ph, ops.size(), ops.data());
+            if (ret != SDSKV_SUCCESS) throw exception(ret);
+            std::vector<size_t> retry;
+            for (size_t j = 0; j < pending.size(); j++) {
+                size_t i = pending[j];
+                if (ops[j].ret == SDSKV_SUCCESS) {
+                    values[i].resize(ops[j].vsize);
+                    found[i] = 1;
+                } else if (ops[j].ret == SDSKV_ERR_SIZE) {
+                    values[i].resize(ops[j].vsize);
+                    retry.push_back(i);
+                } else if (ops[j].ret == SDSKV_ERR_UNKNOWN_KEY) {
+                    values[i].clear();
+                } else {
+                    throw exception(ops[j].ret);
+                }
+            }
+            pending.swap(retry);
+        }
+    }
+
+  public:
+    /**
+     * @brief Default constructor produces an invalid cached_database.
+     */
+    cached_database() = default;
+
+    /**
+     * @brief Creates a cache in front of a database.
+     *
+     * @param db Database.
+     * @param opts Options.
+     */
+    cached_database(const database& db, const cache_options& opts = {})
+        : m_state(std::make_shared<state>(db, opts))
+    {}
+
+    /**
+     * @brief Underlying database.
+     */
+    const database& db() const { return m_state->db; }
+
+    /**
+     * @brief Gets a value, from the cache if possible. Meant to work with
+     * std::string and std::vector<X> where X is a standard layout type.
+     *
+     * @return true if the key exists, false otherwise.
+     */
+    template <typename K, typename V> bool get(const K& key, V& value)
+    {
+        std::vector<std::string> keys{
+            std::string((const char*)object_data(key), object_size(key))};
+        std::vector<std::string> values;
+        auto found = get_multi(keys, values);
+        if (!found[0]) return false;
+        object_resize(value, values[0].size());
+        std::memcpy(object_data(value), values[0].data(), values[0].size());
+        return true;
+    }
+
+    /**
+     * @brief Gets multiple values. Cache misses are fetched together in
+     * a single RPC. Meant to work with std::string and std::vector<X>
+     * where X is a standard layout type.
+     *
+     * @param keys Keys.
+     * @param values Resulting values (empty for missing keys).
+     *
+     * @return an std::vector<bool> v where v[i] is true iff key i exists.
+     */
+    template <typename K, typename V>
+    std::vector<bool> get_multi(const std::vector<K>& keys,
+                                std::vector<V>&       values)
+    {
+        auto& s = *m_state;
+        maybe_check_version();
+        size_t n = keys.size();
+        values.resize(n);
+        std::vector<bool>        result(n, false);
+        std::vector<std::string> miss_keys;
+        std::vector<size_t>      miss_pos;
+        std::vector<uint64_t>    miss_generations;
+        {
+            lock_guard lock(s.mutex);
+            for (size_t i = 0; i < n; i++) {
+                std::string k((const char*)object_data(keys[i]),
+                              object_size(keys[i]));
+                const entry* e = lookup(k);
+                if (!e) {
+                    s.stats.misses += 1;
+                    miss_generations.push_back(generation_of(k));
+                    miss_keys.push_back(std::move(k));
+                    miss_pos.push_back(i);
+                    continue;
+                }
+                if (!e->present) {
+                    s.stats.negative_hits += 1;
+                    object_resize(values[i], 0);
+                    continue;
+                }
+                s.stats.hits += 1;
+                result[i] = true;
+                object_resize(values[i], e->value.size());
+                std::memcpy(object_data(values[i]), e->value.data(),
+                            e->value.size());
+            }
+        }
+        if (miss_keys.empty()) return result;
+
+        std::vector<std::string> miss_values;
+        std::vector<int>         miss_found;
+        fetch(miss_keys, miss_values, miss_found);
+
+        lock_guard lock(s.mutex);
+        for (size_t j = 0; j < miss_keys.size(); j++) {
+            size_t i = miss_pos[j];
+            /* skip values that may have been changed while fetching */
+            if (generation_of(miss_keys[j]) == miss_generations[j])
+                insert(miss_keys[j],
+                       miss_found[j] ? &miss_values[j] : nullptr);
+            result[i] = miss_found[j];
+            object_resize(values[i], miss_values[j].size());
+            std::memcpy(object_data(values[i]), miss_values[j].data(),
+                        miss_values[j].size());
+        }
+        return result;
+    }
+
+    /**
+     * @brief Checks whether a key exists, from the cache if possible.
+     * On a miss, the database is asked whether the key exists without
+     * fetching its value; only a missing key is then cached.
+     */
+    template <typename K> bool exists(const K& key)
+    {
+        auto& s = *m_state;
+        maybe_check_version();
+        std::string k((const char*)object_data(key), object_size(key));
+        uint64_t    generation;
+        {
+            lock_guard   lock(s.mutex);
+            const entry* e = lookup(k);
+            if (e) {
+                if (e->present)
+                    s.stats.hits += 1;
+                else
+                    s.stats.negative_hits += 1;
+                return e->present;
+            }
+            s.stats.misses += 1;
+            generation = generation_of(k);
+        }
+        bool found = s.db.exists(k);
+        if (!found) {
+            lock_guard lock(s.mutex);
+            if (generation_of(k) == generation) insert(k, nullptr);
+        }
+        return found;
+    }
+
+    /**
+     * @brief Puts a key/value pair in the database and in the cache.
+     */
+    template <typename K, typename V> void put(const K& key, const V& value)
+    {
+        auto& s = *m_state;
+        s.db.put(key, value);
+        std::string k((const char*)object_data(key), object_size(key));
+        std::string v((const char*)object_data(value), object_size(value));
+        lock_guard lock(s.mutex);
+        key_generation(k) += 1;
+        insert(k, &v);
+    }
+
+    /**
+     * @brief Erases a key from the database and from the cache.
+     */
+    template <typename K> void erase(const K& key)
+    {
+        auto& s = *m_state;
+        s.db.erase(key);
+        std::string k((const char*)object_data(key), object_size(key));
+        lock_guard lock(s.mutex);
+        key_generation(k) += 1;
+        insert(k, nullptr);
+    }
+
+    /**
+     * @brief Drops a key from the cache.
+     */
+    template <typename K> void invalidate(const K& key)
+    {
+        auto&       s = *m_state;
+        std::string k((const char*)object_data(key), object_size(key));
+        lock_guard lock(s.mutex);
+        key_generation(k) += 1;
+        auto it = s.index.find(k);
+        if (it != s.index.end()) drop(it->second);
+    }
+
+    /**
+     * @brief Drops every entry from the cache.
+     */
+    void invalidate_all()
+    {
+        auto&                       s = *m_state;
+        lock_guard lock(s.mutex);
+        clear_locked();
+        s.stats.invalidations += 1;
+    }
+
+    /**
+     * @brief Reads the version key (see cache_options) and drops every
+     * entry if its value changed since the last check.
+     *
+     * @return true if the cache was dropped.
+     */
+    bool check_version()
+    {
+        auto& s = *m_state;
+        if (s.opts.version_key.empty()) return false;
+        std::vector<std::string> keys{s.opts.version_key};
+        std::vector<std::string> values;
+        std::vector<int>         found;
+        fetch(keys, values, found);
+        lock_guard lock(s.mutex);
+        s.version_checked = clock::now();
+        bool changed      = s.version_known && values[0] != s.version;
+        s.version         = values[0];
+        s.version_known   = true;
+        if (changed) {
+            clear_locked();
+            s.stats.invalidations += 1;
+        }
+        return changed;
+    }
+
+    /**
+     * @brief Number of bytes currently used by the cache.
+     */
+    size_t size_bytes() const
+    {
+        lock_guard lock(m_state->mutex);
+        return m_state->bytes;
+    }
+
+    /**
+     * @brief Counters of the cache.
+     */
+    cache_stats stats() const
+    {
+        lock_guard lock(m_state->mutex);
+        return m_state->stats;
+    }
+};
+
+} // namespace sdskv
+
+#endif
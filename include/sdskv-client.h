@@ -15,6 +15,21 @@ typedef struct sdskv_client* sdskv_client_t;
 typedef struct sdskv_provider_handle* sdskv_provider_handle_t;
 #define SDSKV_PROVIDER_HANDLE_NULL ((sdskv_provider_handle_t)NULL)
 
+/**
+ * @brief Operation of a heterogeneous batch (see sdskv_batch).
+ */
+typedef struct sdskv_batch_op_t {
+    sdskv_batch_op_type_t type;  /* operation */
+    sdskv_database_id_t   db_id; /* target database */
+    const void*           key;   /* key */
+    hg_size_t             ksize; /* size of the key */
+    void* value;     /* value to put (PUT) or buffer to receive it (GET) */
+    hg_size_t vsize; /* in: size of the value (PUT) or of the buffer (GET);
+                        out: size of the value (GET, LENGTH),
+                        1 if the key exists and 0 otherwise (EXISTS) */
+    int ret;         /* out: return code of this operation */
+} sdskv_batch_op_t;
+
 /**
  * @brief Global variable recording the last error encountered by REMI.
  */
@@ -39,6 +54,38 @@ int sdskv_client_init(margo_instance_id mid, sdskv_client_t* client);
  */
 int sdskv_client_finalize(sdskv_client_t client);
 
+/**
+ * @brief Traces a fraction of the requests sent by the client, recording
+ * their spans in a ring buffer of buffer_size events. Spans of requests
+ * about a database are tagged with its id. A request is sampled based on
+ * its id, which is sent to the provider, so that a provider with the same
+ * sample rate traces the same requests. While tracing is enabled, requests
+ * are sent with RPCs that carry the id, which providers older than the
+ * tracing support do not handle. This function should be called before
+ * sending any request. A sample_rate of 0 disables tracing.
+ *
+ * @param[in] client SDSKV client
+ * @param[in] sample_rate fraction of the requests to trace, from 0 to 1
+ * @param[in] buffer_size number of events to keep
+ *
+ * @return SDSKV_SUCCESS or error code defined in sdskv-common.h
+ */
+int sdskv_client_enable_tracing(sdskv_client_t client,
+                                double         sample_rate,
+                                size_t         buffer_size);
+
+/**
+ * @brief Gets the spans recorded by the client (see
+ * sdskv_client_enable_tracing) as a JSON string in the Chrome trace event
+ * format. The string must be freed by the caller using free().
+ *
+ * @param[in] client SDSKV client
+ * @param[out] trace JSON string
+ *
+ * @return SDSKV_SUCCESS or error code defined in sdskv-common.h
+ */
+int sdskv_client_get_trace(sdskv_client_t client, char** trace);
+
 /**
  * @brief accessor for client margo identifider
  *
@@ -122,6 +169,43 @@ int sdskv_open(sdskv_provider_handle_t provider,
  */
 int sdskv_count_databases(sdskv_provider_handle_t provider, size_t* num);
 
+/**
+ * @brief Gets the metrics of a provider, as a JSON string (see
+ * sdskv_provider_get_stats for its content). The string must be freed
+ * by the caller using free().
+ *
+ * @param[in] provider provider handle
+ * @param[out] stats JSON string
+ *
+ * @return SDSKV_SUCCESS or error code defined in sdskv-common.h
+ */
+int sdskv_get_stats(sdskv_provider_handle_t provider, char** stats);
+
+/**
+ * @brief Gets the spans of the requests sampled by a provider, as a JSON
+ * string in the Chrome trace event format (see the "tracing" section of
+ * the provider's configuration). The string must be freed by the caller
+ * using free().
+ *
+ * @param[in] provider provider handle
+ * @param[out] trace JSON string
+ *
+ * @return SDSKV_SUCCESS or error code defined in sdskv-common.h
+ */
+int sdskv_get_trace(sdskv_provider_handle_t provider, char** trace);
+
+/**
+ * @brief Gets the requests that a provider logged as slow, as a JSON
+ * string (see sdskv_provider_get_slow_ops). The string must be freed by
+ * the caller using free().
+ *
+ * @param[in] provider provider handle
+ * @param[out] slow_ops JSON string
+ *
+ * @return SDSKV_SUCCESS or error code defined in sdskv-common.h
+ */
+int sdskv_get_slow_ops(sdskv_provider_handle_t provider, char** slow_ops);
+
 /**
  * @brief Lists the databases names and ids.
  * The caller is responsible for calling free() on each of the
@@ -455,6 +539,343 @@ int sdskv_erase_multi(sdskv_provider_handle_t handle,
                       const void* const*      keys,
                       const hg_size_t*        ksizes);
 
+/**
+ * @brief Same as sdskv_erase_multi but also reports which of the keys
+ * existed and were effectively erased.
+ *
+ * @param[in] handle provider handle
+ * @param[in] db_id database id
+ * @param[in] num_keys number of keys
+ * @param[in] keys array of keys
+ * @param[in] ksizes array of key sizes
+ * @param[out] flags array of num_keys flags set to 1 if the key was
+ * erased, 0 if it did not exist
+ *
+ * @return SDSKV_SUCCESS or error code defined in sdskv-common.h
+ */
+int sdskv_erase_multi_with_flags(sdskv_provider_handle_t handle,
+                                 sdskv_database_id_t     db_id,
+                                 size_t                  num_keys,
+                                 const void* const*      keys,
+                                 const hg_size_t*        ksizes,
+                                 int*                    flags);
+
+/**
+ * @brief Erases all the keys within the range ]lower_bound, upper_bound[
+ * (i.e. bounds not included), in the order defined by the database's
+ * comparison function. An empty bound (size 0) means that the range
+ * is not bounded on that side. The whole operation is executed by the
+ * provider in a single RPC.
+ *
+ * @param[in] handle provider handle
+ * @param[in] db_id database id
+ * @param[in] lower_bound lower bound
+ * @param[in] lb_size size of the lower bound
+ * @param[in] upper_bound upper bound
+ * @param[in] ub_size size of the upper bound
+ * @param[out] num_erased number of keys erased (may be NULL)
+ *
+ * @return SDSKV_SUCCESS or error code defined in sdskv-common.h
+ */
+int sdskv_erase_range(sdskv_provider_handle_t handle,
+                      sdskv_database_id_t     db_id,
+                      const void*             lower_bound,
+                      hg_size_t               lb_size,
+                      const void*             upper_bound,
+                      hg_size_t               ub_size,
+                      hg_size_t*              num_erased);
+
+/**
+ * @brief Erases all the keys starting with the given prefix.
+ * The whole operation is executed by the provider in a single RPC.
+ *
+ * @param[in] handle provider handle
+ * @param[in] db_id database id
+ * @param[in] prefix prefix
+ * @param[in] prefix_size size of the prefix
+ * @param[out] num_erased number of keys erased (may be NULL)
+ *
+ * @return SDSKV_SUCCESS or error code defined in sdskv-common.h
+ */
+int sdskv_erase_prefix(sdskv_provider_handle_t handle,
+                       sdskv_database_id_t     db_id,
+                       const void*             prefix,
+                       hg_size_t               prefix_size,
+                       hg_size_t*              num_erased);
+
+/**
+ * @brief Atomically replaces the value associated with a key by a new
+ * value if the current value is equal to an expected one. An empty
+ * expected value also matches a key that does not exist, in which case
+ * the key is created with the desired value.
+ *
+ * Compare-and-swap, fetch-and-add and append are atomic with respect to
+ * each other. Depending on the backend, a plain put or erase of the same
+ * key running concurrently with them may be overwritten, so keys updated
+ * with these operations should not also be written with sdskv_put.
+ *
+ * @param[in] handle provider handle
+ * @param[in] db_id database id
+ * @param[in] key key
+ * @param[in] ksize size of the key
+ * @param[in] expected expected current value
+ * @param[in] esize size of the expected value
+ * @param[in] desired new value
+ * @param[in] dsize size of the new value
+ * @param[out] swapped 1 if the value was replaced, 0 otherwise
+ *
+ * @return SDSKV_SUCCESS or error code defined in sdskv-common.h
+ */
+int sdskv_compare_and_swap(sdskv_provider_handle_t handle,
+                           sdskv_database_id_t     db_id,
+                           const void*             key,
+                           hg_size_t               ksize,
+                           const void*             expected,
+                           hg_size_t               esize,
+                           const void*             desired,
+                           hg_size_t               dsize,
+                           int*                    swapped);
+
+/**
+ * @brief Same as sdskv_compare_and_swap for multiple keys at once.
+ * Each key is swapped atomically and independently of the others.
+ * If the operation fails for some keys, the others are still processed,
+ * the corresponding swapped flags are set to 0 and the error of the
+ * first failing key is returned.
+ *
+ * @param[in] handle provider handle
+ * @param[in] db_id database id
+ * @param[in] num number of keys
+ * @param[in] packed_keys buffer of packed keys
+ * @param[in] ksizes array of key sizes
+ * @param[in] packed_expected buffer of packed expected values
+ * @param[in] esizes array of expected value sizes
+ * @param[in] packed_desired buffer of packed new values
+ * @param[in] dsizes array of new value sizes
+ * @param[out] swapped array of num flags set to 1 if the value was
+ * replaced, 0 otherwise (may be NULL)
+ *
+ * @return SDSKV_SUCCESS or error code defined in sdskv-common.h
+ */
+int sdskv_compare_and_swap_packed(sdskv_provider_handle_t handle,
+                                  sdskv_database_id_t     db_id,
+                                  size_t                  num,
+                                  const void*             packed_keys,
+                                  const hg_size_t*        ksizes,
+                                  const void*             packed_expected,
+                                  const hg_size_t*        esizes,
+                                  const void*             packed_desired,
+                                  const hg_size_t*        dsizes,
+                                  int*                    swapped);
+
+/**
+ * @brief Atomically adds delta to the value associated with a key.
+ * The value must be an int64_t stored in the byte order of the server.
+ * A key that does not exist is created as if its value was 0.
+ * The addition wraps around on overflow.
+ *
+ * @param[in] handle provider handle
+ * @param[in] db_id database id
+ * @param[in] key key
+ * @param[in] ksize size of the key
+ * @param[in] delta value to add
+ * @param[out] previous value before the addition
+ *
+ * @return SDSKV_SUCCESS, SDSKV_ERR_SIZE if the current value is not
+ * 8 bytes long, or other error code defined in sdskv-common.h
+ */
+int sdskv_fetch_and_add(sdskv_provider_handle_t handle,
+                        sdskv_database_id_t     db_id,
+                        const void*             key,
+                        hg_size_t               ksize,
+                        int64_t                 delta,
+                        int64_t*                previous);
+
+/**
+ * @brief Same as sdskv_fetch_and_add for multiple keys at once.
+ * Each key is updated atomically and independently of the others.
+ * If the operation fails for some keys, the others are still updated,
+ * the corresponding previous values are set to 0 and the error of
+ * the first failing key is returned.
+ *
+ * @param[in] handle provider handle
+ * @param[in] db_id database id
+ * @param[in] num number of keys
+ * @param[in] packed_keys buffer of packed keys
+ * @param[in] ksizes array of key sizes
+ * @param[in] deltas array of values to add
+ * @param[out] previous array of values before the additions
+ *
+ * @return SDSKV_SUCCESS or error code defined in sdskv-common.h
+ */
+int sdskv_fetch_and_add_packed(sdskv_provider_handle_t handle,
+                               sdskv_database_id_t     db_id,
+                               size_t                  num,
+                               const void*             packed_keys,
+                               const hg_size_t*        ksizes,
+                               const int64_t*          deltas,
+                               int64_t*                previous);
+
+/**
+ * @brief Atomically appends data at the end of the value associated
+ * with a key. A key that does not exist is created.
+ *
+ * @param[in] handle provider handle
+ * @param[in] db_id database id
+ * @param[in] key key
+ * @param[in] ksize size of the key
+ * @param[in] data data to append
+ * @param[in] dsize size of the data
+ * @param[out] new_vsize size of the value after the append (may be NULL)
+ *
+ * @return SDSKV_SUCCESS or error code defined in sdskv-common.h
+ */
+int sdskv_append(sdskv_provider_handle_t handle,
+                 sdskv_database_id_t     db_id,
+                 const void*             key,
+                 hg_size_t               ksize,
+                 const void*             data,
+                 hg_size_t               dsize,
+                 hg_size_t*              new_vsize);
+
+/**
+ * @brief Same as sdskv_append for multiple keys at once, with the
+ * same error semantics as sdskv_fetch_and_add_packed.
+ *
+ * @param[in] handle provider handle
+ * @param[in] db_id database id
+ * @param[in] num number of keys
+ * @param[in] packed_keys buffer of packed keys
+ * @param[in] ksizes array of key sizes
+ * @param[in] packed_data buffer of packed data to append
+ * @param[in] dsizes array of data sizes
+ * @param[out] new_vsizes array of value sizes after the appends
+ *
+ * @return SDSKV_SUCCESS or error code defined in sdskv-common.h
+ */
+int sdskv_append_packed(sdskv_provider_handle_t handle,
+                        sdskv_database_id_t     db_id,
+                        size_t                  num,
+                        const void*             packed_keys,
+                        const hg_size_t*        ksizes,
+                        const void*             packed_data,
+                        const hg_size_t*        dsizes,
+                        hg_size_t*              new_vsizes);
+
+/**
+ * @brief Makes all the writes acknowledged so far by the database
+ * durable, whatever durability mode the database is configured with.
+ *
+ * @param[in] handle provider handle
+ * @param[in] db_id database id
+ *
+ * @return SDSKV_SUCCESS or error code defined in sdskv-common.h
+ */
+int sdskv_sync(sdskv_provider_handle_t handle, sdskv_database_id_t db_id);
+
+/**
+ * @brief Executes a list of puts, gets, erases, exists and length
+ * operations, possibly on different databases of the same provider,
+ * in a single RPC. Operations are executed in order and each gets its
+ * own return code in ops[i].ret: a GET with a buffer too small for the
+ * value fails with SDSKV_ERR_SIZE and sets ops[i].vsize to the required
+ * size, a missing key makes GET and LENGTH fail with
+ * SDSKV_ERR_UNKNOWN_KEY, an unknown database id yields
+ * SDSKV_ERR_UNKNOWN_DB. The results are only set if the function
+ * returns SDSKV_SUCCESS.
+ *
+ * @param[in] handle provider handle
+ * @param[in] num_ops number of operations
+ * @param[inout] ops array of operations
+ *
+ * @return SDSKV_SUCCESS or error code defined in sdskv-common.h
+ */
+int sdskv_batch(sdskv_provider_handle_t handle,
+                size_t                  num_ops,
+                sdskv_batch_op_t*       ops);
+
+/**
+ * @brief Same as sdskv_put_packed, but each key/value pair can target a
+ * different database of the provider: pair i goes to the database
+ * db_ids[db_indices[i]]. All the pairs are sent in a single bulk
+ * transfer, and the pairs of each database are stored with a single
+ * put_multi on that database.
+ *
+ * @param provider provider handle
+ * @param num_dbs number of databases in db_ids
+ * @param db_ids array of database ids
+ * @param num number of key/value pairs to put
+ * @param db_indices index in db_ids of the database of each pair
+ * @param packed_keys buffer containing the keys
+ * @param ksizes array of key sizes
+ * @param packed_values buffer containing the values
+ * @param vsizes array of value sizes
+ *
+ * @return SDSKV_SUCCESS or error code defined in sdskv-common.h
+ */
+int sdskv_put_packed_multi_db(sdskv_provider_handle_t    provider,
+                              size_t                     num_dbs,
+                              const sdskv_database_id_t* db_ids,
+                              size_t                     num,
+                              const uint32_t*            db_indices,
+                              const void*                packed_keys,
+                              const hg_size_t*           ksizes,
+                              const void*                packed_values,
+                              const hg_size_t*           vsizes);
+
+/**
+ * @brief Same as sdskv_get_packed, but each key is looked up in the
+ * database db_ids[db_indices[i]] of the provider.
+ *
+ * @param[in] provider provider handle
+ * @param[in] num_dbs number of databases in db_ids
+ * @param[in] db_ids array of database ids
+ * @param[inout] num number of values to retrieve, number of values actually
+ * retrieved
+ * @param[in] db_indices index in db_ids of the database of each key
+ * @param[in] packed_keys buffer of packed keys to retrieve
+ * @param[in] ksizes size of the keys
+ * @param[in] vbufsize size of the buffer allocated for the values
+ * @param[out] packed_values buffer allocated to receive packed values
+ * @param[out] vsizes sizes of the values
+ *
+ * @return SDSKV_SUCCESS or error code defined in sdskv-common.h
+ */
+int sdskv_get_packed_multi_db(sdskv_provider_handle_t    provider,
+                              size_t                     num_dbs,
+                              const sdskv_database_id_t* db_ids,
+                              size_t*                    num,
+                              const uint32_t*            db_indices,
+                              const void*                packed_keys,
+                              const hg_size_t*           ksizes,
+                              hg_size_t                  vbufsize,
+                              void*                      packed_values,
+                              hg_size_t*                 vsizes);
+
+/**
+ * @brief Checks whether each packed key exists in the database
+ * db_ids[db_indices[i]] of the provider.
+ *
+ * @param[in] provider provider handle
+ * @param[in] num_dbs number of databases in db_ids
+ * @param[in] db_ids array of database ids
+ * @param[in] num number of keys
+ * @param[in] db_indices index in db_ids of the database of each key
+ * @param[in] packed_keys buffer of packed keys
+ * @param[in] ksizes size of the keys
+ * @param[out] flags set to 1 for the keys that exist, 0 otherwise
+ *
+ * @return SDSKV_SUCCESS or error code defined in sdskv-common.h
+ */
+int sdskv_exists_packed_multi_db(sdskv_provider_handle_t    provider,
+                                 size_t                     num_dbs,
+                                 const sdskv_database_id_t* db_ids,
+                                 size_t                     num,
+                                 const uint32_t*            db_indices,
+                                 const void*                packed_keys,
+                                 const hg_size_t*           ksizes,
+                                 int*                       flags);
+
 /**
  * Lists at most max_keys keys starting strictly after start_key,
  * whether start_key is effectively in the database or not. "strictly after"
@@ -734,6 +1155,256 @@ int sdskv_migrate_database(sdskv_provider_handle_t source,
                            const char*             dest_root,
                            int                     flag);
 
+/**
+ * @brief A distributed database is a client-side view of several
+ * databases (shards), possibly managed by different providers, among
+ * which keys are spread by a partitioner.
+ */
+typedef struct sdskv_dist_database* sdskv_dist_database_t;
+#define SDSKV_DIST_DATABASE_NULL ((sdskv_dist_database_t)NULL)
+
+/**
+ * @brief Type of a user-provided partitioning function. It must return
+ * the index of the shard (between 0 and num_shards-1) the key belongs to.
+ */
+typedef size_t (*sdskv_partition_fn)(const void* key,
+                                     hg_size_t   ksize,
+                                     size_t      num_shards,
+                                     void*       uargs);
+
+/**
+ * @brief Creates a distributed database from a list of shards, shard i
+ * being the database db_ids[i] of providers[i]. The provider handles are
+ * retained until sdskv_dist_database_free is called. The type must be
+ * SDSKV_PARTITION_CONSISTENT_HASH, SDSKV_PARTITION_JUMP_HASH or
+ * SDSKV_PARTITION_RANGE; in the latter case, sdskv_dist_database_set_ranges
+ * must be called before accessing keys. For both hash partitioners,
+ * the placement of keys only depends on the position of each shard in
+ * the list, so every client must list the shards in the same order.
+ *
+ * @param[in] num_shards number of shards
+ * @param[in] providers provider handle of each shard
+ * @param[in] db_ids database id of each shard
+ * @param[in] type partitioner
+ * @param[out] db resulting distributed database
+ *
+ * @return SDSKV_SUCCESS or error code defined in sdskv-common.h
+ */
+int sdskv_dist_database_create(size_t                         num_shards,
+                               const sdskv_provider_handle_t* providers,
+                               const sdskv_database_id_t*     db_ids,
+                               sdskv_partitioner_type_t       type,
+                               sdskv_dist_database_t*         db);
+
+/**
+ * @brief Switches the distributed database to range partitioning.
+ * split_keys must contain num_shards-1 keys in increasing (bytewise)
+ * order; shard i holds the keys k such that split_keys[i-1] <= k <
+ * split_keys[i]. The keys are copied.
+ *
+ * @param db distributed database
+ * @param split_keys split keys
+ * @param split_ksizes size of the split keys
+ *
+ * @return SDSKV_SUCCESS or error code defined in sdskv-common.h
+ */
+int sdskv_dist_database_set_ranges(sdskv_dist_database_t db,
+                                   const void* const*    split_keys,
+                                   const hg_size_t*      split_ksizes);
+
+/**
+ * @brief Switches the distributed database to a user-provided
+ * partitioning function.
+ *
+ * @param db distributed database
+ * @param fn partitioning function
+ * @param uargs argument passed to the function
+ *
+ * @return SDSKV_SUCCESS or error code defined in sdskv-common.h
+ */
+int sdskv_dist_database_set_partitioner(sdskv_dist_database_t db,
+                                        sdskv_partition_fn    fn,
+                                        void*                 uargs);
+
+/**
+ * @brief Frees a distributed database and releases its provider handles.
+ * The underlying databases are left untouched.
+ *
+ * @param db distributed database
+ *
+ * @return SDSKV_SUCCESS or error code defined in sdskv-common.h
+ */
+int sdskv_dist_database_free(sdskv_dist_database_t db);
+
+/**
+ * @brief Gets the number of shards of a distributed database.
+ *
+ * @param[in] db distributed database
+ * @param[out] num number of shards
+ *
+ * @return SDSKV_SUCCESS or error code defined in sdskv-common.h
+ */
+int sdskv_dist_database_num_shards(sdskv_dist_database_t db, size_t* num);
+
+/**
+ * @brief Finds the shard a key belongs to.
+ *
+ * @param[in] db distributed database
+ * @param[in] key key
+ * @param[in] ksize size of the key
+ * @param[out] shard index of the shard
+ *
+ * @return SDSKV_SUCCESS or error code defined in sdskv-common.h
+ */
+int sdskv_dist_database_locate(sdskv_dist_database_t db,
+                               const void*           key,
+                               hg_size_t             ksize,
+                               size_t*               shard);
+
+/**
+ * @brief Gets the provider handle and database id of a shard. The
+ * provider handle is not retained. Any of the output arguments may be NULL.
+ *
+ * @param[in] db distributed database
+ * @param[in] shard index of the shard
+ * @param[out] provider provider handle of the shard
+ * @param[out] db_id database id of the shard
+ *
+ * @return SDSKV_SUCCESS or error code defined in sdskv-common.h
+ */
+int sdskv_dist_database_shard(sdskv_dist_database_t    db,
+                              size_t                   shard,
+                              sdskv_provider_handle_t* provider,
+                              sdskv_database_id_t*     db_id);
+
+/**
+ * @brief Tells whether a shard may hold keys that are strictly greater
+ * than start_key and start with prefix (an empty start key or prefix
+ * being no constraint). Only range partitioning allows ruling out a
+ * shard; with the other partitioners the flag is always set to 1.
+ *
+ * @param[in] db distributed database
+ * @param[in] shard index of the shard
+ * @param[in] start_key start key (excluded)
+ * @param[in] start_ksize size of the start key
+ * @param[in] prefix prefix
+ * @param[in] prefix_size size of the prefix
+ * @param[out] flag 1 if the shard may hold such keys, 0 otherwise
+ *
+ * @return SDSKV_SUCCESS or error code defined in sdskv-common.h
+ */
+int sdskv_dist_database_overlaps(sdskv_dist_database_t db,
+                                 size_t                shard,
+                                 const void*           start_key,
+                                 hg_size_t             start_ksize,
+                                 const void*           prefix,
+                                 hg_size_t             prefix_size,
+                                 int*                  flag);
+
+/**
+ * @brief Same as sdskv_put, on the shard the key belongs to.
+ */
+int sdskv_dist_put(sdskv_dist_database_t db,
+                   const void*           key,
+                   hg_size_t             ksize,
+                   const void*           value,
+                   hg_size_t             vsize);
+
+/**
+ * @brief Same as sdskv_get, on the shard the key belongs to.
+ */
+int sdskv_dist_get(sdskv_dist_database_t db,
+                   const void*           key,
+                   hg_size_t             ksize,
+                   void*                 value,
+                   hg_size_t*            vsize);
+
+/**
+ * @brief Same as sdskv_exists, on the shard the key belongs to.
+ */
+int sdskv_dist_exists(sdskv_dist_database_t db,
+                      const void*           key,
+                      hg_size_t             ksize,
+                      int*                  flag);
+
+/**
+ * @brief Same as sdskv_length, on the shard the key belongs to.
+ */
+int sdskv_dist_length(sdskv_dist_database_t db,
+                      const void*           key,
+                      hg_size_t             ksize,
+                      hg_size_t*            vsize);
+
+/**
+ * @brief Same as sdskv_erase, on the shard the key belongs to.
+ */
+int sdskv_dist_erase(sdskv_dist_database_t db,
+                     const void*           key,
+                     hg_size_t             ksize);
+
+/**
+ * @brief Same as sdskv_put_multi. The pairs are split per shard and the
+ * resulting sub-batches are sent concurrently, each from its own ULT in
+ * the handler pool of the client's margo instance. If several sub-batches
+ * fail, the error of the one with the lowest shard index is returned.
+ */
+int sdskv_dist_put_multi(sdskv_dist_database_t db,
+                         size_t                num,
+                         const void* const*    keys,
+                         const hg_size_t*      ksizes,
+                         const void* const*    values,
+                         const hg_size_t*      vsizes);
+
+/**
+ * @brief Same as sdskv_get_multi, with keys split per shard and the
+ * sub-batches sent concurrently (see sdskv_dist_put_multi).
+ */
+int sdskv_dist_get_multi(sdskv_dist_database_t db,
+                         size_t                num,
+                         const void* const*    keys,
+                         const hg_size_t*      ksizes,
+                         void**                values,
+                         hg_size_t*            vsizes);
+
+/**
+ * @brief Same as sdskv_exists_multi, with keys split per shard and the
+ * sub-batches sent concurrently (see sdskv_dist_put_multi).
+ */
+int sdskv_dist_exists_multi(sdskv_dist_database_t db,
+                            size_t                num,
+                            const void* const*    keys,
+                            const hg_size_t*      ksizes,
+                            int*                  flags);
+
+/**
+ * @brief Same as sdskv_length_multi, with keys split per shard and the
+ * sub-batches sent concurrently (see sdskv_dist_put_multi).
+ */
+int sdskv_dist_length_multi(sdskv_dist_database_t db,
+                            size_t                num,
+                            const void* const*    keys,
+                            const hg_size_t*      ksizes,
+                            hg_size_t*            vsizes);
+
+/**
+ * @brief Same as sdskv_erase_multi, with keys split per shard and the
+ * sub-batches sent concurrently (see sdskv_dist_put_multi).
+ */
+int sdskv_dist_erase_multi(sdskv_dist_database_t db,
+                           size_t                num,
+                           const void* const*    keys,
+                           const hg_size_t*      ksizes);
+
+/**
+ * @brief Same as sdskv_erase_multi_with_flags, with keys split per shard
+ * and the sub-batches sent concurrently (see sdskv_dist_put_multi).
+ */
+int sdskv_dist_erase_multi_with_flags(sdskv_dist_database_t db,
+                                      size_t                num,
+                                      const void* const*    keys,
+                                      const hg_size_t*      ksizes,
+                                      int*                  flags);
+
 /**
  * Shuts down a remote SDSKV service (given an address).
  * This will shutdown all the providers on the target address.
@@ -5,6 +5,9 @@
 #include <stdexcept>
 #include <vector>
 #include <string>
+#include <memory>
+#include <functional>
+#include <algorithm>
 #include <sdskv-client.h>
 #include <sdskv-common.hpp>
 
@@ -66,6 +69,10 @@ inline void object_resize(std::string& s, size_t new_size)
 
 class provider_handle;
 class database;
+class batch;
+class distributed_database;
+class ordered_scan;
+class cached_database;
 
 /**
  * @brief The sdskv::client class is the C++ equivalent of a C sdskv_client_t.
@@ -73,11 +80,16 @@ class database;
 class client {
 
     friend class provider_handle;
+    friend class ordered_scan;
 
     margo_instance_id m_mid         = MARGO_INSTANCE_NULL;
     sdskv_client_t    m_client      = SDSKV_CLIENT_NULL;
     bool              m_owns_client = true;
 
+    static sdskv_provider_handle_t
+    multi_db_table(const std::vector<database>&      dbs,
+                   std::vector<sdskv_database_id_t>& ids);
+
   public:
     /**
      * @brief Default constructor. Will create an invalid client.
@@ -183,6 +195,33 @@ class client {
      */
     std::vector<database> open(const provider_handle& ph) const;
 
+    /**
+     * @brief Get the metrics of a given provider.
+     *
+     * @param ph Provider handle.
+     *
+     * @return JSON string (see sdskv_provider_get_stats).
+     */
+    std::string get_stats(const provider_handle& ph) const;
+
+    /**
+     * @brief Get the spans of the requests sampled by a given provider.
+     *
+     * @param ph Provider handle.
+     *
+     * @return JSON string in the Chrome trace event format.
+     */
+    std::string get_trace(const provider_handle& ph) const;
+
+    /**
+     * @brief Get the requests that a given provider logged as slow.
+     *
+     * @param ph Provider handle.
+     *
+     * @return JSON string.
+     */
+    std::string get_slow_ops(const provider_handle& ph) const;
+
     //////////////////////////
     // PUT methods
     //////////////////////////
@@ -927,17 +966,20 @@ class client {
     //////////////////////////
 
     /**
-     * @brief Equivalent to sdskv_erase_multi.
+     * @brief Equivalent to sdskv_erase_multi_with_flags.
      *
      * @param db Database instance.
      * @param num Number of key/value pairs to erase.
      * @param keys Array of keys.
      * @param ksizes Array of key sizes.
+     *
+     * @return an std::vector<bool> v where v[i] is true iff key i existed
+     * and was erased.
      */
-    void erase_multi(const database&    db,
-                     hg_size_t          num,
-                     const void* const* keys,
-                     const hg_size_t*   ksizes) const;
+    std::vector<bool> erase_multi(const database&    db,
+                                  hg_size_t          num,
+                                  const void* const* keys,
+                                  const hg_size_t*   ksizes) const;
 
     /**
      * @brief Erase a vector of keys. The key type K should be
@@ -947,10 +989,13 @@ class client {
      * @tparam K Type of
      * @param db Database instance.
      * @param keys Vector of keys to erase.
+     *
+     * @return an std::vector<bool> v where v[i] is true iff key i existed
+     * and was erased.
      */
     template <typename K>
-    inline void erase_multi(const database&       db,
-                            const std::vector<K>& keys) const
+    inline std::vector<bool> erase_multi(const database&       db,
+                                         const std::vector<K>& keys) const
     {
         std::vector<const void*> kdata;
         kdata.reserve(keys.size());
@@ -963,6 +1008,458 @@ class client {
         return erase_multi(db, keys.size(), kdata.data(), ksizes.data());
     }
 
+    //////////////////////////
+    // ERASE_RANGE/PREFIX methods
+    //////////////////////////
+
+    /**
+     * @brief Equivalent to sdskv_erase_range.
+     *
+     * @param db Database instance.
+     * @param lower_bound Lower bound (excluded).
+     * @param lb_size Size of the lower bound.
+     * @param upper_bound Upper bound (excluded).
+     * @param ub_size Size of the upper bound.
+     *
+     * @return the number of keys erased.
+     */
+    hg_size_t erase_range(const database& db,
+                          const void*     lower_bound,
+                          hg_size_t       lb_size,
+                          const void*     upper_bound,
+                          hg_size_t       ub_size) const;
+
+    /**
+     * @brief Templated version of erase_range.
+     *
+     * @tparam K Key type.
+     * @param db Database instance.
+     * @param lower_bound Lower bound (excluded).
+     * @param upper_bound Upper bound (excluded).
+     *
+     * @return the number of keys erased.
+     */
+    template <typename K>
+    inline hg_size_t erase_range(const database& db,
+                                 const K&        lower_bound,
+                                 const K&        upper_bound) const
+    {
+        return erase_range(db, object_data(lower_bound),
+                           object_size(lower_bound), object_data(upper_bound),
+                           object_size(upper_bound));
+    }
+
+    /**
+     * @brief Equivalent to sdskv_erase_prefix.
+     *
+     * @param db Database instance.
+     * @param prefix Prefix.
+     * @param prefix_size Size of the prefix.
+     *
+     * @return the number of keys erased.
+     */
+    hg_size_t erase_prefix(const database& db,
+                           const void*     prefix,
+                           hg_size_t       prefix_size) const;
+
+    /**
+     * @brief Templated version of erase_prefix.
+     *
+     * @tparam K Key type.
+     * @param db Database instance.
+     * @param prefix Prefix.
+     *
+     * @return the number of keys erased.
+     */
+    template <typename K>
+    inline hg_size_t erase_prefix(const database& db, const K& prefix) const
+    {
+        return erase_prefix(db, object_data(prefix), object_size(prefix));
+    }
+
+    //////////////////////////
+    // COMPARE_AND_SWAP methods
+    //////////////////////////
+
+    /**
+     * @brief Equivalent to sdskv_compare_and_swap.
+     *
+     * @param db Database instance.
+     * @param key Key.
+     * @param ksize Size of the key.
+     * @param expected Expected current value (empty for a missing key).
+     * @param esize Size of the expected value.
+     * @param desired New value.
+     * @param dsize Size of the new value.
+     *
+     * @return true if the value was replaced, false otherwise.
+     */
+    bool compare_and_swap(const database& db,
+                          const void*     key,
+                          hg_size_t       ksize,
+                          const void*     expected,
+                          hg_size_t       esize,
+                          const void*     desired,
+                          hg_size_t       dsize) const;
+
+    /**
+     * @brief Templated version of compare_and_swap, meant to work with
+     * std::string and std::vector<X> where X is a standard layout type.
+     *
+     * @tparam K Key type.
+     * @tparam V Value type.
+     * @param db Database instance.
+     * @param key Key.
+     * @param expected Expected current value.
+     * @param desired New value.
+     *
+     * @return true if the value was replaced, false otherwise.
+     */
+    template <typename K, typename V>
+    inline bool compare_and_swap(const database& db,
+                                 const K&        key,
+                                 const V&        expected,
+                                 const V&        desired) const
+    {
+        return compare_and_swap(db, object_data(key), object_size(key),
+                                object_data(expected), object_size(expected),
+                                object_data(desired), object_size(desired));
+    }
+
+    /**
+     * @brief Equivalent to sdskv_compare_and_swap_packed.
+     *
+     * @param db Database instance.
+     * @param num Number of keys.
+     * @param keys Buffer of packed keys.
+     * @param ksizes Array of key sizes.
+     * @param expected Buffer of packed expected values.
+     * @param esizes Array of expected value sizes.
+     * @param desired Buffer of packed new values.
+     * @param dsizes Array of new value sizes.
+     *
+     * @return an std::vector<bool> v where v[i] is true iff the value
+     * of key i was replaced.
+     */
+    std::vector<bool> compare_and_swap_packed(const database&  db,
+                                              hg_size_t        num,
+                                              const void*      keys,
+                                              const hg_size_t* ksizes,
+                                              const void*      expected,
+                                              const hg_size_t* esizes,
+                                              const void*      desired,
+                                              const hg_size_t* dsizes) const;
+
+    /**
+     * @brief Replaces the value of keys[i] by desired[i] if it is equal
+     * to expected[i], for all i.
+     *
+     * @tparam K Key type.
+     * @tparam V Value type.
+     * @param db Database instance.
+     * @param keys Vector of keys.
+     * @param expected Vector of expected values.
+     * @param desired Vector of new values.
+     *
+     * @return an std::vector<bool> v where v[i] is true iff the value
+     * of keys[i] was replaced.
+     */
+    template <typename K, typename V>
+    inline std::vector<bool>
+    compare_and_swap_packed(const database&       db,
+                            const std::vector<K>& keys,
+                            const std::vector<V>& expected,
+                            const std::vector<V>& desired) const
+    {
+        if (keys.size() != expected.size() || keys.size() != desired.size())
+            throw std::length_error("provided keys, expected and desired "
+                                    "vectors don't have the same size");
+        std::vector<char>      packed_keys, packed_expected, packed_desired;
+        std::vector<hg_size_t> ksizes, esizes, dsizes;
+        ksizes.reserve(keys.size());
+        esizes.reserve(keys.size());
+        dsizes.reserve(keys.size());
+        for (unsigned i = 0; i < keys.size(); i++) {
+            auto k = (const char*)object_data(keys[i]);
+            auto e = (const char*)object_data(expected[i]);
+            auto d = (const char*)object_data(desired[i]);
+            packed_keys.insert(packed_keys.end(), k, k + object_size(keys[i]));
+            packed_expected.insert(packed_expected.end(), e,
+                                   e + object_size(expected[i]));
+            packed_desired.insert(packed_desired.end(), d,
+                                  d + object_size(desired[i]));
+            ksizes.push_back(object_size(keys[i]));
+            esizes.push_back(object_size(expected[i]));
+            dsizes.push_back(object_size(desired[i]));
+        }
+        return compare_and_swap_packed(
+            db, keys.size(), packed_keys.data(), ksizes.data(),
+            packed_expected.data(), esizes.data(), packed_desired.data(),
+            dsizes.data());
+    }
+
+    //////////////////////////
+    // FETCH_AND_ADD methods
+    //////////////////////////
+
+    /**
+     * @brief Equivalent to sdskv_fetch_and_add.
+     *
+     * @param db Database instance.
+     * @param key Key.
+     * @param ksize Size of the key.
+     * @param delta Value to add.
+     *
+     * @return the value before the addition.
+     */
+    int64_t fetch_and_add(const database& db,
+                          const void*     key,
+                          hg_size_t       ksize,
+                          int64_t         delta) const;
+
+    /**
+     * @brief Templated version of fetch_and_add.
+     *
+     * @tparam K Key type.
+     * @param db Database instance.
+     * @param key Key.
+     * @param delta Value to add.
+     *
+     * @return the value before the addition.
+     */
+    template <typename K>
+    inline int64_t
+    fetch_and_add(const database& db, const K& key, int64_t delta) const
+    {
+        return fetch_and_add(db, object_data(key), object_size(key), delta);
+    }
+
+    /**
+     * @brief Equivalent to sdskv_fetch_and_add_packed.
+     *
+     * @param db Database instance.
+     * @param num Number of keys.
+     * @param keys Buffer of packed keys.
+     * @param ksizes Array of key sizes.
+     * @param deltas Array of values to add.
+     * @param previous Array of values before the additions.
+     */
+    void fetch_and_add_packed(const database&  db,
+                              hg_size_t        num,
+                              const void*      keys,
+                              const hg_size_t* ksizes,
+                              const int64_t*   deltas,
+                              int64_t*         previous) const;
+
+    /**
+     * @brief Adds deltas[i] to the value of keys[i] for all i.
+     *
+     * @tparam K Key type.
+     * @param db Database instance.
+     * @param keys Vector of keys.
+     * @param deltas Vector of values to add.
+     *
+     * @return a vector of the values before the additions.
+     */
+    template <typename K>
+    inline std::vector<int64_t>
+    fetch_and_add_packed(const database&             db,
+                         const std::vector<K>&       keys,
+                         const std::vector<int64_t>& deltas) const
+    {
+        if (keys.size() != deltas.size())
+            throw std::length_error(
+                "provided keys and deltas vectors don't have the same size");
+        std::vector<char>      packed_keys;
+        std::vector<hg_size_t> ksizes;
+        ksizes.reserve(keys.size());
+        for (const auto& k : keys) {
+            auto data = (const char*)object_data(k);
+            packed_keys.insert(packed_keys.end(), data, data + object_size(k));
+            ksizes.push_back(object_size(k));
+        }
+        std::vector<int64_t> previous(keys.size());
+        fetch_and_add_packed(db, keys.size(), packed_keys.data(),
+                             ksizes.data(), deltas.data(), previous.data());
+        return previous;
+    }
+
+    //////////////////////////
+    // APPEND methods
+    //////////////////////////
+
+    /**
+     * @brief Equivalent to sdskv_append.
+     *
+     * @param db Database instance.
+     * @param key Key.
+     * @param ksize Size of the key.
+     * @param data Data to append.
+     * @param dsize Size of the data.
+     *
+     * @return the size of the value after the append.
+     */
+    hg_size_t append(const database& db,
+                     const void*     key,
+                     hg_size_t       ksize,
+                     const void*     data,
+                     hg_size_t       dsize) const;
+
+    /**
+     * @brief Templated version of append.
+     *
+     * @tparam K Key type.
+     * @tparam V Data type.
+     * @param db Database instance.
+     * @param key Key.
+     * @param data Data to append.
+     *
+     * @return the size of the value after the append.
+     */
+    template <typename K, typename V>
+    inline hg_size_t
+    append(const database& db, const K& key, const V& data) const
+    {
+        return append(db, object_data(key), object_size(key),
+                      object_data(data), object_size(data));
+    }
+
+    /**
+     * @brief Equivalent to sdskv_append_packed.
+     *
+     * @param db Database instance.
+     * @param num Number of keys.
+     * @param keys Buffer of packed keys.
+     * @param ksizes Array of key sizes.
+     * @param data Buffer of packed data.
+     * @param dsizes Array of data sizes.
+     * @param new_vsizes Array of value sizes after the appends.
+     */
+    void append_packed(const database&  db,
+                       hg_size_t        num,
+                       const void*      keys,
+                       const hg_size_t* ksizes,
+                       const void*      data,
+                       const hg_size_t* dsizes,
+                       hg_size_t*       new_vsizes) const;
+
+    /**
+     * @brief Appends data[i] to the value of keys[i] for all i.
+     *
+     * @tparam K Key type.
+     * @tparam V Data type.
+     * @param db Database instance.
+     * @param keys Vector of keys.
+     * @param data Vector of data to append.
+     *
+     * @return a vector of the value sizes after the appends.
+     */
+    template <typename K, typename V>
+    inline std::vector<hg_size_t> append_packed(const database&       db,
+                                                const std::vector<K>& keys,
+                                                const std::vector<V>& data) const
+    {
+        if (keys.size() != data.size())
+            throw std::length_error(
+                "provided keys and data vectors don't have the same size");
+        std::vector<char>      packed_keys, packed_data;
+        std::vector<hg_size_t> ksizes, dsizes;
+        ksizes.reserve(keys.size());
+        dsizes.reserve(keys.size());
+        for (unsigned i = 0; i < keys.size(); i++) {
+            auto k = (const char*)object_data(keys[i]);
+            auto d = (const char*)object_data(data[i]);
+            packed_keys.insert(packed_keys.end(), k, k + object_size(keys[i]));
+            packed_data.insert(packed_data.end(), d, d + object_size(data[i]));
+            ksizes.push_back(object_size(keys[i]));
+            dsizes.push_back(object_size(data[i]));
+        }
+        std::vector<hg_size_t> new_vsizes(keys.size());
+        append_packed(db, keys.size(), packed_keys.data(), ksizes.data(),
+                      packed_data.data(), dsizes.data(), new_vsizes.data());
+        return new_vsizes;
+    }
+
+    /**
+     * @brief Equivalent to sdskv_sync.
+     *
+     * @param db Database instance.
+     */
+    void sync(const database& db) const;
+
+    /**
+     * @brief Executes a batch of operations in a single RPC
+     * (see sdskv_batch). Per-operation results are then available
+     * from the batch object.
+     *
+     * @param b Batch to execute.
+     */
+    void execute(batch& b) const;
+
+    //////////////////////////
+    // MULTI-DATABASE PACKED methods
+    //////////////////////////
+
+    /**
+     * @brief Equivalent to sdskv_put_packed_multi_db. All the databases
+     * must belong to the same provider.
+     *
+     * @param dbs Table of databases.
+     * @param count Number of key/val pairs.
+     * @param db_indices Index in dbs of the database of each pair.
+     * @param keys Buffer of keys.
+     * @param ksizes Array of key sizes.
+     * @param values Buffer of values.
+     * @param vsizes Array of value sizes.
+     */
+    void put_packed(const std::vector<database>& dbs,
+                    hg_size_t                    count,
+                    const uint32_t*              db_indices,
+                    const void*                  keys,
+                    const hg_size_t*             ksizes,
+                    const void*                  values,
+                    const hg_size_t*             vsizes) const;
+
+    /**
+     * @brief Equivalent to sdskv_get_packed_multi_db. All the databases
+     * must belong to the same provider.
+     *
+     * @param dbs Table of databases.
+     * @param count Number of keys, set to the number of values retrieved.
+     * @param db_indices Index in dbs of the database of each key.
+     * @param keys Buffer of packed keys.
+     * @param ksizes Array of key sizes.
+     * @param valbufsize Size of the value buffer.
+     * @param values Buffer of packed values.
+     * @param vsizes Array of value sizes.
+     */
+    bool get_packed(const std::vector<database>& dbs,
+                    hg_size_t*                   count,
+                    const uint32_t*              db_indices,
+                    const void*                  keys,
+                    const hg_size_t*             ksizes,
+                    hg_size_t                    valbufsize,
+                    void*                        values,
+                    hg_size_t*                   vsizes) const;
+
+    /**
+     * @brief Equivalent to sdskv_exists_packed_multi_db. All the databases
+     * must belong to the same provider.
+     *
+     * @param dbs Table of databases.
+     * @param num Number of keys.
+     * @param db_indices Index in dbs of the database of each key.
+     * @param keys Buffer of packed keys.
+     * @param ksizes Array of key sizes.
+     *
+     * @return an std::vector<bool> v where v[i] is true iff key i exists.
+     */
+    std::vector<bool> exists_packed(const std::vector<database>& dbs,
+                                    size_t                       num,
+                                    const uint32_t*              db_indices,
+                                    const void*                  keys,
+                                    const hg_size_t*             ksizes) const;
+
     //////////////////////////
     // LIST_KEYS methods
     //////////////////////////
@@ -1430,9 +1927,13 @@ class provider_handle {
 
     friend class client;
     friend class database;
+    friend class batch;
+    friend class distributed_database;
+    friend class ordered_scan;
+    friend class cached_database;
 
-    sdskv_provider_handle_t m_ph = SDSKV_PROVIDER_HANDLE_NULL;
-    client*                 m_client;
+    sdskv_provider_handle_t m_ph     = SDSKV_PROVIDER_HANDLE_NULL;
+    client*                 m_client = nullptr;
 
   public:
     /**
@@ -1536,6 +2037,10 @@ class database {
 
     friend class client;
     friend class provider_handle;
+    friend class batch;
+    friend class distributed_database;
+    friend class ordered_scan;
+    friend class cached_database;
 
     provider_handle     m_ph;
     sdskv_database_id_t m_db_id;
@@ -1685,50 +2190,876 @@ class database {
     /**
      * @brief @see client::erase_multi.
      */
-    template <typename... T> void erase_multi(T&&... args) const
+    template <typename... T> decltype(auto) erase_multi(T&&... args) const
     {
-        m_ph.m_client->erase_multi(*this, std::forward<T>(args)...);
+        return m_ph.m_client->erase_multi(*this, std::forward<T>(args)...);
     }
 
     /**
-     * @brief @see client::list_keys.
+     * @brief @see client::erase_range.
      */
-    template <typename... T> decltype(auto) list_keys(T&&... args) const
+    template <typename... T> decltype(auto) erase_range(T&&... args) const
     {
-        return m_ph.m_client->list_keys(*this, std::forward<T>(args)...);
+        return m_ph.m_client->erase_range(*this, std::forward<T>(args)...);
     }
 
     /**
-     * @brief @see client::list_keyvals.
+     * @brief @see client::erase_prefix.
      */
-    template <typename... T> decltype(auto) list_keyvals(T&&... args) const
+    template <typename... T> decltype(auto) erase_prefix(T&&... args) const
     {
-        return m_ph.m_client->list_keyvals(*this, std::forward<T>(args)...);
+        return m_ph.m_client->erase_prefix(*this, std::forward<T>(args)...);
     }
 
     /**
-     * @brief @see client::migrate.
+     * @brief @see client::compare_and_swap.
      */
     template <typename... T>
-    void migrate(const database& dest_db, T&&... args) const
+    decltype(auto) compare_and_swap(T&&... args) const
     {
-        m_ph.m_client->migrate(*this, dest_db, std::forward<T>(args)...);
+        return m_ph.m_client->compare_and_swap(*this,
+                                               std::forward<T>(args)...);
     }
 
     /**
-     * @brief @see client::migrate.
+     * @brief @see client::compare_and_swap_packed.
      */
     template <typename... T>
-    void migrate(const std::string& dest_provider_addr,
-                 uint16_t           dest_provider_id,
-                 T&&... args)
+    decltype(auto) compare_and_swap_packed(T&&... args) const
     {
-        m_ph.m_client->migrate(*this, dest_provider_addr, dest_provider_id,
-                               std::forward<T>(args)...);
+        return m_ph.m_client->compare_and_swap_packed(
+            *this, std::forward<T>(args)...);
     }
-};
 
-inline database client::open(const provider_handle& ph,
+    /**
+     * @brief @see client::fetch_and_add.
+     */
+    template <typename... T> decltype(auto) fetch_and_add(T&&... args) const
+    {
+        return m_ph.m_client->fetch_and_add(*this, std::forward<T>(args)...);
+    }
+
+    /**
+     * @brief @see client::fetch_and_add_packed.
+     */
+    template <typename... T>
+    decltype(auto) fetch_and_add_packed(T&&... args) const
+    {
+        return m_ph.m_client->fetch_and_add_packed(*this,
+                                                   std::forward<T>(args)...);
+    }
+
+    /**
+     * @brief @see client::append.
+     */
+    template <typename... T> decltype(auto) append(T&&... args) const
+    {
+        return m_ph.m_client->append(*this, std::forward<T>(args)...);
+    }
+
+    /**
+     * @brief @see client::append_packed.
+     */
+    template <typename... T> decltype(auto) append_packed(T&&... args) const
+    {
+        return m_ph.m_client->append_packed(*this, std::forward<T>(args)...);
+    }
+
+    /**
+     * @brief @see client::sync.
+     */
+    template <typename... T> decltype(auto) sync(T&&... args) const
+    {
+        return m_ph.m_client->sync(*this, std::forward<T>(args)...);
+    }
+
+    /**
+     * @brief @see client::list_keys.
+     */
+    template <typename... T> decltype(auto) list_keys(T&&... args) const
+    {
+        return m_ph.m_client->list_keys(*this, std::forward<T>(args)...);
+    }
+
+    /**
+     * @brief @see client::list_keyvals.
+     */
+    template <typename... T> decltype(auto) list_keyvals(T&&... args) const
+    {
+        return m_ph.m_client->list_keyvals(*this, std::forward<T>(args)...);
+    }
+
+    /**
+     * @brief @see client::migrate.
+     */
+    template <typename... T>
+    void migrate(const database& dest_db, T&&... args) const
+    {
+        m_ph.m_client->migrate(*this, dest_db, std::forward<T>(args)...);
+    }
+
+    /**
+     * @brief @see client::migrate.
+     */
+    template <typename... T>
+    void migrate(const std::string& dest_provider_addr,
+                 uint16_t           dest_provider_id,
+                 T&&... args)
+    {
+        m_ph.m_client->migrate(*this, dest_provider_addr, dest_provider_id,
+                               std::forward<T>(args)...);
+    }
+};
+
+/**
+ * @brief The batch class accumulates puts, gets, erases, exists and
+ * length operations on databases of the same provider, to be executed
+ * in order by a single RPC. Keys and values are copied into the batch.
+ */
+class batch {
+
+    friend class client;
+
+    provider_handle               m_ph;
+    std::vector<sdskv_batch_op_t> m_ops;
+    std::vector<std::string>      m_keys;
+    std::vector<std::string>      m_values;
+
+    batch& add(const database&       db,
+               sdskv_batch_op_type_t type,
+               const void*           key,
+               hg_size_t             ksize,
+               const void*           value,
+               hg_size_t             vsize)
+    {
+        if (m_ops.empty())
+            m_ph = db.m_ph;
+        else if (db.m_ph.m_ph != m_ph.m_ph)
+            throw std::invalid_argument(
+                "databases of a batch must share the same provider handle");
+        sdskv_batch_op_t op;
+        op.type  = type;
+        op.db_id = db.m_db_id;
+        op.key   = nullptr;
+        op.ksize = ksize;
+        op.value = nullptr;
+        op.vsize = vsize;
+        op.ret   = SDSKV_SUCCESS;
+        m_ops.push_back(op);
+        m_keys.emplace_back((const char*)key, ksize);
+        if (value)
+            m_values.emplace_back((const char*)value, vsize);
+        else
+            m_values.emplace_back(vsize, '\0');
+        return *this;
+    }
+
+    const sdskv_batch_op_t& result(size_t i) const
+    {
+        const auto& op = m_ops.at(i);
+        if (op.ret != SDSKV_SUCCESS) throw exception(op.ret);
+        return op;
+    }
+
+  public:
+    /**
+     * @brief Adds a put operation.
+     *
+     * @return the batch itself, for chaining.
+     */
+    template <typename K, typename V>
+    batch& put(const database& db, const K& key, const V& value)
+    {
+        return add(db, SDSKV_BATCH_PUT, object_data(key), object_size(key),
+                   object_data(value), object_size(value));
+    }
+
+    /**
+     * @brief Adds a get operation. The value is retrieved only if it
+     * fits in max_vsize bytes.
+     *
+     * @return the batch itself, for chaining.
+     */
+    template <typename K>
+    batch& get(const database& db, const K& key, hg_size_t max_vsize)
+    {
+        return add(db, SDSKV_BATCH_GET, object_data(key), object_size(key),
+                   nullptr, max_vsize);
+    }
+
+    /**
+     * @brief Adds an erase operation.
+     *
+     * @return the batch itself, for chaining.
+     */
+    template <typename K> batch& erase(const database& db, const K& key)
+    {
+        return add(db, SDSKV_BATCH_ERASE, object_data(key), object_size(key),
+                   nullptr, 0);
+    }
+
+    /**
+     * @brief Adds an exists operation.
+     *
+     * @return the batch itself, for chaining.
+     */
+    template <typename K> batch& exists(const database& db, const K& key)
+    {
+        return add(db, SDSKV_BATCH_EXISTS, object_data(key), object_size(key),
+                   nullptr, 0);
+    }
+
+    /**
+     * @brief Adds a length operation.
+     *
+     * @return the batch itself, for chaining.
+     */
+    template <typename K> batch& length(const database& db, const K& key)
+    {
+        return add(db, SDSKV_BATCH_LENGTH, object_data(key), object_size(key),
+                   nullptr, 0);
+    }
+
+    /**
+     * @brief Number of operations in the batch.
+     */
+    size_t size() const { return m_ops.size(); }
+
+    /**
+     * @brief Executes the batch (@see client::execute). Executing an
+     * empty batch does nothing.
+     */
+    void execute()
+    {
+        if (m_ops.empty()) return;
+        if (m_ph.m_ph == SDSKV_PROVIDER_HANDLE_NULL || !m_ph.m_client)
+            throw std::invalid_argument("batch has no provider handle");
+        m_ph.m_client->execute(*this);
+    }
+
+    /**
+     * @brief Return code of the i-th operation once the batch has
+     * been executed.
+     */
+    int status(size_t i) const { return m_ops.at(i).ret; }
+
+    /**
+     * @brief Value retrieved by the i-th operation, which must be a get.
+     * Throws an exception if the operation failed.
+     */
+    std::string value(size_t i) const
+    {
+        const auto& op = result(i);
+        return std::string(m_values[i].data(), op.vsize);
+    }
+
+    /**
+     * @brief Size of the value found by the i-th operation, which must
+     * be a get or a length. Throws an exception if the operation failed.
+     */
+    hg_size_t vsize(size_t i) const { return result(i).vsize; }
+
+    /**
+     * @brief Whether the key of the i-th operation, which must be an
+     * exists, was found.
+     */
+    bool found(size_t i) const { return result(i).vsize != 0; }
+};
+
+/**
+ * @brief The distributed_database class wraps a sdskv_dist_database_t and
+ * spreads keys over a list of databases (shards), possibly managed by
+ * different providers. Single-key operations are routed to the shard
+ * the key belongs to; multi-key operations are split per shard and the
+ * sub-batches are sent concurrently.
+ */
+class distributed_database {
+
+    using partition_function
+        = std::function<size_t(const void*, hg_size_t, size_t)>;
+
+    std::vector<database>                       m_shards;
+    std::shared_ptr<struct sdskv_dist_database> m_db;
+    std::shared_ptr<partition_function>         m_partitioner;
+
+    static size_t call_partitioner(const void* key,
+                                   hg_size_t   ksize,
+                                   size_t      num_shards,
+                                   void*       uargs)
+    {
+        return (*static_cast<partition_function*>(uargs))(key, ksize,
+                                                          num_shards);
+    }
+
+    template <typename K>
+    using if_object = std::enable_if_t<!std::is_pointer<K>::value, int>;
+
+  public:
+    /**
+     * @brief Default constructor produces an invalid distributed database.
+     */
+    distributed_database() = default;
+
+    /**
+     * @brief Creates a distributed database over the given shards.
+     * Every client must list the shards in the same order.
+     *
+     * @param shards Databases among which keys are spread.
+     * @param type Partitioner (see sdskv_dist_database_create).
+     */
+    distributed_database(
+        const std::vector<database>& shards,
+        sdskv_partitioner_type_t     type = SDSKV_PARTITION_CONSISTENT_HASH)
+        : m_shards(shards)
+    {
+        std::vector<sdskv_provider_handle_t> phs;
+        std::vector<sdskv_database_id_t>     ids;
+        for (const auto& db : shards) {
+            phs.push_back(db.m_ph.m_ph);
+            ids.push_back(db.m_db_id);
+        }
+        sdskv_dist_database_t db;
+        int ret = sdskv_dist_database_create(shards.size(), phs.data(),
+                                             ids.data(), type, &db);
+        _CHECK_RET(ret);
+        m_db = std::shared_ptr<struct sdskv_dist_database>(
+            db, sdskv_dist_database_free);
+    }
+
+    /**
+     * @brief Switches to range partitioning (see
+     * sdskv_dist_database_set_ranges). Meant to work with std::string
+     * and std::vector<X> where X is a standard layout type.
+     *
+     * @param split_keys num_shards()-1 keys in increasing order.
+     */
+    template <typename K>
+    void set_ranges(const std::vector<K>& split_keys) const
+    {
+        std::vector<const void*> kdata;
+        std::vector<hg_size_t>   ksizes;
+        for (const auto& k : split_keys) {
+            kdata.push_back(object_data(k));
+            ksizes.push_back(object_size(k));
+        }
+        if (split_keys.size() + 1 != m_shards.size())
+            throw std::length_error(
+                "The number of split keys should be the number of shards "
+                "minus one");
+        int ret = sdskv_dist_database_set_ranges(m_db.get(), kdata.data(),
+                                                 ksizes.data());
+        _CHECK_RET(ret);
+    }
+
+    /**
+     * @brief Switches to a user-provided partitioner, called with a key,
+     * its size and the number of shards.
+     */
+    void set_partitioner(partition_function fn)
+    {
+        auto p  = std::make_shared<partition_function>(std::move(fn));
+        int ret = sdskv_dist_database_set_partitioner(
+            m_db.get(), call_partitioner, p.get());
+        _CHECK_RET(ret);
+        m_partitioner = std::move(p);
+    }
+
+    /**
+     * @brief Number of shards.
+     */
+    size_t num_shards() const { return m_shards.size(); }
+
+    /**
+     * @brief Database of the i-th shard.
+     */
+    const database& shard(size_t i) const { return m_shards.at(i); }
+
+    /**
+     * @brief Index of the shard a key belongs to.
+     */
+    size_t locate(const void* key, hg_size_t ksize) const
+    {
+        size_t s;
+        int    ret = sdskv_dist_database_locate(m_db.get(), key, ksize, &s);
+        _CHECK_RET(ret);
+        return s;
+    }
+
+    /**
+     * @brief Whether the i-th shard may hold keys greater than start_key
+     * and starting with prefix (see sdskv_dist_database_overlaps).
+     */
+    bool overlaps(size_t             i,
+                  const std::string& start_key,
+                  const std::string& prefix) const
+    {
+        int flag;
+        int ret = sdskv_dist_database_overlaps(
+            m_db.get(), i, start_key.data(), start_key.size(), prefix.data(),
+            prefix.size(), &flag);
+        _CHECK_RET(ret);
+        return flag;
+    }
+
+    /**
+     * @brief Database of the shard a key belongs to. Meant to work with
+     * std::string and std::vector<X> where X is a standard layout type.
+     */
+    template <typename K, if_object<K> = 0>
+    const database& shard_of(const K& key) const
+    {
+        return m_shards[locate(object_data(key), object_size(key))];
+    }
+
+    /**
+     * @brief @see client::put, on the shard the key belongs to.
+     */
+    template <typename K, typename... T, if_object<K> = 0>
+    void put(const K& key, T&&... args) const
+    {
+        shard_of(key).put(key, std::forward<T>(args)...);
+    }
+
+    void put(const void* key,
+             hg_size_t   ksize,
+             const void* value,
+             hg_size_t   vsize) const
+    {
+        m_shards[locate(key, ksize)].put(key, ksize, value, vsize);
+    }
+
+    /**
+     * @brief @see client::get, on the shard the key belongs to.
+     */
+    template <typename K, typename... T, if_object<K> = 0>
+    decltype(auto) get(const K& key, T&&... args) const
+    {
+        return shard_of(key).get(key, std::forward<T>(args)...);
+    }
+
+    bool get(const void* key,
+             hg_size_t   ksize,
+             void*       value,
+             hg_size_t*  vsize) const
+    {
+        return m_shards[locate(key, ksize)].get(key, ksize, value, vsize);
+    }
+
+    /**
+     * @brief @see client::exists, on the shard the key belongs to.
+     */
+    template <typename K, if_object<K> = 0> bool exists(const K& key) const
+    {
+        return shard_of(key).exists(key);
+    }
+
+    bool exists(const void* key, hg_size_t ksize) const
+    {
+        return m_shards[locate(key, ksize)].exists(key, ksize);
+    }
+
+    /**
+     * @brief @see client::length, on the shard the key belongs to.
+     */
+    template <typename K, if_object<K> = 0>
+    hg_size_t length(const K& key) const
+    {
+        return shard_of(key).length(key);
+    }
+
+    hg_size_t length(const void* key, hg_size_t ksize) const
+    {
+        return m_shards[locate(key, ksize)].length(key, ksize);
+    }
+
+    /**
+     * @brief @see client::erase, on the shard the key belongs to.
+     */
+    template <typename K, if_object<K> = 0> void erase(const K& key) const
+    {
+        shard_of(key).erase(key);
+    }
+
+    void erase(const void* key, hg_size_t ksize) const
+    {
+        m_shards[locate(key, ksize)].erase(key, ksize);
+    }
+
+    /**
+     * @brief Equivalent to sdskv_dist_put_multi.
+     */
+    void put_multi(hg_size_t          count,
+                   const void* const* keys,
+                   const hg_size_t*   ksizes,
+                   const void* const* values,
+                   const hg_size_t*   vsizes) const
+    {
+        int ret = sdskv_dist_put_multi(m_db.get(), count, keys, ksizes, values,
+                                       vsizes);
+        _CHECK_RET(ret);
+    }
+
+    /**
+     * @brief Templated version of put_multi, meant to work with
+     * std::string and std::vector<X> where X is a standard layout type.
+     */
+    template <typename K, typename V>
+    void put_multi(const std::vector<K>& keys,
+                   const std::vector<V>& values) const
+    {
+        if (keys.size() != values.size())
+            throw std::length_error(
+                "Provided vectors should have the same size");
+        std::vector<const void*> kdata, vdata;
+        std::vector<hg_size_t>   ksizes, vsizes;
+        for (unsigned i = 0; i < keys.size(); i++) {
+            kdata.push_back(object_data(keys[i]));
+            ksizes.push_back(object_size(keys[i]));
+            vdata.push_back(object_data(values[i]));
+            vsizes.push_back(object_size(values[i]));
+        }
+        put_multi(keys.size(), kdata.data(), ksizes.data(), vdata.data(),
+                  vsizes.data());
+    }
+
+    /**
+     * @brief Equivalent to sdskv_dist_get_multi.
+     */
+    bool get_multi(hg_size_t          count,
+                   const void* const* keys,
+                   const hg_size_t*   ksizes,
+                   void**             values,
+                   hg_size_t*         vsizes) const
+    {
+        int ret = sdskv_dist_get_multi(m_db.get(), count, keys, ksizes, values,
+                                       vsizes);
+        _CHECK_RET(ret);
+        return true;
+    }
+
+    /**
+     * @brief Templated version of get_multi. The values must be
+     * pre-allocated and are resized to the size of the values found.
+     */
+    template <typename K, typename V>
+    bool get_multi(const std::vector<K>& keys, std::vector<V>& values) const
+    {
+        if (keys.size() != values.size())
+            throw std::length_error(
+                "Provided vectors should have the same size");
+        std::vector<const void*> kdata;
+        std::vector<void*>       vdata;
+        std::vector<hg_size_t>   ksizes, vsizes;
+        for (unsigned i = 0; i < keys.size(); i++) {
+            kdata.push_back(object_data(keys[i]));
+            ksizes.push_back(object_size(keys[i]));
+            vdata.push_back(object_data(values[i]));
+            vsizes.push_back(object_size(values[i]));
+        }
+        get_multi(keys.size(), kdata.data(), ksizes.data(), vdata.data(),
+                  vsizes.data());
+        for (unsigned i = 0; i < values.size(); i++)
+            object_resize(values[i], vsizes[i]);
+        return true;
+    }
+
+    /**
+     * @brief Equivalent to sdskv_dist_exists_multi.
+     *
+     * @return an std::vector<bool> v where v[i] is true iff key i exists.
+     */
+    std::vector<bool> exists_multi(size_t             num,
+                                   const void* const* keys,
+                                   const hg_size_t*   ksizes) const
+    {
+        std::vector<int> flags(num);
+        int ret = sdskv_dist_exists_multi(m_db.get(), num, keys, ksizes,
+                                          flags.data());
+        _CHECK_RET(ret);
+        return std::vector<bool>(flags.begin(), flags.end());
+    }
+
+    /**
+     * @brief Templated version of exists_multi.
+     */
+    template <typename K>
+    std::vector<bool> exists_multi(const std::vector<K>& keys) const
+    {
+        std::vector<const void*> kdata;
+        std::vector<hg_size_t>   ksizes;
+        for (const auto& k : keys) {
+            kdata.push_back(object_data(k));
+            ksizes.push_back(object_size(k));
+        }
+        return exists_multi(keys.size(), kdata.data(), ksizes.data());
+    }
+
+    /**
+     * @brief Equivalent to sdskv_dist_length_multi.
+     */
+    bool length_multi(hg_size_t          num,
+                      const void* const* keys,
+                      const hg_size_t*   ksizes,
+                      hg_size_t*         vsizes) const
+    {
+        int ret = sdskv_dist_length_multi(m_db.get(), num, keys, ksizes,
+                                          vsizes);
+        _CHECK_RET(ret);
+        return true;
+    }
+
+    /**
+     * @brief Templated version of length_multi returning a vector of sizes.
+     */
+    template <typename K>
+    std::vector<hg_size_t> length_multi(const std::vector<K>& keys) const
+    {
+        std::vector<const void*> kdata;
+        std::vector<hg_size_t>   ksizes, vsizes(keys.size());
+        for (const auto& k : keys) {
+            kdata.push_back(object_data(k));
+            ksizes.push_back(object_size(k));
+        }
+        length_multi(keys.size(), kdata.data(), ksizes.data(), vsizes.data());
+        return vsizes;
+    }
+
+    /**
+     * @brief Equivalent to sdskv_dist_erase_multi_with_flags.
+     *
+     * @return an std::vector<bool> v where v[i] is true iff key i was
+     * erased.
+     */
+    std::vector<bool> erase_multi(size_t             num,
+                                  const void* const* keys,
+                                  const hg_size_t*   ksizes) const
+    {
+        std::vector<int> flags(num);
+        int ret = sdskv_dist_erase_multi_with_flags(m_db.get(), num, keys,
+                                                    ksizes, flags.data());
+        _CHECK_RET(ret);
+        return std::vector<bool>(flags.begin(), flags.end());
+    }
+
+    /**
+     * @brief Templated version of erase_multi.
+     */
+    template <typename K>
+    std::vector<bool> erase_multi(const std::vector<K>& keys) const
+    {
+        std::vector<const void*> kdata;
+        std::vector<hg_size_t>   ksizes;
+        for (const auto& k : keys) {
+            kdata.push_back(object_data(k));
+            ksizes.push_back(object_size(k));
+        }
+        return erase_multi(keys.size(), kdata.data(), ksizes.data());
+    }
+};
+
+/**
+ * @brief The ordered_scan class iterates, in key order, over the key/value
+ * pairs of a distributed database that are greater than a start key and
+ * match a prefix. Shards that cannot hold such keys are skipped. Pages are
+ * fetched with list_keyvals from all the shards at once, and the next page
+ * of each shard is prefetched in a ULT while the current one is consumed;
+ * the pages are then k-way merged using a comparator that must order keys
+ * the same way as the databases do (bytewise by default).
+ */
+class ordered_scan {
+
+  public:
+    using comparator
+        = std::function<int(const std::string&, const std::string&)>;
+
+  private:
+    struct shard_cursor {
+        database                 db;
+        std::string              prefix;
+        size_t                   page_size;
+        hg_size_t                ksize_hint;
+        hg_size_t                vsize_hint;
+        std::string              last_key;
+        std::vector<std::string> keys, values;
+        size_t                   pos  = 0;
+        bool                     done = false;
+        std::vector<std::string> next_keys, next_values;
+        ABT_thread               fetcher = ABT_THREAD_NULL;
+        int                      error   = SDSKV_SUCCESS;
+
+        void fetch()
+        {
+            next_keys.assign(page_size, std::string(ksize_hint, '\0'));
+            next_values.assign(page_size, std::string(vsize_hint, '\0'));
+            try {
+                db.list_keyvals(last_key, prefix, next_keys, next_values);
+            } catch (exception& ex) {
+                error = ex.error();
+            } catch (...) {
+                error = SDSKV_ERR_ALLOCATION;
+            }
+        }
+
+        static void fetch_ult(void* arg)
+        {
+            static_cast<shard_cursor*>(arg)->fetch();
+        }
+    };
+
+    comparator                                 m_cmp;
+    ABT_pool                                   m_pool = ABT_POOL_NULL;
+    std::vector<std::unique_ptr<shard_cursor>> m_cursors;
+    std::vector<shard_cursor*>                 m_heap;
+
+    void start_fetch(shard_cursor& c)
+    {
+        if (m_pool == ABT_POOL_NULL
+            || ABT_thread_create(m_pool, shard_cursor::fetch_ult, &c,
+                                 ABT_THREAD_ATTR_NULL, &c.fetcher)
+                   != ABT_SUCCESS) {
+            c.fetcher = ABT_THREAD_NULL;
+            c.fetch();
+        }
+    }
+
+    void wait_fetch(shard_cursor& c)
+    {
+        if (c.fetcher != ABT_THREAD_NULL) {
+            ABT_thread_join(c.fetcher);
+            ABT_thread_free(&c.fetcher);
+            c.fetcher = ABT_THREAD_NULL;
+        }
+    }
+
+    /* installs the prefetched page and starts fetching the next one;
+     * returns false if the shard has no more keys */
+    bool next_page(shard_cursor& c)
+    {
+        wait_fetch(c);
+        if (c.error != SDSKV_SUCCESS) throw exception(c.error);
+        c.keys.swap(c.next_keys);
+        c.values.swap(c.next_values);
+        c.pos = 0;
+        if (c.keys.size() < c.page_size) c.done = true;
+        if (c.keys.empty()) return false;
+        c.last_key = c.keys.back();
+        if (!c.done) start_fetch(c);
+        return true;
+    }
+
+    bool heap_greater(const shard_cursor* a, const shard_cursor* b) const
+    {
+        return m_cmp(a->keys[a->pos], b->keys[b->pos]) > 0;
+    }
+
+    void heap_push(shard_cursor* c)
+    {
+        m_heap.push_back(c);
+        std::push_heap(m_heap.begin(), m_heap.end(),
+                       [this](const shard_cursor* a, const shard_cursor* b) {
+                           return heap_greater(a, b);
+                       });
+    }
+
+    shard_cursor* heap_pop()
+    {
+        std::pop_heap(m_heap.begin(), m_heap.end(),
+                      [this](const shard_cursor* a, const shard_cursor* b) {
+                          return heap_greater(a, b);
+                      });
+        shard_cursor* c = m_heap.back();
+        m_heap.pop_back();
+        return c;
+    }
+
+  public:
+    /**
+     * @brief Starts a scan.
+     *
+     * @param ddb Distributed database.
+     * @param start_key Key after which to start (excluded).
+     * @param prefix Prefix the returned keys must have.
+     * @param page_size Number of key/value pairs fetched per RPC.
+     * @param ksize_hint Expected maximum key size.
+     * @param vsize_hint Expected maximum value size.
+     * @param cmp Comparator, returning a negative, zero or positive value
+     * like memcmp.
+     */
+    ordered_scan(const distributed_database& ddb,
+                 const std::string&          start_key  = std::string(),
+                 const std::string&          prefix     = std::string(),
+                 size_t                      page_size  = 256,
+                 hg_size_t                   ksize_hint = 256,
+                 hg_size_t                   vsize_hint = 1024,
+                 comparator                  cmp        = comparator())
+        : m_cmp(cmp ? std::move(cmp)
+                    : [](const std::string& a, const std::string& b) {
+                          return a.compare(b);
+                      })
+    {
+        if (page_size == 0)
+            throw std::invalid_argument("page size should not be 0");
+        for (size_t i = 0; i < ddb.num_shards(); i++) {
+            if (!ddb.overlaps(i, start_key, prefix)) continue;
+            std::unique_ptr<shard_cursor> c(new shard_cursor());
+            c->db         = ddb.shard(i);
+            c->prefix     = prefix;
+            c->page_size  = page_size;
+            c->ksize_hint = ksize_hint;
+            c->vsize_hint = vsize_hint;
+            c->last_key   = start_key;
+            m_cursors.push_back(std::move(c));
+        }
+        if (m_cursors.size() > 1) {
+            margo_get_handler_pool(
+                m_cursors[0]->db.m_ph.m_client->m_mid, &m_pool);
+        }
+        for (auto& c : m_cursors) start_fetch(*c);
+        try {
+            for (auto& c : m_cursors)
+                if (next_page(*c)) heap_push(c.get());
+        } catch (...) {
+            for (auto& c : m_cursors) wait_fetch(*c);
+            throw;
+        }
+    }
+
+    ordered_scan(const ordered_scan&) = delete;
+    ordered_scan& operator=(const ordered_scan&) = delete;
+
+    /**
+     * @brief Destructor. Waits for pending prefetches.
+     */
+    ~ordered_scan()
+    {
+        for (auto& c : m_cursors) wait_fetch(*c);
+    }
+
+    /**
+     * @brief Gets the next key/value pair.
+     *
+     * @param key Resulting key.
+     * @param value Resulting value.
+     *
+     * @return false if there are no more key/value pairs.
+     */
+    bool next(std::string& key, std::string& value)
+    {
+        if (m_heap.empty()) return false;
+        shard_cursor* c = heap_pop();
+        key.swap(c->keys[c->pos]);
+        value.swap(c->values[c->pos]);
+        c->pos += 1;
+        if (c->pos < c->keys.size()) {
+            heap_push(c);
+        } else if (!c->done && next_page(*c)) {
+            heap_push(c);
+        }
+        return true;
+    }
+};
+
+inline database client::open(const provider_handle& ph,
                              const std::string&     db_name) const
 {
     sdskv_database_id_t db_id;
@@ -1757,6 +3088,36 @@ inline std::vector<database> client::open(const provider_handle& ph) const
     return dbs;
 }
 
+inline std::string client::get_stats(const provider_handle& ph) const
+{
+    char* stats = nullptr;
+    int   ret   = sdskv_get_stats(ph.m_ph, &stats);
+    _CHECK_RET(ret);
+    std::string result(stats);
+    free(stats);
+    return result;
+}
+
+inline std::string client::get_trace(const provider_handle& ph) const
+{
+    char* trace = nullptr;
+    int   ret   = sdskv_get_trace(ph.m_ph, &trace);
+    _CHECK_RET(ret);
+    std::string result(trace);
+    free(trace);
+    return result;
+}
+
+inline std::string client::get_slow_ops(const provider_handle& ph) const
+{
+    char* slow_ops = nullptr;
+    int   ret      = sdskv_get_slow_ops(ph.m_ph, &slow_ops);
+    _CHECK_RET(ret);
+    std::string result(slow_ops);
+    free(slow_ops);
+    return result;
+}
+
 inline void client::put(const database& db,
                         const void*     key,
                         hg_size_t       ksize,
@@ -1905,12 +3266,218 @@ client::erase(const database& db, const void* key, hg_size_t ksize) const
     _CHECK_RET(ret);
 }
 
-inline void client::erase_multi(const database&    db,
-                                hg_size_t          num,
-                                const void* const* keys,
-                                const hg_size_t*   ksizes) const
+inline std::vector<bool> client::erase_multi(const database&    db,
+                                             hg_size_t          num,
+                                             const void* const* keys,
+                                             const hg_size_t*   ksizes) const
 {
-    int ret = sdskv_erase_multi(db.m_ph.m_ph, db.m_db_id, num, keys, ksizes);
+    std::vector<int> flags(num);
+    int ret = sdskv_erase_multi_with_flags(db.m_ph.m_ph, db.m_db_id, num, keys,
+                                           ksizes, flags.data());
+    _CHECK_RET(ret);
+    std::vector<bool> result(num);
+    for (unsigned i = 0; i < num; i++) result[i] = flags[i];
+    return result;
+}
+
+inline hg_size_t client::erase_range(const database& db,
+                                     const void*     lower_bound,
+                                     hg_size_t       lb_size,
+                                     const void*     upper_bound,
+                                     hg_size_t       ub_size) const
+{
+    hg_size_t num_erased;
+    int ret = sdskv_erase_range(db.m_ph.m_ph, db.m_db_id, lower_bound, lb_size,
+                                upper_bound, ub_size, &num_erased);
+    _CHECK_RET(ret);
+    return num_erased;
+}
+
+inline hg_size_t client::erase_prefix(const database& db,
+                                      const void*     prefix,
+                                      hg_size_t       prefix_size) const
+{
+    hg_size_t num_erased;
+    int       ret = sdskv_erase_prefix(db.m_ph.m_ph, db.m_db_id, prefix,
+                                 prefix_size, &num_erased);
+    _CHECK_RET(ret);
+    return num_erased;
+}
+
+inline bool client::compare_and_swap(const database& db,
+                                     const void*     key,
+                                     hg_size_t       ksize,
+                                     const void*     expected,
+                                     hg_size_t       esize,
+                                     const void*     desired,
+                                     hg_size_t       dsize) const
+{
+    int swapped;
+    int ret = sdskv_compare_and_swap(db.m_ph.m_ph, db.m_db_id, key, ksize,
+                                     expected, esize, desired, dsize, &swapped);
+    _CHECK_RET(ret);
+    return swapped;
+}
+
+inline std::vector<bool>
+client::compare_and_swap_packed(const database&  db,
+                                hg_size_t        num,
+                                const void*      keys,
+                                const hg_size_t* ksizes,
+                                const void*      expected,
+                                const hg_size_t* esizes,
+                                const void*      desired,
+                                const hg_size_t* dsizes) const
+{
+    std::vector<int> flags(num);
+    int              ret = sdskv_compare_and_swap_packed(
+        db.m_ph.m_ph, db.m_db_id, num, keys, ksizes, expected, esizes,
+        desired, dsizes, flags.data());
+    _CHECK_RET(ret);
+    std::vector<bool> result(num);
+    for (unsigned i = 0; i < num; i++) result[i] = flags[i];
+    return result;
+}
+
+inline int64_t client::fetch_and_add(const database& db,
+                                     const void*     key,
+                                     hg_size_t       ksize,
+                                     int64_t         delta) const
+{
+    int64_t previous;
+    int     ret = sdskv_fetch_and_add(db.m_ph.m_ph, db.m_db_id, key, ksize,
+                                  delta, &previous);
+    _CHECK_RET(ret);
+    return previous;
+}
+
+inline void client::fetch_and_add_packed(const database&  db,
+                                         hg_size_t        num,
+                                         const void*      keys,
+                                         const hg_size_t* ksizes,
+                                         const int64_t*   deltas,
+                                         int64_t*         previous) const
+{
+    int ret = sdskv_fetch_and_add_packed(db.m_ph.m_ph, db.m_db_id, num, keys,
+                                         ksizes, deltas, previous);
+    _CHECK_RET(ret);
+}
+
+inline hg_size_t client::append(const database& db,
+                                const void*     key,
+                                hg_size_t       ksize,
+                                const void*     data,
+                                hg_size_t       dsize) const
+{
+    hg_size_t new_vsize;
+    int       ret = sdskv_append(db.m_ph.m_ph, db.m_db_id, key, ksize, data,
+                           dsize, &new_vsize);
+    _CHECK_RET(ret);
+    return new_vsize;
+}
+
+inline void client::append_packed(const database&  db,
+                                  hg_size_t        num,
+                                  const void*      keys,
+                                  const hg_size_t* ksizes,
+                                  const void*      data,
+                                  const hg_size_t* dsizes,
+                                  hg_size_t*       new_vsizes) const
+{
+    int ret = sdskv_append_packed(db.m_ph.m_ph, db.m_db_id, num, keys, ksizes,
+                                  data, dsizes, new_vsizes);
+    _CHECK_RET(ret);
+}
+
+inline void client::sync(const database& db) const
+{
+    int ret = sdskv_sync(db.m_ph.m_ph, db.m_db_id);
+    _CHECK_RET(ret);
+}
+
+inline sdskv_provider_handle_t
+client::multi_db_table(const std::vector<database>&      dbs,
+                       std::vector<sdskv_database_id_t>& ids)
+{
+    if (dbs.empty())
+        throw std::invalid_argument("empty database table");
+    sdskv_provider_handle_t ph = dbs[0].m_ph.m_ph;
+    ids.resize(dbs.size());
+    for (unsigned i = 0; i < dbs.size(); i++) {
+        if (dbs[i].m_ph.m_ph != ph)
+            throw std::invalid_argument(
+                "all databases must belong to the same provider");
+        ids[i] = dbs[i].m_db_id;
+    }
+    return ph;
+}
+
+inline void client::put_packed(const std::vector<database>& dbs,
+                               hg_size_t                    count,
+                               const uint32_t*              db_indices,
+                               const void*                  keys,
+                               const hg_size_t*             ksizes,
+                               const void*                  values,
+                               const hg_size_t*             vsizes) const
+{
+    std::vector<sdskv_database_id_t> ids;
+    sdskv_provider_handle_t          ph = multi_db_table(dbs, ids);
+    int ret = sdskv_put_packed_multi_db(ph, ids.size(), ids.data(), count,
+                                        db_indices, keys, ksizes, values,
+                                        vsizes);
+    _CHECK_RET(ret);
+}
+
+inline bool client::get_packed(const std::vector<database>& dbs,
+                               hg_size_t*                   count,
+                               const uint32_t*              db_indices,
+                               const void*                  keys,
+                               const hg_size_t*             ksizes,
+                               hg_size_t                    valbufsize,
+                               void*                        values,
+                               hg_size_t*                   vsizes) const
+{
+    std::vector<sdskv_database_id_t> ids;
+    sdskv_provider_handle_t          ph = multi_db_table(dbs, ids);
+    size_t                           n  = *count;
+    int ret = sdskv_get_packed_multi_db(ph, ids.size(), ids.data(), &n,
+                                        db_indices, keys, ksizes, valbufsize,
+                                        values, vsizes);
+    *count  = n;
+    _CHECK_RET(ret);
+    return true;
+}
+
+inline std::vector<bool>
+client::exists_packed(const std::vector<database>& dbs,
+                      size_t                       num,
+                      const uint32_t*              db_indices,
+                      const void*                  keys,
+                      const hg_size_t*             ksizes) const
+{
+    std::vector<sdskv_database_id_t> ids;
+    sdskv_provider_handle_t          ph = multi_db_table(dbs, ids);
+    std::vector<int>                 flags(num);
+    int ret = sdskv_exists_packed_multi_db(ph, ids.size(), ids.data(), num,
+                                           db_indices, keys, ksizes,
+                                           flags.data());
+    _CHECK_RET(ret);
+    std::vector<bool> result(num);
+    for (unsigned i = 0; i < num; i++) result[i] = flags[i];
+    return result;
+}
+
+inline void client::execute(batch& b) const
+{
+    if (b.m_ops.empty()) return;
+    for (size_t i = 0; i < b.m_ops.size(); i++) {
+        auto& op = b.m_ops[i];
+        op.key   = b.m_keys[i].data();
+        op.value = object_data(b.m_values[i]);
+        /* vsize is overwritten by the results of a previous execution */
+        if (op.type == SDSKV_BATCH_GET) op.vsize = b.m_values[i].size();
+    }
+    int ret = sdskv_batch(b.m_ph.m_ph, b.m_ops.size(), b.m_ops.data());
     _CHECK_RET(ret);
 }
 
@@ -22,6 +22,23 @@ typedef uint64_t sdskv_database_id_t;
 #define SDSKV_REMOVE_ORIGINAL \
     1 /* for migration operations, remove the origin after migrating */
 
+typedef enum sdskv_batch_op_type_t
+{
+    SDSKV_BATCH_PUT = 0, /* put a key/value pair */
+    SDSKV_BATCH_GET,     /* get the value associated with a key */
+    SDSKV_BATCH_ERASE,   /* erase a key */
+    SDSKV_BATCH_EXISTS,  /* check whether a key exists */
+    SDSKV_BATCH_LENGTH   /* get the size of the value associated with a key */
+} sdskv_batch_op_type_t;
+
+typedef enum sdskv_partitioner_type_t
+{
+    SDSKV_PARTITION_CONSISTENT_HASH = 0, /* hash ring with virtual nodes */
+    SDSKV_PARTITION_JUMP_HASH,           /* jump consistent hash */
+    SDSKV_PARTITION_RANGE,  /* contiguous key ranges given by split keys */
+    SDSKV_PARTITION_CUSTOM  /* user-provided partitioning function */
+} sdskv_partitioner_type_t;
+
 /* Errors in SDSKV are int32_t. The most-significant byte stores the Argobots
  * error, if any. The second most-significant byte stores the Mercury error, if
  * any. The next 2 bytes store the SDSKV error code defined bellow. Argobots and
@@ -47,6 +64,7 @@ typedef uint64_t sdskv_database_id_t;
     X(SDSKV_ERR_REMI, "REMI error")                       \
     X(SDSKV_ERR_KEYEXISTS, "Key exists")                  \
     X(SDSKV_ERR_CONFIG, "Bad configuration")              \
+    X(SDSKV_ERR_BUSY, "Too many pending requests")        \
     X(SDSKV_ERR_MAX, "End of range for valid error codes")
 
 #define X(__err__, __msg__) __err__,
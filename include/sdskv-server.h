@@ -28,6 +28,13 @@ extern "C" {
 typedef struct sdskv_server_context_t* sdskv_provider_t;
 typedef int (*sdskv_compare_fn)(const void*, hg_size_t, const void*, hg_size_t);
 
+typedef enum sdskv_durability_t
+{
+    SDSKV_DURABILITY_NONE = 0, /* leave flushing to the backend */
+    SDSKV_DURABILITY_PERIODIC, /* sync every db_sync_interval_ms */
+    SDSKV_DURABILITY_SYNC      /* sync every write before acknowledging it */
+} sdskv_durability_t;
+
 typedef struct sdskv_config_t {
     const char*     db_name; // name of the database
     const char*     db_path; // path to the database
@@ -35,6 +42,22 @@ typedef struct sdskv_config_t {
     const char*
         db_comp_fn_name; // name of registered comparison function (can be NULL)
     int db_no_overwrite; // prevents overwritting data if set to 1
+    /* the following fields match the database fields of the JSON config,
+     * and a field left to 0 takes the default value of the JSON field */
+    int                db_group_commit;     // coalesce puts/erases if set to 1
+    sdskv_durability_t db_durability;       // when writes reach the storage
+    unsigned           db_sync_interval_ms; // for SDSKV_DURABILITY_PERIODIC
+    unsigned           db_max_inflight;     // 0 disables admission control
+    unsigned           db_max_queued_per_client; // 0 means no limit
+    /* weights of clients (by address) for admission control, other
+     * clients have a weight of 1 */
+    size_t             db_num_client_weights;
+    const char* const* db_client_addresses;
+    const double*      db_client_weights;
+    /* hot-key tracking, disabled when db_hot_keys is 0 */
+    unsigned db_hot_keys;              // number of hot keys to track
+    unsigned db_hot_key_prefix_length; // length of the tracked key prefixes
+    unsigned db_hot_key_sample_every;  // sample one access out of this many
 } sdskv_config_t;
 
 #define SDSKV_CONFIG_DEFAULT                       \
@@ -53,17 +76,26 @@ typedef void (*sdskv_post_migration_callback_fn)(sdskv_provider_t,
 /**
  * The bake_provider_init_info structure can be passed in to the
  * bake_provider_register() function to configure the provider. The struct
- * can be memset to zero to use default values.
+ * can be memset to zero to use default values. Fields may be appended in
+ * later versions, so initialize it with SDSKV_PROVIDER_INIT_INFO_INIT (or
+ * memset) rather than field by field.
  */
 struct sdskv_provider_init_info {
     const char* json_config;   /* optional JSON-formatted config */
     ABT_pool    rpc_pool;      /* optional pool on which to run RPC handlers */
     void*       remi_provider; /* optional REMI provider */
     void*       remi_client;   /* optional REMI client */
+    /* optional pools for each class of RPC, overriding the "pools" section
+     * of the JSON config; they default to rpc_pool */
+    ABT_pool read_pool;        /* gets, lengths, exists */
+    ABT_pool write_pool;       /* puts, erases, batches, RMW */
+    ABT_pool scan_pool;        /* key listings, range/prefix erasures */
+    ABT_pool maintenance_pool; /* sync, migrations */
 };
-#define SDSKV_PROVIDER_INIT_INFO_INIT   \
-    {                                   \
-        NULL, ABT_POOL_NULL, NULL, NULL \
+#define SDSKV_PROVIDER_INIT_INFO_INIT                                 \
+    {                                                                 \
+        NULL, ABT_POOL_NULL, NULL, NULL, ABT_POOL_NULL, ABT_POOL_NULL, \
+            ABT_POOL_NULL, ABT_POOL_NULL                              \
     }
 /**
  * @brief Creates a new provider.
@@ -92,6 +124,52 @@ int sdskv_provider_set_symbiomon(sdskv_provider_t provider, symbiomon_provider_t
  */
 char* sdskv_provider_get_config(sdskv_provider_t provider);
 
+/**
+ * @brief Obtain a JSON string with the provider's metrics: for each RPC,
+ * and for each RPC of each database, the number of requests, the number
+ * of errors, and the mean, p50, p90, p99, p999 and max latency (in us) of
+ * the whole request ("total") and of its decoding, admission ("queue"),
+ * bulk transfer, response and engine phases. For databases with hot-key
+ * tracking enabled, the "hot_keys" section lists their most accessed keys
+ * and key prefixes, with estimated counts and share of all accesses. The
+ * caller must free the string.
+ *
+ * @param provider provider
+ *
+ * @return a JSON string
+ */
+char* sdskv_provider_get_stats(sdskv_provider_t provider);
+
+/**
+ * @brief Obtain the spans of the requests sampled by the provider (see the
+ * "tracing" section of its configuration) as a JSON string in the Chrome
+ * trace event format, which chrome://tracing and Perfetto can load. Each
+ * request has a span named after its RPC and one span per phase (decode,
+ * queue, bulk_pull, bulk_push, respond), all tagged with the request id
+ * sent by the client (or chosen by the provider, for clients that do not
+ * trace) and, if the request is about a database, with its id. The caller
+ * must free the string.
+ *
+ * @param provider provider
+ *
+ * @return a JSON string, NULL on allocation failure
+ */
+char* sdskv_provider_get_trace(sdskv_provider_t provider);
+
+/**
+ * @brief Obtain the requests logged as slow by the provider (see the
+ * "slow_ops" section of its configuration) as a JSON string: the
+ * thresholds, the number of slow requests seen and dropped, and for each
+ * logged request, oldest first, its RPC, database, request id, return
+ * code, key prefix, number of keys, bytes and time spent in each phase.
+ * The caller must free the string.
+ *
+ * @param provider provider
+ *
+ * @return a JSON string
+ */
+char* sdskv_provider_get_slow_ops(sdskv_provider_t provider);
+
 /**
  * @brief Obtain underlying margo identifier
  */
@@ -133,7 +211,9 @@ int sdskv_provider_find_comparison_function(sdskv_provider_t provider,
 /**
  * Makes the provider start managing a database. The database will
  * be created if it does not exist. Otherwise, the provider will start
- * to manage the existing database.
+ * to manage the existing database. The settings of config apply as
+ * they do to the databases of the JSON config (which are attached
+ * through this function).
  *
  * @param[in] provider provider
  * @param[in] config configuration object to use for the database
@@ -31,7 +31,7 @@ class provider {
              const std::string& config      = std::string())
         : m_mid(mid)
     {
-        sdskv_provider_init_info args;
+        sdskv_provider_init_info args = SDSKV_PROVIDER_INIT_INFO_INIT;
         args.json_config = config.empty() ? nullptr : config.c_str();
         args.rpc_pool    = pool;
         int ret = sdskv_provider_register(mid, provider_id, &args, &m_provider);
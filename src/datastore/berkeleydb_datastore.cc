@@ -199,6 +199,24 @@ int BerkeleyDBDataStore::put_multi(hg_size_t          num_items,
     return SDSKV_SUCCESS;
 }
 
+bool BerkeleyDBDataStore::length(const void* key,
+                                 hg_size_t   ksize,
+                                 size_t*     vsize)
+{
+    Dbt db_key((void*)key, ksize);
+    Dbt db_data;
+    db_key.set_flags(DB_DBT_USERMEM);
+    /* a zero-length user buffer makes get fail with DB_BUFFER_SMALL
+     * after setting the size of the value, without copying it */
+    db_data.set_data(nullptr);
+    db_data.set_ulen(0);
+    db_data.set_flags(DB_DBT_USERMEM);
+    int status = _dbm->get(NULL, &db_key, &db_data, 0);
+    if (status != 0 && status != DB_BUFFER_SMALL) return false;
+    *vsize = db_data.get_size();
+    return true;
+}
+
 bool BerkeleyDBDataStore::exists(const void* key, hg_size_t size) const
 {
     Dbt db_key((void*)key, size);
@@ -214,7 +232,194 @@ bool BerkeleyDBDataStore::erase(const ds_bulk_t& key)
     return status == 0;
 }
 
-void BerkeleyDBDataStore::sync() { _dbm->sync(0); }
+int BerkeleyDBDataStore::erase_multi(hg_size_t          num_items,
+                                     const void* const* keys,
+                                     const hg_size_t*   ksizes,
+                                     uint8_t*           erased)
+{
+    /* all the deletes share a single transaction (and a single log flush
+     * on commit); deleting key by key is what tells us which keys existed */
+    DbTxn* txn    = nullptr;
+    int    status = 0;
+    if (_dbenv->txn_begin(NULL, &txn, 0) != 0) return SDSKV_ERR_ERASE;
+    for (hg_size_t i = 0; i < num_items; i++) {
+        Dbt db_key((void*)keys[i], ksizes[i]);
+        db_key.set_flags(DB_DBT_USERMEM);
+        status    = _dbm->del(txn, &db_key, 0);
+        erased[i] = status == 0 ? 1 : 0;
+        if (status != 0 && status != DB_NOTFOUND) break;
+    }
+    if (status != 0 && status != DB_NOTFOUND) {
+        txn->abort();
+        std::memset(erased, 0, num_items);
+        return SDSKV_ERR_ERASE;
+    }
+    if (txn->commit(0) != 0) {
+        std::memset(erased, 0, num_items);
+        return SDSKV_ERR_ERASE;
+    }
+    return SDSKV_SUCCESS;
+}
+
+void BerkeleyDBDataStore::write_batch(write_op* const* ops, size_t count)
+{
+    /* the whole batch is committed in a single transaction */
+    DbTxn* txn    = nullptr;
+    int    status = 0;
+    size_t i      = 0;
+    if (_dbenv->txn_begin(NULL, &txn, 0) != 0) goto fail;
+    for (i = 0; i < count; i++) {
+        write_op* op = ops[i];
+        Dbt       db_key((void*)op->key, op->ksize);
+        db_key.set_flags(DB_DBT_USERMEM);
+        if (op->erase) {
+            status  = _dbm->del(txn, &db_key, 0);
+            op->ret = status == 0 ? SDSKV_SUCCESS : SDSKV_ERR_ERASE;
+            if (status != 0 && status != DB_NOTFOUND) break;
+        } else {
+            Dbt db_data((void*)op->val, op->vsize);
+            db_data.set_flags(DB_DBT_USERMEM);
+            status = _dbm->put(txn, &db_key, &db_data,
+                               _no_overwrite ? DB_NOOVERWRITE : 0);
+            op->ret = status == 0 ? SDSKV_SUCCESS
+                    : status == DB_KEYEXIST ? SDSKV_ERR_KEYEXISTS
+                                            : SDSKV_ERR_PUT;
+            if (status != 0 && status != DB_KEYEXIST) break;
+        }
+    }
+    if (i != count) {
+        txn->abort();
+        goto fail;
+    }
+    if (txn->commit(0) != 0) goto fail;
+    return;
+
+fail:
+    for (i = 0; i < count; i++)
+        ops[i]->ret = ops[i]->erase ? SDSKV_ERR_ERASE : SDSKV_ERR_PUT;
+}
+
+int BerkeleyDBDataStore::erase_range(const ds_bulk_t& lower_bound,
+                                     const ds_bulk_t& upper_bound,
+                                     hg_size_t*       num_erased)
+{
+    DbTxn* txn = nullptr;
+    Dbc*   cursorp;
+    Dbt    key, data, ub((void*)upper_bound.data(), upper_bound.size());
+    int    ret;
+    *num_erased = 0;
+    /* values are not needed, don't let the cursor copy them */
+    data.set_flags(DB_DBT_PARTIAL);
+    data.set_doff(0);
+    data.set_dlen(0);
+
+    if (_dbenv->txn_begin(NULL, &txn, 0) != 0) return SDSKV_ERR_ERASE;
+    _dbm->cursor(txn, &cursorp, 0);
+
+    if (lower_bound.size()) {
+        Dbt lb((void*)lower_bound.data(), lower_bound.size());
+        key.set_size(lower_bound.size());
+        key.set_data((void*)lower_bound.data());
+        ret = cursorp->get(&key, &data, DB_SET_RANGE);
+        /* the lower bound is excluded */
+        if (ret == 0 && compkeys(_dbm, &key, &lb, nullptr) == 0)
+            ret = cursorp->get(&key, &data, DB_NEXT);
+    } else {
+        ret = cursorp->get(&key, &data, DB_FIRST);
+    }
+
+    hg_size_t count = 0;
+    for (; ret == 0; ret = cursorp->get(&key, &data, DB_NEXT)) {
+        if (upper_bound.size() && compkeys(_dbm, &key, &ub, nullptr) >= 0)
+            break;
+        ret = cursorp->del(0);
+        if (ret != 0) break;
+        count += 1;
+    }
+    cursorp->close();
+
+    if (ret != 0 && ret != DB_NOTFOUND) {
+        txn->abort();
+        return SDSKV_ERR_ERASE;
+    }
+    if (txn->commit(0) != 0) return SDSKV_ERR_ERASE;
+    *num_erased = count;
+    return SDSKV_SUCCESS;
+}
+
+int BerkeleyDBDataStore::erase_prefix(const ds_bulk_t& prefix,
+                                      hg_size_t*       num_erased)
+{
+    DbTxn* txn = nullptr;
+    Dbc*   cursorp;
+    Dbt    key, data;
+    int    ret;
+    *num_erased = 0;
+    /* values are not needed, don't let the cursor copy them */
+    data.set_flags(DB_DBT_PARTIAL);
+    data.set_doff(0);
+    data.set_dlen(0);
+
+    if (_dbenv->txn_begin(NULL, &txn, 0) != 0) return SDSKV_ERR_ERASE;
+    _dbm->cursor(txn, &cursorp, 0);
+    /* keys starting with prefix are contiguous only in byte order */
+    bool bytewise = _wrapper->_less == nullptr;
+
+    if (prefix.size() && bytewise) {
+        key.set_size(prefix.size());
+        key.set_data((void*)prefix.data());
+        ret = cursorp->get(&key, &data, DB_SET_RANGE);
+    } else {
+        ret = cursorp->get(&key, &data, DB_FIRST);
+    }
+
+    hg_size_t count = 0;
+    for (; ret == 0; ret = cursorp->get(&key, &data, DB_NEXT)) {
+        int c = compare_prefix(prefix, key.get_data(), key.get_size());
+        if (c < 0 && bytewise) break;
+        if (c != 0) continue;
+        ret = cursorp->del(0);
+        if (ret != 0) break;
+        count += 1;
+    }
+    cursorp->close();
+
+    if (ret != 0 && ret != DB_NOTFOUND) {
+        txn->abort();
+        return SDSKV_ERR_ERASE;
+    }
+    if (txn->commit(0) != 0) return SDSKV_ERR_ERASE;
+    *num_erased = count;
+    return SDSKV_SUCCESS;
+}
+
+int BerkeleyDBDataStore::sync()
+{
+    /* committed transactions may only be in the log buffer when the
+     * environment is in NOSYNC mode */
+    int status = _dbenv->log_flush(NULL);
+    if (status != 0) {
+        std::cerr << "BerkeleyDBDataStore::sync: BerkeleyDB error on "
+                     "log_flush = "
+                  << status << std::endl;
+        return SDSKV_ERR_PUT;
+    }
+    status = _dbm->sync(0);
+    if (status != 0) {
+        std::cerr << "BerkeleyDBDataStore::sync: BerkeleyDB error on sync = "
+                  << status << std::endl;
+        return SDSKV_ERR_PUT;
+    }
+    return SDSKV_SUCCESS;
+}
+
+void BerkeleyDBDataStore::set_durability(durability_t d)
+{
+    AbstractDataStore::set_durability(d);
+    int nosync = (d == DURABILITY_SYNC) ? 0 : 1;
+    _dbenv->set_flags(DB_TXN_WRITE_NOSYNC, nosync);
+    _dbenv->set_flags(DB_TXN_NOSYNC, nosync);
+}
 
 // In the case where Duplicates::ALLOW, this will return the first
 // value found using key.
@@ -275,110 +480,52 @@ bool BerkeleyDBDataStore::get(const ds_bulk_t&        key,
 
 void BerkeleyDBDataStore::set_in_memory(bool enable) { _in_memory = enable; };
 
-std::vector<ds_bulk_t> BerkeleyDBDataStore::vlist_keys(
-    const ds_bulk_t& start, hg_size_t count, const ds_bulk_t& prefix) const
+void BerkeleyDBDataStore::vvisit(const ds_bulk_t&  start,
+                                 const ds_bulk_t&  prefix,
+                                 bool              with_values,
+                                 const visitor_fn& visitor) const
 {
-    std::vector<ds_bulk_t> keys;
-    Dbc*                   cursorp;
-    Dbt                    key, data;
-    int                    ret;
-    _dbm->cursor(NULL, &cursorp, 0);
-
-    /* 'start' is like RADOS: not inclusive  */
-    if (start.size()) {
-        key.set_size(start.size());
-        key.set_data((void*)start.data());
-        ret = cursorp->get(&key, &data, DB_SET_RANGE);
-        if (ret != 0) {
-            cursorp->close();
-            return keys;
-        }
-    } else {
-        ret = cursorp->get(&key, &data, DB_FIRST);
-        if (ret != 0) {
-            cursorp->close();
-            return keys;
-        }
-    }
-
-    ds_bulk_t k((char*)key.get_data(),
-                ((char*)key.get_data()) + key.get_size());
-    /* SET_RANGE will return the smallest key greater than or equal to the
-     * requested key, but we want strictly greater than */
-    int c = 0;
-    if (k != start) {
-        c = std::memcmp(prefix.data(), k.data(), prefix.size());
-        if (c == 0) { keys.push_back(std::move(k)); }
+    Dbc* cursorp;
+    Dbt  key, data;
+    int  ret;
+    if (!with_values) {
+        /* only the keys are needed, don't let the cursor copy values */
+        data.set_flags(DB_DBT_PARTIAL);
+        data.set_doff(0);
+        data.set_dlen(0);
     }
-    while (keys.size() < count && c >= 0) {
-        ret = cursorp->get(&key, &data, DB_NEXT);
-        if (ret != 0) break;
-
-        ds_bulk_t k((char*)key.get_data(),
-                    ((char*)key.get_data()) + key.get_size());
-        c = std::memcmp(prefix.data(), k.data(), prefix.size());
-        if (c == 0) { keys.push_back(std::move(k)); }
-    }
-    cursorp->close();
-    return keys;
-}
-
-std::vector<std::pair<ds_bulk_t, ds_bulk_t>> BerkeleyDBDataStore::vlist_keyvals(
-    const ds_bulk_t& start, hg_size_t count, const ds_bulk_t& prefix) const
-{
-    std::vector<std::pair<ds_bulk_t, ds_bulk_t>> result;
-    Dbc*                                         cursorp;
-    Dbt                                          key, data;
-    int                                          ret;
     _dbm->cursor(NULL, &cursorp, 0);
+    /* keys starting with prefix are contiguous only in byte order */
+    bool bytewise = _wrapper->_less == nullptr;
 
-    /* 'start' is like RADOS: not inclusive  */
     if (start.size()) {
+        Dbt sk((void*)start.data(), start.size());
         key.set_size(start.size());
         key.set_data((void*)start.data());
         ret = cursorp->get(&key, &data, DB_SET_RANGE);
-        if (ret != 0) {
-            cursorp->close();
-            return result;
-        }
+        /* SET_RANGE will return the smallest key greater than or equal to the
+         * requested key, but 'start' is like RADOS: not inclusive */
+        if (ret == 0 && compkeys(_dbm, &key, &sk, nullptr) == 0)
+            ret = cursorp->get(&key, &data, DB_NEXT);
+    } else if (prefix.size() && bytewise) {
+        key.set_size(prefix.size());
+        key.set_data((void*)prefix.data());
+        ret = cursorp->get(&key, &data, DB_SET_RANGE);
     } else {
         ret = cursorp->get(&key, &data, DB_FIRST);
-        if (ret != 0) {
-            cursorp->close();
-            return result;
-        }
     }
 
-    ds_bulk_t k((char*)key.get_data(),
-                ((char*)key.get_data()) + key.get_size());
-    ds_bulk_t v((char*)data.get_data(),
-                ((char*)data.get_data()) + data.get_size());
-
-    /* SET_RANGE will return the smallest key greater than or equal to the
-     * requested key, but we want strictly greater than */
-    int c = 0;
-    if (k != start) {
-        c = std::memcmp(prefix.data(), k.data(), prefix.size());
-        if (c == 0) {
-            result.push_back(std::make_pair(std::move(k), std::move(v)));
-        }
-    }
-    while (result.size() < count && c >= 0) {
-        ret = cursorp->get(&key, &data, DB_NEXT);
-        if (ret != 0) break;
-
-        ds_bulk_t k((char*)key.get_data(),
-                    ((char*)key.get_data()) + key.get_size());
-        ds_bulk_t v((char*)data.get_data(),
-                    ((char*)data.get_data()) + data.get_size());
-
-        c = std::memcmp(prefix.data(), k.data(), prefix.size());
-        if (c == 0) {
-            result.push_back(std::make_pair(std::move(k), std::move(v)));
-        }
+    for (; ret == 0; ret = cursorp->get(&key, &data, DB_NEXT)) {
+        int c = compare_prefix(prefix, key.get_data(), key.get_size());
+        if (c < 0 && bytewise) break;
+        if (c != 0) continue;
+        bool keep_going
+            = with_values ? visitor(key.get_data(), key.get_size(),
+                                    data.get_data(), data.get_size())
+                          : visitor(key.get_data(), key.get_size(), nullptr, 0);
+        if (!keep_going) break;
     }
     cursorp->close();
-    return result;
 }
 
 std::vector<ds_bulk_t>
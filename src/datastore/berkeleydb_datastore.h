@@ -46,26 +46,40 @@ class BerkeleyDBDataStore : public AbstractDataStore {
     virtual bool get(const ds_bulk_t& key, ds_bulk_t& data) override;
     virtual bool get(const ds_bulk_t&        key,
                      std::vector<ds_bulk_t>& data) override;
+    virtual bool length(const void* key,
+                        hg_size_t   ksize,
+                        size_t*     vsize) override;
+    virtual bool length(const ds_bulk_t& key, size_t* vsize) override
+    {
+        return length(key.data(), key.size(), vsize);
+    }
     virtual bool exists(const void* key, hg_size_t ksize) const override;
     virtual bool erase(const ds_bulk_t& key) override;
+    virtual int  erase_multi(hg_size_t          num_items,
+                             const void* const* keys,
+                             const hg_size_t*   ksizes,
+                             uint8_t*           erased) override;
+    virtual void write_batch(write_op* const* ops, size_t count) override;
+    virtual int  erase_range(const ds_bulk_t& lower_bound,
+                             const ds_bulk_t& upper_bound,
+                             hg_size_t*       num_erased) override;
+    virtual int  erase_prefix(const ds_bulk_t& prefix,
+                              hg_size_t*       num_erased) override;
     virtual void
     set_in_memory(bool enable) override; // enable/disable in-memory mode
     virtual void set_comparison_function(const std::string& name,
                                          comparator_fn      less) override;
     virtual void set_no_overwrite() override { _no_overwrite = true; }
-    virtual void sync() override;
+    virtual int sync() override;
+    virtual void set_durability(durability_t d) override;
 #ifdef USE_REMI
     virtual remi_fileset_t create_and_populate_fileset() const override;
 #endif
   protected:
-    virtual std::vector<ds_bulk_t>
-    vlist_keys(const ds_bulk_t& start,
-               hg_size_t        count,
-               const ds_bulk_t& prefix) const override;
-    virtual std::vector<std::pair<ds_bulk_t, ds_bulk_t>>
-    vlist_keyvals(const ds_bulk_t& start_key,
-                  hg_size_t        count,
-                  const ds_bulk_t&) const override;
+    virtual void vvisit(const ds_bulk_t&  start_key,
+                        const ds_bulk_t&  prefix,
+                        bool              with_values,
+                        const visitor_fn& visitor) const override;
     virtual std::vector<ds_bulk_t>
     vlist_key_range(const ds_bulk_t& lower_bound,
                     const ds_bulk_t& upper_bound,
@@ -12,6 +12,10 @@ AbstractDataStore::AbstractDataStore()
     _eraseOnGet = false;
     _debug      = false;
     _in_memory  = false;
+    for (unsigned i = 0; i < _num_rmw_locks; i++)
+        ABT_mutex_create(&_rmw_locks[i]);
+    ABT_mutex_create(&_gc_mutex);
+    ABT_mutex_create(&_adm_mutex);
 };
 
 AbstractDataStore::AbstractDataStore(bool eraseOnGet, bool debug)
@@ -19,6 +23,314 @@ AbstractDataStore::AbstractDataStore(bool eraseOnGet, bool debug)
     _eraseOnGet = eraseOnGet;
     _debug      = debug;
     _in_memory  = false;
+    for (unsigned i = 0; i < _num_rmw_locks; i++)
+        ABT_mutex_create(&_rmw_locks[i]);
+    ABT_mutex_create(&_gc_mutex);
+    ABT_mutex_create(&_adm_mutex);
 };
 
-AbstractDataStore::~AbstractDataStore(){};
+AbstractDataStore::~AbstractDataStore()
+{
+    for (unsigned i = 0; i < _num_rmw_locks; i++)
+        ABT_mutex_free(&_rmw_locks[i]);
+    ABT_mutex_free(&_gc_mutex);
+    ABT_mutex_free(&_adm_mutex);
+    delete _hot_keys;
+};
+
+int AbstractDataStore::erase_prefix(const ds_bulk_t& prefix,
+                                    hg_size_t*       num_erased)
+{
+    /* the visitor may not modify the database, so keys are collected
+     * in batches and erased between scans */
+    const hg_size_t        batch_size = 1024;
+    std::vector<ds_bulk_t> keys;
+    ds_bulk_t              start;
+    *num_erased = 0;
+    do {
+        keys = vlist_keys(start, batch_size, prefix);
+        for (const auto& k : keys) {
+            if (erase(k)) *num_erased += 1;
+        }
+        if (!keys.empty()) start = keys.back();
+    } while (keys.size() == batch_size);
+    return SDSKV_SUCCESS;
+}
+
+void AbstractDataStore::write_batch(write_op* const* ops, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        write_op* op = ops[i];
+        if (op->erase) {
+            ds_bulk_t k((const char*)op->key, (const char*)op->key + op->ksize);
+            op->ret = erase(k) ? SDSKV_SUCCESS : SDSKV_ERR_ERASE;
+        } else {
+            op->ret = put(op->key, op->ksize, op->val, op->vsize);
+        }
+    }
+}
+
+int AbstractDataStore::grouped_put(const void* key,
+                                   hg_size_t   ksize,
+                                   const void* val,
+                                   hg_size_t   vsize)
+{
+    if (!_group_commit) return put(key, ksize, val, vsize);
+    write_op op = {false, key, ksize, val, vsize, SDSKV_SUCCESS, false,
+                   ABT_EVENTUAL_NULL};
+    return group_commit(&op);
+}
+
+int AbstractDataStore::grouped_erase(const void* key, hg_size_t ksize)
+{
+    if (!_group_commit) {
+        ds_bulk_t k((const char*)key, (const char*)key + ksize);
+        return erase(k) ? SDSKV_SUCCESS : SDSKV_ERR_ERASE;
+    }
+    write_op op = {true, key, ksize, nullptr, 0, SDSKV_SUCCESS, false,
+                   ABT_EVENTUAL_NULL};
+    return group_commit(&op);
+}
+
+int AbstractDataStore::group_commit(write_op* op)
+{
+    /* the first caller to find no active leader becomes the leader and
+     * commits whatever got queued in the meantime; the others wait until
+     * their operation has been committed, or until they are promoted to
+     * leader for the next batch */
+    ABT_eventual_create(0, &op->done);
+    ABT_mutex_lock(_gc_mutex);
+    _gc_pending.push_back(op);
+    bool lead = !_gc_leader_active;
+    if (lead) _gc_leader_active = true;
+    ABT_mutex_unlock(_gc_mutex);
+
+    if (!lead) {
+        ABT_eventual_wait(op->done, nullptr);
+        if (!op->lead) {
+            ABT_eventual_free(&op->done);
+            return op->ret;
+        }
+    }
+
+    /* give the other ULTs of the pool a chance to queue their writes */
+    ABT_thread_yield();
+
+    std::vector<write_op*> batch;
+    ABT_mutex_lock(_gc_mutex);
+    batch.swap(_gc_pending);
+    ABT_mutex_unlock(_gc_mutex);
+
+    write_batch(batch.data(), batch.size());
+
+    for (auto o : batch) {
+        if (o != op) ABT_eventual_set(o->done, nullptr, 0);
+    }
+
+    ABT_mutex_lock(_gc_mutex);
+    if (_gc_pending.empty()) {
+        _gc_leader_active = false;
+    } else {
+        write_op* next = _gc_pending.front();
+        next->lead     = true;
+        ABT_eventual_set(next->done, nullptr, 0);
+    }
+    ABT_mutex_unlock(_gc_mutex);
+
+    ABT_eventual_free(&op->done);
+    return op->ret;
+}
+
+void AbstractDataStore::set_admission_limits(size_t max_inflight,
+                                             size_t max_queued)
+{
+    ABT_mutex_lock(_adm_mutex);
+    _adm_max_inflight = max_inflight;
+    _adm_max_queued   = max_queued;
+    ABT_mutex_unlock(_adm_mutex);
+}
+
+void AbstractDataStore::set_client_weight(const std::string& client,
+                                          double             weight)
+{
+    ABT_mutex_lock(_adm_mutex);
+    _adm_clients[client].weight = weight > 0 ? weight : 1.0;
+    ABT_mutex_unlock(_adm_mutex);
+}
+
+void AbstractDataStore::set_hot_keys(size_t   capacity,
+                                     size_t   prefix_length,
+                                     unsigned sample_every)
+{
+    delete _hot_keys;
+    _hot_keys = capacity ? new HotKeys(capacity, prefix_length, sample_every)
+                         : nullptr;
+}
+
+int AbstractDataStore::admit(const std::string& client)
+{
+    ABT_mutex_lock(_adm_mutex);
+    if (_adm_max_inflight == 0
+        || (_adm_inflight < _adm_max_inflight && _adm_active.empty())) {
+        _adm_inflight += 1;
+        ABT_mutex_unlock(_adm_mutex);
+        return SDSKV_SUCCESS;
+    }
+    auto& c = _adm_clients[client];
+    if (_adm_max_queued != 0 && c.waiting.size() >= _adm_max_queued) {
+        ABT_mutex_unlock(_adm_mutex);
+        return SDSKV_ERR_BUSY;
+    }
+    ABT_eventual ev;
+    ABT_eventual_create(0, &ev);
+    if (c.waiting.empty()) _adm_active.push_back(client);
+    c.waiting.push_back(ev);
+    ABT_mutex_unlock(_adm_mutex);
+
+    /* release() counts us as in flight before waking us up */
+    ABT_eventual_wait(ev, nullptr);
+    ABT_eventual_free(&ev);
+    return SDSKV_SUCCESS;
+}
+
+void AbstractDataStore::release()
+{
+    ABT_mutex_lock(_adm_mutex);
+    _adm_inflight -= 1;
+    /* deficit round-robin over the clients that have waiting operations:
+     * each visit gives a client its weight in credit, and each admitted
+     * operation costs one credit */
+    while (_adm_inflight < _adm_max_inflight && !_adm_active.empty()) {
+        std::string name = std::move(_adm_active.front());
+        _adm_active.pop_front();
+        auto& c = _adm_clients[name];
+        if (c.credit < 1.0) c.credit += c.weight;
+        while (c.credit >= 1.0 && !c.waiting.empty()
+               && _adm_inflight < _adm_max_inflight) {
+            ABT_eventual_set(c.waiting.front(), nullptr, 0);
+            c.waiting.pop_front();
+            c.credit -= 1.0;
+            _adm_inflight += 1;
+        }
+        if (c.waiting.empty()) {
+            c.credit = 0.0;
+            if (c.weight == 1.0) _adm_clients.erase(name);
+        } else if (c.credit >= 1.0) {
+            /* stopped because the database is full: keep its turn */
+            _adm_active.push_front(std::move(name));
+        } else {
+            _adm_active.push_back(std::move(name));
+        }
+    }
+    ABT_mutex_unlock(_adm_mutex);
+}
+
+ABT_mutex AbstractDataStore::rmw_lock(const void* key, hg_size_t ksize) const
+{
+    /* FNV-1a hash of the key */
+    uint64_t    h = 14695981039346656037ULL;
+    const char* k = (const char*)key;
+    for (hg_size_t i = 0; i < ksize; i++) {
+        h ^= (unsigned char)k[i];
+        h *= 1099511628211ULL;
+    }
+    return _rmw_locks[h % _num_rmw_locks];
+}
+
+int AbstractDataStore::compare_and_swap(const void* key,
+                                        hg_size_t   ksize,
+                                        const void* expected,
+                                        hg_size_t   esize,
+                                        const void* desired,
+                                        hg_size_t   dsize,
+                                        bool*       swapped)
+{
+    ds_bulk_t k((const char*)key, (const char*)key + ksize);
+    ds_bulk_t current;
+    int       ret = SDSKV_SUCCESS;
+    ABT_mutex mtx = rmw_lock(key, ksize);
+    ABT_mutex_lock(mtx);
+    bool found = get(k, current);
+    bool match = found ? (current.size() == esize
+                          && std::memcmp(current.data(), expected, esize) == 0)
+                       : (esize == 0);
+    if (match) ret = put(key, ksize, desired, dsize);
+    ABT_mutex_unlock(mtx);
+    *swapped = match && ret == SDSKV_SUCCESS;
+    return ret;
+}
+
+int AbstractDataStore::fetch_and_add(const void* key,
+                                     hg_size_t   ksize,
+                                     int64_t     delta,
+                                     int64_t*    previous)
+{
+    ds_bulk_t k((const char*)key, (const char*)key + ksize);
+    ds_bulk_t current;
+    int64_t   value = 0;
+    ABT_mutex mtx   = rmw_lock(key, ksize);
+    ABT_mutex_lock(mtx);
+    if (get(k, current)) {
+        if (current.size() != sizeof(value)) {
+            ABT_mutex_unlock(mtx);
+            return SDSKV_ERR_SIZE;
+        }
+        std::memcpy(&value, current.data(), sizeof(value));
+    }
+    // add as unsigned so that overflow wraps around instead of being UB
+    int64_t updated = (int64_t)((uint64_t)value + (uint64_t)delta);
+    int     ret     = put(key, ksize, &updated, sizeof(updated));
+    ABT_mutex_unlock(mtx);
+    if (ret == SDSKV_SUCCESS) *previous = value;
+    return ret;
+}
+
+int AbstractDataStore::append(const void* key,
+                              hg_size_t   ksize,
+                              const void* data,
+                              hg_size_t   dsize,
+                              hg_size_t*  new_size)
+{
+    ds_bulk_t k((const char*)key, (const char*)key + ksize);
+    ds_bulk_t value;
+    ABT_mutex mtx = rmw_lock(key, ksize);
+    ABT_mutex_lock(mtx);
+    get(k, value);
+    value.insert(value.end(), (const char*)data, (const char*)data + dsize);
+    int ret = put(k, value);
+    ABT_mutex_unlock(mtx);
+    if (ret == SDSKV_SUCCESS) *new_size = value.size();
+    return ret;
+}
+
+std::vector<ds_bulk_t> AbstractDataStore::vlist_keys(
+    const ds_bulk_t& start_key, hg_size_t count, const ds_bulk_t& prefix) const
+{
+    std::vector<ds_bulk_t> result;
+    if (count == 0) return result;
+    result.reserve(count);
+    vvisit(start_key, prefix, false,
+           [&result, count](const void* key, hg_size_t ksize, const void*,
+                            hg_size_t) {
+               result.emplace_back((const char*)key, (const char*)key + ksize);
+               return result.size() < count;
+           });
+    return result;
+}
+
+std::vector<std::pair<ds_bulk_t, ds_bulk_t>> AbstractDataStore::vlist_keyvals(
+    const ds_bulk_t& start_key, hg_size_t count, const ds_bulk_t& prefix) const
+{
+    std::vector<std::pair<ds_bulk_t, ds_bulk_t>> result;
+    if (count == 0) return result;
+    result.reserve(count);
+    vvisit(start_key, prefix, true,
+           [&result, count](const void* key, hg_size_t ksize, const void* val,
+                            hg_size_t vsize) {
+               result.emplace_back(
+                   ds_bulk_t((const char*)key, (const char*)key + ksize),
+                   ds_bulk_t((const char*)val, (const char*)val + vsize));
+               return result.size() < count;
+           });
+    return result;
+}
@@ -5,12 +5,22 @@
 
 #include "kv-config.h"
 #include "bulk.h"
+#include "sdskv-common.h"
+#include "sdskv-hotkeys.h"
 #include <margo.h>
 #ifdef USE_REMI
     #include "remi/remi-common.h"
 #endif
 
 #include <vector>
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <cstring>
+#include <functional>
+#include <memory>
+
+class OpStats;
 
 class AbstractDataStore {
   public:
@@ -19,6 +29,36 @@ class AbstractDataStore {
                                  const void*,
                                  hg_size_t);
 
+    /* visitor invoked on each key/value pair of a scan; the pointers
+     * are only valid for the duration of the call, and returning false
+     * stops the scan */
+    typedef std::function<bool(
+        const void* key, hg_size_t ksize, const void* val, hg_size_t vsize)>
+        visitor_fn;
+
+    /* single put or erase submitted through the group commit queue;
+     * ret is set by write_batch */
+    struct write_op {
+        bool         erase;
+        const void*  key;
+        hg_size_t    ksize;
+        const void*  val;
+        hg_size_t    vsize;
+        int          ret;
+        bool         lead;
+        ABT_eventual done;
+    };
+
+    /* how writes reach stable storage: NONE leaves it to the backend
+     * until sync() is called, PERIODIC has the provider call sync() at a
+     * regular interval, SYNC makes every write batch durable before it
+     * is acknowledged */
+    enum durability_t {
+        DURABILITY_NONE,
+        DURABILITY_PERIODIC,
+        DURABILITY_SYNC
+    };
+
     AbstractDataStore();
     AbstractDataStore(bool eraseOnGet, bool debug);
     virtual ~AbstractDataStore();
@@ -69,6 +109,8 @@ class AbstractDataStore {
     }
     virtual bool get(const ds_bulk_t& key, ds_bulk_t& data)              = 0;
     virtual bool get(const ds_bulk_t& key, std::vector<ds_bulk_t>& data) = 0;
+    /* backends should override length and exists so that they don't
+     * read the value itself; the defaults below go through get() */
     virtual bool length(const void* key, hg_size_t ksize, size_t* vsize)
     {
         auto k = ds_bulk_t((const char*)key, (const char*)key + ksize);
@@ -87,13 +129,180 @@ class AbstractDataStore {
         return exists(key.data(), key.size());
     }
     virtual bool erase(const ds_bulk_t& key) = 0;
+    /* erases num_items keys, setting erased[i] to 1 if keys[i] existed
+     * and was removed, 0 otherwise */
+    virtual int erase_multi(hg_size_t          num_items,
+                            const void* const* keys,
+                            const hg_size_t*   ksizes,
+                            uint8_t*           erased)
+    {
+        for (hg_size_t i = 0; i < num_items; i++) {
+            ds_bulk_t k((const char*)keys[i], (const char*)keys[i] + ksizes[i]);
+            erased[i] = erase(k) ? 1 : 0;
+        }
+        return SDSKV_SUCCESS;
+    }
+
+    /**
+     * Erases all the keys strictly between lower_bound and upper_bound,
+     * in the order of the database's comparator. An empty lower_bound
+     * (resp. upper_bound) means no lower (resp. upper) bound. The number
+     * of keys erased is returned in num_erased.
+     */
+    virtual int erase_range(const ds_bulk_t& lower_bound,
+                            const ds_bulk_t& upper_bound,
+                            hg_size_t*       num_erased)
+    {
+        return SDSKV_OP_NOT_IMPL;
+    }
+
+    /**
+     * Erases all the keys starting with prefix. The number of keys
+     * erased is returned in num_erased.
+     */
+    virtual int erase_prefix(const ds_bulk_t& prefix, hg_size_t* num_erased);
+
+    /**
+     * Read-modify-write operations. They are atomic with respect to each
+     * other on the same key. The default implementations, used by
+     * LevelDB and BerkeleyDB among others, read and write the key under a
+     * striped lock that plain writes (put, erase and their batched,
+     * ranged and grouped variants) do not take, so a write racing with
+     * one of them on the same key may be overwritten by it. MapDataStore
+     * runs them under its write lock, which also orders them with plain
+     * writes. Clients that mix both on a key should only update it through
+     * these operations.
+     */
+
+    /**
+     * Atomically replaces the value associated with key by desired if
+     * the current value is equal to expected. An empty expected value
+     * also matches a key that does not exist, in which case the key is
+     * created. swapped is set to whether the value was replaced.
+     */
+    virtual int compare_and_swap(const void* key,
+                                 hg_size_t   ksize,
+                                 const void* expected,
+                                 hg_size_t   esize,
+                                 const void* desired,
+                                 hg_size_t   dsize,
+                                 bool*       swapped);
+
+    /**
+     * Atomically adds delta to the value associated with key, which must
+     * be an int64_t in native byte order, and sets previous to the value
+     * before the addition. A missing key is created as if its value was 0.
+     * The addition wraps around on overflow, like std::atomic's.
+     * Returns SDSKV_ERR_SIZE if the current value is not 8 bytes long.
+     */
+    virtual int fetch_and_add(const void* key,
+                              hg_size_t   ksize,
+                              int64_t     delta,
+                              int64_t*    previous);
+
+    /**
+     * Atomically appends data at the end of the value associated with
+     * key, creating the key if it does not exist, and sets new_size to
+     * the size of the resulting value.
+     */
+    virtual int append(const void* key,
+                       hg_size_t   ksize,
+                       const void* data,
+                       hg_size_t   dsize,
+                       hg_size_t*  new_size);
+    /**
+     * Applies a batch of puts and erases, in order, setting the ret
+     * field of each operation (SDSKV_ERR_ERASE for an erase of a missing
+     * key). Backends should override this to commit the whole batch at
+     * once; the default applies the operations one by one.
+     */
+    virtual void write_batch(write_op* const* ops, size_t count);
+
+    /**
+     * Put and erase going through the group commit queue: concurrent
+     * calls are merged into a single write_batch by whichever caller
+     * gets there first, and each caller gets its own result back.
+     * These are plain put/erase when group commit is disabled.
+     */
+    int grouped_put(const void* key,
+                    hg_size_t   ksize,
+                    const void* val,
+                    hg_size_t   vsize);
+    int grouped_erase(const void* key, hg_size_t ksize);
+
+    void set_group_commit(bool enable) { _group_commit = enable; }
+
+    /**
+     * Admission control: at most max_inflight operations run on the
+     * database at once (0, the default, disables admission control).
+     * Operations beyond that wait in one queue per client, and the queues
+     * are served in weighted round-robin order. A client that already has
+     * max_queued operations waiting (0 for no limit) gets SDSKV_ERR_BUSY.
+     */
+    void set_admission_limits(size_t max_inflight, size_t max_queued);
+    /* share of a client relative to the others (1.0 by default) */
+    void set_client_weight(const std::string& client, double weight);
+    bool admission_enabled() const { return _adm_max_inflight != 0; }
+    /* blocks until the operation can run, or returns SDSKV_ERR_BUSY;
+     * each successful admit must be matched by a call to release */
+    int  admit(const std::string& client);
+    void release();
+
+    /**
+     * Hot-key tracking (see HotKeys): keeps the capacity most accessed
+     * keys, and key prefixes of prefix_length bytes if not 0, recording one
+     * access out of sample_every. A capacity of 0, the default, disables
+     * it. Must be set before the database is accessed.
+     */
+    void set_hot_keys(size_t capacity, size_t prefix_length,
+                      unsigned sample_every);
+    const HotKeys* hot_keys() const { return _hot_keys; }
+
+    /* per-RPC statistics of the database, set by the provider when it is
+     * attached (see MetricsRegistry::add_database) */
+    void set_op_stats(std::shared_ptr<OpStats> stats) { _op_stats = stats; }
+    const std::shared_ptr<OpStats>& op_stats() const { return _op_stats; }
+    void record_access(const void* key, hg_size_t ksize, bool write)
+    {
+        if (_hot_keys) _hot_keys->record(key, ksize, write);
+    }
+    void record_accesses(size_t             num,
+                         const void* const* keys,
+                         const hg_size_t*   ksizes,
+                         bool               write)
+    {
+        if (!_hot_keys) return;
+        for (size_t i = 0; i < num; i++)
+            _hot_keys->record(keys[i], ksizes[i], write);
+    }
+    void record_packed_accesses(size_t           num,
+                                const char*      packed_keys,
+                                const hg_size_t* ksizes,
+                                bool             write)
+    {
+        if (!_hot_keys) return;
+        for (size_t i = 0; i < num; i++) {
+            _hot_keys->record(packed_keys, ksizes[i], write);
+            packed_keys += ksizes[i];
+        }
+    }
+
     virtual void set_in_memory(bool enable)
         = 0; // enable/disable in-memory mode (where supported)
     virtual void set_comparison_function(const std::string& name,
                                          comparator_fn      less)
         = 0;
     virtual void set_no_overwrite() = 0;
-    virtual void sync()             = 0;
+    /* makes all the writes acknowledged so far durable, returns
+     * SDSKV_SUCCESS or SDSKV_ERR_PUT if they could not be flushed */
+    virtual int sync() = 0;
+    /* backends that support it should override this to adjust how they
+     * flush their writes, and call the base version */
+    virtual void set_durability(durability_t d) { _durability = d; }
+    durability_t get_durability() const { return _durability; }
+    /* interval between syncs for DURABILITY_PERIODIC, in seconds */
+    void   set_sync_interval(double seconds) { _sync_interval = seconds; }
+    double get_sync_interval() const { return _sync_interval; }
 
 #ifdef USE_REMI
     virtual remi_fileset_t create_and_populate_fileset() const = 0;
@@ -108,6 +317,30 @@ class AbstractDataStore {
         return _comp_fun_name;
     }
 
+    /**
+     * Calls visitor on each key strictly after start_key that starts
+     * with prefix, in key order, until the visitor returns false or the
+     * end of the database is reached. The value is not read (the visitor
+     * gets a NULL value of size 0). The visitor must not modify the
+     * database.
+     */
+    void visit_keys(const ds_bulk_t&  start_key,
+                    const ds_bulk_t&  prefix,
+                    const visitor_fn& visitor) const
+    {
+        vvisit(start_key, prefix, false, visitor);
+    }
+
+    /**
+     * Same as visit_keys but also passes the values to the visitor.
+     */
+    void visit_keyvals(const ds_bulk_t&  start_key,
+                       const ds_bulk_t&  prefix,
+                       const visitor_fn& visitor) const
+    {
+        vvisit(start_key, prefix, true, visitor);
+    }
+
     std::vector<ds_bulk_t> list_keys(const ds_bulk_t& start_key,
                                      hg_size_t        count,
                                      const ds_bulk_t& prefix
@@ -147,15 +380,69 @@ class AbstractDataStore {
     bool        _eraseOnGet;
     bool        _debug;
     bool        _in_memory;
+    durability_t _durability    = DURABILITY_NONE;
+    double       _sync_interval = 1.0;
 
-    virtual std::vector<ds_bulk_t>
-    vlist_keys(const ds_bulk_t& start_key,
-               hg_size_t        count,
-               const ds_bulk_t& prefix) const = 0;
+    /* striped locks serializing the default read-modify-write
+     * implementations, which are built on get and put; plain writes do
+     * not take them (see compare_and_swap) */
+    static const unsigned _num_rmw_locks = 64;
+    ABT_mutex             _rmw_locks[_num_rmw_locks];
+
+    ABT_mutex rmw_lock(const void* key, hg_size_t ksize) const;
+
+    /* group commit queue, off unless enabled by the database's
+     * "group_commit" setting since it delays a lone writer */
+    bool                   _group_commit = false;
+    ABT_mutex              _gc_mutex;
+    bool                   _gc_leader_active = false;
+    std::vector<write_op*> _gc_pending;
+
+    int group_commit(write_op* op);
+
+    /* admission control */
+    struct admission_client {
+        std::deque<ABT_eventual> waiting;
+        double                   weight = 1.0;
+        double                   credit = 0.0;
+    };
+    ABT_mutex _adm_mutex;
+    size_t    _adm_max_inflight = 0;
+    size_t    _adm_max_queued   = 0;
+    size_t    _adm_inflight     = 0;
+    std::unordered_map<std::string, admission_client> _adm_clients;
+    std::deque<std::string> _adm_active; // clients with waiting operations
+
+    /* hot-key tracking, nullptr if disabled */
+    HotKeys* _hot_keys = nullptr;
+
+    std::shared_ptr<OpStats> _op_stats;
+
+    /* compares prefix with the beginning of key: returns 0 if key starts
+     * with prefix, > 0 if key sorts before the keys starting with prefix,
+     * < 0 if key sorts after them, in byte order (which is not the order
+     * of the database when it has a custom comparator) */
+    static int
+    compare_prefix(const ds_bulk_t& prefix, const void* key, hg_size_t ksize)
+    {
+        if (prefix.empty()) return 0;
+        if (prefix.size() <= ksize)
+            return std::memcmp(prefix.data(), key, prefix.size());
+        int c = std::memcmp(prefix.data(), key, ksize);
+        return c == 0 ? 1 : c;
+    }
+
+    virtual void vvisit(const ds_bulk_t&  start_key,
+                        const ds_bulk_t&  prefix,
+                        bool              with_values,
+                        const visitor_fn& visitor) const = 0;
+    virtual std::vector<ds_bulk_t> vlist_keys(const ds_bulk_t& start_key,
+                                              hg_size_t        count,
+                                              const ds_bulk_t& prefix) const;
     virtual std::vector<std::pair<ds_bulk_t, ds_bulk_t>>
     vlist_keyvals(const ds_bulk_t& start_key,
                   hg_size_t        count,
-                  const ds_bulk_t& prefix) const = 0;
+                  const ds_bulk_t& prefix) const;
     virtual std::vector<ds_bulk_t>
     vlist_key_range(const ds_bulk_t& lower_bound,
                     const ds_bulk_t& upper_bound,
@@ -3,6 +3,8 @@
 #include "leveldb_datastore.h"
 #include "fs_util.h"
 #include "kv-config.h"
+#include <leveldb/write_batch.h>
+#include <map>
 #include <cstring>
 #include <chrono>
 #include <iostream>
@@ -46,7 +48,27 @@ LevelDBDataStore::~LevelDBDataStore()
     // leveldb::Env::Shutdown(); // Riak version only
 };
 
-void LevelDBDataStore::sync() {}
+int LevelDBDataStore::sync()
+{
+    /* LevelDB has no explicit flush, but a synchronous write forces the
+     * log, and with it all the previous writes, to stable storage */
+    leveldb::WriteOptions options;
+    leveldb::WriteBatch   batch;
+    options.sync           = true;
+    leveldb::Status status = _dbm->Write(options, &batch);
+    if (!status.ok()) {
+        std::cerr << "LevelDBDataStore::sync: LevelDB error on Write = "
+                  << status.ToString() << std::endl;
+        return SDSKV_ERR_PUT;
+    }
+    return SDSKV_SUCCESS;
+}
+
+void LevelDBDataStore::set_durability(durability_t d)
+{
+    AbstractDataStore::set_durability(d);
+    _write_options.sync = (d == DURABILITY_SYNC);
+}
 
 bool LevelDBDataStore::openDatabase(const std::string& db_name,
                                     const std::string& db_path)
@@ -94,7 +116,7 @@ int LevelDBDataStore::put(const void* key,
         if (exists(key, ksize)) return SDSKV_ERR_KEYEXISTS;
     }
 
-    status = _dbm->Put(leveldb::WriteOptions(),
+    status = _dbm->Put(_write_options,
                        leveldb::Slice((const char*)key, ksize),
                        leveldb::Slice((const char*)value, vsize));
     if (status.ok()) return SDSKV_SUCCESS;
@@ -104,17 +126,187 @@ int LevelDBDataStore::put(const void* key,
 bool LevelDBDataStore::erase(const ds_bulk_t& key)
 {
     leveldb::Status status;
-    status = _dbm->Delete(leveldb::WriteOptions(), toString(key));
+    status = _dbm->Delete(_write_options, toString(key));
     return status.ok();
 }
 
+int LevelDBDataStore::erase_multi(hg_size_t          num_items,
+                                  const void* const* keys,
+                                  const hg_size_t*   ksizes,
+                                  uint8_t*           erased)
+{
+    /* the keys are looked up in a single snapshot, but LevelDB can't make
+     * the lookups and the write atomic: a key put or erased by another
+     * request between the two may be reported wrongly in erased */
+    leveldb::WriteBatch  batch;
+    leveldb::ReadOptions options;
+    options.snapshot = _dbm->GetSnapshot();
+    std::string value;
+    for (hg_size_t i = 0; i < num_items; i++) {
+        leveldb::Slice k((const char*)keys[i], ksizes[i]);
+        erased[i] = _dbm->Get(options, k, &value).ok() ? 1 : 0;
+        if (erased[i]) batch.Delete(k);
+    }
+    _dbm->ReleaseSnapshot(options.snapshot);
+    leveldb::Status status = _dbm->Write(_write_options, &batch);
+    if (!status.ok()) {
+        std::cerr << "LevelDBDataStore::erase_multi: LevelDB error on Write = "
+                  << status.ToString() << std::endl;
+        std::memset(erased, 0, num_items);
+        return SDSKV_ERR_ERASE;
+    }
+    return SDSKV_SUCCESS;
+}
+
+void LevelDBDataStore::write_batch(write_op* const* ops, size_t count)
+{
+    leveldb::WriteBatch batch;
+    /* with no_overwrite, earlier operations of the batch decide whether
+     * a key exists for the later ones */
+    std::map<std::string, bool> written;
+    for (size_t i = 0; i < count; i++) {
+        write_op*   op = ops[i];
+        std::string k((const char*)op->key, op->ksize);
+        if (op->erase) {
+            batch.Delete(k);
+            if (_no_overwrite) written[k] = false;
+        } else {
+            if (_no_overwrite) {
+                auto it = written.find(k);
+                bool e  = it != written.end() ? it->second
+                                              : exists(op->key, op->ksize);
+                if (e) {
+                    op->ret = SDSKV_ERR_KEYEXISTS;
+                    continue;
+                }
+                written[k] = true;
+            }
+            batch.Put(k, leveldb::Slice((const char*)op->val, op->vsize));
+        }
+        op->ret = SDSKV_SUCCESS;
+    }
+    leveldb::Status status = _dbm->Write(_write_options, &batch);
+    if (!status.ok()) {
+        std::cerr << "LevelDBDataStore::write_batch: LevelDB error on Write = "
+                  << status.ToString() << std::endl;
+        for (size_t i = 0; i < count; i++) {
+            if (ops[i]->ret == SDSKV_SUCCESS)
+                ops[i]->ret = ops[i]->erase ? SDSKV_ERR_ERASE : SDSKV_ERR_PUT;
+        }
+    }
+}
+
+/* deletes are accumulated in a WriteBatch that is flushed every
+ * erase_batch_size keys so that the batch's memory stays bounded */
+static const hg_size_t erase_batch_size = 4096;
+
+int LevelDBDataStore::erase_range(const ds_bulk_t& lower_bound,
+                                  const ds_bulk_t& upper_bound,
+                                  hg_size_t*       num_erased)
+{
+    leveldb::Slice      lb(lower_bound.data(), lower_bound.size());
+    leveldb::Slice      ub(upper_bound.data(), upper_bound.size());
+    leveldb::WriteBatch batch;
+    leveldb::Status     status;
+    hg_size_t           pending = 0;
+    *num_erased                 = 0;
+
+    leveldb::Iterator* it = _dbm->NewIterator(leveldb::ReadOptions());
+    if (lower_bound.size() > 0) {
+        it->Seek(lb);
+        /* the lower bound is excluded */
+        if (it->Valid() && _keycmp.Compare(it->key(), lb) == 0) it->Next();
+    } else {
+        it->SeekToFirst();
+    }
+    for (; it->Valid(); it->Next()) {
+        if (upper_bound.size() > 0 && _keycmp.Compare(it->key(), ub) >= 0)
+            break;
+        batch.Delete(it->key());
+        pending += 1;
+        if (pending == erase_batch_size) {
+            status = _dbm->Write(_write_options, &batch);
+            if (!status.ok()) break;
+            *num_erased += pending;
+            pending = 0;
+            batch.Clear();
+        }
+    }
+    delete it;
+    if (status.ok() && pending) {
+        status = _dbm->Write(_write_options, &batch);
+        if (status.ok()) *num_erased += pending;
+    }
+    if (!status.ok()) {
+        std::cerr << "LevelDBDataStore::erase_range: LevelDB error on Write = "
+                  << status.ToString() << std::endl;
+        return SDSKV_ERR_ERASE;
+    }
+    return SDSKV_SUCCESS;
+}
+
+int LevelDBDataStore::erase_prefix(const ds_bulk_t& prefix,
+                                   hg_size_t*       num_erased)
+{
+    leveldb::WriteBatch batch;
+    leveldb::Status     status;
+    hg_size_t           pending = 0;
+    *num_erased                 = 0;
+
+    leveldb::Iterator* it = _dbm->NewIterator(leveldb::ReadOptions());
+    /* keys starting with prefix are contiguous only in byte order */
+    bool bytewise = _less == nullptr;
+    if (prefix.size() > 0 && bytewise)
+        it->Seek(leveldb::Slice(prefix.data(), prefix.size()));
+    else
+        it->SeekToFirst();
+    for (; it->Valid(); it->Next()) {
+        leveldb::Slice k = it->key();
+        int            c = compare_prefix(prefix, k.data(), k.size());
+        if (c < 0 && bytewise) break;
+        if (c != 0) continue;
+        batch.Delete(k);
+        pending += 1;
+        if (pending == erase_batch_size) {
+            status = _dbm->Write(_write_options, &batch);
+            if (!status.ok()) break;
+            *num_erased += pending;
+            pending = 0;
+            batch.Clear();
+        }
+    }
+    delete it;
+    if (status.ok() && pending) {
+        status = _dbm->Write(_write_options, &batch);
+        if (status.ok()) *num_erased += pending;
+    }
+    if (!status.ok()) {
+        std::cerr << "LevelDBDataStore::erase_prefix: LevelDB error on Write = "
+                  << status.ToString() << std::endl;
+        return SDSKV_ERR_ERASE;
+    }
+    return SDSKV_SUCCESS;
+}
+
+/* LevelDB has no way of querying a value's metadata, but an iterator
+ * positioned on the key exposes the value as a slice of the block it
+ * lives in, so existence and size can be answered without copying it */
+bool LevelDBDataStore::length(const void* key, hg_size_t ksize, size_t* vsize)
+{
+    /* a point lookup can use the bloom filters and the table cache, unlike
+     * an iterator; LevelDB can only return the value as a copy */
+    leveldb::Slice k((const char*)key, ksize);
+    std::string    value;
+    if (!_dbm->Get(leveldb::ReadOptions(), k, &value).ok()) return false;
+    *vsize = value.size();
+    return true;
+}
+
 bool LevelDBDataStore::exists(const void* key, hg_size_t ksize) const
 {
-    leveldb::Status status;
-    std::string     value;
-    status = _dbm->Get(leveldb::ReadOptions(),
-                       leveldb::Slice((const char*)key, ksize), &value);
-    return status.ok();
+    leveldb::Slice k((const char*)key, ksize);
+    std::string    value;
+    return _dbm->Get(leveldb::ReadOptions(), k, &value).ok();
 }
 
 bool LevelDBDataStore::get(const ds_bulk_t& key, ds_bulk_t& data)
@@ -157,79 +349,44 @@ bool LevelDBDataStore::get(const ds_bulk_t& key, std::vector<ds_bulk_t>& data)
 
 void LevelDBDataStore::set_in_memory(bool enable){};
 
-std::vector<ds_bulk_t> LevelDBDataStore::vlist_keys(
-    const ds_bulk_t& start, hg_size_t count, const ds_bulk_t& prefix) const
+void LevelDBDataStore::vvisit(const ds_bulk_t&  start,
+                              const ds_bulk_t&  prefix,
+                              bool              with_values,
+                              const visitor_fn& visitor) const
 {
-    std::vector<ds_bulk_t> keys;
-
     leveldb::Iterator* it = _dbm->NewIterator(leveldb::ReadOptions());
-    leveldb::Slice     start_slice(start.data(), start.size());
-
-    int c = 0;
+    /* keys starting with prefix are contiguous only in byte order */
+    bool bytewise = _less == nullptr;
 
     if (start.size() > 0) {
+        leveldb::Slice start_slice(start.data(), start.size());
         it->Seek(start_slice);
         /* we treat 'start' the way RADOS treats it: excluding it from returned
          * keys. LevelDB treats start inclusively, so skip over it if we found
-         * an exact match */
-        if (it->Valid() && (start.size() == it->key().size())
-            && (memcmp(it->key().data(), start.data(), start.size()) == 0))
+         * a key that the comparator considers equal */
+        if (it->Valid() && _keycmp.Compare(it->key(), start_slice) == 0)
             it->Next();
+    } else if (prefix.size() > 0 && bytewise) {
+        it->Seek(leveldb::Slice(prefix.data(), prefix.size()));
     } else {
         it->SeekToFirst();
     }
     /* note: iterator initialized above, not in for loop */
-    for (; it->Valid() && keys.size() < count; it->Next()) {
-        ds_bulk_t k(it->key().size());
-        memcpy(k.data(), it->key().data(), it->key().size());
-        c = std::memcmp(prefix.data(), k.data(), prefix.size());
-        if (c == 0) {
-            keys.push_back(std::move(k));
-        } else if (c < 0) {
-            break;
+    for (; it->Valid(); it->Next()) {
+        leveldb::Slice k = it->key();
+        int            c = compare_prefix(prefix, k.data(), k.size());
+        if (c < 0 && bytewise) break;
+        if (c != 0) continue;
+        bool keep_going;
+        if (with_values) {
+            leveldb::Slice v = it->value();
+            keep_going       = visitor(k.data(), k.size(), v.data(), v.size());
+        } else {
+            keep_going = visitor(k.data(), k.size(), nullptr, 0);
         }
+        if (!keep_going) break;
     }
     delete it;
-    return keys;
-}
-
-std::vector<std::pair<ds_bulk_t, ds_bulk_t>> LevelDBDataStore::vlist_keyvals(
-    const ds_bulk_t& start, hg_size_t count, const ds_bulk_t& prefix) const
-{
-    std::vector<std::pair<ds_bulk_t, ds_bulk_t>> result;
-
-    leveldb::Iterator* it = _dbm->NewIterator(leveldb::ReadOptions());
-    leveldb::Slice     start_slice(start.data(), start.size());
-
-    int c = 0;
-
-    if (start.size() > 0) {
-        it->Seek(start_slice);
-        /* we treat 'start' the way RADOS treats it: excluding it from returned
-         * keys. LevelDB treats start inclusively, so skip over it if we found
-         * an exact match */
-        if (it->Valid() && (start.size() == it->key().size())
-            && (memcmp(it->key().data(), start.data(), start.size()) == 0))
-            it->Next();
-    } else {
-        it->SeekToFirst();
-    }
-    /* note: iterator initialized above, not in for loop */
-    for (; it->Valid() && result.size() < count; it->Next()) {
-        ds_bulk_t k(it->key().size());
-        ds_bulk_t v(it->value().size());
-        memcpy(k.data(), it->key().data(), it->key().size());
-        memcpy(v.data(), it->value().data(), it->value().size());
-
-        c = std::memcmp(prefix.data(), k.data(), prefix.size());
-        if (c == 0) {
-            result.push_back(std::make_pair(std::move(k), std::move(v)));
-        } else if (c < 0) {
-            break;
-        }
-    }
-    delete it;
-    return result;
 }
 
 std::vector<ds_bulk_t>
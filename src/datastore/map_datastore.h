@@ -4,6 +4,7 @@
 #define map_datastore_h
 
 #include <map>
+#include <algorithm>
 #include <cstring>
 #include "kv-config.h"
 #include "bulk.h"
@@ -12,17 +13,41 @@
 class MapDataStore : public AbstractDataStore {
 
   private:
+    /* key given by the caller, looked up without copying it */
+    struct key_view {
+        const char* data;
+        size_t      size;
+    };
+
     struct keycmp {
+        /* lets find() take a key_view where heterogeneous lookup is
+         * supported (C++14) */
+        using is_transparent = void;
+
         MapDataStore* _store;
         keycmp(MapDataStore* store) : _store(store) {}
-        bool operator()(const ds_bulk_t& a, const ds_bulk_t& b) const
+        bool
+        less(const char* a, size_t asize, const char* b, size_t bsize) const
         {
             if (_store->_less)
-                return _store->_less((const void*)a.data(), a.size(),
-                                     (const void*)b.data(), b.size())
+                return _store->_less((const void*)a, asize, (const void*)b,
+                                     bsize)
                      < 0;
             else
-                return std::less<ds_bulk_t>()(a, b);
+                return std::lexicographical_compare(a, a + asize, b,
+                                                    b + bsize);
+        }
+        bool operator()(const ds_bulk_t& a, const ds_bulk_t& b) const
+        {
+            return less(a.data(), a.size(), b.data(), b.size());
+        }
+        bool operator()(const ds_bulk_t& a, const key_view& b) const
+        {
+            return less(a.data(), a.size(), b.data, b.size);
+        }
+        bool operator()(const key_view& a, const ds_bulk_t& b) const
+        {
+            return less(a.data, a.size, b.data(), b.size());
         }
     };
 
@@ -52,7 +77,7 @@ class MapDataStore : public AbstractDataStore {
         return true;
     }
 
-    virtual void sync() override {}
+    virtual int sync() override { return SDSKV_SUCCESS; }
 
     virtual int put(const ds_bulk_t& key, const ds_bulk_t& data) override
     {
@@ -138,9 +163,24 @@ class MapDataStore : public AbstractDataStore {
         return e;
     }
 
+    virtual bool length(const void* key,
+                        hg_size_t   ksize,
+                        size_t*     vsize) override
+    {
+        ABT_rwlock_rdlock(_map_lock);
+        auto it    = find(key, ksize);
+        bool found = it != _map.end();
+        if (found) *vsize = it->second.size();
+        ABT_rwlock_unlock(_map_lock);
+        return found;
+    }
+
     virtual bool exists(const void* key, hg_size_t ksize) const override
     {
-        return exists(ds_bulk_t((const char*)key, ((const char*)key) + ksize));
+        ABT_rwlock_rdlock(_map_lock);
+        bool e = find(key, ksize) != _map.end();
+        ABT_rwlock_unlock(_map_lock);
+        return e;
     }
 
     virtual bool erase(const ds_bulk_t& key) override
@@ -152,6 +192,164 @@ class MapDataStore : public AbstractDataStore {
         return b;
     }
 
+    virtual int erase_multi(hg_size_t          num_items,
+                            const void* const* keys,
+                            const hg_size_t*   ksizes,
+                            uint8_t*           erased) override
+    {
+        ABT_rwlock_wrlock(_map_lock);
+        for (hg_size_t i = 0; i < num_items; i++) {
+            ds_bulk_t k((const char*)keys[i],
+                        ((const char*)keys[i]) + ksizes[i]);
+            erased[i] = _map.erase(k) ? 1 : 0;
+        }
+        ABT_rwlock_unlock(_map_lock);
+        return SDSKV_SUCCESS;
+    }
+
+    virtual void write_batch(write_op* const* ops, size_t count) override
+    {
+        ABT_rwlock_wrlock(_map_lock);
+        for (size_t i = 0; i < count; i++) {
+            write_op* op = ops[i];
+            ds_bulk_t k((const char*)op->key, (const char*)op->key + op->ksize);
+            if (op->erase) {
+                op->ret = _map.erase(k) ? SDSKV_SUCCESS : SDSKV_ERR_ERASE;
+            } else if (_no_overwrite && _map.count(k)) {
+                op->ret = SDSKV_ERR_KEYEXISTS;
+            } else {
+                _map[std::move(k)] = ds_bulk_t(
+                    (const char*)op->val, ((const char*)op->val) + op->vsize);
+                op->ret = SDSKV_SUCCESS;
+            }
+        }
+        ABT_rwlock_unlock(_map_lock);
+    }
+
+    virtual int erase_range(const ds_bulk_t& lower_bound,
+                            const ds_bulk_t& upper_bound,
+                            hg_size_t*       num_erased) override
+    {
+        ABT_rwlock_wrlock(_map_lock);
+        auto first = lower_bound.empty() ? _map.begin()
+                                         : _map.upper_bound(lower_bound);
+        auto last
+            = upper_bound.empty() ? _map.end() : _map.lower_bound(upper_bound);
+        *num_erased = 0;
+        if (lower_bound.empty() || upper_bound.empty()
+            || _map.key_comp()(lower_bound, upper_bound)) {
+            *num_erased = std::distance(first, last);
+            _map.erase(first, last);
+        }
+        ABT_rwlock_unlock(_map_lock);
+        return SDSKV_SUCCESS;
+    }
+
+    virtual int erase_prefix(const ds_bulk_t& prefix,
+                             hg_size_t*       num_erased) override
+    {
+        ABT_rwlock_wrlock(_map_lock);
+        // keys starting with prefix are contiguous only in byte order
+        bool bytewise = _less == nullptr;
+        auto it       = prefix.empty() || !bytewise ? _map.begin()
+                                                    : _map.lower_bound(prefix);
+        *num_erased   = 0;
+        while (it != _map.end()) {
+            int c = compare_prefix(prefix, it->first.data(), it->first.size());
+            if (c < 0 && bytewise) break;
+            if (c != 0) {
+                ++it;
+                continue;
+            }
+            it = _map.erase(it);
+            *num_erased += 1;
+        }
+        ABT_rwlock_unlock(_map_lock);
+        return SDSKV_SUCCESS;
+    }
+
+    virtual int compare_and_swap(const void* key,
+                                 hg_size_t   ksize,
+                                 const void* expected,
+                                 hg_size_t   esize,
+                                 const void* desired,
+                                 hg_size_t   dsize,
+                                 bool*       swapped) override
+    {
+        ds_bulk_t k((const char*)key, ((const char*)key) + ksize);
+        *swapped = false;
+        ABT_rwlock_wrlock(_map_lock);
+        auto it = _map.find(k);
+        if (it == _map.end()) {
+            if (esize == 0) {
+                _map.emplace(std::move(k),
+                             ds_bulk_t((const char*)desired,
+                                       ((const char*)desired) + dsize));
+                *swapped = true;
+            }
+        } else if (it->second.size() == esize
+                   && std::memcmp(it->second.data(), expected, esize) == 0) {
+            if (_no_overwrite) {
+                ABT_rwlock_unlock(_map_lock);
+                return SDSKV_ERR_KEYEXISTS;
+            }
+            it->second.assign((const char*)desired,
+                              ((const char*)desired) + dsize);
+            *swapped = true;
+        }
+        ABT_rwlock_unlock(_map_lock);
+        return SDSKV_SUCCESS;
+    }
+
+    virtual int fetch_and_add(const void* key,
+                              hg_size_t   ksize,
+                              int64_t     delta,
+                              int64_t*    previous) override
+    {
+        ds_bulk_t k((const char*)key, ((const char*)key) + ksize);
+        int64_t   value = 0;
+        ABT_rwlock_wrlock(_map_lock);
+        auto it = _map.find(k);
+        if (it == _map.end()) {
+            it = _map.emplace(std::move(k), ds_bulk_t(sizeof(value))).first;
+        } else if (_no_overwrite) {
+            ABT_rwlock_unlock(_map_lock);
+            return SDSKV_ERR_KEYEXISTS;
+        } else if (it->second.size() != sizeof(value)) {
+            ABT_rwlock_unlock(_map_lock);
+            return SDSKV_ERR_SIZE;
+        } else {
+            std::memcpy(&value, it->second.data(), sizeof(value));
+        }
+        int64_t updated = value + delta;
+        std::memcpy(it->second.data(), &updated, sizeof(updated));
+        ABT_rwlock_unlock(_map_lock);
+        *previous = value;
+        return SDSKV_SUCCESS;
+    }
+
+    virtual int append(const void* key,
+                       hg_size_t   ksize,
+                       const void* data,
+                       hg_size_t   dsize,
+                       hg_size_t*  new_size) override
+    {
+        ds_bulk_t k((const char*)key, ((const char*)key) + ksize);
+        ABT_rwlock_wrlock(_map_lock);
+        auto it = _map.find(k);
+        if (it == _map.end()) {
+            it = _map.emplace(std::move(k), ds_bulk_t()).first;
+        } else if (_no_overwrite) {
+            ABT_rwlock_unlock(_map_lock);
+            return SDSKV_ERR_KEYEXISTS;
+        }
+        it->second.insert(it->second.end(), (const char*)data,
+                          ((const char*)data) + dsize);
+        *new_size = it->second.size();
+        ABT_rwlock_unlock(_map_lock);
+        return SDSKV_SUCCESS;
+    }
+
     virtual void set_in_memory(bool enable) override { _in_memory = enable; }
 
     virtual void set_comparison_function(const std::string& name,
@@ -171,60 +369,34 @@ class MapDataStore : public AbstractDataStore {
 #endif
 
   protected:
-    virtual std::vector<ds_bulk_t>
-    vlist_keys(const ds_bulk_t& start_key,
-               hg_size_t        count,
-               const ds_bulk_t& prefix) const override
+    virtual void vvisit(const ds_bulk_t&  start_key,
+                        const ds_bulk_t&  prefix,
+                        bool              with_values,
+                        const visitor_fn& visitor) const override
     {
         ABT_rwlock_rdlock(_map_lock);
-        std::vector<ds_bulk_t> result;
+        // keys starting with prefix are contiguous only in byte order
+        bool                   bytewise = _less == nullptr;
         decltype(_map.begin()) it;
         if (start_key.size() > 0) {
             it = _map.upper_bound(start_key);
+        } else if (prefix.size() > 0 && bytewise) {
+            it = _map.lower_bound(prefix);
         } else {
             it = _map.begin();
         }
-        while (result.size() < count && it != _map.end()) {
-            const auto& p = *it;
-            if (prefix.size() > p.first.size()) continue;
-            int c = std::memcmp(prefix.data(), p.first.data(), prefix.size());
-            if (c == 0) {
-                result.push_back(p.first);
-            } else if (c < 0) {
-                break; // we have exceeded prefix
-            }
-            it++;
-        }
-        ABT_rwlock_unlock(_map_lock);
-        return result;
-    }
-
-    virtual std::vector<std::pair<ds_bulk_t, ds_bulk_t>>
-    vlist_keyvals(const ds_bulk_t& start_key,
-                  hg_size_t        count,
-                  const ds_bulk_t& prefix) const override
-    {
-        ABT_rwlock_rdlock(_map_lock);
-        std::vector<std::pair<ds_bulk_t, ds_bulk_t>> result;
-        decltype(_map.begin())                       it;
-        if (start_key.size() > 0) {
-            it = _map.upper_bound(start_key);
-        } else {
-            it = _map.begin();
-        }
-        while (result.size() < count && it != _map.end()) {
-            const auto& p = *it;
-            if (prefix.size() > p.first.size()) continue;
-            int c = std::memcmp(prefix.data(), p.first.data(), prefix.size());
-            if (c == 0) {
-                result.push_back(p);
-            } else if (c < 0) {
-                break; // we have exceeded prefix
-            }
-            it++;
+        for (; it != _map.end(); it++) {
+            const auto& k = it->first;
+            int         c = compare_prefix(prefix, k.data(), k.size());
+            if (c < 0 && bytewise) break; // we have exceeded prefix
+            if (c != 0) continue;
+            const auto& v = it->second;
+            bool        keep_going
+                = with_values ? visitor(k.data(), k.size(), v.data(), v.size())
+                              : visitor(k.data(), k.size(), nullptr, 0);
+            if (!keep_going) break;
         }
         ABT_rwlock_unlock(_map_lock);
-        return result;
     }
 
     virtual std::vector<ds_bulk_t>
@@ -279,6 +451,18 @@ class MapDataStore : public AbstractDataStore {
     AbstractDataStore::comparator_fn       _less;
     std::map<ds_bulk_t, ds_bulk_t, keycmp> _map;
     ABT_rwlock                             _map_lock;
+
+    /* must be called with _map_lock held */
+    std::map<ds_bulk_t, ds_bulk_t, keycmp>::const_iterator
+    find(const void* key, hg_size_t ksize) const
+    {
+#if __cplusplus >= 201402L
+        return _map.find(key_view{(const char*)key, ksize});
+#else
+        return _map.find(
+            ds_bulk_t((const char*)key, ((const char*)key) + ksize));
+#endif
+    }
 };
 
 #endif
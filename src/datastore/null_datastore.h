@@ -25,7 +25,7 @@ class NullDataStore : public AbstractDataStore {
         return true;
     }
 
-    virtual void sync() override {}
+    virtual int sync() override { return SDSKV_SUCCESS; }
 
     virtual int put(const ds_bulk_t& key, const ds_bulk_t& data) override
     {
@@ -65,6 +65,21 @@ class NullDataStore : public AbstractDataStore {
 
     virtual bool erase(const ds_bulk_t& key) override { return false; }
 
+    virtual int erase_range(const ds_bulk_t& lower_bound,
+                            const ds_bulk_t& upper_bound,
+                            hg_size_t*       num_erased) override
+    {
+        *num_erased = 0;
+        return SDSKV_SUCCESS;
+    }
+
+    virtual int erase_prefix(const ds_bulk_t& prefix,
+                             hg_size_t*       num_erased) override
+    {
+        *num_erased = 0;
+        return SDSKV_SUCCESS;
+    }
+
     virtual void set_in_memory(bool enable) override {}
 
     virtual void set_comparison_function(const std::string& name,
@@ -81,23 +96,11 @@ class NullDataStore : public AbstractDataStore {
 #endif
 
   protected:
-    virtual std::vector<ds_bulk_t>
-    vlist_keys(const ds_bulk_t& start_key,
-               hg_size_t        count,
-               const ds_bulk_t& prefix) const override
-    {
-        std::vector<ds_bulk_t> result;
-        return result;
-    }
-
-    virtual std::vector<std::pair<ds_bulk_t, ds_bulk_t>>
-    vlist_keyvals(const ds_bulk_t& start_key,
-                  hg_size_t        count,
-                  const ds_bulk_t& prefix) const override
-    {
-        std::vector<std::pair<ds_bulk_t, ds_bulk_t>> result;
-        return result;
-    }
+    virtual void vvisit(const ds_bulk_t&  start_key,
+                        const ds_bulk_t&  prefix,
+                        bool              with_values,
+                        const visitor_fn& visitor) const override
+    {}
 
     virtual std::vector<ds_bulk_t>
     vlist_key_range(const ds_bulk_t& lower_bound,
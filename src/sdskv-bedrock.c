@@ -15,6 +15,10 @@ static int sdskv_register_provider(bedrock_args_t             args,
     const char*       config      = bedrock_args_get_config(args);
     const char*       name        = bedrock_args_get_name(args);
 
+    /* the provider's "pool" is the default for all its RPCs; the "pools"
+     * section of its config can move reads, writes, scans and maintenance
+     * RPCs to other pools declared in the margo section of the bedrock
+     * config, by name */
     struct sdskv_provider_init_info sdskv_args = SDSKV_PROVIDER_INIT_INFO_INIT;
     sdskv_args.rpc_pool                        = pool;
     sdskv_args.json_config                     = config;
@@ -0,0 +1,115 @@
+#ifndef SDSKV_BENCHMARK_UTIL_H
+#define SDSKV_BENCHMARK_UTIL_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <cmath>
+#include <algorithm>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <json/json.h>
+#include "sdskv-common.h"
+
+/* Helpers shared by sdskv-benchmark and sdskv-engine-benchmark. */
+
+/**
+ * Zipfian generator of Gray et al., "Quickly Generating Billion-Record
+ * Synthetic Databases", as used by YCSB. Returns 0 most often. The number
+ * of items can grow (e.g. with inserts) without recomputing zeta from
+ * scratch.
+ */
+class ZipfianGenerator {
+    double   m_theta;
+    double   m_alpha;
+    double   m_zeta2;
+    double   m_zetan = 0.0;
+    double   m_eta   = 0.0;
+    uint64_t m_items = 0;
+
+  public:
+    ZipfianGenerator(double theta = 0.99)
+        : m_theta(theta), m_alpha(1.0 / (1.0 - theta)),
+          m_zeta2(1.0 + std::pow(0.5, theta))
+    {}
+
+    void resize(uint64_t items)
+    {
+        if (items < m_items) m_zetan = 0.0, m_items = 0;
+        for (uint64_t i = m_items + 1; i <= items; i++)
+            m_zetan += 1.0 / std::pow((double)i, m_theta);
+        m_items = items;
+        m_eta   = (1.0 - std::pow(2.0 / items, 1.0 - m_theta))
+              / (1.0 - m_zeta2 / m_zetan);
+    }
+
+    template <typename RNG> uint64_t next(RNG& rng) const
+    {
+        double u  = std::uniform_real_distribution<double>(0.0, 1.0)(rng);
+        double uz = u * m_zetan;
+        if (uz < 1.0) return 0;
+        if (uz < 1.0 + std::pow(0.5, m_theta)) return 1;
+        uint64_t x
+            = (uint64_t)(m_items * std::pow(m_eta * u - m_eta + 1, m_alpha));
+        return std::min(x, m_items - 1);
+    }
+};
+
+static inline sdskv_db_type_t
+database_type_from_string(const std::string& type)
+{
+    if (type == "null") {
+        return KVDB_NULL;
+    } else if (type == "map") {
+        return KVDB_MAP;
+    } else if (type == "bwtree") {
+        return KVDB_BWTREE;
+    } else if (type == "leveldb" || type == "ldb") {
+        return KVDB_LEVELDB;
+    } else if (type == "berkeleydb" || type == "bdb") {
+        return KVDB_BERKELEYDB;
+    }
+    throw std::runtime_error(std::string("Unknown database type \"") + type
+                             + "\"");
+}
+
+/* applies a command line override of the form a.b.c=x to config */
+static inline void parse_extra_cmd_arg(Json::Value& config, const char* arg)
+{
+    // find first instance of a point
+    const char* period = strchr(arg, '.');
+    // period found, call recursively
+    if (period != NULL) {
+        std::string key(arg, (size_t)(period - arg));
+        parse_extra_cmd_arg(config[key], period + 1);
+        return;
+    }
+    // period not found, search for equal sign
+    const char* equal = strchr(arg, '=');
+    if (!equal) throw std::runtime_error("Syntax error in command line");
+    std::string key = std::string(arg, (size_t)(equal - arg));
+    std::string val = std::string(equal + 1);
+    if (val[0] == '"' && val[val.size() - 1] == '"') {
+        config[key] = val.substr(1, val.size() - 2);
+    } else if (val == "true") {
+        config[key] = true;
+    } else if (val == "false") {
+        config[key] = false;
+    } else {
+        bool is_number = true;
+        for (auto& c : val) {
+            if (c < '0' || c > '9') {
+                is_number = false;
+                break;
+            }
+        }
+        if (is_number) {
+            config[key] = atoi(val.c_str());
+        } else {
+            config[key] = val;
+        }
+    }
+}
+
+#endif
@@ -7,10 +7,14 @@
 #include <map>
 #include <functional>
 #include <memory>
+#include <atomic>
+#include <random>
 #include <mpi.h>
 #include <json/json.h>
 #include <sdskv-client.hpp>
 #include <sdskv-server.hpp>
+#include "sdskv-metrics.h"
+#include "sdskv-benchmark-util.h"
 
 using RemoteDatabase = sdskv::database;
 
@@ -57,6 +61,24 @@ class AbstractBenchmark {
     const RemoteDatabase& remoteDatabase() const { return m_remote_db; }
     MPI_Comm              comm() const { return m_comm; }
 
+    /* number of entries of the arrays filled by reduce_histogram */
+    static const unsigned reduced_histogram_size
+        = LatencyHistogram::num_buckets + 3;
+
+    /* merges h across the processes of comm() into global, on rank 0:
+     * the counts of each bucket, followed by the count, sum and max (see
+     * LatencyHistogram::accumulate) */
+    void reduce_histogram(const LatencyHistogram& h, uint64_t* global) const
+    {
+        const unsigned n = LatencyHistogram::num_buckets;
+        uint64_t       local[reduced_histogram_size] = {0};
+        h.accumulate(local, local[n], local[n + 1], local[n + 2]);
+        // counts, count and sum add up, max is the max
+        MPI_Reduce(local, global, n + 2, MPI_UINT64_T, MPI_SUM, 0, m_comm);
+        MPI_Reduce(local + n + 2, global + n + 2, 1, MPI_UINT64_T, MPI_MAX, 0,
+                   m_comm);
+    }
+
   public:
     AbstractBenchmark(MPI_Comm c, RemoteDatabase& rdb)
         : m_comm(c), m_remote_db(rdb)
@@ -67,6 +89,13 @@ class AbstractBenchmark {
     virtual void execute()       = 0;
     virtual void teardown()      = 0;
 
+    /**
+     * @brief Prints details about the executions since the last report, in
+     * addition to the timings of execute(). Collective over comm(); print
+     * is true on the process that should print.
+     */
+    virtual void report(bool print) {}
+
     /**
      * @brief Factory function used to create benchmark instances.
      */
@@ -752,11 +781,598 @@ class ListKeyValsBenchmark : public ListKeysBenchmark {
 };
 REGISTER_BENCHMARK("list-keyvals", ListKeyValsBenchmark);
 
-static void            run_server(MPI_Comm comm, Json::Value& config);
-static void            run_client(MPI_Comm comm, Json::Value& config);
-static void            run_single_node(Json::Value& config);
-static sdskv_db_type_t database_type_from_string(const std::string& type);
-static void parse_extra_cmd_arg(Json::Value& config, const char* arg);
+/**
+ * YCSBBenchmark runs a mix of operations in the style of the YCSB core
+ * workloads: reads, updates, inserts, scans and read-modify-writes, on keys
+ * picked following a uniform, zipfian or latest distribution. In setup, the
+ * clients load num-entries records (not part of the measure). Each
+ * execution then issues operation-count operations per client, and the
+ * latency of each operation is recorded so that report() can print the
+ * throughput and latency percentiles of each type of operation.
+ *
+ * Keys are "user" followed by a hash of the record number, zero-padded to
+ * the requested key size (at least 24 bytes), so that records are spread
+ * over the key space. With several clients, inserts of other clients may
+ * not have happened yet when a key is picked; such reads count as errors.
+ */
+class YCSBBenchmark : public AbstractAccessBenchmark {
+
+  protected:
+    enum op_t { READ = 0, UPDATE, INSERT, SCAN, READ_MODIFY_WRITE, NUM_OPS };
+    enum distribution_t { UNIFORM, ZIPFIAN, LATEST };
+
+    struct op_stats {
+        LatencyHistogram latencies;
+        uint64_t         errors = 0;
+    };
+
+    static const char* op_name(int op)
+    {
+        static const char* names[NUM_OPS]
+            = {"read", "update", "insert", "scan", "read-modify-write"};
+        return names[op];
+    }
+
+    static uint64_t fnv_hash(uint64_t x)
+    {
+        uint64_t h = 0xcbf29ce484222325ULL;
+        for (unsigned i = 0; i < 8; i++) {
+            h ^= x & 0xff;
+            h *= 0x100000001b3ULL;
+            x >>= 8;
+        }
+        return h;
+    }
+
+    double                   m_proportions[NUM_OPS] = {0};
+    distribution_t           m_distribution;
+    uint64_t                 m_operation_count;
+    size_t                   m_max_scan_length;
+    size_t                   m_load_batch_size;
+    int                      m_rank        = 0;
+    int                      m_num_clients = 1;
+    std::mt19937_64          m_rng;
+    ZipfianGenerator         m_zipfian;
+    uint64_t                 m_num_inserted = 0; // by this client
+    std::string              m_value_pool;
+    std::vector<char>        m_value_buffer;
+    std::vector<std::string> m_keys_buffer;
+    std::vector<std::string> m_vals_buffer;
+    // statistics since the last report
+    std::unique_ptr<op_stats[]> m_stats{new op_stats[NUM_OPS]};
+    double                      m_elapsed = 0.0;
+
+    /* Fills in the fields of config that are missing with the parameters
+     * of YCSB core workload a to f. */
+    static Json::Value& with_defaults(Json::Value& config, char workload)
+    {
+        static const struct {
+            double      read, update, insert, scan, rmw;
+            const char* distribution;
+        } workloads[] = {
+            {0.50, 0.50, 0.00, 0.00, 0.00, "zipfian"}, // a: update heavy
+            {0.95, 0.05, 0.00, 0.00, 0.00, "zipfian"}, // b: read mostly
+            {1.00, 0.00, 0.00, 0.00, 0.00, "zipfian"}, // c: read only
+            {0.95, 0.00, 0.05, 0.00, 0.00, "latest"},  // d: read latest
+            {0.00, 0.00, 0.05, 0.95, 0.00, "zipfian"}, // e: short ranges
+            {0.50, 0.00, 0.00, 0.00, 0.50, "zipfian"}, // f: read-modify-write
+        };
+        const auto& w = workloads[workload - 'a'];
+        if (!config.isMember("num-entries")) config["num-entries"] = 1000;
+        if (!config.isMember("key-sizes")) config["key-sizes"] = 24;
+        if (!config.isMember("val-sizes")) config["val-sizes"] = 1000;
+        if (!config.isMember("operation-count"))
+            config["operation-count"] = 1000;
+        if (!config.isMember("read-proportion"))
+            config["read-proportion"] = w.read;
+        if (!config.isMember("update-proportion"))
+            config["update-proportion"] = w.update;
+        if (!config.isMember("insert-proportion"))
+            config["insert-proportion"] = w.insert;
+        if (!config.isMember("scan-proportion"))
+            config["scan-proportion"] = w.scan;
+        if (!config.isMember("read-modify-write-proportion"))
+            config["read-modify-write-proportion"] = w.rmw;
+        if (!config.isMember("request-distribution"))
+            config["request-distribution"] = w.distribution;
+        if (!config.isMember("max-scan-length"))
+            config["max-scan-length"] = 100;
+        return config;
+    }
+
+    std::string key_of(uint64_t index) const
+    {
+        uint64_t    h   = fnv_hash(index);
+        std::string num = std::to_string(h);
+        size_t      ksize
+            = m_key_size_range.first
+            + h % (m_key_size_range.second - m_key_size_range.first);
+        ksize = std::max(ksize, num.size() + 4);
+        return "user" + std::string(ksize - 4 - num.size(), '0') + num;
+    }
+
+    /* number of records this client can expect to exist */
+    uint64_t num_records() const
+    {
+        return m_num_entries + m_num_inserted * m_num_clients;
+    }
+
+    uint64_t next_index()
+    {
+        uint64_t n = num_records();
+        switch (m_distribution) {
+        case UNIFORM:
+            return std::uniform_int_distribution<uint64_t>(0, n - 1)(m_rng);
+        case ZIPFIAN:
+            /* scrambled, so that popular records are not all adjacent */
+            return fnv_hash(m_zipfian.next(m_rng)) % n;
+        case LATEST:
+        default:
+            return n - 1 - m_zipfian.next(m_rng);
+        }
+    }
+
+    /* pointer to a value of a random size from the pool */
+    std::pair<const char*, size_t> next_value()
+    {
+        size_t vsize = std::uniform_int_distribution<size_t>(
+            m_val_size_range.first, m_val_size_range.second - 1)(m_rng);
+        return {m_value_pool.data(), vsize};
+    }
+
+    /* runs one operation, returns false if it failed */
+    bool run_operation(int op)
+    {
+        auto& db = remoteDatabase();
+        try {
+            switch (op) {
+            case READ:
+            case READ_MODIFY_WRITE: {
+                std::string key   = key_of(next_index());
+                hg_size_t   vsize = m_value_buffer.size();
+                db.get(key.data(), key.size(), m_value_buffer.data(), &vsize);
+                if (op == READ) break;
+                auto val = next_value();
+                db.put(key.data(), key.size(), val.first, val.second);
+            } break;
+            case UPDATE: {
+                std::string key = key_of(next_index());
+                auto        val = next_value();
+                db.put(key.data(), key.size(), val.first, val.second);
+            } break;
+            case INSERT: {
+                std::string key = key_of(num_records() + m_rank);
+                auto        val = next_value();
+                db.put(key.data(), key.size(), val.first, val.second);
+                m_num_inserted += 1;
+                if (m_distribution != UNIFORM) m_zipfian.resize(num_records());
+            } break;
+            case SCAN: {
+                std::string key = key_of(next_index());
+                hg_size_t   count
+                    = std::uniform_int_distribution<size_t>(
+                        1, m_max_scan_length)(m_rng);
+                std::vector<void*>     kptrs(count), vptrs(count);
+                std::vector<hg_size_t> ksizes(count), vsizes(count);
+                for (unsigned i = 0; i < count; i++) {
+                    kptrs[i]  = (void*)m_keys_buffer[i].data();
+                    ksizes[i] = m_keys_buffer[i].size();
+                    vptrs[i]  = (void*)m_vals_buffer[i].data();
+                    vsizes[i] = m_vals_buffer[i].size();
+                }
+                db.list_keyvals(key.data(), key.size(), kptrs.data(),
+                                ksizes.data(), vptrs.data(), vsizes.data(),
+                                &count);
+            } break;
+            }
+        } catch (const sdskv::exception&) {
+            return false;
+        }
+        return true;
+    }
+
+  public:
+    template <typename... T>
+    YCSBBenchmark(Json::Value& config, T&&... args)
+        : AbstractAccessBenchmark(config, std::forward<T>(args)...)
+    {
+        static const char* fields[NUM_OPS]
+            = {"read-proportion", "update-proportion", "insert-proportion",
+               "scan-proportion", "read-modify-write-proportion"};
+        double total = 0.0;
+        for (int op = 0; op < NUM_OPS; op++) {
+            m_proportions[op] = config.get(fields[op], 0.0).asDouble();
+            if (m_proportions[op] < 0.0)
+                throw std::range_error(std::string("invalid ") + fields[op]);
+            total += m_proportions[op];
+        }
+        if (total <= 0.0)
+            throw std::range_error("operation proportions sum up to 0");
+        for (auto& p : m_proportions) p /= total;
+        std::string distribution
+            = config.get("request-distribution", "zipfian").asString();
+        if (distribution == "uniform")
+            m_distribution = UNIFORM;
+        else if (distribution == "zipfian")
+            m_distribution = ZIPFIAN;
+        else if (distribution == "latest")
+            m_distribution = LATEST;
+        else
+            throw std::range_error("invalid request-distribution "
+                                   + distribution);
+        m_operation_count = config.get("operation-count", 1000).asUInt64();
+        m_max_scan_length = config.get("max-scan-length", 100).asUInt();
+        m_load_batch_size = config.get("load-batch-size", 128).asUInt();
+        if (m_num_entries == 0)
+            throw std::range_error("num-entries should be positive");
+        if (m_max_scan_length == 0 || m_load_batch_size == 0)
+            throw std::range_error(
+                "max-scan-length and load-batch-size should be positive");
+        MPI_Comm_rank(comm(), &m_rank);
+        MPI_Comm_size(comm(), &m_num_clients);
+    }
+
+    virtual void setup() override
+    {
+        m_rng.seed(rand());
+        m_num_inserted = 0;
+        m_value_pool   = gen_random_string(m_val_size_range.second - 1);
+        m_value_buffer.resize(m_val_size_range.second - 1);
+        size_t max_ksize = std::max<size_t>(m_key_size_range.second - 1, 24);
+        m_keys_buffer.assign(m_max_scan_length, std::string(max_ksize, 0));
+        m_vals_buffer.assign(m_max_scan_length,
+                             std::string(m_val_size_range.second - 1, 0));
+        if (m_distribution != UNIFORM) m_zipfian.resize(m_num_entries);
+        // load phase: each client puts its share of the records
+        auto&                    db = remoteDatabase();
+        std::vector<std::string> keys;
+        std::vector<const void*> kptrs, vptrs;
+        std::vector<hg_size_t>   ksizes, vsizes;
+        for (uint64_t i = m_rank; i < m_num_entries; i += m_num_clients) {
+            keys.push_back(key_of(i));
+            if (keys.size() == m_load_batch_size
+                || i + m_num_clients >= m_num_entries) {
+                kptrs.clear();
+                ksizes.clear();
+                vptrs.clear();
+                vsizes.clear();
+                for (auto& key : keys) {
+                    auto val = next_value();
+                    kptrs.push_back(key.data());
+                    ksizes.push_back(key.size());
+                    vptrs.push_back(val.first);
+                    vsizes.push_back(val.second);
+                }
+                db.put_multi(kptrs, ksizes, vptrs, vsizes);
+                keys.clear();
+            }
+        }
+    }
+
+    virtual void execute() override
+    {
+        double t_start = MPI_Wtime();
+        for (uint64_t i = 0; i < m_operation_count; i++) {
+            double u = std::uniform_real_distribution<double>(0.0, 1.0)(m_rng);
+            int    op = 0;
+            while (op < NUM_OPS - 1 && u >= m_proportions[op]) {
+                u -= m_proportions[op];
+                op += 1;
+            }
+            double start = MPI_Wtime();
+            bool   ok    = run_operation(op);
+            m_stats[op].latencies.record(
+                (uint64_t)((MPI_Wtime() - start) * 1e9));
+            if (!ok) m_stats[op].errors += 1;
+        }
+        m_elapsed += MPI_Wtime() - t_start;
+    }
+
+    virtual void teardown() override
+    {
+        if (m_erase_on_teardown) {
+            // erase the records loaded and inserted by this client
+            std::vector<std::string> keys;
+            for (uint64_t i = m_rank; i < m_num_entries; i += m_num_clients)
+                keys.push_back(key_of(i));
+            for (uint64_t i = 0; i < m_num_inserted; i++)
+                keys.push_back(
+                    key_of(m_num_entries + i * m_num_clients + m_rank));
+            remoteDatabase().erase_multi(keys);
+        }
+        m_value_pool.clear();
+        m_value_pool.shrink_to_fit();
+        m_keys_buffer.resize(0);
+        m_keys_buffer.shrink_to_fit();
+        m_vals_buffer.resize(0);
+        m_vals_buffer.shrink_to_fit();
+    }
+
+    virtual void report(bool print) override
+    {
+        MPI_Comm c = comm();
+        double   elapsed;
+        MPI_Reduce(&m_elapsed, &elapsed, 1, MPI_DOUBLE, MPI_MAX, 0, c);
+        if (print) {
+            std::cout << std::setprecision(3) << std::fixed;
+            std::cout << "Total time(sec) : " << elapsed << std::endl;
+        }
+        for (int op = 0; op < NUM_OPS; op++) {
+            // merge the histograms of all the clients
+            const unsigned n = LatencyHistogram::num_buckets;
+            uint64_t       global[reduced_histogram_size] = {0};
+            uint64_t       errors                         = 0;
+            reduce_histogram(m_stats[op].latencies, global);
+            MPI_Reduce(&m_stats[op].errors, &errors, 1, MPI_UINT64_T, MPI_SUM,
+                       0, c);
+            uint64_t count = global[n], sum = global[n + 1],
+                     max = global[n + 2];
+            if (!print || count == 0) continue;
+            auto percentile = [&](double q) {
+                return LatencyHistogram::percentile(global, count, max, q);
+            };
+            std::cout << "[" << op_name(op) << "]" << std::endl;
+            std::cout << "Operations      : " << count << std::endl;
+            std::cout << "Errors          : " << errors << std::endl;
+            std::cout << "Throughput(op/s): " << count / elapsed << std::endl;
+            std::cout << "Average(usec)   : " << sum / 1e3 / count
+                      << std::endl;
+            std::cout << "P50(usec)       : " << percentile(0.5) << std::endl;
+            std::cout << "P95(usec)       : " << percentile(0.95) << std::endl;
+            std::cout << "P99(usec)       : " << percentile(0.99) << std::endl;
+            std::cout << "P999(usec)      : " << percentile(0.999)
+                      << std::endl;
+            std::cout << "Maximum(usec)   : " << max / 1e3 << std::endl;
+        }
+        m_stats.reset(new op_stats[NUM_OPS]);
+        m_elapsed = 0.0;
+    }
+};
+
+/**
+ * YCSBWorkload runs YCSBBenchmark with the parameters of one of the YCSB
+ * core workloads, which the configuration may override.
+ */
+template <char W> class YCSBWorkload : public YCSBBenchmark {
+
+  public:
+    template <typename... T>
+    YCSBWorkload(Json::Value& config, T&&... args)
+        : YCSBBenchmark(with_defaults(config, W), std::forward<T>(args)...)
+    {}
+};
+
+using YCSBWorkloadA = YCSBWorkload<'a'>;
+using YCSBWorkloadB = YCSBWorkload<'b'>;
+using YCSBWorkloadC = YCSBWorkload<'c'>;
+using YCSBWorkloadD = YCSBWorkload<'d'>;
+using YCSBWorkloadE = YCSBWorkload<'e'>;
+using YCSBWorkloadF = YCSBWorkload<'f'>;
+REGISTER_BENCHMARK("ycsb-a", YCSBWorkloadA);
+REGISTER_BENCHMARK("ycsb-b", YCSBWorkloadB);
+REGISTER_BENCHMARK("ycsb-c", YCSBWorkloadC);
+REGISTER_BENCHMARK("ycsb-d", YCSBWorkloadD);
+REGISTER_BENCHMARK("ycsb-e", YCSBWorkloadE);
+REGISTER_BENCHMARK("ycsb-f", YCSBWorkloadF);
+
+/**
+ * OpenLoopBenchmark issues GET and PUT operations at a target rate,
+ * independently of how fast previous operations complete, to measure
+ * latencies under a given offered load (closed-loop benchmarks only
+ * measure latency at saturation). Arrivals are either evenly spaced
+ * ("constant") or follow a Poisson process ("poisson"). Each operation
+ * runs in its own ULT so that many can be outstanding at once, and its
+ * latency is measured from its scheduled arrival time, so that a client
+ * falling behind schedule shows up as latency instead of being hidden.
+ * Latencies are recorded in histograms that report() merges across the
+ * clients. Running several entries with increasing rates gives a
+ * latency-vs-load curve.
+ */
+class OpenLoopBenchmark : public AbstractAccessBenchmark {
+
+  protected:
+    enum op_t { GET = 0, PUT, NUM_OPS };
+
+    struct operation {
+        OpenLoopBenchmark* bench;
+        double             arrival; // seconds after the start of execute()
+        uint64_t           index;   // of the key
+        op_t               type;
+    };
+
+    double                   m_rate; // operations per second, per client
+    bool                     m_poisson;
+    double                   m_read_proportion;
+    uint64_t                 m_operation_count;
+    uint64_t                 m_max_outstanding;
+    std::vector<std::string> m_keys;
+    std::string              m_value_pool;
+    std::vector<operation>   m_operations;
+    double                   m_start;
+    std::atomic<uint64_t>    m_outstanding{0};
+    // statistics since the last report
+    std::unique_ptr<LatencyHistogram[]> m_histograms;
+    std::atomic<uint64_t>               m_errors[NUM_OPS];
+    uint64_t                            m_dropped = 0;
+    double                              m_elapsed = 0.0;
+
+    static void run_operation(void* arg)
+    {
+        operation*         op    = static_cast<operation*>(arg);
+        OpenLoopBenchmark* bench = op->bench;
+        auto&              db    = bench->remoteDatabase();
+        const std::string& key   = bench->m_keys[op->index];
+        try {
+            if (op->type == GET) {
+                std::vector<char> value(bench->m_val_size_range.second - 1);
+                hg_size_t         vsize = value.size();
+                db.get(key.data(), key.size(), value.data(), &vsize);
+            } else {
+                size_t vsize = bench->m_val_size_range.first
+                             + op->index
+                                   % (bench->m_val_size_range.second
+                                      - bench->m_val_size_range.first);
+                db.put(key.data(), key.size(), bench->m_value_pool.data(),
+                       vsize);
+            }
+        } catch (const sdskv::exception&) {
+            bench->m_errors[op->type]++;
+        }
+        double latency = ABT_get_wtime() - (bench->m_start + op->arrival);
+        bench->m_histograms[op->type].record((uint64_t)(latency * 1e9));
+        bench->m_outstanding--;
+    }
+
+    void reset_statistics()
+    {
+        m_histograms.reset(new LatencyHistogram[NUM_OPS]);
+        for (auto& e : m_errors) e.store(0);
+        m_dropped = 0;
+        m_elapsed = 0.0;
+    }
+
+  public:
+    template <typename... T>
+    OpenLoopBenchmark(Json::Value& config, T&&... args)
+        : AbstractAccessBenchmark(config, std::forward<T>(args)...)
+    {
+        m_rate = config.get("rate", 1000.0).asDouble();
+        if (m_rate <= 0.0) throw std::range_error("rate should be positive");
+        std::string arrivals = config.get("arrivals", "poisson").asString();
+        if (arrivals != "poisson" && arrivals != "constant")
+            throw std::range_error("invalid arrivals " + arrivals);
+        m_poisson         = arrivals == "poisson";
+        m_read_proportion = config.get("read-proportion", 1.0).asDouble();
+        if (m_read_proportion < 0.0 || m_read_proportion > 1.0)
+            throw std::range_error("read-proportion should be in [0, 1]");
+        m_operation_count = config.get("operation-count", 10000).asUInt64();
+        m_max_outstanding = config.get("max-outstanding", 4096).asUInt64();
+        if (m_num_entries == 0)
+            throw std::range_error("num-entries should be positive");
+        reset_statistics();
+    }
+
+    virtual void setup() override
+    {
+        // generate keys and put them (not part of the measure)
+        m_keys.reserve(m_num_entries);
+        for (unsigned i = 0; i < m_num_entries; i++) {
+            size_t ksize
+                = m_key_size_range.first
+                + (rand() % (m_key_size_range.second - m_key_size_range.first));
+            m_keys.push_back(gen_random_string(ksize));
+        }
+        m_value_pool = gen_random_string(m_val_size_range.second - 1);
+        auto& db     = remoteDatabase();
+        for (unsigned i = 0; i < m_num_entries; i++) {
+            size_t vsize
+                = m_val_size_range.first
+                + i % (m_val_size_range.second - m_val_size_range.first);
+            db.put(m_keys[i].data(), m_keys[i].size(), m_value_pool.data(),
+                   vsize);
+        }
+        // schedule the operations
+        std::mt19937_64                        rng(rand());
+        std::exponential_distribution<double>  interval(m_rate);
+        std::uniform_real_distribution<double> uniform(0.0, 1.0);
+        m_operations.resize(m_operation_count);
+        double t = 0.0;
+        for (auto& op : m_operations) {
+            t += m_poisson ? interval(rng) : 1.0 / m_rate;
+            op.bench   = this;
+            op.arrival = t;
+            op.index   = rng() % m_num_entries;
+            op.type    = uniform(rng) < m_read_proportion ? GET : PUT;
+        }
+    }
+
+    virtual void execute() override
+    {
+        ABT_xstream xstream;
+        ABT_pool    pool;
+        ABT_self_get_xstream(&xstream);
+        ABT_xstream_get_main_pools(xstream, 1, &pool);
+        m_start = ABT_get_wtime();
+        for (auto& op : m_operations) {
+            // wait for the arrival time, letting operations progress
+            while (ABT_get_wtime() < m_start + op.arrival) ABT_thread_yield();
+            if (m_outstanding.load() >= m_max_outstanding) {
+                m_dropped += 1;
+                continue;
+            }
+            m_outstanding++;
+            ABT_thread_create(pool, run_operation, &op, ABT_THREAD_ATTR_NULL,
+                              NULL);
+        }
+        while (m_outstanding.load() != 0) ABT_thread_yield();
+        m_elapsed += ABT_get_wtime() - m_start;
+    }
+
+    virtual void teardown() override
+    {
+        if (m_erase_on_teardown) {
+            // erase all the keys from the database
+            auto& db = remoteDatabase();
+            db.erase_multi(m_keys);
+        }
+        m_keys.resize(0);
+        m_keys.shrink_to_fit();
+        m_value_pool.clear();
+        m_value_pool.shrink_to_fit();
+        m_operations.resize(0);
+        m_operations.shrink_to_fit();
+    }
+
+    virtual void report(bool print) override
+    {
+        static const char* op_names[NUM_OPS] = {"get", "put"};
+        MPI_Comm           c                 = comm();
+        double             elapsed;
+        uint64_t           dropped;
+        int                num_clients;
+        MPI_Comm_size(c, &num_clients);
+        MPI_Reduce(&m_elapsed, &elapsed, 1, MPI_DOUBLE, MPI_MAX, 0, c);
+        MPI_Reduce(&m_dropped, &dropped, 1, MPI_UINT64_T, MPI_SUM, 0, c);
+        if (print) {
+            std::cout << std::setprecision(3) << std::fixed;
+            std::cout << "Offered(op/s)   : " << m_rate * num_clients
+                      << std::endl;
+            std::cout << "Dropped         : " << dropped << std::endl;
+        }
+        for (int op = 0; op < NUM_OPS; op++) {
+            // merge the histograms of all the clients
+            const unsigned n = LatencyHistogram::num_buckets;
+            uint64_t       global[reduced_histogram_size] = {0};
+            uint64_t       local_errors = m_errors[op].load(), errors = 0;
+            reduce_histogram(m_histograms[op], global);
+            MPI_Reduce(&local_errors, &errors, 1, MPI_UINT64_T, MPI_SUM, 0,
+                       c);
+            uint64_t count = global[n], sum = global[n + 1],
+                     max = global[n + 2];
+            if (!print || count == 0) continue;
+            auto percentile = [&](double q) {
+                return LatencyHistogram::percentile(global, count, max, q);
+            };
+            std::cout << "[" << op_names[op] << "]" << std::endl;
+            std::cout << "Operations      : " << count << std::endl;
+            std::cout << "Errors          : " << errors << std::endl;
+            std::cout << "Throughput(op/s): " << count / elapsed << std::endl;
+            std::cout << "Average(usec)   : " << sum / 1e3 / count
+                      << std::endl;
+            std::cout << "P50(usec)       : " << percentile(0.5) << std::endl;
+            std::cout << "P99(usec)       : " << percentile(0.99) << std::endl;
+            std::cout << "P999(usec)      : " << percentile(0.999)
+                      << std::endl;
+            std::cout << "Maximum(usec)   : " << max / 1e3 << std::endl;
+        }
+        reset_statistics();
+    }
+};
+REGISTER_BENCHMARK("open-loop", OpenLoopBenchmark);
+
+static void run_server(MPI_Comm comm, Json::Value& config);
+static void run_client(MPI_Comm comm, Json::Value& config);
+static void run_single_node(Json::Value& config);
 
 /**
  * @brief Main function.
@@ -979,6 +1595,7 @@ static void run_client(MPI_Comm comm, Json::Value& config)
                 std::cout << "Q3(sec)         : " << q3 << std::endl;
                 std::cout << "Maximum(sec)    : " << max << std::endl;
             }
+            bench->report(rank == 0);
         }
         // wait for all the clients to be done with their tasks
         MPI_Barrier(comm);
@@ -1112,59 +1729,9 @@ static void run_single_node(Json::Value& config)
             std::cout << "Median(sec)     : " << median << std::endl;
             std::cout << "Q3(sec)         : " << q3 << std::endl;
             std::cout << "Maximum(sec)    : " << max << std::endl;
+            bench->report(true);
         }
     }
     margo_addr_free(mid, server_addr);
     margo_finalize(mid);
 }
-static sdskv_db_type_t database_type_from_string(const std::string& type)
-{
-    if (type == "null") {
-        return KVDB_NULL;
-    } else if (type == "map") {
-        return KVDB_MAP;
-    } else if (type == "leveldb" || type == "ldb") {
-        return KVDB_LEVELDB;
-    } else if (type == "berkeleydb" || type == "bdb") {
-        return KVDB_BERKELEYDB;
-    }
-    throw std::runtime_error(std::string("Unknown database type \"") + type
-                             + "\"");
-}
-
-static void parse_extra_cmd_arg(Json::Value& config, const char* arg)
-{
-    // find first instance of a point
-    const char* period = strchr(arg, '.');
-    // period found, call recursively
-    if (period != NULL) {
-        std::string key(arg, (size_t)(period - arg));
-        parse_extra_cmd_arg(config[key], period + 1);
-        return;
-    }
-    // period not found, search for equal sign
-    const char* equal = strchr(arg, '=');
-    if (!equal) throw std::runtime_error("Syntax error in command line");
-    std::string key = std::string(arg, (size_t)(equal - arg));
-    std::string val = std::string(equal + 1);
-    if (val[0] == '"' && val[val.size() - 1] == '"') {
-        config[key] = val.substr(1, val.size() - 2);
-    } else if (val == "true") {
-        config[key] = true;
-    } else if (val == "false") {
-        config[key] = false;
-    } else {
-        bool is_number = true;
-        for (auto& c : val) {
-            if (c < '0' || c > '9') {
-                is_number = false;
-                break;
-            }
-        }
-        if (is_number) {
-            config[key] = atoi(val.c_str());
-        } else {
-            config[key] = val;
-        }
-    }
-}
@@ -1,6 +1,9 @@
 #include <stdlib.h>
+#include <string.h>
 #include "sdskv-client.h"
 #include "sdskv-rpc-types.h"
+#include "sdskv-local.h"
+#include "sdskv-trace.h"
 
 #define MAX_RPC_MESSAGE_SIZE 4000 // in bytes
 
@@ -24,20 +27,82 @@ struct sdskv_client {
     hg_id_t sdskv_exists_multi_id;
     hg_id_t sdskv_erase_id;
     hg_id_t sdskv_erase_multi_id;
+    hg_id_t sdskv_erase_range_id;
+    hg_id_t sdskv_erase_prefix_id;
+    hg_id_t sdskv_cas_id;
+    hg_id_t sdskv_cas_packed_id;
+    hg_id_t sdskv_fetch_add_id;
+    hg_id_t sdskv_fetch_add_packed_id;
+    hg_id_t sdskv_append_id;
+    hg_id_t sdskv_append_packed_id;
     hg_id_t sdskv_length_id;
     hg_id_t sdskv_length_multi_id;
     hg_id_t sdskv_length_packed_id;
     hg_id_t sdskv_bulk_get_id;
     hg_id_t sdskv_list_keys_id;
     hg_id_t sdskv_list_keyvals_id;
+    hg_id_t sdskv_sync_id;
+    hg_id_t sdskv_batch_id;
+    hg_id_t sdskv_put_packed_multi_db_id;
+    hg_id_t sdskv_get_packed_multi_db_id;
+    hg_id_t sdskv_exists_packed_multi_db_id;
     /* migration */
     hg_id_t sdskv_migrate_keys_id;
     hg_id_t sdskv_migrate_key_range_id;
     hg_id_t sdskv_migrate_keys_prefixed_id;
     hg_id_t sdskv_migrate_all_keys_id;
     hg_id_t sdskv_migrate_database_id;
+    /* monitoring */
+    hg_id_t sdskv_get_stats_id;
+    hg_id_t sdskv_get_trace_id;
+    hg_id_t sdskv_get_slow_ops_id;
+    /* "_traced" variants (see SDSKV_TRACED_RPC_ID) */
+    hg_id_t sdskv_open_traced_id;
+    hg_id_t sdskv_count_databases_traced_id;
+    hg_id_t sdskv_list_databases_traced_id;
+    hg_id_t sdskv_put_traced_id;
+    hg_id_t sdskv_put_multi_traced_id;
+    hg_id_t sdskv_put_packed_traced_id;
+    hg_id_t sdskv_bulk_put_traced_id;
+    hg_id_t sdskv_get_traced_id;
+    hg_id_t sdskv_get_multi_traced_id;
+    hg_id_t sdskv_get_packed_traced_id;
+    hg_id_t sdskv_length_traced_id;
+    hg_id_t sdskv_length_multi_traced_id;
+    hg_id_t sdskv_length_packed_traced_id;
+    hg_id_t sdskv_exists_traced_id;
+    hg_id_t sdskv_exists_multi_traced_id;
+    hg_id_t sdskv_bulk_get_traced_id;
+    hg_id_t sdskv_list_keys_traced_id;
+    hg_id_t sdskv_list_keyvals_traced_id;
+    hg_id_t sdskv_sync_traced_id;
+    hg_id_t sdskv_batch_traced_id;
+    hg_id_t sdskv_put_packed_multi_db_traced_id;
+    hg_id_t sdskv_get_packed_multi_db_traced_id;
+    hg_id_t sdskv_exists_packed_multi_db_traced_id;
+    hg_id_t sdskv_erase_traced_id;
+    hg_id_t sdskv_erase_multi_traced_id;
+    hg_id_t sdskv_erase_range_traced_id;
+    hg_id_t sdskv_erase_prefix_traced_id;
+    hg_id_t sdskv_cas_traced_id;
+    hg_id_t sdskv_cas_packed_traced_id;
+    hg_id_t sdskv_fetch_add_traced_id;
+    hg_id_t sdskv_fetch_add_packed_traced_id;
+    hg_id_t sdskv_append_traced_id;
+    hg_id_t sdskv_append_packed_traced_id;
+    hg_id_t sdskv_migrate_keys_traced_id;
+    hg_id_t sdskv_migrate_key_range_traced_id;
+    hg_id_t sdskv_migrate_keys_prefixed_traced_id;
+    hg_id_t sdskv_migrate_all_keys_traced_id;
+    hg_id_t sdskv_migrate_database_traced_id;
+    hg_id_t sdskv_get_stats_traced_id;
+    hg_id_t sdskv_get_trace_traced_id;
+    hg_id_t sdskv_get_slow_ops_traced_id;
 
     uint64_t num_provider_handles;
+    /* tracing (see sdskv_client_enable_tracing) */
+    uint64_t       next_request_id;
+    sdskv_trace_t* trace;
 };
 
 struct sdskv_provider_handle {
@@ -45,8 +110,27 @@ struct sdskv_provider_handle {
     hg_addr_t      addr;
     uint16_t       provider_id;
     uint64_t       refcount;
+    hg_bool_t      is_local; /* addr is the client's own address */
 };
 
+/* returns the entry points of the provider if it lives in the same margo
+ * instance as the client, NULL otherwise (see sdskv-local.h) */
+static const sdskv_local_ops_t*
+sdskv_local_ops(sdskv_provider_handle_t provider)
+{
+    hg_id_t   id;
+    hg_bool_t flag = HG_FALSE;
+    if (!provider->is_local) return NULL;
+    if (margo_provider_registered_name(provider->client->mid,
+                                       SDSKV_LOCAL_RPC_NAME,
+                                       provider->provider_id, &id, &flag)
+            != HG_SUCCESS
+        || !flag)
+        return NULL;
+    return (const sdskv_local_ops_t*)margo_registered_data(
+        provider->client->mid, id);
+}
+
 static int sdskv_client_register(sdskv_client_t client, margo_instance_id mid)
 {
     client->mid      = mid;
@@ -83,6 +167,22 @@ static int sdskv_client_register(sdskv_client_t client, margo_instance_id mid)
                               &flag);
         margo_registered_name(mid, "sdskv_erase_multi_rpc",
                               &client->sdskv_erase_multi_id, &flag);
+        margo_registered_name(mid, "sdskv_erase_range_rpc",
+                              &client->sdskv_erase_range_id, &flag);
+        margo_registered_name(mid, "sdskv_erase_prefix_rpc",
+                              &client->sdskv_erase_prefix_id, &flag);
+        margo_registered_name(mid, "sdskv_cas_rpc", &client->sdskv_cas_id,
+                              &flag);
+        margo_registered_name(mid, "sdskv_cas_packed_rpc",
+                              &client->sdskv_cas_packed_id, &flag);
+        margo_registered_name(mid, "sdskv_fetch_add_rpc",
+                              &client->sdskv_fetch_add_id, &flag);
+        margo_registered_name(mid, "sdskv_fetch_add_packed_rpc",
+                              &client->sdskv_fetch_add_packed_id, &flag);
+        margo_registered_name(mid, "sdskv_append_rpc",
+                              &client->sdskv_append_id, &flag);
+        margo_registered_name(mid, "sdskv_append_packed_rpc",
+                              &client->sdskv_append_packed_id, &flag);
         margo_registered_name(mid, "sdskv_exists_rpc", &client->sdskv_exists_id,
                               &flag);
         margo_registered_name(mid, "sdskv_exists_multi_rpc",
@@ -99,6 +199,16 @@ static int sdskv_client_register(sdskv_client_t client, margo_instance_id mid)
                               &client->sdskv_list_keys_id, &flag);
         margo_registered_name(mid, "sdskv_list_keyvals_rpc",
                               &client->sdskv_list_keyvals_id, &flag);
+        margo_registered_name(mid, "sdskv_sync_rpc", &client->sdskv_sync_id,
+                              &flag);
+        margo_registered_name(mid, "sdskv_batch_rpc", &client->sdskv_batch_id,
+                              &flag);
+        margo_registered_name(mid, "sdskv_put_packed_multi_db_rpc",
+                              &client->sdskv_put_packed_multi_db_id, &flag);
+        margo_registered_name(mid, "sdskv_get_packed_multi_db_rpc",
+                              &client->sdskv_get_packed_multi_db_id, &flag);
+        margo_registered_name(mid, "sdskv_exists_packed_multi_db_rpc",
+                              &client->sdskv_exists_packed_multi_db_id, &flag);
         margo_registered_name(mid, "sdskv_migrate_keys_rpc",
                               &client->sdskv_migrate_keys_id, &flag);
         margo_registered_name(mid, "sdskv_migrate_key_range_rpc",
@@ -109,6 +219,99 @@ static int sdskv_client_register(sdskv_client_t client, margo_instance_id mid)
                               &client->sdskv_migrate_all_keys_id, &flag);
         margo_registered_name(mid, "sdskv_migrate_database_rpc",
                               &client->sdskv_migrate_database_id, &flag);
+        margo_registered_name(mid, "sdskv_get_stats_rpc",
+                              &client->sdskv_get_stats_id, &flag);
+        margo_registered_name(mid, "sdskv_get_trace_rpc",
+                              &client->sdskv_get_trace_id, &flag);
+        margo_registered_name(mid, "sdskv_get_slow_ops_rpc",
+                              &client->sdskv_get_slow_ops_id, &flag);
+        margo_registered_name(mid, "sdskv_open_traced_rpc",
+                              &client->sdskv_open_traced_id, &flag);
+        margo_registered_name(mid, "sdskv_count_databases_traced_rpc",
+                              &client->sdskv_count_databases_traced_id, &flag);
+        margo_registered_name(mid, "sdskv_list_databases_traced_rpc",
+                              &client->sdskv_list_databases_traced_id, &flag);
+        margo_registered_name(mid, "sdskv_put_traced_rpc",
+                              &client->sdskv_put_traced_id, &flag);
+        margo_registered_name(mid, "sdskv_put_multi_traced_rpc",
+                              &client->sdskv_put_multi_traced_id, &flag);
+        margo_registered_name(mid, "sdskv_put_packed_traced_rpc",
+                              &client->sdskv_put_packed_traced_id, &flag);
+        margo_registered_name(mid, "sdskv_bulk_put_traced_rpc",
+                              &client->sdskv_bulk_put_traced_id, &flag);
+        margo_registered_name(mid, "sdskv_get_traced_rpc",
+                              &client->sdskv_get_traced_id, &flag);
+        margo_registered_name(mid, "sdskv_get_multi_traced_rpc",
+                              &client->sdskv_get_multi_traced_id, &flag);
+        margo_registered_name(mid, "sdskv_get_packed_traced_rpc",
+                              &client->sdskv_get_packed_traced_id, &flag);
+        margo_registered_name(mid, "sdskv_length_traced_rpc",
+                              &client->sdskv_length_traced_id, &flag);
+        margo_registered_name(mid, "sdskv_length_multi_traced_rpc",
+                              &client->sdskv_length_multi_traced_id, &flag);
+        margo_registered_name(mid, "sdskv_length_packed_traced_rpc",
+                              &client->sdskv_length_packed_traced_id, &flag);
+        margo_registered_name(mid, "sdskv_exists_traced_rpc",
+                              &client->sdskv_exists_traced_id, &flag);
+        margo_registered_name(mid, "sdskv_exists_multi_traced_rpc",
+                              &client->sdskv_exists_multi_traced_id, &flag);
+        margo_registered_name(mid, "sdskv_bulk_get_traced_rpc",
+                              &client->sdskv_bulk_get_traced_id, &flag);
+        margo_registered_name(mid, "sdskv_list_keys_traced_rpc",
+                              &client->sdskv_list_keys_traced_id, &flag);
+        margo_registered_name(mid, "sdskv_list_keyvals_traced_rpc",
+                              &client->sdskv_list_keyvals_traced_id, &flag);
+        margo_registered_name(mid, "sdskv_sync_traced_rpc",
+                              &client->sdskv_sync_traced_id, &flag);
+        margo_registered_name(mid, "sdskv_batch_traced_rpc",
+                              &client->sdskv_batch_traced_id, &flag);
+        margo_registered_name(mid, "sdskv_put_packed_multi_db_traced_rpc",
+                              &client->sdskv_put_packed_multi_db_traced_id,
+                              &flag);
+        margo_registered_name(mid, "sdskv_get_packed_multi_db_traced_rpc",
+                              &client->sdskv_get_packed_multi_db_traced_id,
+                              &flag);
+        margo_registered_name(mid, "sdskv_exists_packed_multi_db_traced_rpc",
+                              &client->sdskv_exists_packed_multi_db_traced_id,
+                              &flag);
+        margo_registered_name(mid, "sdskv_erase_traced_rpc",
+                              &client->sdskv_erase_traced_id, &flag);
+        margo_registered_name(mid, "sdskv_erase_multi_traced_rpc",
+                              &client->sdskv_erase_multi_traced_id, &flag);
+        margo_registered_name(mid, "sdskv_erase_range_traced_rpc",
+                              &client->sdskv_erase_range_traced_id, &flag);
+        margo_registered_name(mid, "sdskv_erase_prefix_traced_rpc",
+                              &client->sdskv_erase_prefix_traced_id, &flag);
+        margo_registered_name(mid, "sdskv_cas_traced_rpc",
+                              &client->sdskv_cas_traced_id, &flag);
+        margo_registered_name(mid, "sdskv_cas_packed_traced_rpc",
+                              &client->sdskv_cas_packed_traced_id, &flag);
+        margo_registered_name(mid, "sdskv_fetch_add_traced_rpc",
+                              &client->sdskv_fetch_add_traced_id, &flag);
+        margo_registered_name(mid, "sdskv_fetch_add_packed_traced_rpc",
+                              &client->sdskv_fetch_add_packed_traced_id, &flag);
+        margo_registered_name(mid, "sdskv_append_traced_rpc",
+                              &client->sdskv_append_traced_id, &flag);
+        margo_registered_name(mid, "sdskv_append_packed_traced_rpc",
+                              &client->sdskv_append_packed_traced_id, &flag);
+        margo_registered_name(mid, "sdskv_migrate_keys_traced_rpc",
+                              &client->sdskv_migrate_keys_traced_id, &flag);
+        margo_registered_name(mid, "sdskv_migrate_key_range_traced_rpc",
+                              &client->sdskv_migrate_key_range_traced_id,
+                              &flag);
+        margo_registered_name(mid, "sdskv_migrate_keys_prefixed_traced_rpc",
+                              &client->sdskv_migrate_keys_prefixed_traced_id,
+                              &flag);
+        margo_registered_name(mid, "sdskv_migrate_all_keys_traced_rpc",
+                              &client->sdskv_migrate_all_keys_traced_id, &flag);
+        margo_registered_name(mid, "sdskv_migrate_database_traced_rpc",
+                              &client->sdskv_migrate_database_traced_id, &flag);
+        margo_registered_name(mid, "sdskv_get_stats_traced_rpc",
+                              &client->sdskv_get_stats_traced_id, &flag);
+        margo_registered_name(mid, "sdskv_get_trace_traced_rpc",
+                              &client->sdskv_get_trace_traced_id, &flag);
+        margo_registered_name(mid, "sdskv_get_slow_ops_traced_rpc",
+                              &client->sdskv_get_slow_ops_traced_id, &flag);
 
     } else {
 
@@ -139,6 +342,28 @@ static int sdskv_client_register(sdskv_client_t client, margo_instance_id mid)
         client->sdskv_erase_multi_id
             = MARGO_REGISTER(mid, "sdskv_erase_multi_rpc", erase_multi_in_t,
                              erase_multi_out_t, NULL);
+        client->sdskv_erase_range_id
+            = MARGO_REGISTER(mid, "sdskv_erase_range_rpc", erase_range_in_t,
+                             erase_range_out_t, NULL);
+        client->sdskv_erase_prefix_id
+            = MARGO_REGISTER(mid, "sdskv_erase_prefix_rpc", erase_prefix_in_t,
+                             erase_prefix_out_t, NULL);
+        client->sdskv_cas_id
+            = MARGO_REGISTER(mid, "sdskv_cas_rpc", cas_in_t, cas_out_t, NULL);
+        client->sdskv_cas_packed_id
+            = MARGO_REGISTER(mid, "sdskv_cas_packed_rpc", cas_packed_in_t,
+                             cas_packed_out_t, NULL);
+        client->sdskv_fetch_add_id = MARGO_REGISTER(
+            mid, "sdskv_fetch_add_rpc", fetch_add_in_t, fetch_add_out_t, NULL);
+        client->sdskv_fetch_add_packed_id
+            = MARGO_REGISTER(mid, "sdskv_fetch_add_packed_rpc",
+                             fetch_add_packed_in_t, fetch_add_packed_out_t,
+                             NULL);
+        client->sdskv_append_id = MARGO_REGISTER(
+            mid, "sdskv_append_rpc", append_in_t, append_out_t, NULL);
+        client->sdskv_append_packed_id
+            = MARGO_REGISTER(mid, "sdskv_append_packed_rpc", append_packed_in_t,
+                             append_packed_out_t, NULL);
         client->sdskv_exists_id = MARGO_REGISTER(
             mid, "sdskv_exists_rpc", exists_in_t, exists_out_t, NULL);
         client->sdskv_exists_multi_id
@@ -159,6 +384,19 @@ static int sdskv_client_register(sdskv_client_t client, margo_instance_id mid)
         client->sdskv_list_keyvals_id
             = MARGO_REGISTER(mid, "sdskv_list_keyvals_rpc", list_keyvals_in_t,
                              list_keyvals_out_t, NULL);
+        client->sdskv_sync_id
+            = MARGO_REGISTER(mid, "sdskv_sync_rpc", sync_in_t, sync_out_t, NULL);
+        client->sdskv_batch_id = MARGO_REGISTER(mid, "sdskv_batch_rpc",
+                                                batch_in_t, batch_out_t, NULL);
+        client->sdskv_put_packed_multi_db_id = MARGO_REGISTER(
+            mid, "sdskv_put_packed_multi_db_rpc", put_packed_multi_db_in_t,
+            put_packed_multi_db_out_t, NULL);
+        client->sdskv_get_packed_multi_db_id = MARGO_REGISTER(
+            mid, "sdskv_get_packed_multi_db_rpc", get_packed_multi_db_in_t,
+            get_packed_multi_db_out_t, NULL);
+        client->sdskv_exists_packed_multi_db_id = MARGO_REGISTER(
+            mid, "sdskv_exists_packed_multi_db_rpc",
+            exists_packed_multi_db_in_t, exists_packed_multi_db_out_t, NULL);
         client->sdskv_migrate_keys_id
             = MARGO_REGISTER(mid, "sdskv_migrate_keys_rpc", migrate_keys_in_t,
                              migrate_keys_out_t, NULL);
@@ -174,6 +412,136 @@ static int sdskv_client_register(sdskv_client_t client, margo_instance_id mid)
         client->sdskv_migrate_database_id = MARGO_REGISTER(
             mid, "sdskv_migrate_database_rpc", migrate_database_in_t,
             migrate_database_out_t, NULL);
+        client->sdskv_get_stats_id = MARGO_REGISTER(
+            mid, "sdskv_get_stats_rpc", void, get_stats_out_t, NULL);
+        client->sdskv_get_trace_id = MARGO_REGISTER(
+            mid, "sdskv_get_trace_rpc", void, get_trace_out_t, NULL);
+        client->sdskv_get_slow_ops_id = MARGO_REGISTER(
+            mid, "sdskv_get_slow_ops_rpc", void, get_slow_ops_out_t, NULL);
+        client->sdskv_open_traced_id
+            = MARGO_REGISTER(mid, "sdskv_open_traced_rpc", traced_open_in_t,
+                             open_out_t, NULL);
+        client->sdskv_count_databases_traced_id
+            = MARGO_REGISTER(mid, "sdskv_count_databases_traced_rpc",
+                             traced_void_in_t, count_db_out_t, NULL);
+        client->sdskv_list_databases_traced_id
+            = MARGO_REGISTER(mid, "sdskv_list_databases_traced_rpc",
+                             traced_list_db_in_t, list_db_out_t, NULL);
+        client->sdskv_put_traced_id
+            = MARGO_REGISTER(mid, "sdskv_put_traced_rpc", traced_put_in_t,
+                             put_out_t, NULL);
+        client->sdskv_put_multi_traced_id
+            = MARGO_REGISTER(mid, "sdskv_put_multi_traced_rpc",
+                             traced_put_multi_in_t, put_multi_out_t, NULL);
+        client->sdskv_put_packed_traced_id
+            = MARGO_REGISTER(mid, "sdskv_put_packed_traced_rpc",
+                             traced_put_packed_in_t, put_packed_out_t, NULL);
+        client->sdskv_bulk_put_traced_id
+            = MARGO_REGISTER(mid, "sdskv_bulk_put_traced_rpc",
+                             traced_bulk_put_in_t, bulk_put_out_t, NULL);
+        client->sdskv_get_traced_id
+            = MARGO_REGISTER(mid, "sdskv_get_traced_rpc", traced_get_in_t,
+                             get_out_t, NULL);
+        client->sdskv_get_multi_traced_id
+            = MARGO_REGISTER(mid, "sdskv_get_multi_traced_rpc",
+                             traced_get_multi_in_t, get_multi_out_t, NULL);
+        client->sdskv_get_packed_traced_id
+            = MARGO_REGISTER(mid, "sdskv_get_packed_traced_rpc",
+                             traced_get_packed_in_t, get_packed_out_t, NULL);
+        client->sdskv_length_traced_id
+            = MARGO_REGISTER(mid, "sdskv_length_traced_rpc", traced_length_in_t,
+                             length_out_t, NULL);
+        client->sdskv_length_multi_traced_id = MARGO_REGISTER(
+            mid, "sdskv_length_multi_traced_rpc", traced_length_multi_in_t,
+            length_multi_out_t, NULL);
+        client->sdskv_length_packed_traced_id = MARGO_REGISTER(
+            mid, "sdskv_length_packed_traced_rpc", traced_length_packed_in_t,
+            length_packed_out_t, NULL);
+        client->sdskv_exists_traced_id
+            = MARGO_REGISTER(mid, "sdskv_exists_traced_rpc", traced_exists_in_t,
+                             exists_out_t, NULL);
+        client->sdskv_exists_multi_traced_id = MARGO_REGISTER(
+            mid, "sdskv_exists_multi_traced_rpc", traced_exists_multi_in_t,
+            exists_multi_out_t, NULL);
+        client->sdskv_bulk_get_traced_id
+            = MARGO_REGISTER(mid, "sdskv_bulk_get_traced_rpc",
+                             traced_bulk_get_in_t, bulk_get_out_t, NULL);
+        client->sdskv_list_keys_traced_id
+            = MARGO_REGISTER(mid, "sdskv_list_keys_traced_rpc",
+                             traced_list_keys_in_t, list_keys_out_t, NULL);
+        client->sdskv_list_keyvals_traced_id = MARGO_REGISTER(
+            mid, "sdskv_list_keyvals_traced_rpc", traced_list_keyvals_in_t,
+            list_keyvals_out_t, NULL);
+        client->sdskv_sync_traced_id
+            = MARGO_REGISTER(mid, "sdskv_sync_traced_rpc", traced_sync_in_t,
+                             sync_out_t, NULL);
+        client->sdskv_batch_traced_id
+            = MARGO_REGISTER(mid, "sdskv_batch_traced_rpc", traced_batch_in_t,
+                             batch_out_t, NULL);
+        client->sdskv_put_packed_multi_db_traced_id = MARGO_REGISTER(
+            mid, "sdskv_put_packed_multi_db_traced_rpc",
+            traced_put_packed_multi_db_in_t, put_packed_multi_db_out_t, NULL);
+        client->sdskv_get_packed_multi_db_traced_id = MARGO_REGISTER(
+            mid, "sdskv_get_packed_multi_db_traced_rpc",
+            traced_get_packed_multi_db_in_t, get_packed_multi_db_out_t, NULL);
+        client->sdskv_exists_packed_multi_db_traced_id = MARGO_REGISTER(
+            mid, "sdskv_exists_packed_multi_db_traced_rpc",
+            traced_exists_packed_multi_db_in_t, exists_packed_multi_db_out_t,
+            NULL);
+        client->sdskv_erase_traced_id
+            = MARGO_REGISTER(mid, "sdskv_erase_traced_rpc", traced_erase_in_t,
+                             erase_out_t, NULL);
+        client->sdskv_erase_multi_traced_id
+            = MARGO_REGISTER(mid, "sdskv_erase_multi_traced_rpc",
+                             traced_erase_multi_in_t, erase_multi_out_t, NULL);
+        client->sdskv_erase_range_traced_id
+            = MARGO_REGISTER(mid, "sdskv_erase_range_traced_rpc",
+                             traced_erase_range_in_t, erase_range_out_t, NULL);
+        client->sdskv_erase_prefix_traced_id = MARGO_REGISTER(
+            mid, "sdskv_erase_prefix_traced_rpc", traced_erase_prefix_in_t,
+            erase_prefix_out_t, NULL);
+        client->sdskv_cas_traced_id
+            = MARGO_REGISTER(mid, "sdskv_cas_traced_rpc", traced_cas_in_t,
+                             cas_out_t, NULL);
+        client->sdskv_cas_packed_traced_id
+            = MARGO_REGISTER(mid, "sdskv_cas_packed_traced_rpc",
+                             traced_cas_packed_in_t, cas_packed_out_t, NULL);
+        client->sdskv_fetch_add_traced_id
+            = MARGO_REGISTER(mid, "sdskv_fetch_add_traced_rpc",
+                             traced_fetch_add_in_t, fetch_add_out_t, NULL);
+        client->sdskv_fetch_add_packed_traced_id = MARGO_REGISTER(
+            mid, "sdskv_fetch_add_packed_traced_rpc",
+            traced_fetch_add_packed_in_t, fetch_add_packed_out_t, NULL);
+        client->sdskv_append_traced_id
+            = MARGO_REGISTER(mid, "sdskv_append_traced_rpc", traced_append_in_t,
+                             append_out_t, NULL);
+        client->sdskv_append_packed_traced_id = MARGO_REGISTER(
+            mid, "sdskv_append_packed_traced_rpc", traced_append_packed_in_t,
+            append_packed_out_t, NULL);
+        client->sdskv_migrate_keys_traced_id = MARGO_REGISTER(
+            mid, "sdskv_migrate_keys_traced_rpc", traced_migrate_keys_in_t,
+            migrate_keys_out_t, NULL);
+        client->sdskv_migrate_key_range_traced_id = MARGO_REGISTER(
+            mid, "sdskv_migrate_key_range_traced_rpc",
+            traced_migrate_key_range_in_t, migrate_keys_out_t, NULL);
+        client->sdskv_migrate_keys_prefixed_traced_id = MARGO_REGISTER(
+            mid, "sdskv_migrate_keys_prefixed_traced_rpc",
+            traced_migrate_keys_prefixed_in_t, migrate_keys_out_t, NULL);
+        client->sdskv_migrate_all_keys_traced_id = MARGO_REGISTER(
+            mid, "sdskv_migrate_all_keys_traced_rpc",
+            traced_migrate_all_keys_in_t, migrate_keys_out_t, NULL);
+        client->sdskv_migrate_database_traced_id = MARGO_REGISTER(
+            mid, "sdskv_migrate_database_traced_rpc",
+            traced_migrate_database_in_t, migrate_database_out_t, NULL);
+        client->sdskv_get_stats_traced_id
+            = MARGO_REGISTER(mid, "sdskv_get_stats_traced_rpc",
+                             traced_void_in_t, get_stats_out_t, NULL);
+        client->sdskv_get_trace_traced_id
+            = MARGO_REGISTER(mid, "sdskv_get_trace_traced_rpc",
+                             traced_void_in_t, get_trace_out_t, NULL);
+        client->sdskv_get_slow_ops_traced_id
+            = MARGO_REGISTER(mid, "sdskv_get_slow_ops_traced_rpc",
+                             traced_void_in_t, get_slow_ops_out_t, NULL);
     }
 
     return SDSKV_SUCCESS;
@@ -185,6 +553,14 @@ int sdskv_client_init(margo_instance_id mid, sdskv_client_t* client)
     if (!c) return SDSKV_ERR_ALLOCATION;
 
     c->num_provider_handles = 0;
+    /* request ids of different clients should not collide: start from a
+     * random point, leaving the top bit for ids generated by providers */
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    c->next_request_id
+        = sdskv_trace_hash(((uint64_t)getpid() << 32) ^ (uint64_t)tv.tv_sec
+                           ^ ((uint64_t)tv.tv_usec << 20) ^ (uintptr_t)c)
+        >> 1;
 
     int ret = sdskv_client_register(c, mid);
     if (ret != 0) return ret;
@@ -201,10 +577,73 @@ int sdskv_client_finalize(sdskv_client_t client)
                 "sdskv_client_finalize was called\n",
                 client->num_provider_handles);
     }
+    sdskv_trace_free(client->trace);
     free(client);
     return SDSKV_SUCCESS;
 }
 
+int sdskv_client_enable_tracing(sdskv_client_t client,
+                                double         sample_rate,
+                                size_t         buffer_size)
+{
+    if (sample_rate < 0.0 || sample_rate > 1.0) return SDSKV_ERR_INVALID_ARG;
+    sdskv_trace_free(client->trace);
+    client->trace = sdskv_trace_create(sample_rate, buffer_size, 1000);
+    if (sample_rate > 0.0 && buffer_size > 0 && !client->trace)
+        return SDSKV_ERR_ALLOCATION;
+    return SDSKV_SUCCESS;
+}
+
+int sdskv_client_get_trace(sdskv_client_t client, char** trace)
+{
+    *trace = sdskv_trace_to_json(client->trace, "sdskv client");
+    return *trace ? SDSKV_SUCCESS : SDSKV_ERR_ALLOCATION;
+}
+
+/* id sent with the RPCs so that providers trace the same requests */
+static uint64_t sdskv_new_request_id(sdskv_client_t client)
+{
+    return __atomic_add_fetch(&client->next_request_id, 1, __ATOMIC_RELAXED);
+}
+
+/* records the span of a request, from start to now, if it is sampled;
+ * db_id is NULL for requests that are not about a single database */
+static void sdskv_client_trace(sdskv_client_t             client,
+                               const char*                name,
+                               uint64_t                   request_id,
+                               double                     start,
+                               const sdskv_database_id_t* db_id,
+                               hg_size_t                  size)
+{
+    if (!sdskv_trace_sampled(client->trace, request_id)) return;
+    sdskv_trace_event_t event
+        = {request_id, name, start, ABT_get_wtime(), -1, db_id != NULL,
+           db_id ? *db_id : 0, size};
+    sdskv_trace_record(client->trace, &event);
+}
+
+/* requests go through the "_traced" variant of their RPC (see
+ * traced_put_in_t) when the client traces requests, so that the regular
+ * RPCs keep their format */
+#define SDSKV_TRACED_RPC_ID(__client__, __rpc__, __traced__)  \
+    ((__traced__) ? (__client__)->sdskv_##__rpc__##_traced_id \
+                  : (__client__)->sdskv_##__rpc__##_id)
+
+#define SDSKV_TRACED_FORWARD(__provider__, __handle__, __type__, __in__,  \
+                             __trace_id__, __traced__)                   \
+    ((__traced__) ? margo_provider_forward(                               \
+         (__provider__)->provider_id, (__handle__),                       \
+         &(traced_##__type__){(__in__), (__trace_id__)})                  \
+                  : margo_provider_forward((__provider__)->provider_id,   \
+                                           (__handle__), &(__in__)))
+
+/* SDSKV_TRACED_FORWARD for the RPCs without input */
+#define SDSKV_TRACED_FORWARD_VOID(__provider__, __handle__, __trace_id__, \
+                                  __traced__)                            \
+    margo_provider_forward(                                               \
+        (__provider__)->provider_id, (__handle__),                        \
+        (__traced__) ? &(traced_void_in_t){(__trace_id__)} : NULL)
+
 margo_instance_id sdskv_client_get_mid(sdskv_client_t client)
 {
     return client->mid;
@@ -232,6 +671,12 @@ int sdskv_provider_handle_create(sdskv_client_t           client,
     provider->provider_id = provider_id;
     provider->refcount    = 1;
 
+    hg_addr_t self_addr = HG_ADDR_NULL;
+    if (margo_addr_self(client->mid, &self_addr) == HG_SUCCESS) {
+        provider->is_local = margo_addr_cmp(client->mid, self_addr, addr);
+        margo_addr_free(client->mid, self_addr);
+    }
+
     client->num_provider_handles += 1;
 
     *handle = provider;
@@ -284,14 +729,20 @@ int sdskv_open(sdskv_provider_handle_t provider,
     open_out_t  out;
     hg_handle_t handle;
 
+    int      traced      = provider->client->trace != NULL;
+    uint64_t trace_id    = sdskv_new_request_id(provider->client);
+    double   trace_start = ABT_get_wtime();
+
     /* create handle */
-    hret = margo_create(provider->client->mid, provider->addr,
-                        provider->client->sdskv_open_id, &handle);
+    hret = margo_create(
+        provider->client->mid, provider->addr,
+        SDSKV_TRACED_RPC_ID(provider->client, open, traced), &handle);
     if (hret != HG_SUCCESS) return SDSKV_MAKE_HG_ERROR(hret);
 
     in.name = (char*)db_name;
 
-    hret = margo_provider_forward(provider->provider_id, handle, &in);
+    hret = SDSKV_TRACED_FORWARD(provider, handle, open_in_t, in, trace_id,
+                                traced);
     if (hret != HG_SUCCESS) {
         margo_destroy(handle);
         return SDSKV_MAKE_HG_ERROR(hret);
@@ -306,6 +757,8 @@ int sdskv_open(sdskv_provider_handle_t provider,
     ret    = out.ret;
     *db_id = out.db_id;
 
+    sdskv_client_trace(provider->client, "sdskv_open", trace_id, trace_start,
+                       NULL, 0);
     margo_free_output(handle, &out);
     margo_destroy(handle);
 
@@ -319,12 +772,18 @@ int sdskv_count_databases(sdskv_provider_handle_t provider, size_t* num)
     count_db_out_t out;
     hg_handle_t    handle;
 
+    int      traced      = provider->client->trace != NULL;
+    uint64_t trace_id    = sdskv_new_request_id(provider->client);
+    double   trace_start = ABT_get_wtime();
+
     /* create handle */
-    hret = margo_create(provider->client->mid, provider->addr,
-                        provider->client->sdskv_count_databases_id, &handle);
+    hret = margo_create(
+        provider->client->mid, provider->addr,
+        SDSKV_TRACED_RPC_ID(provider->client, count_databases, traced),
+        &handle);
     if (hret != HG_SUCCESS) return SDSKV_MAKE_HG_ERROR(hret);
 
-    hret = margo_provider_forward(provider->provider_id, handle, NULL);
+    hret = SDSKV_TRACED_FORWARD_VOID(provider, handle, trace_id, traced);
     if (hret != HG_SUCCESS) {
         margo_destroy(handle);
         return SDSKV_MAKE_HG_ERROR(hret);
@@ -339,6 +798,137 @@ int sdskv_count_databases(sdskv_provider_handle_t provider, size_t* num)
     ret  = out.ret;
     *num = out.count;
 
+    sdskv_client_trace(provider->client, "sdskv_count_databases", trace_id,
+                       trace_start, NULL, 0);
+    margo_free_output(handle, &out);
+    margo_destroy(handle);
+
+    return ret;
+}
+
+int sdskv_get_stats(sdskv_provider_handle_t provider, char** stats)
+{
+    hg_return_t     hret;
+    int             ret;
+    get_stats_out_t out;
+    hg_handle_t     handle;
+
+    int      traced      = provider->client->trace != NULL;
+    uint64_t trace_id    = sdskv_new_request_id(provider->client);
+    double   trace_start = ABT_get_wtime();
+
+    /* create handle */
+    hret = margo_create(
+        provider->client->mid, provider->addr,
+        SDSKV_TRACED_RPC_ID(provider->client, get_stats, traced), &handle);
+    if (hret != HG_SUCCESS) return SDSKV_MAKE_HG_ERROR(hret);
+
+    hret = SDSKV_TRACED_FORWARD_VOID(provider, handle, trace_id, traced);
+    if (hret != HG_SUCCESS) {
+        margo_destroy(handle);
+        return SDSKV_MAKE_HG_ERROR(hret);
+    }
+
+    hret = margo_get_output(handle, &out);
+    if (hret != HG_SUCCESS) {
+        margo_destroy(handle);
+        return SDSKV_MAKE_HG_ERROR(hret);
+    }
+
+    ret = out.ret;
+    if (ret == SDSKV_SUCCESS) {
+        *stats = strdup(out.stats);
+        if (!*stats) ret = SDSKV_ERR_ALLOCATION;
+    }
+
+    sdskv_client_trace(provider->client, "sdskv_get_stats", trace_id,
+                       trace_start, NULL, 0);
+    margo_free_output(handle, &out);
+    margo_destroy(handle);
+
+    return ret;
+}
+
+int sdskv_get_trace(sdskv_provider_handle_t provider, char** trace)
+{
+    hg_return_t     hret;
+    int             ret;
+    get_trace_out_t out;
+    hg_handle_t     handle;
+
+    int      traced      = provider->client->trace != NULL;
+    uint64_t trace_id    = sdskv_new_request_id(provider->client);
+    double   trace_start = ABT_get_wtime();
+
+    /* create handle */
+    hret = margo_create(
+        provider->client->mid, provider->addr,
+        SDSKV_TRACED_RPC_ID(provider->client, get_trace, traced), &handle);
+    if (hret != HG_SUCCESS) return SDSKV_MAKE_HG_ERROR(hret);
+
+    hret = SDSKV_TRACED_FORWARD_VOID(provider, handle, trace_id, traced);
+    if (hret != HG_SUCCESS) {
+        margo_destroy(handle);
+        return SDSKV_MAKE_HG_ERROR(hret);
+    }
+
+    hret = margo_get_output(handle, &out);
+    if (hret != HG_SUCCESS) {
+        margo_destroy(handle);
+        return SDSKV_MAKE_HG_ERROR(hret);
+    }
+
+    ret = out.ret;
+    if (ret == SDSKV_SUCCESS) {
+        *trace = strdup(out.trace);
+        if (!*trace) ret = SDSKV_ERR_ALLOCATION;
+    }
+
+    sdskv_client_trace(provider->client, "sdskv_get_trace", trace_id,
+                       trace_start, NULL, 0);
+    margo_free_output(handle, &out);
+    margo_destroy(handle);
+
+    return ret;
+}
+
+int sdskv_get_slow_ops(sdskv_provider_handle_t provider, char** slow_ops)
+{
+    hg_return_t        hret;
+    int                ret;
+    get_slow_ops_out_t out;
+    hg_handle_t        handle;
+
+    int      traced      = provider->client->trace != NULL;
+    uint64_t trace_id    = sdskv_new_request_id(provider->client);
+    double   trace_start = ABT_get_wtime();
+
+    /* create handle */
+    hret = margo_create(
+        provider->client->mid, provider->addr,
+        SDSKV_TRACED_RPC_ID(provider->client, get_slow_ops, traced), &handle);
+    if (hret != HG_SUCCESS) return SDSKV_MAKE_HG_ERROR(hret);
+
+    hret = SDSKV_TRACED_FORWARD_VOID(provider, handle, trace_id, traced);
+    if (hret != HG_SUCCESS) {
+        margo_destroy(handle);
+        return SDSKV_MAKE_HG_ERROR(hret);
+    }
+
+    hret = margo_get_output(handle, &out);
+    if (hret != HG_SUCCESS) {
+        margo_destroy(handle);
+        return SDSKV_MAKE_HG_ERROR(hret);
+    }
+
+    ret = out.ret;
+    if (ret == SDSKV_SUCCESS) {
+        *slow_ops = strdup(out.slow_ops);
+        if (!*slow_ops) ret = SDSKV_ERR_ALLOCATION;
+    }
+
+    sdskv_client_trace(provider->client, "sdskv_get_slow_ops", trace_id,
+                       trace_start, NULL, 0);
     margo_free_output(handle, &out);
     margo_destroy(handle);
 
@@ -357,12 +947,18 @@ int sdskv_list_databases(sdskv_provider_handle_t provider,
     list_db_out_t out;
     hg_handle_t   handle;
 
+    int      traced      = provider->client->trace != NULL;
+    uint64_t trace_id    = sdskv_new_request_id(provider->client);
+    double   trace_start = ABT_get_wtime();
+
     /* create handle */
-    hret = margo_create(provider->client->mid, provider->addr,
-                        provider->client->sdskv_list_databases_id, &handle);
+    hret = margo_create(
+        provider->client->mid, provider->addr,
+        SDSKV_TRACED_RPC_ID(provider->client, list_databases, traced), &handle);
     if (hret != HG_SUCCESS) return SDSKV_MAKE_HG_ERROR(hret);
 
-    hret = margo_provider_forward(provider->provider_id, handle, &in);
+    hret = SDSKV_TRACED_FORWARD(provider, handle, list_db_in_t, in, trace_id,
+                                traced);
     if (hret != HG_SUCCESS) {
         margo_destroy(handle);
         return SDSKV_MAKE_HG_ERROR(hret);
@@ -386,6 +982,8 @@ int sdskv_list_databases(sdskv_provider_handle_t provider,
         *count = 0;
     }
 
+    sdskv_client_trace(provider->client, "sdskv_list_databases", trace_id,
+                       trace_start, NULL, 0);
     margo_free_output(handle, &out);
     margo_destroy(handle);
 
@@ -403,6 +1001,10 @@ int sdskv_put(sdskv_provider_handle_t provider,
     int         ret = SDSKV_SUCCESS;
     hg_handle_t handle;
 
+    const sdskv_local_ops_t* local = sdskv_local_ops(provider);
+    if (local)
+        return local->put(local->provider, db_id, key, ksize, value, vsize);
+
     hg_size_t msize = ksize + vsize + 2 * sizeof(hg_size_t);
 
     if (msize <= MAX_RPC_MESSAGE_SIZE) {
@@ -416,15 +1018,21 @@ int sdskv_put(sdskv_provider_handle_t provider,
         in.value.data = (kv_ptr_t)value;
         in.value.size = vsize;
 
+        int      traced      = provider->client->trace != NULL;
+        uint64_t trace_id    = sdskv_new_request_id(provider->client);
+        double   trace_start = ABT_get_wtime();
+
         /* create handle */
-        hret = margo_create(provider->client->mid, provider->addr,
-                            provider->client->sdskv_put_id, &handle);
+        hret = margo_create(
+            provider->client->mid, provider->addr,
+            SDSKV_TRACED_RPC_ID(provider->client, put, traced), &handle);
         if (hret != HG_SUCCESS) {
             fprintf(stderr, "[SDSKV] margo_create() failed in sdskv_put()\n");
             return SDSKV_MAKE_HG_ERROR(hret);
         }
 
-        hret = margo_provider_forward(provider->provider_id, handle, &in);
+        hret = SDSKV_TRACED_FORWARD(provider, handle, put_in_t, in, trace_id,
+                                    traced);
         if (hret != HG_SUCCESS) {
             fprintf(stderr, "[SDSKV] margo_forward() failed in sdskv_put()\n");
             margo_destroy(handle);
@@ -440,6 +1048,8 @@ int sdskv_put(sdskv_provider_handle_t provider,
         }
 
         ret = out.ret;
+        sdskv_client_trace(provider->client, "sdskv_put", trace_id,
+                           trace_start, &db_id, ksize + vsize);
 
         margo_free_output(handle, &out);
 
@@ -461,16 +1071,22 @@ int sdskv_put(sdskv_provider_handle_t provider,
             return SDSKV_MAKE_HG_ERROR(hret);
         }
 
+        int      traced      = provider->client->trace != NULL;
+        uint64_t trace_id    = sdskv_new_request_id(provider->client);
+        double   trace_start = ABT_get_wtime();
+
         /* create handle */
-        hret = margo_create(provider->client->mid, provider->addr,
-                            provider->client->sdskv_bulk_put_id, &handle);
+        hret = margo_create(
+            provider->client->mid, provider->addr,
+            SDSKV_TRACED_RPC_ID(provider->client, bulk_put, traced), &handle);
         if (hret != HG_SUCCESS) {
             fprintf(stderr, "[SDSKV] margo_create() failed in sdskv_put()\n");
             margo_bulk_free(in.handle);
             return SDSKV_MAKE_HG_ERROR(hret);
         }
 
-        hret = margo_provider_forward(provider->provider_id, handle, &in);
+        hret = SDSKV_TRACED_FORWARD(provider, handle, bulk_put_in_t, in,
+                                    trace_id, traced);
         if (hret != HG_SUCCESS) {
             fprintf(stderr, "[SDSKV] margo_forward() failed in sdskv_put()\n");
             margo_bulk_free(in.handle);
@@ -488,6 +1104,8 @@ int sdskv_put(sdskv_provider_handle_t provider,
         }
 
         ret = out.ret;
+        sdskv_client_trace(provider->client, "sdskv_put", trace_id, trace_start,
+                           &db_id, ksize + vsize);
         margo_free_output(handle, &out);
         margo_bulk_free(in.handle);
     }
@@ -514,6 +1132,11 @@ int sdskv_put_multi(sdskv_provider_handle_t provider,
     void**          val_seg_ptrs  = NULL;
     hg_size_t*      val_seg_sizes = NULL;
 
+    const sdskv_local_ops_t* local = sdskv_local_ops(provider);
+    if (local)
+        return local->put_multi(local->provider, db_id, num, keys, ksizes,
+                                values, vsizes);
+
     in.db_id            = db_id;
     in.num_keys         = num;
     in.keys_bulk_handle = HG_BULK_NULL;
@@ -521,6 +1144,10 @@ int sdskv_put_multi(sdskv_provider_handle_t provider,
     in.vals_bulk_handle = HG_BULK_NULL;
     in.vals_bulk_size   = 0;
 
+    int      traced      = provider->client->trace != NULL;
+    uint64_t trace_id    = sdskv_new_request_id(provider->client);
+    double   trace_start = ABT_get_wtime();
+
     /* check that none of the keys have a size of 0 */
     int i;
     for (i = 0; i < num; i++) {
@@ -588,8 +1215,9 @@ int sdskv_put_multi(sdskv_provider_handle_t provider,
     }
 
     /* create a RPC handle */
-    hret = margo_create(provider->client->mid, provider->addr,
-                        provider->client->sdskv_put_multi_id, &handle);
+    hret = margo_create(
+        provider->client->mid, provider->addr,
+        SDSKV_TRACED_RPC_ID(provider->client, put_multi, traced), &handle);
     if (hret != HG_SUCCESS) {
         fprintf(stderr, "[SDSKV] margo_create() failed in sdskv_put_multi()\n");
         out.ret = SDSKV_MAKE_HG_ERROR(hret);
@@ -597,7 +1225,8 @@ int sdskv_put_multi(sdskv_provider_handle_t provider,
     }
 
     /* forward the RPC */
-    hret = margo_provider_forward(provider->provider_id, handle, &in);
+    hret = SDSKV_TRACED_FORWARD(provider, handle, put_multi_in_t, in, trace_id,
+                                traced);
     if (hret != HG_SUCCESS) {
         fprintf(stderr,
                 "[SDSKV] margo_forward() failed in sdskv_put_multi()\n");
@@ -615,6 +1244,9 @@ int sdskv_put_multi(sdskv_provider_handle_t provider,
     }
 
     ret = out.ret;
+    sdskv_client_trace(provider->client, "sdskv_put_multi", trace_id,
+                       trace_start, &db_id,
+                       in.keys_bulk_size + in.vals_bulk_size);
 
 finish:
     margo_free_output(handle, &out);
@@ -640,6 +1272,11 @@ int sdskv_put_packed(sdskv_provider_handle_t provider,
     int         ret         = SDSKV_SUCCESS;
     hg_bulk_t   bulk_handle = HG_BULK_NULL;
 
+    const sdskv_local_ops_t* local = sdskv_local_ops(provider);
+    if (local)
+        return local->put_packed(local->provider, db_id, num, packed_keys,
+                                 ksizes, packed_values, vsizes);
+
     hg_size_t keys_buffer_size = 0;
     hg_size_t vals_buffer_size = 0;
     unsigned  i                = 0;
@@ -690,9 +1327,14 @@ int sdskv_proxy_put_packed(sdskv_provider_handle_t provider,
     in.bulk_handle = packed_data;
     in.bulk_size   = bulk_data_size;
 
+    int      traced      = provider->client->trace != NULL;
+    uint64_t trace_id    = sdskv_new_request_id(provider->client);
+    double   trace_start = ABT_get_wtime();
+
     /* create handle */
-    hret = margo_create(provider->client->mid, provider->addr,
-                        provider->client->sdskv_put_packed_id, &handle);
+    hret = margo_create(
+        provider->client->mid, provider->addr,
+        SDSKV_TRACED_RPC_ID(provider->client, put_packed, traced), &handle);
     if (hret != HG_SUCCESS) {
         fprintf(stderr,
                 "[SDSKV] margo_create() failed in sdskv_put_packed()\n");
@@ -700,7 +1342,8 @@ int sdskv_proxy_put_packed(sdskv_provider_handle_t provider,
         return SDSKV_MAKE_HG_ERROR(hret);
     }
 
-    hret = margo_provider_forward(provider->provider_id, handle, &in);
+    hret = SDSKV_TRACED_FORWARD(provider, handle, put_packed_in_t, in, trace_id,
+                                traced);
     if (hret != HG_SUCCESS) {
         fprintf(stderr,
                 "[SDSKV] margo_forward() failed in sdskv_put_packed()\n");
@@ -719,6 +1362,8 @@ int sdskv_proxy_put_packed(sdskv_provider_handle_t provider,
     }
 
     ret = out.ret;
+    sdskv_client_trace(provider->client, "sdskv_put_packed", trace_id,
+                       trace_start, &db_id, bulk_data_size);
     margo_free_output(handle, &out);
 
     margo_destroy(handle);
@@ -742,6 +1387,10 @@ int sdskv_get(sdskv_provider_handle_t provider,
         return sdskv_length(provider, db_id, key, ksize, vsize);
     }
 
+    const sdskv_local_ops_t* local = sdskv_local_ops(provider);
+    if (local)
+        return local->get(local->provider, db_id, key, ksize, value, vsize);
+
     size  = *(hg_size_t*)vsize;
     msize = size + sizeof(hg_size_t) + sizeof(hg_return_t);
 
@@ -755,12 +1404,18 @@ int sdskv_get(sdskv_provider_handle_t provider,
         in.key.size = ksize;
         in.vsize    = size;
 
+        int      traced      = provider->client->trace != NULL;
+        uint64_t trace_id    = sdskv_new_request_id(provider->client);
+        double   trace_start = ABT_get_wtime();
+
         /* create handle */
-        hret = margo_create(provider->client->mid, provider->addr,
-                            provider->client->sdskv_get_id, &handle);
+        hret = margo_create(
+            provider->client->mid, provider->addr,
+            SDSKV_TRACED_RPC_ID(provider->client, get, traced), &handle);
         if (hret != HG_SUCCESS) return SDSKV_MAKE_HG_ERROR(hret);
 
-        hret = margo_provider_forward(provider->provider_id, handle, &in);
+        hret = SDSKV_TRACED_FORWARD(provider, handle, get_in_t, in, trace_id,
+                                    traced);
         if (hret != HG_SUCCESS) {
             margo_destroy(handle);
             return SDSKV_MAKE_HG_ERROR(hret);
@@ -773,6 +1428,8 @@ int sdskv_get(sdskv_provider_handle_t provider,
         }
 
         ret = out.ret;
+        sdskv_client_trace(provider->client, "sdskv_get", trace_id,
+                           trace_start, &db_id, ksize + out.vsize);
 
         if (ret == SDSKV_SUCCESS) {
             *vsize = out.vsize;
@@ -799,15 +1456,21 @@ int sdskv_get(sdskv_provider_handle_t provider,
                                  HG_BULK_WRITE_ONLY, &in.handle);
         if (hret != HG_SUCCESS) return SDSKV_MAKE_HG_ERROR(hret);
 
+        int      traced      = provider->client->trace != NULL;
+        uint64_t trace_id    = sdskv_new_request_id(provider->client);
+        double   trace_start = ABT_get_wtime();
+
         /* create handle */
-        hret = margo_create(provider->client->mid, provider->addr,
-                            provider->client->sdskv_bulk_get_id, &handle);
+        hret = margo_create(
+            provider->client->mid, provider->addr,
+            SDSKV_TRACED_RPC_ID(provider->client, bulk_get, traced), &handle);
         if (hret != HG_SUCCESS) {
             margo_bulk_free(in.handle);
             return SDSKV_MAKE_HG_ERROR(hret);
         }
 
-        hret = margo_provider_forward(provider->provider_id, handle, &in);
+        hret = SDSKV_TRACED_FORWARD(provider, handle, bulk_get_in_t, in,
+                                    trace_id, traced);
         if (hret != HG_SUCCESS) {
             margo_bulk_free(in.handle);
             margo_destroy(handle);
@@ -824,6 +1487,8 @@ int sdskv_get(sdskv_provider_handle_t provider,
         ret    = out.ret;
         *vsize = out.vsize;
 
+        sdskv_client_trace(provider->client, "sdskv_get", trace_id, trace_start,
+                           &db_id, ksize + out.vsize);
         margo_free_output(handle, &out);
         margo_bulk_free(in.handle);
     }
@@ -868,6 +1533,11 @@ int sdskv_get_multi(sdskv_provider_handle_t provider,
         return sdskv_length_multi(provider, db_id, num, keys, ksizes, vsizes);
     }
 
+    const sdskv_local_ops_t* local = sdskv_local_ops(provider);
+    if (local)
+        return local->get_multi(local->provider, db_id, num, keys, ksizes,
+                                values, vsizes);
+
     in.db_id            = db_id;
     in.num_keys         = num;
     in.keys_bulk_handle = HG_BULK_NULL;
@@ -875,6 +1545,10 @@ int sdskv_get_multi(sdskv_provider_handle_t provider,
     in.vals_bulk_handle = HG_BULK_NULL;
     in.vals_bulk_size   = 0;
 
+    int      traced      = provider->client->trace != NULL;
+    uint64_t trace_id    = sdskv_new_request_id(provider->client);
+    double   trace_start = ABT_get_wtime();
+
     /* create an array of key sizes and key pointers */
     key_seg_sizes    = malloc(sizeof(hg_size_t) * (num + 1));
     key_seg_sizes[0] = num * sizeof(hg_size_t);
@@ -917,8 +1591,9 @@ int sdskv_get_multi(sdskv_provider_handle_t provider,
     }
 
     /* create a RPC handle */
-    hret = margo_create(provider->client->mid, provider->addr,
-                        provider->client->sdskv_get_multi_id, &handle);
+    hret = margo_create(
+        provider->client->mid, provider->addr,
+        SDSKV_TRACED_RPC_ID(provider->client, get_multi, traced), &handle);
     if (hret != HG_SUCCESS) {
         fprintf(stderr, "[SDSKV] margo_create() failed in sdskv_get_multi()\n");
         out.ret = SDSKV_MAKE_HG_ERROR(hret);
@@ -926,7 +1601,8 @@ int sdskv_get_multi(sdskv_provider_handle_t provider,
     }
 
     /* forward the RPC handle */
-    hret = margo_provider_forward(provider->provider_id, handle, &in);
+    hret = SDSKV_TRACED_FORWARD(provider, handle, get_multi_in_t, in, trace_id,
+                                traced);
     if (hret != HG_SUCCESS) {
         fprintf(stderr,
                 "[SDSKV] margo_forward() failed in sdskv_get_multi()\n");
@@ -944,6 +1620,9 @@ int sdskv_get_multi(sdskv_provider_handle_t provider,
     }
 
     ret = out.ret;
+    sdskv_client_trace(provider->client, "sdskv_get_multi", trace_id,
+                       trace_start, &db_id,
+                       in.keys_bulk_size + in.vals_bulk_size);
     if (out.ret != SDSKV_SUCCESS) { goto finish; }
 
     /* copy the values from the buffer into the user-provided buffer */
@@ -975,6 +1654,10 @@ int sdskv_exists(sdskv_provider_handle_t provider,
     int         ret;
     hg_handle_t handle;
 
+    const sdskv_local_ops_t* local = sdskv_local_ops(provider);
+    if (local)
+        return local->exists(local->provider, db_id, key, ksize, flag);
+
     exists_in_t  in;
     exists_out_t out;
 
@@ -982,12 +1665,18 @@ int sdskv_exists(sdskv_provider_handle_t provider,
     in.key.data = (kv_ptr_t)key;
     in.key.size = ksize;
 
+    int      traced      = provider->client->trace != NULL;
+    uint64_t trace_id    = sdskv_new_request_id(provider->client);
+    double   trace_start = ABT_get_wtime();
+
     /* create handle */
-    hret = margo_create(provider->client->mid, provider->addr,
-                        provider->client->sdskv_exists_id, &handle);
+    hret = margo_create(
+        provider->client->mid, provider->addr,
+        SDSKV_TRACED_RPC_ID(provider->client, exists, traced), &handle);
     if (hret != HG_SUCCESS) return SDSKV_MAKE_HG_ERROR(hret);
 
-    hret = margo_provider_forward(provider->provider_id, handle, &in);
+    hret = SDSKV_TRACED_FORWARD(provider, handle, exists_in_t, in, trace_id,
+                                traced);
     if (hret != HG_SUCCESS) {
         margo_destroy(handle);
         return SDSKV_MAKE_HG_ERROR(hret);
@@ -1002,6 +1691,8 @@ int sdskv_exists(sdskv_provider_handle_t provider,
     ret = out.ret;
     if (ret == 0) *flag = out.flag;
 
+    sdskv_client_trace(provider->client, "sdskv_exists", trace_id, trace_start,
+                       &db_id, ksize);
     margo_free_output(handle, &out);
     margo_destroy(handle);
     return ret;
@@ -1065,9 +1756,14 @@ int sdskv_exists_multi(sdskv_provider_handle_t provider,
         goto finish;
     }
 
+    int      traced      = provider->client->trace != NULL;
+    uint64_t trace_id    = sdskv_new_request_id(provider->client);
+    double   trace_start = ABT_get_wtime();
+
     /* create a RPC handle */
-    hret = margo_create(provider->client->mid, provider->addr,
-                        provider->client->sdskv_exists_multi_id, &handle);
+    hret = margo_create(
+        provider->client->mid, provider->addr,
+        SDSKV_TRACED_RPC_ID(provider->client, exists_multi, traced), &handle);
     if (hret != HG_SUCCESS) {
         fprintf(stderr,
                 "[SDSKV] margo_create() failed in sdskv_exists_multi()\n");
@@ -1076,7 +1772,8 @@ int sdskv_exists_multi(sdskv_provider_handle_t provider,
     }
 
     /* forward the RPC handle */
-    hret = margo_provider_forward(provider->provider_id, handle, &in);
+    hret = SDSKV_TRACED_FORWARD(provider, handle, exists_multi_in_t, in,
+                                trace_id, traced);
     if (hret != HG_SUCCESS) {
         fprintf(stderr,
                 "[SDSKV] margo_forward() failed in sdskv_exists_multi()\n");
@@ -1094,6 +1791,8 @@ int sdskv_exists_multi(sdskv_provider_handle_t provider,
     }
 
     ret = out.ret;
+    sdskv_client_trace(provider->client, "sdskv_exists_multi", trace_id,
+                       trace_start, &db_id, in.keys_bulk_size);
     if (out.ret != SDSKV_SUCCESS) { goto finish; }
 
     uint8_t mask = 1;
@@ -1128,6 +1827,10 @@ int sdskv_length(sdskv_provider_handle_t provider,
     int         ret;
     hg_handle_t handle;
 
+    const sdskv_local_ops_t* local = sdskv_local_ops(provider);
+    if (local)
+        return local->length(local->provider, db_id, key, ksize, vsize);
+
     length_in_t  in;
     length_out_t out;
 
@@ -1135,12 +1838,18 @@ int sdskv_length(sdskv_provider_handle_t provider,
     in.key.data = (kv_ptr_t)key;
     in.key.size = ksize;
 
+    int      traced      = provider->client->trace != NULL;
+    uint64_t trace_id    = sdskv_new_request_id(provider->client);
+    double   trace_start = ABT_get_wtime();
+
     /* create handle */
-    hret = margo_create(provider->client->mid, provider->addr,
-                        provider->client->sdskv_length_id, &handle);
+    hret = margo_create(
+        provider->client->mid, provider->addr,
+        SDSKV_TRACED_RPC_ID(provider->client, length, traced), &handle);
     if (hret != HG_SUCCESS) return SDSKV_MAKE_HG_ERROR(hret);
 
-    hret = margo_provider_forward(provider->provider_id, handle, &in);
+    hret = SDSKV_TRACED_FORWARD(provider, handle, length_in_t, in, trace_id,
+                                traced);
     if (hret != HG_SUCCESS) {
         margo_destroy(handle);
         return SDSKV_MAKE_HG_ERROR(hret);
@@ -1155,6 +1864,8 @@ int sdskv_length(sdskv_provider_handle_t provider,
     ret = out.ret;
     if (ret == 0) *vsize = out.size;
 
+    sdskv_client_trace(provider->client, "sdskv_length", trace_id, trace_start,
+                       &db_id, ksize);
     margo_free_output(handle, &out);
     margo_destroy(handle);
     return ret;
@@ -1217,9 +1928,14 @@ int sdskv_length_multi(sdskv_provider_handle_t provider,
         goto finish;
     }
 
+    int      traced      = provider->client->trace != NULL;
+    uint64_t trace_id    = sdskv_new_request_id(provider->client);
+    double   trace_start = ABT_get_wtime();
+
     /* create a RPC handle */
-    hret = margo_create(provider->client->mid, provider->addr,
-                        provider->client->sdskv_length_multi_id, &handle);
+    hret = margo_create(
+        provider->client->mid, provider->addr,
+        SDSKV_TRACED_RPC_ID(provider->client, length_multi, traced), &handle);
     if (hret != HG_SUCCESS) {
         fprintf(stderr,
                 "[SDSKV] margo_create() failed in sdskv_length_multi()\n");
@@ -1228,7 +1944,8 @@ int sdskv_length_multi(sdskv_provider_handle_t provider,
     }
 
     /* forward the RPC handle */
-    hret = margo_provider_forward(provider->provider_id, handle, &in);
+    hret = SDSKV_TRACED_FORWARD(provider, handle, length_multi_in_t, in,
+                                trace_id, traced);
     if (hret != HG_SUCCESS) {
         fprintf(stderr,
                 "[SDSKV] margo_forward() failed in sdskv_length_multi()\n");
@@ -1246,6 +1963,8 @@ int sdskv_length_multi(sdskv_provider_handle_t provider,
     }
 
     ret = out.ret;
+    sdskv_client_trace(provider->client, "sdskv_length_multi", trace_id,
+                       trace_start, &db_id, in.keys_bulk_size);
     if (out.ret != SDSKV_SUCCESS) { goto finish; }
 
 finish:
@@ -1309,9 +2028,14 @@ int sdskv_length_packed(sdskv_provider_handle_t provider,
         return SDSKV_MAKE_HG_ERROR(hret);
     }
 
+    int      traced      = provider->client->trace != NULL;
+    uint64_t trace_id    = sdskv_new_request_id(provider->client);
+    double   trace_start = ABT_get_wtime();
+
     /* create RPC handle */
-    hret = margo_create(provider->client->mid, provider->addr,
-                        provider->client->sdskv_length_packed_id, &handle);
+    hret = margo_create(
+        provider->client->mid, provider->addr,
+        SDSKV_TRACED_RPC_ID(provider->client, length_packed, traced), &handle);
     if (hret != HG_SUCCESS) {
         fprintf(stderr,
                 "[SDSKV] margo_create() failed in sdskv_length_packed()\n");
@@ -1321,7 +2045,8 @@ int sdskv_length_packed(sdskv_provider_handle_t provider,
     }
 
     /* forward RPC */
-    hret = margo_provider_forward(provider->provider_id, handle, &in);
+    hret = SDSKV_TRACED_FORWARD(provider, handle, length_packed_in_t, in,
+                                trace_id, traced);
     if (hret != HG_SUCCESS) {
         fprintf(stderr,
                 "[SDSKV] margo_provider_forward() failed in "
@@ -1346,6 +2071,8 @@ int sdskv_length_packed(sdskv_provider_handle_t provider,
     ret = out.ret;
     margo_bulk_free(in.in_bulk_handle);
     margo_bulk_free(in.out_bulk_handle);
+    sdskv_client_trace(provider->client, "sdskv_length_packed", trace_id,
+                       trace_start, &db_id, in.in_bulk_size);
     margo_free_output(handle, &out);
     margo_destroy(handle);
     return ret;
@@ -1367,6 +2094,11 @@ int sdskv_get_packed(sdskv_provider_handle_t provider,
     get_packed_in_t  in;
     get_packed_out_t out;
 
+    const sdskv_local_ops_t* local = sdskv_local_ops(provider);
+    if (local)
+        return local->get_packed(local->provider, db_id, num, packed_keys,
+                                 ksizes, vbufsize, packed_vals, vsizes);
+
     in.db_id            = db_id;
     in.num_keys         = *num;
     in.keys_bulk_size   = 0;
@@ -1374,6 +2106,10 @@ int sdskv_get_packed(sdskv_provider_handle_t provider,
     in.vals_bulk_size   = 0;
     in.vals_bulk_handle = HG_BULK_NULL;
 
+    int      traced      = provider->client->trace != NULL;
+    uint64_t trace_id    = sdskv_new_request_id(provider->client);
+    double   trace_start = ABT_get_wtime();
+
     hg_size_t total_ksize = 0;
     unsigned  i           = 0;
     for (i = 0; i < *num; i++) { total_ksize += ksizes[i]; }
@@ -1410,8 +2146,9 @@ int sdskv_get_packed(sdskv_provider_handle_t provider,
     }
 
     /* create RPC handle */
-    hret = margo_create(provider->client->mid, provider->addr,
-                        provider->client->sdskv_get_packed_id, &handle);
+    hret = margo_create(
+        provider->client->mid, provider->addr,
+        SDSKV_TRACED_RPC_ID(provider->client, get_packed, traced), &handle);
     if (hret != HG_SUCCESS) {
         fprintf(stderr,
                 "[SDSKV] margo_create() failed in sdskv_get_packed()\n");
@@ -1421,7 +2158,8 @@ int sdskv_get_packed(sdskv_provider_handle_t provider,
     }
 
     /* forward RPC */
-    hret = margo_provider_forward(provider->provider_id, handle, &in);
+    hret = SDSKV_TRACED_FORWARD(provider, handle, get_packed_in_t, in, trace_id,
+                                traced);
     if (hret != HG_SUCCESS) {
         fprintf(
             stderr,
@@ -1444,6 +2182,9 @@ int sdskv_get_packed(sdskv_provider_handle_t provider,
     }
 
     ret  = out.ret;
+    sdskv_client_trace(provider->client, "sdskv_get_packed", trace_id,
+                       trace_start, &db_id,
+                       in.keys_bulk_size + in.vals_bulk_size);
     *num = out.num_keys;
 
     margo_bulk_free(in.keys_bulk_handle);
@@ -1462,6 +2203,10 @@ int sdskv_erase(sdskv_provider_handle_t provider,
     int         ret;
     hg_handle_t handle;
 
+    const sdskv_local_ops_t* local = sdskv_local_ops(provider);
+    if (local)
+        return local->erase(local->provider, db_id, key, ksize);
+
     erase_in_t  in;
     erase_out_t out;
 
@@ -1469,12 +2214,18 @@ int sdskv_erase(sdskv_provider_handle_t provider,
     in.key.data = (kv_ptr_t)key;
     in.key.size = ksize;
 
+    int      traced      = provider->client->trace != NULL;
+    uint64_t trace_id    = sdskv_new_request_id(provider->client);
+    double   trace_start = ABT_get_wtime();
+
     /* create handle */
-    hret = margo_create(provider->client->mid, provider->addr,
-                        provider->client->sdskv_erase_id, &handle);
+    hret = margo_create(
+        provider->client->mid, provider->addr,
+        SDSKV_TRACED_RPC_ID(provider->client, erase, traced), &handle);
     if (hret != HG_SUCCESS) return SDSKV_MAKE_HG_ERROR(hret);
 
-    hret = margo_provider_forward(provider->provider_id, handle, &in);
+    hret = SDSKV_TRACED_FORWARD(provider, handle, erase_in_t, in, trace_id,
+                                traced);
     if (hret != HG_SUCCESS) {
         margo_destroy(handle);
         return SDSKV_MAKE_HG_ERROR(hret);
@@ -1488,6 +2239,8 @@ int sdskv_erase(sdskv_provider_handle_t provider,
 
     ret = out.ret;
 
+    sdskv_client_trace(provider->client, "sdskv_erase", trace_id, trace_start,
+                       &db_id, ksize);
     margo_free_output(handle, &out);
     margo_destroy(handle);
     return ret;
@@ -1498,6 +2251,17 @@ int sdskv_erase_multi(sdskv_provider_handle_t provider,
                       size_t                  num,
                       const void* const*      keys,
                       const hg_size_t*        ksizes)
+{
+    return sdskv_erase_multi_with_flags(provider, db_id, num, keys, ksizes,
+                                        NULL);
+}
+
+int sdskv_erase_multi_with_flags(sdskv_provider_handle_t provider,
+                                 sdskv_database_id_t     db_id,
+                                 size_t                  num,
+                                 const void* const*      keys,
+                                 const hg_size_t*        ksizes,
+                                 int*                    flags)
 {
     hg_return_t       hret;
     int               ret;
@@ -1506,11 +2270,18 @@ int sdskv_erase_multi(sdskv_provider_handle_t provider,
     erase_multi_out_t out;
     void**            key_seg_ptrs  = NULL;
     hg_size_t*        key_seg_sizes = NULL;
+    uint8_t*          erased        = NULL;
 
-    in.db_id            = db_id;
-    in.num_keys         = num;
-    in.keys_bulk_handle = HG_BULK_NULL;
-    in.keys_bulk_size   = 0;
+    const sdskv_local_ops_t* local = sdskv_local_ops(provider);
+    if (local)
+        return local->erase_multi(local->provider, db_id, num, keys, ksizes,
+                                  flags);
+
+    in.db_id             = db_id;
+    in.num_keys          = num;
+    in.keys_bulk_handle  = HG_BULK_NULL;
+    in.keys_bulk_size    = 0;
+    in.flags_bulk_handle = HG_BULK_NULL;
 
     /* create an array of key sizes and key pointers */
     key_seg_sizes    = malloc(sizeof(hg_size_t) * (num + 1));
@@ -1534,9 +2305,32 @@ int sdskv_erase_multi(sdskv_provider_handle_t provider,
         goto finish;
     }
 
+    /* create the bulk handle for the server to tell which keys were erased
+     * (none when there are no keys, since Mercury can't expose an empty
+     * buffer) */
+    hg_size_t erased_size = num / 8 + (num % 8 == 0 ? 0 : 1);
+    if (flags && num > 0) {
+        erased = calloc(erased_size, 1);
+        hret   = margo_bulk_create(provider->client->mid, 1, (void**)&erased,
+                                 &erased_size, HG_BULK_WRITE_ONLY,
+                                 &in.flags_bulk_handle);
+        if (hret != HG_SUCCESS) {
+            fprintf(stderr,
+                    "[SDSKV] margo_bulk_create() for flags failed in "
+                    "sdskv_erase_multi()\n");
+            out.ret = SDSKV_MAKE_HG_ERROR(hret);
+            goto finish;
+        }
+    }
+
+    int      traced      = provider->client->trace != NULL;
+    uint64_t trace_id    = sdskv_new_request_id(provider->client);
+    double   trace_start = ABT_get_wtime();
+
     /* create a RPC handle */
-    hret = margo_create(provider->client->mid, provider->addr,
-                        provider->client->sdskv_erase_multi_id, &handle);
+    hret = margo_create(
+        provider->client->mid, provider->addr,
+        SDSKV_TRACED_RPC_ID(provider->client, erase_multi, traced), &handle);
     if (hret != HG_SUCCESS) {
         fprintf(stderr,
                 "[SDSKV] margo_create() failed in sdskv_erase_multi()\n");
@@ -1545,7 +2339,8 @@ int sdskv_erase_multi(sdskv_provider_handle_t provider,
     }
 
     /* forward the RPC handle */
-    hret = margo_provider_forward(provider->provider_id, handle, &in);
+    hret = SDSKV_TRACED_FORWARD(provider, handle, erase_multi_in_t, in,
+                                trace_id, traced);
     if (hret != HG_SUCCESS) {
         fprintf(stderr,
                 "[SDSKV] margo_forward() failed in sdskv_erase_multi()\n");
@@ -1562,110 +2357,1271 @@ int sdskv_erase_multi(sdskv_provider_handle_t provider,
         goto finish;
     }
 
-    ret = out.ret;
-    if (out.ret != SDSKV_SUCCESS) { goto finish; }
+    sdskv_client_trace(provider->client, "sdskv_erase_multi", trace_id,
+                       trace_start, &db_id, in.keys_bulk_size);
+    if (out.ret != SDSKV_SUCCESS || !flags) { goto finish; }
+
+    for (i = 0; i < num; i++) {
+        flags[i] = erased[i / 8] & (1 << (i % 8)) ? 1 : 0;
+    }
 
 finish:
+    ret = out.ret;
     margo_free_output(handle, &out);
     margo_bulk_free(in.keys_bulk_handle);
+    margo_bulk_free(in.flags_bulk_handle);
     free(key_seg_sizes);
     free(key_seg_ptrs);
+    free(erased);
     margo_destroy(handle);
     return ret;
 }
 
-int sdskv_list_keys(
-    sdskv_provider_handle_t provider,
-    sdskv_database_id_t     db_id, // db instance
-    const void* start_key,         // we want keys strictly after this start_key
-    hg_size_t   start_ksize,       // size of the start_key
-    void**      keys,              // pointer to an array of void* pointers,
-    //     this array has size *max_keys
-    hg_size_t* ksizes, // pointer to an array of hg_size_t sizes
-    //    representing sizes allocated in
-    //     keys for each key
-    hg_size_t* max_keys) // maximum number of keys requested
+int sdskv_erase_range(sdskv_provider_handle_t provider,
+                      sdskv_database_id_t     db_id,
+                      const void*             lower_bound,
+                      hg_size_t               lb_size,
+                      const void*             upper_bound,
+                      hg_size_t               ub_size,
+                      hg_size_t*              num_erased)
 {
-    return sdskv_list_keys_with_prefix(provider, db_id, start_key, start_ksize,
-                                       NULL, 0, keys, ksizes, max_keys);
-}
+    hg_return_t hret;
+    int         ret;
+    hg_handle_t handle;
 
-int sdskv_list_keys_with_prefix(
-    sdskv_provider_handle_t provider,
-    sdskv_database_id_t     db_id, // db instance
-    const void* start_key,         // we want keys strictly after this start_key
-    hg_size_t   start_ksize,       // size of the start_key
-    const void* prefix,
-    hg_size_t   prefix_size,
-    void**      keys, // pointer to an array of void* pointers,
-    //     this array has size *max_keys
-    hg_size_t* ksizes, // pointer to an array of hg_size_t sizes
-    //    representing sizes allocated in
-    //     keys for each key
-    hg_size_t* max_keys) // maximum number of keys requested
-{
-    list_keys_in_t  in;
-    list_keys_out_t out;
-    hg_return_t     hret   = HG_SUCCESS;
-    hg_handle_t     handle = HG_HANDLE_NULL;
-    int             ret    = SDSKV_SUCCESS;
-    int             i;
+    erase_range_in_t  in;
+    erase_range_out_t out;
 
-    if (*max_keys == 0) { return SDSKV_SUCCESS; }
+    in.db_id            = db_id;
+    in.lower_bound.data = (kv_ptr_t)lower_bound;
+    in.lower_bound.size = lb_size;
+    in.upper_bound.data = (kv_ptr_t)upper_bound;
+    in.upper_bound.size = ub_size;
 
-    in.db_id              = db_id;
-    in.start_key.data     = (kv_ptr_t)start_key;
-    in.start_key.size     = start_ksize;
-    in.prefix.data        = (char*)prefix;
-    in.prefix.size        = prefix_size;
-    in.keys_bulk_handle   = HG_BULK_NULL;
-    in.ksizes_bulk_handle = HG_BULK_NULL;
-    in.max_keys           = *max_keys;
+    int      traced      = provider->client->trace != NULL;
+    uint64_t trace_id    = sdskv_new_request_id(provider->client);
+    double   trace_start = ABT_get_wtime();
 
-    /* create bulk handle to expose the segments with key sizes */
-    hg_size_t ksize_bulk_size = (*max_keys) * sizeof(*ksizes);
-    void*     buf_ptr[1]      = {ksizes};
-    hret
-        = margo_bulk_create(provider->client->mid, 1, buf_ptr, &ksize_bulk_size,
-                            HG_BULK_READWRITE, &in.ksizes_bulk_handle);
+    /* create handle */
+    hret = margo_create(
+        provider->client->mid, provider->addr,
+        SDSKV_TRACED_RPC_ID(provider->client, erase_range, traced), &handle);
+    if (hret != HG_SUCCESS) return SDSKV_MAKE_HG_ERROR(hret);
+
+    hret = SDSKV_TRACED_FORWARD(provider, handle, erase_range_in_t, in,
+                                trace_id, traced);
     if (hret != HG_SUCCESS) {
-        ret = SDSKV_MAKE_HG_ERROR(hret);
-        goto finish;
+        margo_destroy(handle);
+        return SDSKV_MAKE_HG_ERROR(hret);
     }
 
-    /* make sure none of the buffers is NULL or 0-sized */
-    int requesting_sizes = 0;
-    if (keys == NULL) {
-        requesting_sizes = 1;
-    } else {
-        for (i = 0; i < *max_keys; i++) {
-            if (keys[i] == NULL || ksizes[i] == 0) {
-                requesting_sizes = 1;
-                break;
-            }
-        }
+    hret = margo_get_output(handle, &out);
+    if (hret != HG_SUCCESS) {
+        margo_destroy(handle);
+        return SDSKV_MAKE_HG_ERROR(hret);
     }
 
-    /* create bulk handle to expose where the keys should be placed */
-    if (!requesting_sizes) {
-        hret = margo_bulk_create(provider->client->mid, *max_keys, keys, ksizes,
-                                 HG_BULK_WRITE_ONLY, &in.keys_bulk_handle);
-        if (hret != HG_SUCCESS) {
-            ret = SDSKV_MAKE_HG_ERROR(hret);
-            goto finish;
-        }
-    }
+    ret = out.ret;
+    if (ret == 0 && num_erased) *num_erased = out.num_erased;
 
-    /* create handle */
-    hret = margo_create(provider->client->mid, provider->addr,
-                        provider->client->sdskv_list_keys_id, &handle);
+    sdskv_client_trace(provider->client, "sdskv_erase_range", trace_id,
+                       trace_start, &db_id, lb_size + ub_size);
+    margo_free_output(handle, &out);
+    margo_destroy(handle);
+    return ret;
+}
+
+int sdskv_erase_prefix(sdskv_provider_handle_t provider,
+                       sdskv_database_id_t     db_id,
+                       const void*             prefix,
+                       hg_size_t               prefix_size,
+                       hg_size_t*              num_erased)
+{
+    hg_return_t hret;
+    int         ret;
+    hg_handle_t handle;
+
+    erase_prefix_in_t  in;
+    erase_prefix_out_t out;
+
+    in.db_id       = db_id;
+    in.prefix.data = (kv_ptr_t)prefix;
+    in.prefix.size = prefix_size;
+
+    int      traced      = provider->client->trace != NULL;
+    uint64_t trace_id    = sdskv_new_request_id(provider->client);
+    double   trace_start = ABT_get_wtime();
+
+    /* create handle */
+    hret = margo_create(
+        provider->client->mid, provider->addr,
+        SDSKV_TRACED_RPC_ID(provider->client, erase_prefix, traced), &handle);
+    if (hret != HG_SUCCESS) return SDSKV_MAKE_HG_ERROR(hret);
+
+    hret = SDSKV_TRACED_FORWARD(provider, handle, erase_prefix_in_t, in,
+                                trace_id, traced);
+    if (hret != HG_SUCCESS) {
+        margo_destroy(handle);
+        return SDSKV_MAKE_HG_ERROR(hret);
+    }
+
+    hret = margo_get_output(handle, &out);
+    if (hret != HG_SUCCESS) {
+        margo_destroy(handle);
+        return SDSKV_MAKE_HG_ERROR(hret);
+    }
+
+    ret = out.ret;
+    if (ret == 0 && num_erased) *num_erased = out.num_erased;
+
+    sdskv_client_trace(provider->client, "sdskv_erase_prefix", trace_id,
+                       trace_start, &db_id, prefix_size);
+    margo_free_output(handle, &out);
+    margo_destroy(handle);
+    return ret;
+}
+
+int sdskv_compare_and_swap(sdskv_provider_handle_t provider,
+                           sdskv_database_id_t     db_id,
+                           const void*             key,
+                           hg_size_t               ksize,
+                           const void*             expected,
+                           hg_size_t               esize,
+                           const void*             desired,
+                           hg_size_t               dsize,
+                           int*                    swapped)
+{
+    hg_return_t hret;
+    int         ret;
+    hg_handle_t handle;
+
+    cas_in_t  in;
+    cas_out_t out;
+
+    in.db_id         = db_id;
+    in.key.data      = (kv_ptr_t)key;
+    in.key.size      = ksize;
+    in.expected.data = (kv_ptr_t)expected;
+    in.expected.size = esize;
+    in.desired.data  = (kv_ptr_t)desired;
+    in.desired.size  = dsize;
+
+    int      traced      = provider->client->trace != NULL;
+    uint64_t trace_id    = sdskv_new_request_id(provider->client);
+    double   trace_start = ABT_get_wtime();
+
+    /* create handle */
+    hret = margo_create(
+        provider->client->mid, provider->addr,
+        SDSKV_TRACED_RPC_ID(provider->client, cas, traced), &handle);
+    if (hret != HG_SUCCESS) return SDSKV_MAKE_HG_ERROR(hret);
+
+    hret = SDSKV_TRACED_FORWARD(provider, handle, cas_in_t, in, trace_id,
+                                traced);
+    if (hret != HG_SUCCESS) {
+        margo_destroy(handle);
+        return SDSKV_MAKE_HG_ERROR(hret);
+    }
+
+    hret = margo_get_output(handle, &out);
+    if (hret != HG_SUCCESS) {
+        margo_destroy(handle);
+        return SDSKV_MAKE_HG_ERROR(hret);
+    }
+
+    ret = out.ret;
+    if (ret == 0 && swapped) *swapped = out.swapped;
+
+    sdskv_client_trace(provider->client, "sdskv_compare_and_swap", trace_id,
+                       trace_start, &db_id, ksize + esize + dsize);
+    margo_free_output(handle, &out);
+    margo_destroy(handle);
+    return ret;
+}
+
+int sdskv_compare_and_swap_packed(sdskv_provider_handle_t provider,
+                                  sdskv_database_id_t     db_id,
+                                  size_t                  num,
+                                  const void*             packed_keys,
+                                  const hg_size_t*        ksizes,
+                                  const void*             packed_expected,
+                                  const hg_size_t*        esizes,
+                                  const void*             packed_desired,
+                                  const hg_size_t*        dsizes,
+                                  int*                    swapped)
+{
+    hg_return_t hret;
+    int         ret;
+    hg_handle_t handle;
+    uint8_t*    flags = NULL;
+
+    cas_packed_in_t  in;
+    cas_packed_out_t out;
+
+    in.db_id           = db_id;
+    in.num_keys        = num;
+    in.in_bulk_size    = 0;
+    in.in_bulk_handle  = HG_BULK_NULL;
+    in.out_bulk_handle = HG_BULK_NULL;
+
+    if (num == 0) return SDSKV_SUCCESS;
+
+    hg_size_t total_ksize = 0;
+    hg_size_t total_esize = 0;
+    hg_size_t total_dsize = 0;
+    unsigned  i           = 0;
+    for (i = 0; i < num; i++) {
+        total_ksize += ksizes[i];
+        total_esize += esizes[i];
+        total_dsize += dsizes[i];
+    }
+
+    /* create bulk handle to expose the sizes, keys and values */
+    void*     seg_ptrs[6]  = {(void*)ksizes,          (void*)esizes,
+                         (void*)dsizes,          (void*)packed_keys,
+                         (void*)packed_expected, (void*)packed_desired};
+    hg_size_t seg_sizes[6] = {num * sizeof(hg_size_t), num * sizeof(hg_size_t),
+                              num * sizeof(hg_size_t), total_ksize,
+                              total_esize,             total_dsize};
+    for (i = 0; i < 6; i++) in.in_bulk_size += seg_sizes[i];
+
+    hret = margo_bulk_create(provider->client->mid, 6, seg_ptrs, seg_sizes,
+                             HG_BULK_READ_ONLY, &in.in_bulk_handle);
+    if (hret != HG_SUCCESS) {
+        fprintf(stderr,
+                "[SDSKV] margo_bulk_create() for keys/values failed in "
+                "sdskv_compare_and_swap_packed()\n");
+        return SDSKV_MAKE_HG_ERROR(hret);
+    }
+
+    /* create bulk handle to receive one swapped flag per key */
+    flags                    = (uint8_t*)calloc(num, 1);
+    hg_size_t flags_buf_size = num;
+    hret = margo_bulk_create(provider->client->mid, 1, (void**)(&flags),
+                             &flags_buf_size, HG_BULK_WRITE_ONLY,
+                             &in.out_bulk_handle);
+    if (hret != HG_SUCCESS) {
+        fprintf(stderr,
+                "[SDSKV] margo_bulk_create() for flags failed in "
+                "sdskv_compare_and_swap_packed()\n");
+        ret = SDSKV_MAKE_HG_ERROR(hret);
+        goto finish;
+    }
+
+    int      traced      = provider->client->trace != NULL;
+    uint64_t trace_id    = sdskv_new_request_id(provider->client);
+    double   trace_start = ABT_get_wtime();
+
+    /* create RPC handle */
+    hret = margo_create(
+        provider->client->mid, provider->addr,
+        SDSKV_TRACED_RPC_ID(provider->client, cas_packed, traced), &handle);
+    if (hret != HG_SUCCESS) {
+        fprintf(stderr,
+                "[SDSKV] margo_create() failed in "
+                "sdskv_compare_and_swap_packed()\n");
+        ret = SDSKV_MAKE_HG_ERROR(hret);
+        goto finish;
+    }
+
+    /* forward RPC */
+    hret = SDSKV_TRACED_FORWARD(provider, handle, cas_packed_in_t, in, trace_id,
+                                traced);
+    if (hret != HG_SUCCESS) {
+        fprintf(stderr,
+                "[SDSKV] margo_provider_forward() failed in "
+                "sdskv_compare_and_swap_packed()\n");
+        margo_destroy(handle);
+        ret = SDSKV_MAKE_HG_ERROR(hret);
+        goto finish;
+    }
+
+    /* get output */
+    hret = margo_get_output(handle, &out);
+    if (hret != HG_SUCCESS) {
+        fprintf(stderr,
+                "[SDSKV] margo_get_output() failed in "
+                "sdskv_compare_and_swap_packed()\n");
+        margo_destroy(handle);
+        ret = SDSKV_MAKE_HG_ERROR(hret);
+        goto finish;
+    }
+
+    ret = out.ret;
+    if (swapped) {
+        for (i = 0; i < num; i++) swapped[i] = flags[i];
+    }
+    sdskv_client_trace(provider->client, "sdskv_compare_and_swap_packed",
+                       trace_id, trace_start, &db_id, in.in_bulk_size);
+    margo_free_output(handle, &out);
+    margo_destroy(handle);
+
+finish:
+    margo_bulk_free(in.in_bulk_handle);
+    margo_bulk_free(in.out_bulk_handle);
+    free(flags);
+    return ret;
+}
+
+int sdskv_fetch_and_add(sdskv_provider_handle_t provider,
+                        sdskv_database_id_t     db_id,
+                        const void*             key,
+                        hg_size_t               ksize,
+                        int64_t                 delta,
+                        int64_t*                previous)
+{
+    hg_return_t hret;
+    int         ret;
+    hg_handle_t handle;
+
+    fetch_add_in_t  in;
+    fetch_add_out_t out;
+
+    in.db_id    = db_id;
+    in.key.data = (kv_ptr_t)key;
+    in.key.size = ksize;
+    in.delta    = delta;
+
+    int      traced      = provider->client->trace != NULL;
+    uint64_t trace_id    = sdskv_new_request_id(provider->client);
+    double   trace_start = ABT_get_wtime();
+
+    /* create handle */
+    hret = margo_create(
+        provider->client->mid, provider->addr,
+        SDSKV_TRACED_RPC_ID(provider->client, fetch_add, traced), &handle);
+    if (hret != HG_SUCCESS) return SDSKV_MAKE_HG_ERROR(hret);
+
+    hret = SDSKV_TRACED_FORWARD(provider, handle, fetch_add_in_t, in, trace_id,
+                                traced);
+    if (hret != HG_SUCCESS) {
+        margo_destroy(handle);
+        return SDSKV_MAKE_HG_ERROR(hret);
+    }
+
+    hret = margo_get_output(handle, &out);
+    if (hret != HG_SUCCESS) {
+        margo_destroy(handle);
+        return SDSKV_MAKE_HG_ERROR(hret);
+    }
+
+    ret = out.ret;
+    if (ret == 0 && previous) *previous = out.value;
+
+    sdskv_client_trace(provider->client, "sdskv_fetch_and_add", trace_id,
+                       trace_start, &db_id, ksize);
+    margo_free_output(handle, &out);
+    margo_destroy(handle);
+    return ret;
+}
+
+int sdskv_fetch_and_add_packed(sdskv_provider_handle_t provider,
+                               sdskv_database_id_t     db_id,
+                               size_t                  num,
+                               const void*             packed_keys,
+                               const hg_size_t*        ksizes,
+                               const int64_t*          deltas,
+                               int64_t*                previous)
+{
+    hg_return_t hret;
+    int         ret;
+    hg_handle_t handle;
+
+    fetch_add_packed_in_t  in;
+    fetch_add_packed_out_t out;
+
+    in.db_id           = db_id;
+    in.num_keys        = num;
+    in.in_bulk_size    = 0;
+    in.in_bulk_handle  = HG_BULK_NULL;
+    in.out_bulk_handle = HG_BULK_NULL;
+
+    hg_size_t total_ksize = 0;
+    unsigned  i           = 0;
+    for (i = 0; i < num; i++) { total_ksize += ksizes[i]; }
+
+    /* create bulk handle to expose the ksizes, deltas and packed keys */
+    void* seg_ptrs[3] = {(void*)ksizes, (void*)deltas, (void*)packed_keys};
+    hg_size_t seg_sizes[3]
+        = {num * sizeof(hg_size_t), num * sizeof(int64_t), total_ksize};
+    in.in_bulk_size = seg_sizes[0] + seg_sizes[1] + seg_sizes[2];
+
+    hret = margo_bulk_create(provider->client->mid, 3, seg_ptrs, seg_sizes,
+                             HG_BULK_READ_ONLY, &in.in_bulk_handle);
+    if (hret != HG_SUCCESS) {
+        fprintf(stderr,
+                "[SDSKV] margo_bulk_create() for keys/deltas failed in "
+                "sdskv_fetch_and_add_packed()\n");
+        return SDSKV_MAKE_HG_ERROR(hret);
+    }
+
+    /* create bulk handle to expose the previous values */
+    hg_size_t previous_buf_size = num * sizeof(int64_t);
+    hret = margo_bulk_create(provider->client->mid, 1, (void**)(&previous),
+                             &previous_buf_size, HG_BULK_WRITE_ONLY,
+                             &in.out_bulk_handle);
+    if (hret != HG_SUCCESS) {
+        fprintf(stderr,
+                "[SDSKV] margo_bulk_create() for previous values failed in "
+                "sdskv_fetch_and_add_packed()\n");
+        margo_bulk_free(in.in_bulk_handle);
+        return SDSKV_MAKE_HG_ERROR(hret);
+    }
+
+    int      traced      = provider->client->trace != NULL;
+    uint64_t trace_id    = sdskv_new_request_id(provider->client);
+    double   trace_start = ABT_get_wtime();
+
+    /* create RPC handle */
+    hret = margo_create(
+        provider->client->mid, provider->addr,
+        SDSKV_TRACED_RPC_ID(provider->client, fetch_add_packed, traced),
+        &handle);
+    if (hret != HG_SUCCESS) {
+        fprintf(stderr,
+                "[SDSKV] margo_create() failed in "
+                "sdskv_fetch_and_add_packed()\n");
+        margo_bulk_free(in.in_bulk_handle);
+        margo_bulk_free(in.out_bulk_handle);
+        return SDSKV_MAKE_HG_ERROR(hret);
+    }
+
+    /* forward RPC */
+    hret = SDSKV_TRACED_FORWARD(provider, handle, fetch_add_packed_in_t, in,
+                                trace_id, traced);
+    if (hret != HG_SUCCESS) {
+        fprintf(stderr,
+                "[SDSKV] margo_provider_forward() failed in "
+                "sdskv_fetch_and_add_packed()\n");
+        margo_bulk_free(in.in_bulk_handle);
+        margo_bulk_free(in.out_bulk_handle);
+        margo_destroy(handle);
+        return SDSKV_MAKE_HG_ERROR(hret);
+    }
+
+    /* get output */
+    hret = margo_get_output(handle, &out);
+    if (hret != HG_SUCCESS) {
+        fprintf(stderr,
+                "[SDSKV] margo_get_output() failed in "
+                "sdskv_fetch_and_add_packed()\n");
+        margo_bulk_free(in.in_bulk_handle);
+        margo_bulk_free(in.out_bulk_handle);
+        margo_destroy(handle);
+        return SDSKV_MAKE_HG_ERROR(hret);
+    }
+
+    ret = out.ret;
+    margo_bulk_free(in.in_bulk_handle);
+    margo_bulk_free(in.out_bulk_handle);
+    sdskv_client_trace(provider->client, "sdskv_fetch_and_add_packed", trace_id,
+                       trace_start, &db_id, in.in_bulk_size);
+    margo_free_output(handle, &out);
+    margo_destroy(handle);
+    return ret;
+}
+
+int sdskv_append(sdskv_provider_handle_t provider,
+                 sdskv_database_id_t     db_id,
+                 const void*             key,
+                 hg_size_t               ksize,
+                 const void*             data,
+                 hg_size_t               dsize,
+                 hg_size_t*              new_vsize)
+{
+    hg_return_t hret;
+    int         ret;
+    hg_handle_t handle;
+
+    append_in_t  in;
+    append_out_t out;
+
+    in.db_id      = db_id;
+    in.key.data   = (kv_ptr_t)key;
+    in.key.size   = ksize;
+    in.value.data = (kv_ptr_t)data;
+    in.value.size = dsize;
+
+    int      traced      = provider->client->trace != NULL;
+    uint64_t trace_id    = sdskv_new_request_id(provider->client);
+    double   trace_start = ABT_get_wtime();
+
+    /* create handle */
+    hret = margo_create(
+        provider->client->mid, provider->addr,
+        SDSKV_TRACED_RPC_ID(provider->client, append, traced), &handle);
+    if (hret != HG_SUCCESS) return SDSKV_MAKE_HG_ERROR(hret);
+
+    hret = SDSKV_TRACED_FORWARD(provider, handle, append_in_t, in, trace_id,
+                                traced);
+    if (hret != HG_SUCCESS) {
+        margo_destroy(handle);
+        return SDSKV_MAKE_HG_ERROR(hret);
+    }
+
+    hret = margo_get_output(handle, &out);
+    if (hret != HG_SUCCESS) {
+        margo_destroy(handle);
+        return SDSKV_MAKE_HG_ERROR(hret);
+    }
+
+    ret = out.ret;
+    if (ret == 0 && new_vsize) *new_vsize = out.vsize;
+
+    sdskv_client_trace(provider->client, "sdskv_append", trace_id, trace_start,
+                       &db_id, ksize + dsize);
+    margo_free_output(handle, &out);
+    margo_destroy(handle);
+    return ret;
+}
+
+int sdskv_append_packed(sdskv_provider_handle_t provider,
+                        sdskv_database_id_t     db_id,
+                        size_t                  num,
+                        const void*             packed_keys,
+                        const hg_size_t*        ksizes,
+                        const void*             packed_data,
+                        const hg_size_t*        dsizes,
+                        hg_size_t*              new_vsizes)
+{
+    hg_return_t hret;
+    int         ret;
+    hg_handle_t handle;
+
+    append_packed_in_t  in;
+    append_packed_out_t out;
+
+    in.db_id           = db_id;
+    in.num_keys        = num;
+    in.in_bulk_size    = 0;
+    in.in_bulk_handle  = HG_BULK_NULL;
+    in.out_bulk_handle = HG_BULK_NULL;
+
+    hg_size_t total_ksize = 0;
+    hg_size_t total_dsize = 0;
+    unsigned  i           = 0;
+    for (i = 0; i < num; i++) {
+        total_ksize += ksizes[i];
+        total_dsize += dsizes[i];
+    }
+
+    /* create bulk handle to expose the sizes, packed keys and packed data */
+    void*     seg_ptrs[4]  = {(void*)ksizes, (void*)dsizes, (void*)packed_keys,
+                         (void*)packed_data};
+    hg_size_t seg_sizes[4] = {num * sizeof(hg_size_t), num * sizeof(hg_size_t),
+                              total_ksize, total_dsize};
+    in.in_bulk_size = seg_sizes[0] + seg_sizes[1] + seg_sizes[2] + seg_sizes[3];
+
+    hret = margo_bulk_create(provider->client->mid, 4, seg_ptrs, seg_sizes,
+                             HG_BULK_READ_ONLY, &in.in_bulk_handle);
+    if (hret != HG_SUCCESS) {
+        fprintf(stderr,
+                "[SDSKV] margo_bulk_create() for keys/data failed in "
+                "sdskv_append_packed()\n");
+        return SDSKV_MAKE_HG_ERROR(hret);
+    }
+
+    /* create bulk handle to expose the resulting value sizes */
+    hg_size_t vsizes_buf_size = num * sizeof(hg_size_t);
+    hret = margo_bulk_create(provider->client->mid, 1, (void**)(&new_vsizes),
+                             &vsizes_buf_size, HG_BULK_WRITE_ONLY,
+                             &in.out_bulk_handle);
+    if (hret != HG_SUCCESS) {
+        fprintf(stderr,
+                "[SDSKV] margo_bulk_create() for vsizes failed in "
+                "sdskv_append_packed()\n");
+        margo_bulk_free(in.in_bulk_handle);
+        return SDSKV_MAKE_HG_ERROR(hret);
+    }
+
+    int      traced      = provider->client->trace != NULL;
+    uint64_t trace_id    = sdskv_new_request_id(provider->client);
+    double   trace_start = ABT_get_wtime();
+
+    /* create RPC handle */
+    hret = margo_create(
+        provider->client->mid, provider->addr,
+        SDSKV_TRACED_RPC_ID(provider->client, append_packed, traced), &handle);
+    if (hret != HG_SUCCESS) {
+        fprintf(stderr,
+                "[SDSKV] margo_create() failed in sdskv_append_packed()\n");
+        margo_bulk_free(in.in_bulk_handle);
+        margo_bulk_free(in.out_bulk_handle);
+        return SDSKV_MAKE_HG_ERROR(hret);
+    }
+
+    /* forward RPC */
+    hret = SDSKV_TRACED_FORWARD(provider, handle, append_packed_in_t, in,
+                                trace_id, traced);
+    if (hret != HG_SUCCESS) {
+        fprintf(stderr,
+                "[SDSKV] margo_provider_forward() failed in "
+                "sdskv_append_packed()\n");
+        margo_bulk_free(in.in_bulk_handle);
+        margo_bulk_free(in.out_bulk_handle);
+        margo_destroy(handle);
+        return SDSKV_MAKE_HG_ERROR(hret);
+    }
+
+    /* get output */
+    hret = margo_get_output(handle, &out);
+    if (hret != HG_SUCCESS) {
+        fprintf(stderr,
+                "[SDSKV] margo_get_output() failed in sdskv_append_packed()\n");
+        margo_bulk_free(in.in_bulk_handle);
+        margo_bulk_free(in.out_bulk_handle);
+        margo_destroy(handle);
+        return SDSKV_MAKE_HG_ERROR(hret);
+    }
+
+    ret = out.ret;
+    margo_bulk_free(in.in_bulk_handle);
+    margo_bulk_free(in.out_bulk_handle);
+    sdskv_client_trace(provider->client, "sdskv_append_packed", trace_id,
+                       trace_start, &db_id, in.in_bulk_size);
+    margo_free_output(handle, &out);
+    margo_destroy(handle);
+    return ret;
+}
+
+int sdskv_sync(sdskv_provider_handle_t provider, sdskv_database_id_t db_id)
+{
+    hg_return_t hret;
+    int         ret;
+    hg_handle_t handle;
+
+    sync_in_t  in;
+    sync_out_t out;
+
+    in.db_id = db_id;
+
+    int      traced      = provider->client->trace != NULL;
+    uint64_t trace_id    = sdskv_new_request_id(provider->client);
+    double   trace_start = ABT_get_wtime();
+
+    /* create handle */
+    hret = margo_create(
+        provider->client->mid, provider->addr,
+        SDSKV_TRACED_RPC_ID(provider->client, sync, traced), &handle);
+    if (hret != HG_SUCCESS) return SDSKV_MAKE_HG_ERROR(hret);
+
+    hret = SDSKV_TRACED_FORWARD(provider, handle, sync_in_t, in, trace_id,
+                                traced);
+    if (hret != HG_SUCCESS) {
+        margo_destroy(handle);
+        return SDSKV_MAKE_HG_ERROR(hret);
+    }
+
+    hret = margo_get_output(handle, &out);
+    if (hret != HG_SUCCESS) {
+        margo_destroy(handle);
+        return SDSKV_MAKE_HG_ERROR(hret);
+    }
+
+    ret = out.ret;
+
+    sdskv_client_trace(provider->client, "sdskv_sync", trace_id, trace_start,
+                       &db_id, 0);
+    margo_free_output(handle, &out);
+    margo_destroy(handle);
+    return ret;
+}
+
+int sdskv_batch(sdskv_provider_handle_t provider,
+                size_t                  num_ops,
+                sdskv_batch_op_t*       ops)
+{
+    hg_return_t hret;
+    int         ret;
+    hg_handle_t handle;
+
+    batch_in_t  in;
+    batch_out_t out;
+
+    size_t i;
+    if (num_ops == 0) return SDSKV_SUCCESS;
+
+    /* the request is packed in a single buffer: database ids, key sizes,
+     * value sizes, operation types, then the keys and the values to put */
+    hg_size_t total_ksize = 0, total_put_size = 0, num_get_slots = 0;
+    for (i = 0; i < num_ops; i++) {
+        total_ksize += ops[i].ksize;
+        if (ops[i].type == SDSKV_BATCH_PUT) total_put_size += ops[i].vsize;
+        if (ops[i].type == SDSKV_BATCH_GET && ops[i].vsize != 0)
+            num_get_slots += 1;
+    }
+    hg_size_t header_size = num_ops
+                          * (sizeof(uint64_t) + 2 * sizeof(hg_size_t)
+                             + sizeof(int32_t));
+    in.num_ops      = num_ops;
+    in.in_bulk_size = header_size + total_ksize + total_put_size;
+
+    char* req = (char*)malloc(in.in_bulk_size);
+    if (!req) return SDSKV_ERR_ALLOCATION;
+    uint64_t*  db_ids = (uint64_t*)req;
+    hg_size_t* ksizes = (hg_size_t*)(db_ids + num_ops);
+    hg_size_t* vsizes = ksizes + num_ops;
+    int32_t*   types  = (int32_t*)(vsizes + num_ops);
+    char*      keys   = (char*)(types + num_ops);
+    char*      values = keys + total_ksize;
+    for (i = 0; i < num_ops; i++) {
+        db_ids[i] = ops[i].db_id;
+        ksizes[i] = ops[i].ksize;
+        types[i]  = ops[i].type;
+        vsizes[i] = (ops[i].type == SDSKV_BATCH_PUT
+                     || ops[i].type == SDSKV_BATCH_GET)
+                      ? ops[i].vsize
+                      : 0;
+        memcpy(keys, ops[i].key, ops[i].ksize);
+        keys += ops[i].ksize;
+        if (ops[i].type == SDSKV_BATCH_PUT) {
+            memcpy(values, ops[i].value, ops[i].vsize);
+            values += ops[i].vsize;
+        }
+    }
+
+    /* the reply lands directly in the user's buffers: value sizes and
+     * return codes first, then one segment per get buffer */
+    hg_size_t* rsizes = (hg_size_t*)malloc(num_ops * sizeof(hg_size_t));
+    int32_t*   rets   = (int32_t*)malloc(num_ops * sizeof(int32_t));
+    size_t     num_segments = 2 + num_get_slots;
+    void**     seg_ptrs     = (void**)malloc(num_segments * sizeof(void*));
+    hg_size_t* seg_sizes = (hg_size_t*)malloc(num_segments * sizeof(hg_size_t));
+    if (!rsizes || !rets || !seg_ptrs || !seg_sizes) {
+        ret = SDSKV_ERR_ALLOCATION;
+        goto free_buffers;
+    }
+    seg_ptrs[0]      = rsizes;
+    seg_sizes[0]     = num_ops * sizeof(hg_size_t);
+    seg_ptrs[1]      = rets;
+    seg_sizes[1]     = num_ops * sizeof(int32_t);
+    in.out_bulk_size = seg_sizes[0] + seg_sizes[1];
+    size_t s         = 2;
+    for (i = 0; i < num_ops; i++) {
+        if (ops[i].type != SDSKV_BATCH_GET || ops[i].vsize == 0) continue;
+        seg_ptrs[s]  = ops[i].value;
+        seg_sizes[s] = ops[i].vsize;
+        in.out_bulk_size += ops[i].vsize;
+        s += 1;
+    }
+
+    hret = margo_bulk_create(provider->client->mid, 1, (void**)&req,
+                             &in.in_bulk_size, HG_BULK_READ_ONLY,
+                             &in.in_bulk_handle);
+    if (hret != HG_SUCCESS) {
+        fprintf(stderr,
+                "[SDSKV] margo_bulk_create() for request failed in "
+                "sdskv_batch()\n");
+        ret = SDSKV_MAKE_HG_ERROR(hret);
+        goto free_buffers;
+    }
+
+    hret = margo_bulk_create(provider->client->mid, num_segments, seg_ptrs,
+                             seg_sizes, HG_BULK_WRITE_ONLY,
+                             &in.out_bulk_handle);
+    if (hret != HG_SUCCESS) {
+        fprintf(stderr,
+                "[SDSKV] margo_bulk_create() for reply failed in "
+                "sdskv_batch()\n");
+        ret = SDSKV_MAKE_HG_ERROR(hret);
+        goto free_in_bulk;
+    }
+
+    int      traced      = provider->client->trace != NULL;
+    uint64_t trace_id    = sdskv_new_request_id(provider->client);
+    double   trace_start = ABT_get_wtime();
+
+    /* create RPC handle */
+    hret = margo_create(
+        provider->client->mid, provider->addr,
+        SDSKV_TRACED_RPC_ID(provider->client, batch, traced), &handle);
+    if (hret != HG_SUCCESS) {
+        fprintf(stderr, "[SDSKV] margo_create() failed in sdskv_batch()\n");
+        ret = SDSKV_MAKE_HG_ERROR(hret);
+        goto free_out_bulk;
+    }
+
+    /* forward RPC */
+    hret = SDSKV_TRACED_FORWARD(provider, handle, batch_in_t, in, trace_id,
+                                traced);
+    if (hret != HG_SUCCESS) {
+        fprintf(stderr,
+                "[SDSKV] margo_provider_forward() failed in sdskv_batch()\n");
+        ret = SDSKV_MAKE_HG_ERROR(hret);
+        goto destroy_handle;
+    }
+
+    /* get output */
+    hret = margo_get_output(handle, &out);
+    if (hret != HG_SUCCESS) {
+        fprintf(stderr,
+                "[SDSKV] margo_get_output() failed in sdskv_batch()\n");
+        ret = SDSKV_MAKE_HG_ERROR(hret);
+        goto destroy_handle;
+    }
+
+    ret = out.ret;
+    if (ret == SDSKV_SUCCESS) {
+        for (i = 0; i < num_ops; i++) {
+            ops[i].ret = rets[i];
+            if (ops[i].type != SDSKV_BATCH_PUT
+                && ops[i].type != SDSKV_BATCH_ERASE)
+                ops[i].vsize = rsizes[i];
+        }
+    }
+    sdskv_client_trace(provider->client, "sdskv_batch", trace_id, trace_start,
+                       NULL, in.in_bulk_size + in.out_bulk_size);
+    margo_free_output(handle, &out);
+
+destroy_handle:
+    margo_destroy(handle);
+free_out_bulk:
+    margo_bulk_free(in.out_bulk_handle);
+free_in_bulk:
+    margo_bulk_free(in.in_bulk_handle);
+free_buffers:
+    free(seg_sizes);
+    free(seg_ptrs);
+    free(rets);
+    free(rsizes);
+    free(req);
+    return ret;
+}
+
+/* creates a bulk handle over the non-empty segments among the given ones */
+static hg_return_t create_bulk_skip_empty(margo_instance_id mid,
+                                          size_t            count,
+                                          void**            ptrs,
+                                          hg_size_t*        sizes,
+                                          uint8_t           flags,
+                                          hg_bulk_t*        bulk)
+{
+    size_t i, j = 0;
+    for (i = 0; i < count; i++) {
+        if (sizes[i] == 0) continue;
+        ptrs[j]  = ptrs[i];
+        sizes[j] = sizes[i];
+        j += 1;
+    }
+    return margo_bulk_create(mid, j, ptrs, sizes, flags, bulk);
+}
+
+int sdskv_put_packed_multi_db(sdskv_provider_handle_t    provider,
+                              size_t                     num_dbs,
+                              const sdskv_database_id_t* db_ids,
+                              size_t                     num,
+                              const uint32_t*            db_indices,
+                              const void*                packed_keys,
+                              const hg_size_t*           ksizes,
+                              const void*                packed_values,
+                              const hg_size_t*           vsizes)
+{
+    hg_return_t hret;
+    int         ret;
+    hg_handle_t handle;
+
+    put_packed_multi_db_in_t  in;
+    put_packed_multi_db_out_t out;
+
+    hg_size_t total_ksize = 0;
+    hg_size_t total_vsize = 0;
+    size_t    i;
+    for (i = 0; i < num; i++) {
+        total_ksize += ksizes[i];
+        total_vsize += vsizes[i];
+    }
+
+    void*     seg_ptrs[6]  = {(void*)db_ids,     (void*)ksizes,
+                         (void*)vsizes,     (void*)db_indices,
+                         (void*)packed_keys, (void*)packed_values};
+    hg_size_t seg_sizes[6] = {num_dbs * sizeof(uint64_t),
+                              num * sizeof(hg_size_t),
+                              num * sizeof(hg_size_t),
+                              num * sizeof(uint32_t),
+                              total_ksize,
+                              total_vsize};
+    in.num_dbs   = num_dbs;
+    in.num_keys  = num;
+    in.bulk_size = 0;
+    for (i = 0; i < 6; i++) in.bulk_size += seg_sizes[i];
+
+    hret = create_bulk_skip_empty(provider->client->mid, 6, seg_ptrs,
+                                  seg_sizes, HG_BULK_READ_ONLY,
+                                  &in.bulk_handle);
+    if (hret != HG_SUCCESS) {
+        fprintf(stderr,
+                "[SDSKV] margo_bulk_create() failed in "
+                "sdskv_put_packed_multi_db()\n");
+        return SDSKV_MAKE_HG_ERROR(hret);
+    }
+
+    int      traced      = provider->client->trace != NULL;
+    uint64_t trace_id    = sdskv_new_request_id(provider->client);
+    double   trace_start = ABT_get_wtime();
+
+    hret = margo_create(
+        provider->client->mid, provider->addr,
+        SDSKV_TRACED_RPC_ID(provider->client, put_packed_multi_db, traced),
+        &handle);
+    if (hret != HG_SUCCESS) {
+        fprintf(stderr,
+                "[SDSKV] margo_create() failed in "
+                "sdskv_put_packed_multi_db()\n");
+        margo_bulk_free(in.bulk_handle);
+        return SDSKV_MAKE_HG_ERROR(hret);
+    }
+
+    hret = SDSKV_TRACED_FORWARD(provider, handle, put_packed_multi_db_in_t, in,
+                                trace_id, traced);
+    if (hret != HG_SUCCESS) {
+        fprintf(stderr,
+                "[SDSKV] margo_provider_forward() failed in "
+                "sdskv_put_packed_multi_db()\n");
+        margo_bulk_free(in.bulk_handle);
+        margo_destroy(handle);
+        return SDSKV_MAKE_HG_ERROR(hret);
+    }
+
+    hret = margo_get_output(handle, &out);
+    if (hret != HG_SUCCESS) {
+        fprintf(stderr,
+                "[SDSKV] margo_get_output() failed in "
+                "sdskv_put_packed_multi_db()\n");
+        margo_bulk_free(in.bulk_handle);
+        margo_destroy(handle);
+        return SDSKV_MAKE_HG_ERROR(hret);
+    }
+
+    ret = out.ret;
+    sdskv_client_trace(provider->client, "sdskv_put_packed_multi_db", trace_id,
+                       trace_start, NULL, in.bulk_size);
+    margo_free_output(handle, &out);
+    margo_bulk_free(in.bulk_handle);
+    margo_destroy(handle);
+    return ret;
+}
+
+int sdskv_get_packed_multi_db(sdskv_provider_handle_t    provider,
+                              size_t                     num_dbs,
+                              const sdskv_database_id_t* db_ids,
+                              size_t*                    num,
+                              const uint32_t*            db_indices,
+                              const void*                packed_keys,
+                              const hg_size_t*           ksizes,
+                              hg_size_t                  vbufsize,
+                              void*                      packed_values,
+                              hg_size_t*                 vsizes)
+{
+    hg_return_t hret;
+    int         ret;
+    hg_handle_t handle;
+
+    get_packed_multi_db_in_t  in;
+    get_packed_multi_db_out_t out;
+
+    hg_size_t total_ksize = 0;
+    size_t    i;
+    for (i = 0; i < *num; i++) total_ksize += ksizes[i];
+
+    in.num_dbs          = num_dbs;
+    in.num_keys         = *num;
+    in.keys_bulk_size   = 0;
+    in.keys_bulk_handle = HG_BULK_NULL;
+    in.vals_bulk_handle = HG_BULK_NULL;
+
+    void*     kseg_ptrs[4]  = {(void*)db_ids, (void*)ksizes, (void*)db_indices,
+                          (void*)packed_keys};
+    hg_size_t kseg_sizes[4] = {num_dbs * sizeof(uint64_t),
+                               (*num) * sizeof(hg_size_t),
+                               (*num) * sizeof(uint32_t), total_ksize};
+    for (i = 0; i < 4; i++) in.keys_bulk_size += kseg_sizes[i];
+
+    hret = create_bulk_skip_empty(provider->client->mid, 4, kseg_ptrs,
+                                  kseg_sizes, HG_BULK_READ_ONLY,
+                                  &in.keys_bulk_handle);
+    if (hret != HG_SUCCESS) {
+        fprintf(stderr,
+                "[SDSKV] margo_bulk_create() for keys failed in "
+                "sdskv_get_packed_multi_db()\n");
+        return SDSKV_MAKE_HG_ERROR(hret);
+    }
+
+    void*     vseg_ptrs[2]  = {(void*)vsizes, packed_values};
+    hg_size_t vseg_sizes[2] = {(*num) * sizeof(hg_size_t), vbufsize};
+    in.vals_bulk_size       = vseg_sizes[0] + vseg_sizes[1];
+
+    hret = create_bulk_skip_empty(provider->client->mid, 2, vseg_ptrs,
+                                  vseg_sizes, HG_BULK_WRITE_ONLY,
+                                  &in.vals_bulk_handle);
+    if (hret != HG_SUCCESS) {
+        fprintf(stderr,
+                "[SDSKV] margo_bulk_create() for values failed in "
+                "sdskv_get_packed_multi_db()\n");
+        margo_bulk_free(in.keys_bulk_handle);
+        return SDSKV_MAKE_HG_ERROR(hret);
+    }
+
+    int      traced      = provider->client->trace != NULL;
+    uint64_t trace_id    = sdskv_new_request_id(provider->client);
+    double   trace_start = ABT_get_wtime();
+
+    hret = margo_create(
+        provider->client->mid, provider->addr,
+        SDSKV_TRACED_RPC_ID(provider->client, get_packed_multi_db, traced),
+        &handle);
+    if (hret != HG_SUCCESS) {
+        fprintf(stderr,
+                "[SDSKV] margo_create() failed in "
+                "sdskv_get_packed_multi_db()\n");
+        margo_bulk_free(in.keys_bulk_handle);
+        margo_bulk_free(in.vals_bulk_handle);
+        return SDSKV_MAKE_HG_ERROR(hret);
+    }
+
+    hret = SDSKV_TRACED_FORWARD(provider, handle, get_packed_multi_db_in_t, in,
+                                trace_id, traced);
+    if (hret != HG_SUCCESS) {
+        fprintf(stderr,
+                "[SDSKV] margo_provider_forward() failed in "
+                "sdskv_get_packed_multi_db()\n");
+        margo_bulk_free(in.keys_bulk_handle);
+        margo_bulk_free(in.vals_bulk_handle);
+        margo_destroy(handle);
+        return SDSKV_MAKE_HG_ERROR(hret);
+    }
+
+    hret = margo_get_output(handle, &out);
+    if (hret != HG_SUCCESS) {
+        fprintf(stderr,
+                "[SDSKV] margo_get_output() failed in "
+                "sdskv_get_packed_multi_db()\n");
+        margo_bulk_free(in.keys_bulk_handle);
+        margo_bulk_free(in.vals_bulk_handle);
+        margo_destroy(handle);
+        return SDSKV_MAKE_HG_ERROR(hret);
+    }
+
+    ret  = out.ret;
+    *num = out.num_keys;
+
+    sdskv_client_trace(provider->client, "sdskv_get_packed_multi_db", trace_id,
+                       trace_start, NULL,
+                       in.keys_bulk_size + in.vals_bulk_size);
+    margo_free_output(handle, &out);
+    margo_bulk_free(in.keys_bulk_handle);
+    margo_bulk_free(in.vals_bulk_handle);
+    margo_destroy(handle);
+    return ret;
+}
+
+int sdskv_exists_packed_multi_db(sdskv_provider_handle_t    provider,
+                                 size_t                     num_dbs,
+                                 const sdskv_database_id_t* db_ids,
+                                 size_t                     num,
+                                 const uint32_t*            db_indices,
+                                 const void*                packed_keys,
+                                 const hg_size_t*           ksizes,
+                                 int*                       flags)
+{
+    hg_return_t hret;
+    int         ret;
+    hg_handle_t handle;
+
+    exists_packed_multi_db_in_t  in;
+    exists_packed_multi_db_out_t out;
+
+    hg_size_t total_ksize = 0;
+    size_t    i;
+    for (i = 0; i < num; i++) total_ksize += ksizes[i];
+
+    in.num_dbs           = num_dbs;
+    in.num_keys          = num;
+    in.keys_bulk_size    = 0;
+    in.keys_bulk_handle  = HG_BULK_NULL;
+    in.flags_bulk_handle = HG_BULK_NULL;
+
+    void*     kseg_ptrs[4]  = {(void*)db_ids, (void*)ksizes, (void*)db_indices,
+                          (void*)packed_keys};
+    hg_size_t kseg_sizes[4] = {num_dbs * sizeof(uint64_t),
+                               num * sizeof(hg_size_t),
+                               num * sizeof(uint32_t), total_ksize};
+    for (i = 0; i < 4; i++) in.keys_bulk_size += kseg_sizes[i];
+
+    hret = create_bulk_skip_empty(provider->client->mid, 4, kseg_ptrs,
+                                  kseg_sizes, HG_BULK_READ_ONLY,
+                                  &in.keys_bulk_handle);
+    if (hret != HG_SUCCESS) {
+        fprintf(stderr,
+                "[SDSKV] margo_bulk_create() for keys failed in "
+                "sdskv_exists_packed_multi_db()\n");
+        return SDSKV_MAKE_HG_ERROR(hret);
+    }
+
+    hg_size_t exist_size = num / 8 + (num % 8 == 0 ? 0 : 1);
+    uint8_t*  exist      = calloc(exist_size, 1);
+    hret = margo_bulk_create(provider->client->mid, 1, (void**)&exist,
+                             &exist_size, HG_BULK_WRITE_ONLY,
+                             &in.flags_bulk_handle);
+    if (hret != HG_SUCCESS) {
+        fprintf(stderr,
+                "[SDSKV] margo_bulk_create() for flags failed in "
+                "sdskv_exists_packed_multi_db()\n");
+        margo_bulk_free(in.keys_bulk_handle);
+        free(exist);
+        return SDSKV_MAKE_HG_ERROR(hret);
+    }
+
+    int      traced      = provider->client->trace != NULL;
+    uint64_t trace_id    = sdskv_new_request_id(provider->client);
+    double   trace_start = ABT_get_wtime();
+
+    hret = margo_create(
+        provider->client->mid, provider->addr,
+        SDSKV_TRACED_RPC_ID(provider->client, exists_packed_multi_db, traced),
+        &handle);
+    if (hret != HG_SUCCESS) {
+        fprintf(stderr,
+                "[SDSKV] margo_create() failed in "
+                "sdskv_exists_packed_multi_db()\n");
+        ret = SDSKV_MAKE_HG_ERROR(hret);
+        goto free_bulks;
+    }
+
+    hret = SDSKV_TRACED_FORWARD(provider, handle, exists_packed_multi_db_in_t,
+                                in, trace_id, traced);
+    if (hret != HG_SUCCESS) {
+        fprintf(stderr,
+                "[SDSKV] margo_provider_forward() failed in "
+                "sdskv_exists_packed_multi_db()\n");
+        ret = SDSKV_MAKE_HG_ERROR(hret);
+        goto destroy_handle;
+    }
+
+    hret = margo_get_output(handle, &out);
+    if (hret != HG_SUCCESS) {
+        fprintf(stderr,
+                "[SDSKV] margo_get_output() failed in "
+                "sdskv_exists_packed_multi_db()\n");
+        ret = SDSKV_MAKE_HG_ERROR(hret);
+        goto destroy_handle;
+    }
+
+    ret = out.ret;
+    if (ret == SDSKV_SUCCESS) {
+        for (i = 0; i < num; i++)
+            flags[i] = (exist[i / 8] & (1 << (i % 8))) ? 1 : 0;
+    }
+    sdskv_client_trace(provider->client, "sdskv_exists_packed_multi_db",
+                       trace_id, trace_start, NULL, in.keys_bulk_size);
+    margo_free_output(handle, &out);
+
+destroy_handle:
+    margo_destroy(handle);
+free_bulks:
+    margo_bulk_free(in.keys_bulk_handle);
+    margo_bulk_free(in.flags_bulk_handle);
+    free(exist);
+    return ret;
+}
+
+int sdskv_list_keys(
+    sdskv_provider_handle_t provider,
+    sdskv_database_id_t     db_id, // db instance
+    const void* start_key,         // we want keys strictly after this start_key
+    hg_size_t   start_ksize,       // size of the start_key
+    void**      keys,              // pointer to an array of void* pointers,
+    //     this array has size *max_keys
+    hg_size_t* ksizes, // pointer to an array of hg_size_t sizes
+    //    representing sizes allocated in
+    //     keys for each key
+    hg_size_t* max_keys) // maximum number of keys requested
+{
+    return sdskv_list_keys_with_prefix(provider, db_id, start_key, start_ksize,
+                                       NULL, 0, keys, ksizes, max_keys);
+}
+
+int sdskv_list_keys_with_prefix(
+    sdskv_provider_handle_t provider,
+    sdskv_database_id_t     db_id, // db instance
+    const void* start_key,         // we want keys strictly after this start_key
+    hg_size_t   start_ksize,       // size of the start_key
+    const void* prefix,
+    hg_size_t   prefix_size,
+    void**      keys, // pointer to an array of void* pointers,
+    //     this array has size *max_keys
+    hg_size_t* ksizes, // pointer to an array of hg_size_t sizes
+    //    representing sizes allocated in
+    //     keys for each key
+    hg_size_t* max_keys) // maximum number of keys requested
+{
+    list_keys_in_t  in;
+    list_keys_out_t out;
+    hg_return_t     hret   = HG_SUCCESS;
+    hg_handle_t     handle = HG_HANDLE_NULL;
+    int             ret    = SDSKV_SUCCESS;
+    int             i;
+
+    if (*max_keys == 0) { return SDSKV_SUCCESS; }
+
+    in.db_id              = db_id;
+    in.start_key.data     = (kv_ptr_t)start_key;
+    in.start_key.size     = start_ksize;
+    in.prefix.data        = (char*)prefix;
+    in.prefix.size        = prefix_size;
+    in.keys_bulk_handle   = HG_BULK_NULL;
+    in.ksizes_bulk_handle = HG_BULK_NULL;
+    in.max_keys           = *max_keys;
+
+    /* create bulk handle to expose the segments with key sizes */
+    hg_size_t ksize_bulk_size = (*max_keys) * sizeof(*ksizes);
+    void*     buf_ptr[1]      = {ksizes};
+    hret
+        = margo_bulk_create(provider->client->mid, 1, buf_ptr, &ksize_bulk_size,
+                            HG_BULK_READWRITE, &in.ksizes_bulk_handle);
+    if (hret != HG_SUCCESS) {
+        ret = SDSKV_MAKE_HG_ERROR(hret);
+        goto finish;
+    }
+
+    /* make sure none of the buffers is NULL or 0-sized */
+    int requesting_sizes = 0;
+    if (keys == NULL) {
+        requesting_sizes = 1;
+    } else {
+        for (i = 0; i < *max_keys; i++) {
+            if (keys[i] == NULL || ksizes[i] == 0) {
+                requesting_sizes = 1;
+                break;
+            }
+        }
+    }
+
+    /* create bulk handle to expose where the keys should be placed */
+    if (!requesting_sizes) {
+        hret = margo_bulk_create(provider->client->mid, *max_keys, keys, ksizes,
+                                 HG_BULK_WRITE_ONLY, &in.keys_bulk_handle);
+        if (hret != HG_SUCCESS) {
+            ret = SDSKV_MAKE_HG_ERROR(hret);
+            goto finish;
+        }
+    }
+
+    int      traced      = provider->client->trace != NULL;
+    uint64_t trace_id    = sdskv_new_request_id(provider->client);
+    double   trace_start = ABT_get_wtime();
+
+    /* create handle */
+    hret = margo_create(
+        provider->client->mid, provider->addr,
+        SDSKV_TRACED_RPC_ID(provider->client, list_keys, traced), &handle);
     if (hret != HG_SUCCESS) {
         ret = SDSKV_MAKE_HG_ERROR(hret);
         goto finish;
     }
 
     /* forward to provider */
-    hret = margo_provider_forward(provider->provider_id, handle, &in);
+    hret = SDSKV_TRACED_FORWARD(provider, handle, list_keys_in_t, in, trace_id,
+                                traced);
     if (hret != HG_SUCCESS) {
         ret = SDSKV_MAKE_HG_ERROR(hret);
         goto finish;
@@ -1681,6 +3637,8 @@ int sdskv_list_keys_with_prefix(
     /* set return values */
     *max_keys = out.nkeys;
     ret       = out.ret;
+    sdskv_client_trace(provider->client, "sdskv_list_keys", trace_id,
+                       trace_start, &db_id, 0);
 
 finish:
     /* free everything we created */
@@ -1794,16 +3752,22 @@ int sdskv_list_keyvals_with_prefix(
         }
     }
 
+    int      traced      = provider->client->trace != NULL;
+    uint64_t trace_id    = sdskv_new_request_id(provider->client);
+    double   trace_start = ABT_get_wtime();
+
     /* create handle */
-    hret = margo_create(provider->client->mid, provider->addr,
-                        provider->client->sdskv_list_keyvals_id, &handle);
+    hret = margo_create(
+        provider->client->mid, provider->addr,
+        SDSKV_TRACED_RPC_ID(provider->client, list_keyvals, traced), &handle);
     if (hret != HG_SUCCESS) {
         ret = SDSKV_MAKE_HG_ERROR(hret);
         goto finish;
     }
 
     /* forward to provider */
-    hret = margo_provider_forward(provider->provider_id, handle, &in);
+    hret = SDSKV_TRACED_FORWARD(provider, handle, list_keyvals_in_t, in,
+                                trace_id, traced);
     if (hret != HG_SUCCESS) {
         ret = SDSKV_MAKE_HG_ERROR(hret);
         goto finish;
@@ -1819,6 +3783,8 @@ int sdskv_list_keyvals_with_prefix(
     /* set return values */
     *max_keys = out.nkeys;
     ret       = out.ret;
+    sdskv_client_trace(provider->client, "sdskv_list_keyvals", trace_id,
+                       trace_start, &db_id, 0);
 
 finish:
     /* free everything we created */
@@ -1873,16 +3839,22 @@ int sdskv_migrate_keys(sdskv_provider_handle_t source_provider,
         goto finish;
     }
 
+    int      traced      = source_provider->client->trace != NULL;
+    uint64_t trace_id    = sdskv_new_request_id(source_provider->client);
+    double   trace_start = ABT_get_wtime();
+
     /* create handle */
-    hret = margo_create(source_provider->client->mid, source_provider->addr,
-                        source_provider->client->sdskv_migrate_key_range_id,
-                        &handle);
+    hret = margo_create(
+        source_provider->client->mid, source_provider->addr,
+        SDSKV_TRACED_RPC_ID(source_provider->client, migrate_keys, traced),
+        &handle);
     if (hret != HG_SUCCESS) {
         ret = SDSKV_MAKE_HG_ERROR(hret);
         goto finish;
     }
     /* forward to provider */
-    hret = margo_provider_forward(source_provider->provider_id, handle, &in);
+    hret = SDSKV_TRACED_FORWARD(source_provider, handle, migrate_keys_in_t, in,
+                                trace_id, traced);
     if (hret != HG_SUCCESS) {
         ret = SDSKV_MAKE_HG_ERROR(hret);
         goto finish;
@@ -1894,6 +3866,8 @@ int sdskv_migrate_keys(sdskv_provider_handle_t source_provider,
         goto finish;
     }
     ret = out.ret;
+    sdskv_client_trace(source_provider->client, "sdskv_migrate_keys", trace_id,
+                       trace_start, &source_db_id, in.bulk_size);
 
 finish:
     free(seg_sizes);
@@ -1927,16 +3901,23 @@ int sdskv_migrate_key_range(sdskv_provider_handle_t source_provider,
     in.key_ub.size        = key_range_sizes[1];
     in.key_ub.data        = (void*)key_range[1];
     in.flag               = flag;
+
+    int      traced      = source_provider->client->trace != NULL;
+    uint64_t trace_id    = sdskv_new_request_id(source_provider->client);
+    double   trace_start = ABT_get_wtime();
+
     /* create handle */
-    hret = margo_create(source_provider->client->mid, source_provider->addr,
-                        source_provider->client->sdskv_migrate_key_range_id,
-                        &handle);
+    hret = margo_create(
+        source_provider->client->mid, source_provider->addr,
+        SDSKV_TRACED_RPC_ID(source_provider->client, migrate_key_range, traced),
+        &handle);
     if (hret != HG_SUCCESS) {
         ret = SDSKV_MAKE_HG_ERROR(hret);
         goto finish;
     }
     /* forward to provider */
-    hret = margo_provider_forward(source_provider->provider_id, handle, &in);
+    hret = SDSKV_TRACED_FORWARD(source_provider, handle, migrate_key_range_in_t,
+                                in, trace_id, traced);
     if (hret != HG_SUCCESS) {
         ret = SDSKV_MAKE_HG_ERROR(hret);
         goto finish;
@@ -1948,6 +3929,8 @@ int sdskv_migrate_key_range(sdskv_provider_handle_t source_provider,
         goto finish;
     }
     ret = out.ret;
+    sdskv_client_trace(source_provider->client, "sdskv_migrate_key_range",
+                       trace_id, trace_start, &source_db_id, 0);
 finish:
     margo_free_output(handle, &out);
     margo_destroy(handle);
@@ -1975,16 +3958,24 @@ int sdskv_migrate_keys_prefixed(sdskv_provider_handle_t source_provider,
     in.key_prefix.size    = key_prefix_size;
     in.key_prefix.data    = (void*)key_prefix;
     in.flag               = flag;
+
+    int      traced      = source_provider->client->trace != NULL;
+    uint64_t trace_id    = sdskv_new_request_id(source_provider->client);
+    double   trace_start = ABT_get_wtime();
+
     /* create handle */
     hret = margo_create(source_provider->client->mid, source_provider->addr,
-                        source_provider->client->sdskv_migrate_keys_prefixed_id,
+                        SDSKV_TRACED_RPC_ID(source_provider->client,
+                                            migrate_keys_prefixed, traced),
                         &handle);
     if (hret != HG_SUCCESS) {
         ret = SDSKV_MAKE_HG_ERROR(hret);
         goto finish;
     }
     /* forward to provider */
-    hret = margo_provider_forward(source_provider->provider_id, handle, &in);
+    hret = SDSKV_TRACED_FORWARD(
+        source_provider, handle, migrate_keys_prefixed_in_t, in, trace_id,
+        traced);
     if (hret != HG_SUCCESS) {
         ret = SDSKV_MAKE_HG_ERROR(hret);
         goto finish;
@@ -1996,6 +3987,8 @@ int sdskv_migrate_keys_prefixed(sdskv_provider_handle_t source_provider,
         goto finish;
     }
     ret = out.ret;
+    sdskv_client_trace(source_provider->client, "sdskv_migrate_keys_prefixed",
+                       trace_id, trace_start, &source_db_id, 0);
 finish:
     margo_free_output(handle, &out);
     margo_destroy(handle);
@@ -2019,16 +4012,23 @@ int sdskv_migrate_all_keys(sdskv_provider_handle_t source_provider,
     in.target_provider_id = target_provider_id;
     in.target_db_id       = target_db_id;
     in.flag               = flag;
+
+    int      traced      = source_provider->client->trace != NULL;
+    uint64_t trace_id    = sdskv_new_request_id(source_provider->client);
+    double   trace_start = ABT_get_wtime();
+
     /* create handle */
-    hret = margo_create(source_provider->client->mid, source_provider->addr,
-                        source_provider->client->sdskv_migrate_all_keys_id,
-                        &handle);
+    hret = margo_create(
+        source_provider->client->mid, source_provider->addr,
+        SDSKV_TRACED_RPC_ID(source_provider->client, migrate_all_keys, traced),
+        &handle);
     if (hret != HG_SUCCESS) {
         ret = SDSKV_MAKE_HG_ERROR(hret);
         goto finish;
     }
     /* forward to provider */
-    hret = margo_provider_forward(source_provider->provider_id, handle, &in);
+    hret = SDSKV_TRACED_FORWARD(source_provider, handle, migrate_all_keys_in_t,
+                                in, trace_id, traced);
     if (hret != HG_SUCCESS) {
         ret = SDSKV_MAKE_HG_ERROR(hret);
         goto finish;
@@ -2040,6 +4040,8 @@ int sdskv_migrate_all_keys(sdskv_provider_handle_t source_provider,
         goto finish;
     }
     ret = out.ret;
+    sdskv_client_trace(source_provider->client, "sdskv_migrate_all_keys",
+                       trace_id, trace_start, &source_db_id, 0);
 finish:
     margo_free_output(handle, &out);
     margo_destroy(handle);
@@ -2065,11 +4067,17 @@ int sdskv_migrate_database(sdskv_provider_handle_t source,
     in.dest_remi_provider_id = dest_provider_id;
     in.dest_root             = dest_root;
 
-    hret = margo_create(source->client->mid, source->addr,
-                        source->client->sdskv_migrate_database_id, &handle);
+    int      traced      = source->client->trace != NULL;
+    uint64_t trace_id    = sdskv_new_request_id(source->client);
+    double   trace_start = ABT_get_wtime();
+
+    hret = margo_create(
+        source->client->mid, source->addr,
+        SDSKV_TRACED_RPC_ID(source->client, migrate_database, traced), &handle);
     if (hret != HG_SUCCESS) return SDSKV_MAKE_HG_ERROR(hret);
 
-    hret = margo_provider_forward(source->provider_id, handle, &in);
+    hret = SDSKV_TRACED_FORWARD(source, handle, migrate_database_in_t, in,
+                                trace_id, traced);
     if (hret != HG_SUCCESS) {
         margo_destroy(handle);
         return SDSKV_MAKE_HG_ERROR(hret);
@@ -2084,6 +4092,8 @@ int sdskv_migrate_database(sdskv_provider_handle_t source,
     ret              = out.ret;
     sdskv_remi_errno = out.remi_ret;
 
+    sdskv_client_trace(source->client, "sdskv_migrate_database", trace_id,
+                       trace_start, &source_db_id, 0);
     margo_free_output(handle, &out);
     margo_destroy(handle);
     return ret;
@@ -2093,3 +4103,642 @@ int sdskv_shutdown_service(sdskv_client_t client, hg_addr_t addr)
 {
     return margo_shutdown_remote_instance(client->mid, addr);
 }
+
+/* ---------------------- distributed databases ---------------------- */
+
+/* number of points each shard owns on the consistent-hashing ring */
+#define SDSKV_DIST_VNODES 64
+
+typedef struct dist_ring_point {
+    uint64_t hash;
+    size_t   shard;
+} dist_ring_point;
+
+struct sdskv_dist_database {
+    size_t                   num_shards;
+    sdskv_provider_handle_t* providers;
+    sdskv_database_id_t*     db_ids;
+    sdskv_partitioner_type_t type;
+    /* SDSKV_PARTITION_CONSISTENT_HASH */
+    dist_ring_point* ring;
+    size_t           ring_size;
+    /* SDSKV_PARTITION_RANGE */
+    void**     split_keys;
+    hg_size_t* split_ksizes;
+    /* SDSKV_PARTITION_CUSTOM */
+    sdskv_partition_fn partition_fn;
+    void*              partition_uargs;
+};
+
+/* 64-bit FNV-1a */
+static uint64_t dist_hash_key(const void* key, hg_size_t ksize)
+{
+    const unsigned char* p = (const unsigned char*)key;
+    uint64_t             h = 14695981039346656037ULL;
+    hg_size_t            i;
+    for (i = 0; i < ksize; i++) {
+        h ^= p[i];
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+/* splitmix64 finalizer, spreads FNV hashes over the whole ring */
+static uint64_t dist_mix(uint64_t x)
+{
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+/* Lamping & Veach, "A Fast, Minimal Memory, Consistent Hash Algorithm" */
+static size_t dist_jump_hash(uint64_t key, size_t num_buckets)
+{
+    int64_t b = -1, j = 0;
+    while (j < (int64_t)num_buckets) {
+        b   = j;
+        key = key * 2862933555777941757ULL + 1;
+        j   = (int64_t)((b + 1)
+                      * ((double)(1LL << 31) / (double)((key >> 33) + 1)));
+    }
+    return (size_t)b;
+}
+
+static int dist_compare_ring_points(const void* a, const void* b)
+{
+    const dist_ring_point* pa = (const dist_ring_point*)a;
+    const dist_ring_point* pb = (const dist_ring_point*)b;
+    if (pa->hash != pb->hash) return pa->hash < pb->hash ? -1 : 1;
+    if (pa->shard != pb->shard) return pa->shard < pb->shard ? -1 : 1;
+    return 0;
+}
+
+/* bytewise comparison, a key is smaller than any key it is a prefix of */
+static int dist_compare_keys(const void* k1,
+                             hg_size_t   s1,
+                             const void* k2,
+                             hg_size_t   s2)
+{
+    int c = memcmp(k1, k2, s1 < s2 ? s1 : s2);
+    if (c != 0) return c;
+    if (s1 == s2) return 0;
+    return s1 < s2 ? -1 : 1;
+}
+
+static void dist_free_ranges(sdskv_dist_database_t db)
+{
+    size_t i;
+    if (db->split_keys) {
+        for (i = 0; i + 1 < db->num_shards; i++) free(db->split_keys[i]);
+    }
+    free(db->split_keys);
+    free(db->split_ksizes);
+    db->split_keys   = NULL;
+    db->split_ksizes = NULL;
+}
+
+int sdskv_dist_database_create(size_t                         num_shards,
+                               const sdskv_provider_handle_t* providers,
+                               const sdskv_database_id_t*     db_ids,
+                               sdskv_partitioner_type_t       type,
+                               sdskv_dist_database_t*         db)
+{
+    size_t i, j;
+    if (num_shards == 0 || providers == NULL || db_ids == NULL || db == NULL)
+        return SDSKV_ERR_INVALID_ARG;
+    if (type != SDSKV_PARTITION_CONSISTENT_HASH
+        && type != SDSKV_PARTITION_JUMP_HASH && type != SDSKV_PARTITION_RANGE)
+        return SDSKV_ERR_INVALID_ARG;
+    for (i = 0; i < num_shards; i++)
+        if (providers[i] == SDSKV_PROVIDER_HANDLE_NULL)
+            return SDSKV_ERR_INVALID_ARG;
+
+    sdskv_dist_database_t tmp
+        = (sdskv_dist_database_t)calloc(1, sizeof(*tmp));
+    if (!tmp) return SDSKV_ERR_ALLOCATION;
+    tmp->num_shards = num_shards;
+    tmp->type       = type;
+    tmp->providers
+        = (sdskv_provider_handle_t*)malloc(num_shards * sizeof(*providers));
+    tmp->db_ids    = (sdskv_database_id_t*)malloc(num_shards * sizeof(*db_ids));
+    tmp->ring_size = num_shards * SDSKV_DIST_VNODES;
+    tmp->ring = (dist_ring_point*)malloc(tmp->ring_size * sizeof(*tmp->ring));
+    if (!tmp->providers || !tmp->db_ids || !tmp->ring) {
+        free(tmp->providers);
+        free(tmp->db_ids);
+        free(tmp->ring);
+        free(tmp);
+        return SDSKV_ERR_ALLOCATION;
+    }
+
+    for (i = 0; i < num_shards; i++) {
+        tmp->providers[i] = providers[i];
+        tmp->db_ids[i]    = db_ids[i];
+        sdskv_provider_handle_ref_incr(providers[i]);
+        /* the points of a shard only depend on its index, so appending
+         * a shard only moves the keys that land on its own points */
+        for (j = 0; j < SDSKV_DIST_VNODES; j++) {
+            dist_ring_point* p = &tmp->ring[i * SDSKV_DIST_VNODES + j];
+            p->hash            = dist_mix(((uint64_t)i << 32) | j);
+            p->shard           = i;
+        }
+    }
+    qsort(tmp->ring, tmp->ring_size, sizeof(*tmp->ring),
+          dist_compare_ring_points);
+
+    *db = tmp;
+    return SDSKV_SUCCESS;
+}
+
+int sdskv_dist_database_set_ranges(sdskv_dist_database_t db,
+                                   const void* const*    split_keys,
+                                   const hg_size_t*      split_ksizes)
+{
+    size_t i;
+    if (db == SDSKV_DIST_DATABASE_NULL) return SDSKV_ERR_INVALID_ARG;
+    size_t num_splits = db->num_shards - 1;
+    if (num_splits > 0 && (split_keys == NULL || split_ksizes == NULL))
+        return SDSKV_ERR_INVALID_ARG;
+    for (i = 1; i < num_splits; i++) {
+        if (dist_compare_keys(split_keys[i - 1], split_ksizes[i - 1],
+                              split_keys[i], split_ksizes[i])
+            >= 0)
+            return SDSKV_ERR_INVALID_ARG;
+    }
+
+    dist_free_ranges(db);
+    if (num_splits > 0) {
+        db->split_keys   = (void**)calloc(num_splits, sizeof(void*));
+        db->split_ksizes = (hg_size_t*)malloc(num_splits * sizeof(hg_size_t));
+        if (!db->split_keys || !db->split_ksizes) {
+            dist_free_ranges(db);
+            return SDSKV_ERR_ALLOCATION;
+        }
+        for (i = 0; i < num_splits; i++) {
+            db->split_keys[i] = malloc(split_ksizes[i] ? split_ksizes[i] : 1);
+            if (!db->split_keys[i]) {
+                dist_free_ranges(db);
+                return SDSKV_ERR_ALLOCATION;
+            }
+            memcpy(db->split_keys[i], split_keys[i], split_ksizes[i]);
+            db->split_ksizes[i] = split_ksizes[i];
+        }
+    }
+    db->type = SDSKV_PARTITION_RANGE;
+    return SDSKV_SUCCESS;
+}
+
+int sdskv_dist_database_set_partitioner(sdskv_dist_database_t db,
+                                        sdskv_partition_fn    fn,
+                                        void*                 uargs)
+{
+    if (db == SDSKV_DIST_DATABASE_NULL || fn == NULL)
+        return SDSKV_ERR_INVALID_ARG;
+    db->partition_fn    = fn;
+    db->partition_uargs = uargs;
+    db->type            = SDSKV_PARTITION_CUSTOM;
+    return SDSKV_SUCCESS;
+}
+
+int sdskv_dist_database_free(sdskv_dist_database_t db)
+{
+    size_t i;
+    if (db == SDSKV_DIST_DATABASE_NULL) return SDSKV_SUCCESS;
+    for (i = 0; i < db->num_shards; i++)
+        sdskv_provider_handle_release(db->providers[i]);
+    dist_free_ranges(db);
+    free(db->providers);
+    free(db->db_ids);
+    free(db->ring);
+    free(db);
+    return SDSKV_SUCCESS;
+}
+
+int sdskv_dist_database_num_shards(sdskv_dist_database_t db, size_t* num)
+{
+    if (db == SDSKV_DIST_DATABASE_NULL) return SDSKV_ERR_INVALID_ARG;
+    *num = db->num_shards;
+    return SDSKV_SUCCESS;
+}
+
+int sdskv_dist_database_locate(sdskv_dist_database_t db,
+                               const void*           key,
+                               hg_size_t             ksize,
+                               size_t*               shard)
+{
+    size_t lo, hi, mid;
+    if (db == SDSKV_DIST_DATABASE_NULL) return SDSKV_ERR_INVALID_ARG;
+
+    switch (db->type) {
+    case SDSKV_PARTITION_CONSISTENT_HASH: {
+        /* first point clockwise from the key's hash */
+        uint64_t h = dist_mix(dist_hash_key(key, ksize));
+        lo         = 0;
+        hi         = db->ring_size;
+        while (lo < hi) {
+            mid = (lo + hi) / 2;
+            if (db->ring[mid].hash < h)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        if (lo == db->ring_size) lo = 0;
+        *shard = db->ring[lo].shard;
+        return SDSKV_SUCCESS;
+    }
+    case SDSKV_PARTITION_JUMP_HASH:
+        *shard = dist_jump_hash(dist_hash_key(key, ksize), db->num_shards);
+        return SDSKV_SUCCESS;
+    case SDSKV_PARTITION_RANGE:
+        if (db->num_shards > 1 && db->split_keys == NULL)
+            return SDSKV_ERR_INVALID_ARG;
+        /* shard i holds the keys in [split_keys[i-1], split_keys[i]) */
+        lo = 0;
+        hi = db->num_shards - 1;
+        while (lo < hi) {
+            mid = (lo + hi) / 2;
+            if (dist_compare_keys(db->split_keys[mid], db->split_ksizes[mid],
+                                  key, ksize)
+                <= 0)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        *shard = lo;
+        return SDSKV_SUCCESS;
+    case SDSKV_PARTITION_CUSTOM:
+        *shard = db->partition_fn(key, ksize, db->num_shards,
+                                  db->partition_uargs);
+        if (*shard >= db->num_shards) return SDSKV_ERR_INVALID_ARG;
+        return SDSKV_SUCCESS;
+    }
+    return SDSKV_ERR_INVALID_ARG;
+}
+
+int sdskv_dist_database_shard(sdskv_dist_database_t    db,
+                              size_t                   shard,
+                              sdskv_provider_handle_t* provider,
+                              sdskv_database_id_t*     db_id)
+{
+    if (db == SDSKV_DIST_DATABASE_NULL || shard >= db->num_shards)
+        return SDSKV_ERR_INVALID_ARG;
+    if (provider) *provider = db->providers[shard];
+    if (db_id) *db_id = db->db_ids[shard];
+    return SDSKV_SUCCESS;
+}
+
+int sdskv_dist_database_overlaps(sdskv_dist_database_t db,
+                                 size_t                shard,
+                                 const void*           start_key,
+                                 hg_size_t             start_ksize,
+                                 const void*           prefix,
+                                 hg_size_t             prefix_size,
+                                 int*                  flag)
+{
+    if (db == SDSKV_DIST_DATABASE_NULL || shard >= db->num_shards)
+        return SDSKV_ERR_INVALID_ARG;
+    *flag = 1;
+    /* only range partitioning tells where keys are */
+    if (db->type != SDSKV_PARTITION_RANGE || db->split_keys == NULL)
+        return SDSKV_SUCCESS;
+
+    /* the shard holds keys in [lo, hi), a missing bound being infinite */
+    const void* lo      = shard > 0 ? db->split_keys[shard - 1] : NULL;
+    hg_size_t   lo_size = shard > 0 ? db->split_ksizes[shard - 1] : 0;
+    const void* hi
+        = shard + 1 < db->num_shards ? db->split_keys[shard] : NULL;
+    hg_size_t hi_size = hi ? db->split_ksizes[shard] : 0;
+
+    /* returned keys are strictly greater than the start key */
+    if (hi && start_ksize
+        && dist_compare_keys(hi, hi_size, start_key, start_ksize) <= 0) {
+        *flag = 0;
+        return SDSKV_SUCCESS;
+    }
+    if (prefix_size == 0) return SDSKV_SUCCESS;
+
+    /* keys with the prefix are in [prefix, succ(prefix)), where succ
+     * increments the last byte that is not 0xff and drops the rest */
+    if (hi && dist_compare_keys(hi, hi_size, prefix, prefix_size) <= 0) {
+        *flag = 0;
+        return SDSKV_SUCCESS;
+    }
+    if (lo) {
+        const unsigned char* p = (const unsigned char*)prefix;
+        hg_size_t            n = prefix_size;
+        while (n > 0 && p[n - 1] == 0xff) n--;
+        if (n > 0) {
+            unsigned char* succ = (unsigned char*)malloc(n);
+            if (!succ) return SDSKV_ERR_ALLOCATION;
+            memcpy(succ, p, n);
+            succ[n - 1] += 1;
+            if (dist_compare_keys(lo, lo_size, succ, n) >= 0) *flag = 0;
+            free(succ);
+        }
+    }
+    return SDSKV_SUCCESS;
+}
+
+int sdskv_dist_put(sdskv_dist_database_t db,
+                   const void*           key,
+                   hg_size_t             ksize,
+                   const void*           value,
+                   hg_size_t             vsize)
+{
+    size_t s;
+    int    ret = sdskv_dist_database_locate(db, key, ksize, &s);
+    if (ret != SDSKV_SUCCESS) return ret;
+    return sdskv_put(db->providers[s], db->db_ids[s], key, ksize, value,
+                     vsize);
+}
+
+int sdskv_dist_get(sdskv_dist_database_t db,
+                   const void*           key,
+                   hg_size_t             ksize,
+                   void*                 value,
+                   hg_size_t*            vsize)
+{
+    size_t s;
+    int    ret = sdskv_dist_database_locate(db, key, ksize, &s);
+    if (ret != SDSKV_SUCCESS) return ret;
+    return sdskv_get(db->providers[s], db->db_ids[s], key, ksize, value,
+                     vsize);
+}
+
+int sdskv_dist_exists(sdskv_dist_database_t db,
+                      const void*           key,
+                      hg_size_t             ksize,
+                      int*                  flag)
+{
+    size_t s;
+    int    ret = sdskv_dist_database_locate(db, key, ksize, &s);
+    if (ret != SDSKV_SUCCESS) return ret;
+    return sdskv_exists(db->providers[s], db->db_ids[s], key, ksize, flag);
+}
+
+int sdskv_dist_length(sdskv_dist_database_t db,
+                      const void*           key,
+                      hg_size_t             ksize,
+                      hg_size_t*            vsize)
+{
+    size_t s;
+    int    ret = sdskv_dist_database_locate(db, key, ksize, &s);
+    if (ret != SDSKV_SUCCESS) return ret;
+    return sdskv_length(db->providers[s], db->db_ids[s], key, ksize, vsize);
+}
+
+int sdskv_dist_erase(sdskv_dist_database_t db,
+                     const void*           key,
+                     hg_size_t             ksize)
+{
+    size_t s;
+    int    ret = sdskv_dist_database_locate(db, key, ksize, &s);
+    if (ret != SDSKV_SUCCESS) return ret;
+    return sdskv_erase(db->providers[s], db->db_ids[s], key, ksize);
+}
+
+typedef enum dist_op_kind
+{
+    DIST_PUT,
+    DIST_GET,
+    DIST_EXISTS,
+    DIST_LENGTH,
+    DIST_ERASE
+} dist_op_kind;
+
+/* the part of a multi-key operation that targets a single shard */
+typedef struct dist_sub_batch {
+    dist_op_kind            kind;
+    sdskv_provider_handle_t provider;
+    sdskv_database_id_t     db_id;
+    size_t                  num;
+    const void**            keys;
+    hg_size_t*              ksizes;
+    void**                  values;
+    hg_size_t*              vsizes;
+    int*                    flags;
+    int                     ret;
+} dist_sub_batch;
+
+static void dist_sub_batch_ult(void* arg)
+{
+    dist_sub_batch* b = (dist_sub_batch*)arg;
+    switch (b->kind) {
+    case DIST_PUT:
+        b->ret = sdskv_put_multi(b->provider, b->db_id, b->num, b->keys,
+                                 b->ksizes, (const void* const*)b->values,
+                                 b->vsizes);
+        break;
+    case DIST_GET:
+        b->ret = sdskv_get_multi(b->provider, b->db_id, b->num, b->keys,
+                                 b->ksizes, b->values, b->vsizes);
+        break;
+    case DIST_EXISTS:
+        b->ret = sdskv_exists_multi(b->provider, b->db_id, b->num, b->keys,
+                                    b->ksizes, b->flags);
+        break;
+    case DIST_LENGTH:
+        b->ret = sdskv_length_multi(b->provider, b->db_id, b->num, b->keys,
+                                    b->ksizes, b->vsizes);
+        break;
+    case DIST_ERASE:
+        b->ret = sdskv_erase_multi_with_flags(b->provider, b->db_id, b->num,
+                                              b->keys, b->ksizes, b->flags);
+        break;
+    }
+}
+
+/* Groups the keys by shard and issues one sub-batch per shard. The
+ * sub-batches run in separate ULTs so their RPCs are in flight at the
+ * same time; the calling ULT blocks until all of them have completed. */
+static int dist_multi(sdskv_dist_database_t db,
+                      dist_op_kind          kind,
+                      size_t                num,
+                      const void* const*    keys,
+                      const hg_size_t*      ksizes,
+                      void**                values,
+                      hg_size_t*            vsizes,
+                      int*                  flags)
+{
+    int             ret = SDSKV_SUCCESS;
+    size_t          i, s, g, nonempty = 0;
+    size_t          num_shards = 0;
+    size_t*         shard_of   = NULL;
+    size_t*         offsets    = NULL;
+    size_t*         cursors    = NULL;
+    size_t*         perm       = NULL;
+    const void**    keys_g     = NULL;
+    hg_size_t*      ksizes_g   = NULL;
+    void**          values_g   = NULL;
+    hg_size_t*      vsizes_g   = NULL;
+    int*            flags_g    = NULL;
+    dist_sub_batch* subs       = NULL;
+    ABT_thread*     threads    = NULL;
+    ABT_pool        pool       = ABT_POOL_NULL;
+
+    if (db == SDSKV_DIST_DATABASE_NULL) return SDSKV_ERR_INVALID_ARG;
+    if (num == 0) return SDSKV_SUCCESS;
+    num_shards = db->num_shards;
+
+    shard_of = (size_t*)malloc(num * sizeof(size_t));
+    perm     = (size_t*)malloc(num * sizeof(size_t));
+    offsets  = (size_t*)calloc(num_shards + 1, sizeof(size_t));
+    cursors  = (size_t*)malloc(num_shards * sizeof(size_t));
+    keys_g   = (const void**)malloc(num * sizeof(void*));
+    ksizes_g = (hg_size_t*)malloc(num * sizeof(hg_size_t));
+    subs     = (dist_sub_batch*)calloc(num_shards, sizeof(dist_sub_batch));
+    threads  = (ABT_thread*)malloc(num_shards * sizeof(ABT_thread));
+    if (values) values_g = (void**)malloc(num * sizeof(void*));
+    if (vsizes) vsizes_g = (hg_size_t*)malloc(num * sizeof(hg_size_t));
+    if (flags) flags_g = (int*)malloc(num * sizeof(int));
+    if (!shard_of || !perm || !offsets || !cursors || !keys_g || !ksizes_g
+        || !subs || !threads || (values && !values_g) || (vsizes && !vsizes_g)
+        || (flags && !flags_g)) {
+        ret = SDSKV_ERR_ALLOCATION;
+        goto finish;
+    }
+
+    for (i = 0; i < num; i++) {
+        ret = sdskv_dist_database_locate(db, keys[i], ksizes[i], &shard_of[i]);
+        if (ret != SDSKV_SUCCESS) goto finish;
+        offsets[shard_of[i] + 1] += 1;
+    }
+    for (s = 0; s < num_shards; s++) {
+        offsets[s + 1] += offsets[s];
+        cursors[s] = offsets[s];
+    }
+
+    /* gather the arguments so that each shard sees contiguous arrays */
+    for (i = 0; i < num; i++) {
+        g           = cursors[shard_of[i]]++;
+        perm[g]     = i;
+        keys_g[g]   = keys[i];
+        ksizes_g[g] = ksizes[i];
+        if (values_g) values_g[g] = values[i];
+        if (vsizes_g) vsizes_g[g] = vsizes[i];
+    }
+
+    for (s = 0; s < num_shards; s++) {
+        threads[s] = ABT_THREAD_NULL;
+        if (offsets[s + 1] == offsets[s]) continue;
+        nonempty += 1;
+        dist_sub_batch* b = &subs[s];
+        b->kind           = kind;
+        b->provider       = db->providers[s];
+        b->db_id          = db->db_ids[s];
+        b->num            = offsets[s + 1] - offsets[s];
+        b->keys           = keys_g + offsets[s];
+        b->ksizes         = ksizes_g + offsets[s];
+        b->values         = values_g ? values_g + offsets[s] : NULL;
+        b->vsizes         = vsizes_g ? vsizes_g + offsets[s] : NULL;
+        b->flags          = flags_g ? flags_g + offsets[s] : NULL;
+        b->ret            = SDSKV_SUCCESS;
+    }
+
+    if (nonempty > 1)
+        margo_get_handler_pool(db->providers[0]->client->mid, &pool);
+
+    for (s = 0; s < num_shards; s++) {
+        if (subs[s].num == 0) continue;
+        if (pool == ABT_POOL_NULL
+            || ABT_thread_create(pool, dist_sub_batch_ult, &subs[s],
+                                 ABT_THREAD_ATTR_NULL, &threads[s])
+                   != ABT_SUCCESS) {
+            threads[s] = ABT_THREAD_NULL;
+            dist_sub_batch_ult(&subs[s]);
+        }
+    }
+    for (s = 0; s < num_shards; s++) {
+        if (threads[s] == ABT_THREAD_NULL) continue;
+        ABT_thread_join(threads[s]);
+        ABT_thread_free(&threads[s]);
+    }
+
+    /* report the first error, in shard order */
+    for (s = 0; s < num_shards; s++) {
+        if (subs[s].num != 0 && subs[s].ret != SDSKV_SUCCESS) {
+            ret = subs[s].ret;
+            break;
+        }
+    }
+
+    /* scatter the outputs back to the caller's order */
+    for (g = 0; g < num; g++) {
+        i = perm[g];
+        if (vsizes && kind != DIST_PUT) vsizes[i] = vsizes_g[g];
+        if (flags) flags[i] = flags_g[g];
+    }
+
+finish:
+    free(shard_of);
+    free(perm);
+    free(offsets);
+    free(cursors);
+    free(keys_g);
+    free(ksizes_g);
+    free(values_g);
+    free(vsizes_g);
+    free(flags_g);
+    free(subs);
+    free(threads);
+    return ret;
+}
+
+int sdskv_dist_put_multi(sdskv_dist_database_t db,
+                         size_t                num,
+                         const void* const*    keys,
+                         const hg_size_t*      ksizes,
+                         const void* const*    values,
+                         const hg_size_t*      vsizes)
+{
+    return dist_multi(db, DIST_PUT, num, keys, ksizes, (void**)values,
+                      (hg_size_t*)vsizes, NULL);
+}
+
+int sdskv_dist_get_multi(sdskv_dist_database_t db,
+                         size_t                num,
+                         const void* const*    keys,
+                         const hg_size_t*      ksizes,
+                         void**                values,
+                         hg_size_t*            vsizes)
+{
+    return dist_multi(db, DIST_GET, num, keys, ksizes, values, vsizes, NULL);
+}
+
+int sdskv_dist_exists_multi(sdskv_dist_database_t db,
+                            size_t                num,
+                            const void* const*    keys,
+                            const hg_size_t*      ksizes,
+                            int*                  flags)
+{
+    return dist_multi(db, DIST_EXISTS, num, keys, ksizes, NULL, NULL, flags);
+}
+
+int sdskv_dist_length_multi(sdskv_dist_database_t db,
+                            size_t                num,
+                            const void* const*    keys,
+                            const hg_size_t*      ksizes,
+                            hg_size_t*            vsizes)
+{
+    return dist_multi(db, DIST_LENGTH, num, keys, ksizes, NULL, vsizes, NULL);
+}
+
+int sdskv_dist_erase_multi(sdskv_dist_database_t db,
+                           size_t                num,
+                           const void* const*    keys,
+                           const hg_size_t*      ksizes)
+{
+    return dist_multi(db, DIST_ERASE, num, keys, ksizes, NULL, NULL, NULL);
+}
+
+int sdskv_dist_erase_multi_with_flags(sdskv_dist_database_t db,
+                                      size_t                num,
+                                      const void* const*    keys,
+                                      const hg_size_t*      ksizes,
+                                      int*                  flags)
+{
+    return dist_multi(db, DIST_ERASE, num, keys, ksizes, NULL, NULL, flags);
+}
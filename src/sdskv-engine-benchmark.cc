@@ -0,0 +1,440 @@
+#define SDSKV
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+#include <fstream>
+#include <memory>
+#include <random>
+#include <algorithm>
+#include <vector>
+#include <string>
+#include <ftw.h>
+#include <unistd.h>
+#include <abt.h>
+#include <json/json.h>
+#include "datastore/datastore_factory.h"
+#include "sdskv-metrics.h"
+#include "sdskv-benchmark-util.h"
+
+/**
+ * sdskv-engine-benchmark drives AbstractDataStore instances directly, as
+ * created by datastore_factory::open_datastore, from a number of ULTs
+ * spread over a number of execution streams. Nothing goes through Mercury
+ * or Margo, so comparing its latencies with those of sdskv-benchmark tells
+ * how much of the cost of an operation comes from the backend itself.
+ */
+
+/**
+ * EngineBenchmark runs one type of operation (put, get, put-packed,
+ * list-keys or erase) against one engine. Each repetition opens a fresh
+ * database, stores num-entries key/value pairs in it if the operation needs
+ * them (not part of the measure), then has the ULTs share operation-count
+ * operations. The database and its files are removed at the end of each
+ * repetition. Latencies of all the repetitions go into one histogram.
+ *
+ * Keys are the zero-padded record number followed by random characters up
+ * to the requested size, in a random order, so that "sequential" accesses
+ * do not follow the key order. They are picked following the
+ * key-distribution: "sequential" (each operation uses the next key),
+ * "uniform" or "zipfian". Erases always use sequential keys so that each
+ * one removes an existing key.
+ *
+ * Puts and erases go through AbstractDataStore::grouped_put/grouped_erase,
+ * as in the provider, so that setting group-commit shows the effect of
+ * group commit on the backend.
+ */
+class EngineBenchmark {
+
+    enum op_t { PUT, GET, PUT_PACKED, LIST_KEYS, ERASE };
+    enum distribution_t { SEQUENTIAL, UNIFORM, ZIPFIAN };
+
+    struct worker_args {
+        EngineBenchmark* bench;
+        unsigned         rank;
+        uint64_t         errors;
+    };
+
+    op_t                      m_op;
+    sdskv_db_type_t           m_db_type;
+    std::string               m_path;
+    distribution_t            m_distribution;
+    uint64_t                  m_num_entries;
+    uint64_t                  m_operation_count;
+    std::pair<size_t, size_t> m_key_size_range;
+    std::pair<size_t, size_t> m_val_size_range;
+    size_t                    m_batch_size;
+    size_t                    m_list_size;
+    unsigned                  m_threads;
+    uint64_t                  m_seed;
+    bool                      m_group_commit;
+    std::vector<ds_bulk_t>    m_keys;
+    std::vector<uint64_t>     m_keys_after; /* keys sorting after each one */
+    std::vector<size_t>       m_val_sizes;
+    std::string               m_value_pool;
+    ZipfianGenerator          m_zipfian;
+    AbstractDataStore*        m_db = nullptr;
+
+    /* statistics, accumulated over the repetitions */
+    LatencyHistogram m_histogram;
+    uint64_t         m_errors  = 0;
+    double           m_elapsed = 0.0;
+
+    static std::pair<size_t, size_t> parse_range(const Json::Value& v,
+                                                 const char*        name)
+    {
+        if (v.isIntegral()) {
+            auto x = v.asUInt64();
+            return {x, x + 1};
+        }
+        if (v.isArray() && v.size() == 2) {
+            auto x = v[0].asUInt64();
+            auto y = v[1].asUInt64();
+            if (x >= y)
+                throw std::range_error(std::string("invalid ") + name
+                                       + " range");
+            return {x, y};
+        }
+        throw std::range_error(std::string("invalid ") + name
+                               + " range or value");
+    }
+
+    static int remove_file(const char* path, const struct stat*, int,
+                           struct FTW*)
+    {
+        return ::remove(path);
+    }
+
+    uint64_t next_key(uint64_t i, std::mt19937_64& rng) const
+    {
+        switch (m_distribution) {
+        case UNIFORM:
+            return std::uniform_int_distribution<uint64_t>(
+                0, m_num_entries - 1)(rng);
+        case ZIPFIAN:
+            return m_zipfian.next(rng);
+        default:
+            return i % m_num_entries;
+        }
+    }
+
+    template <typename F> void timed(F&& f)
+    {
+        double start = ABT_get_wtime();
+        f();
+        m_histogram.record((uint64_t)((ABT_get_wtime() - start) * 1e9));
+    }
+
+    void generate(std::mt19937_64& rng)
+    {
+        static const char alphanum[]
+            = "0123456789"
+              "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
+              "abcdefghijklmnopqrstuvwxyz";
+        size_t width = std::to_string(m_num_entries - 1).size();
+        m_keys.resize(m_num_entries);
+        m_val_sizes.resize(m_num_entries);
+        for (uint64_t i = 0; i < m_num_entries; i++) {
+            size_t ksize = std::uniform_int_distribution<size_t>(
+                m_key_size_range.first, m_key_size_range.second - 1)(rng);
+            std::string k = std::to_string(i);
+            k.insert(0, width - k.size(), '0');
+            while (k.size() < ksize)
+                k += alphanum[rng() % (sizeof(alphanum) - 1)];
+            m_keys[i] = ds_bulk_t(k.begin(), k.end());
+            m_val_sizes[i] = std::uniform_int_distribution<size_t>(
+                m_val_size_range.first, m_val_size_range.second - 1)(rng);
+        }
+        std::shuffle(m_keys.begin(), m_keys.end(), rng);
+        /* how many keys list-keys can find after each key */
+        std::vector<uint64_t> order(m_num_entries);
+        for (uint64_t i = 0; i < m_num_entries; i++) order[i] = i;
+        std::sort(order.begin(), order.end(), [this](uint64_t a, uint64_t b) {
+            return m_keys[a] < m_keys[b];
+        });
+        m_keys_after.resize(m_num_entries);
+        for (uint64_t r = 0; r < m_num_entries; r++)
+            m_keys_after[order[r]] = m_num_entries - 1 - r;
+        m_value_pool.resize(m_val_size_range.second);
+        for (auto& c : m_value_pool)
+            c = alphanum[rng() % (sizeof(alphanum) - 1)];
+    }
+
+    void run_operations(worker_args* args)
+    {
+        std::mt19937_64        rng(m_seed + args->rank);
+        ds_bulk_t              data;
+        std::string            packed_keys, packed_vals;
+        std::vector<hg_size_t> ksizes, vsizes;
+        for (uint64_t i = args->rank; i < m_operation_count; i += m_threads) {
+            switch (m_op) {
+            case PUT: {
+                uint64_t k  = next_key(i, rng);
+                int      r = 0;
+                timed([&] {
+                    r = m_db->grouped_put(m_keys[k].data(), m_keys[k].size(),
+                                          m_value_pool.data(), m_val_sizes[k]);
+                });
+                if (r != SDSKV_SUCCESS) args->errors += 1;
+            } break;
+            case GET: {
+                uint64_t k     = next_key(i, rng);
+                bool     found = false;
+                timed([&] { found = m_db->get(m_keys[k], data); });
+                if (!found) args->errors += 1;
+            } break;
+            case PUT_PACKED: {
+                packed_keys.clear();
+                packed_vals.clear();
+                ksizes.clear();
+                vsizes.clear();
+                for (size_t j = 0; j < m_batch_size; j++) {
+                    uint64_t k = next_key(i * m_batch_size + j, rng);
+                    packed_keys.append(m_keys[k].begin(), m_keys[k].end());
+                    packed_vals.append(m_value_pool, 0, m_val_sizes[k]);
+                    ksizes.push_back(m_keys[k].size());
+                    vsizes.push_back(m_val_sizes[k]);
+                }
+                int r = 0;
+                timed([&] {
+                    r = m_db->put_packed(m_batch_size, packed_keys.data(),
+                                         ksizes.data(), packed_vals.data(),
+                                         vsizes.data());
+                });
+                if (r != SDSKV_SUCCESS) args->errors += 1;
+            } break;
+            case LIST_KEYS: {
+                uint64_t               k = next_key(i, rng);
+                std::vector<ds_bulk_t> keys;
+                timed([&] {
+                    keys = m_db->list_keys(m_keys[k], m_list_size);
+                });
+                if (keys.size() != std::min<uint64_t>(m_list_size,
+                                                      m_keys_after[k]))
+                    args->errors += 1;
+            } break;
+            case ERASE: {
+                int r = 0;
+                timed([&] {
+                    r = m_db->grouped_erase(m_keys[i].data(),
+                                            m_keys[i].size());
+                });
+                if (r != SDSKV_SUCCESS) args->errors += 1;
+            } break;
+            }
+        }
+    }
+
+    static void run_worker(void* a)
+    {
+        worker_args* args = static_cast<worker_args*>(a);
+        args->bench->run_operations(args);
+    }
+
+  public:
+    EngineBenchmark(const Json::Value& config,
+                    sdskv_db_type_t    db_type,
+                    const std::string& path,
+                    unsigned           threads,
+                    uint64_t           seed)
+        : m_db_type(db_type), m_path(path), m_seed(seed)
+    {
+        std::string type = config["type"].asString();
+        if (type == "put")
+            m_op = PUT;
+        else if (type == "get")
+            m_op = GET;
+        else if (type == "put-packed")
+            m_op = PUT_PACKED;
+        else if (type == "list-keys")
+            m_op = LIST_KEYS;
+        else if (type == "erase")
+            m_op = ERASE;
+        else
+            throw std::invalid_argument(type + " benchmark type unknown");
+        std::string dist
+            = config.get("key-distribution", "sequential").asString();
+        if (dist == "sequential")
+            m_distribution = SEQUENTIAL;
+        else if (dist == "uniform")
+            m_distribution = UNIFORM;
+        else if (dist == "zipfian")
+            m_distribution = ZIPFIAN;
+        else
+            throw std::invalid_argument("unknown key-distribution " + dist);
+        m_num_entries = config.get("num-entries", 10000).asUInt64();
+        if (m_num_entries == 0)
+            throw std::range_error("num-entries must be positive");
+        m_operation_count
+            = config.get("operation-count", (Json::UInt64)m_num_entries)
+                  .asUInt64();
+        if (m_op == ERASE)
+            m_operation_count = std::min(m_operation_count, m_num_entries);
+        m_key_size_range = parse_range(config["key-sizes"], "key-sizes");
+        m_val_size_range = parse_range(config["val-sizes"], "val-sizes");
+        m_batch_size     = config.get("batch-size", 64).asUInt64();
+        m_list_size      = config.get("list-size", 16).asUInt64();
+        m_threads        = config.get("threads", threads).asUInt();
+        m_group_commit   = config.get("group-commit", false).asBool();
+        if (m_batch_size == 0 || m_threads == 0)
+            throw std::range_error("batch-size and threads must be positive");
+        if (m_distribution == ZIPFIAN) m_zipfian.resize(m_num_entries);
+    }
+
+    /**
+     * @brief Runs one repetition with ULTs pushed into pool. Returns false
+     * if the engine could not be opened (e.g. it is not compiled in).
+     */
+    bool run(ABT_pool pool)
+    {
+        std::mt19937_64 rng(m_seed);
+        if (m_keys.empty()) generate(rng);
+        std::string dir = m_path + "/sdskv-engine-benchmark-"
+                        + std::to_string(getpid());
+        m_db = datastore_factory::open_datastore(m_db_type, "bench", dir);
+        if (!m_db) return false;
+        m_db->set_group_commit(m_group_commit);
+        // store the keys the operation needs (not measured)
+        if (m_op != PUT && m_op != PUT_PACKED) {
+            for (uint64_t i = 0; i < m_num_entries; i++)
+                m_db->put(m_keys[i].data(), m_keys[i].size(),
+                          m_value_pool.data(), m_val_sizes[i]);
+        }
+        std::vector<worker_args> args(m_threads);
+        std::vector<ABT_thread>  ults(m_threads);
+        double                   start = ABT_get_wtime();
+        for (unsigned t = 0; t < m_threads; t++) {
+            args[t] = {this, t, 0};
+            ABT_thread_create(pool, run_worker, &args[t],
+                              ABT_THREAD_ATTR_NULL, &ults[t]);
+        }
+        for (unsigned t = 0; t < m_threads; t++) {
+            ABT_thread_join(ults[t]);
+            ABT_thread_free(&ults[t]);
+            m_errors += args[t].errors;
+        }
+        m_elapsed += ABT_get_wtime() - start;
+        delete m_db;
+        m_db = nullptr;
+        nftw(dir.c_str(), remove_file, 16, FTW_DEPTH | FTW_PHYS);
+        return true;
+    }
+
+    void report() const
+    {
+        const unsigned n         = LatencyHistogram::num_buckets;
+        uint64_t       counts[n] = {0};
+        uint64_t       count = 0, sum = 0, max = 0;
+        m_histogram.accumulate(counts, count, sum, max);
+        if (count == 0) return;
+        auto percentile = [&](double q) {
+            return LatencyHistogram::percentile(counts, count, max, q);
+        };
+        std::cout << std::setprecision(3) << std::fixed;
+        std::cout << "Threads         : " << m_threads << std::endl;
+        std::cout << "Operations      : " << count << std::endl;
+        std::cout << "Errors          : " << m_errors << std::endl;
+        std::cout << "Throughput(op/s): " << count / m_elapsed << std::endl;
+        if (m_op == PUT_PACKED)
+            std::cout << "Throughput(kv/s): "
+                      << count * m_batch_size / m_elapsed << std::endl;
+        std::cout << "Average(usec)   : " << sum / 1e3 / count << std::endl;
+        std::cout << "P50(usec)       : " << percentile(0.5) << std::endl;
+        std::cout << "P99(usec)       : " << percentile(0.99) << std::endl;
+        std::cout << "P999(usec)      : " << percentile(0.999) << std::endl;
+        std::cout << "Maximum(usec)   : " << max / 1e3 << std::endl;
+    }
+};
+
+/**
+ * @brief Main function.
+ */
+int main(int argc, char** argv)
+{
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <config.json> [ a.b.c=x ... ]"
+                  << std::endl;
+        return -1;
+    }
+
+    std::ifstream config_file(argv[1]);
+    if (!config_file.good()) {
+        std::cerr << "Could not read configuration file " << argv[1]
+                  << std::endl;
+        return -1;
+    }
+
+    Json::Value config;
+    config_file >> config;
+
+    for (int i = 2; i < argc; i++) { parse_extra_cmd_arg(config, argv[i]); }
+
+    // all the execution streams share a single pool of ULTs
+    unsigned num_xstreams = config.get("xstreams", 1).asUInt();
+    if (num_xstreams == 0) num_xstreams = 1;
+    ABT_init(argc, argv);
+    ABT_pool    pool;
+    ABT_xstream self;
+    ABT_pool_create_basic(ABT_POOL_FIFO, ABT_POOL_ACCESS_MPMC, ABT_TRUE,
+                          &pool);
+    ABT_xstream_self(&self);
+    ABT_xstream_set_main_sched_basic(self, ABT_SCHED_DEFAULT, 1, &pool);
+    std::vector<ABT_xstream> xstreams(num_xstreams - 1);
+    for (auto& xstream : xstreams)
+        ABT_xstream_create_basic(ABT_SCHED_DEFAULT, 1, &pool,
+                                 ABT_SCHED_CONFIG_NULL, &xstream);
+
+    Json::StyledStreamWriter styledStream;
+    std::string              path    = config.get("path", "/tmp").asString();
+    unsigned                 threads = config.get("threads", 1).asUInt();
+    uint64_t                 seed    = config["seed"].asUInt64();
+    Json::Value              engines = config["engines"];
+    if (!engines.isArray()) {
+        engines = Json::Value(Json::arrayValue);
+        engines.append(config.get("engine", "map"));
+    }
+    Json::Value benchmarks = config["benchmarks"];
+    if (!benchmarks.isArray()) {
+        benchmarks = Json::Value(Json::arrayValue);
+        benchmarks.append(config["benchmarks"]);
+    }
+
+    int ret = 0;
+    try {
+        for (auto& engine : engines) {
+            std::string     engine_name = engine.asString();
+            sdskv_db_type_t db_type = database_type_from_string(engine_name);
+            for (auto& bench_config : benchmarks) {
+                EngineBenchmark bench(bench_config, db_type, path, threads,
+                                      seed);
+                unsigned rep = bench_config.get("repetitions", 1).asUInt();
+                bool     ok  = true;
+                for (unsigned j = 0; j < rep && ok; j++) ok = bench.run(pool);
+                if (!ok) {
+                    std::cerr << "Could not open a " << engine_name
+                              << " database in " << path << ", skipping"
+                              << std::endl;
+                    break;
+                }
+                std::string title = bench_config["type"].asString() + " ("
+                                  + engine_name + ")";
+                std::cout << "================ " << title
+                          << " ================" << std::endl;
+                styledStream.write(std::cout, bench_config);
+                std::cout << "-----------------"
+                          << std::string(title.size(), '-')
+                          << "-----------------" << std::endl;
+                bench.report();
+            }
+        }
+    } catch (const std::exception& ex) {
+        std::cerr << ex.what() << std::endl;
+        ret = -1;
+    }
+
+    for (auto& xstream : xstreams) {
+        ABT_xstream_join(xstream);
+        ABT_xstream_free(&xstream);
+    }
+    ABT_finalize();
+    return ret;
+}
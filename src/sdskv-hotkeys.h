@@ -0,0 +1,186 @@
+#ifndef SDSKV_HOTKEYS_H
+#define SDSKV_HOTKEYS_H
+
+#include <abt.h>
+#include <stdint.h>
+#include <algorithm>
+#include <atomic>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Streaming heavy hitters of a database, using the Space-Saving algorithm:
+ * the capacity most frequent keys (and key prefixes, if prefix_length is
+ * not 0) are tracked with counters that overestimate their number of
+ * accesses by at most the reported error, in O(capacity) memory. Only one
+ * access out of sample_every is recorded, and accesses that find the
+ * sketch locked by another execution stream are skipped rather than
+ * waited for; counts are scaled back by sample_every.
+ */
+class HotKeys {
+  public:
+    struct entry {
+        std::string key;
+        uint64_t    count;  /* estimated number of accesses */
+        uint64_t    error;  /* count may be overestimated by up to this */
+        uint64_t    writes; /* accesses that were writes, since tracked */
+    };
+
+    struct summary {
+        uint64_t           accesses; /* estimated number of accesses */
+        std::vector<entry> keys;     /* by decreasing count */
+        std::vector<entry> prefixes;
+    };
+
+    HotKeys(size_t capacity, size_t prefix_length, unsigned sample_every)
+    : _keys(capacity), _prefixes(prefix_length ? capacity : 0),
+      _prefix_length(prefix_length),
+      _sample_every(sample_every ? sample_every : 1)
+    {
+        ABT_mutex_create(&_mutex);
+    }
+
+    ~HotKeys() { ABT_mutex_free(&_mutex); }
+
+    HotKeys(const HotKeys&) = delete;
+    HotKeys& operator=(const HotKeys&) = delete;
+
+    void record(const void* key, size_t ksize, bool write)
+    {
+        if (_sample_every > 1) {
+            int rank = 0;
+            ABT_self_get_xstream_rank(&rank);
+            auto& tick = _ticks[(unsigned)rank % num_ticks].value;
+            if ((tick.fetch_add(1, std::memory_order_relaxed) + 1)
+                    % _sample_every
+                != 0)
+                return;
+        }
+        if (ABT_mutex_trylock(_mutex) != ABT_SUCCESS) return;
+        _accesses += 1;
+        _keys.add((const char*)key, ksize, write);
+        if (_prefix_length && ksize >= _prefix_length)
+            _prefixes.add((const char*)key, _prefix_length, write);
+        ABT_mutex_unlock(_mutex);
+    }
+
+    summary snapshot() const
+    {
+        summary s;
+        ABT_mutex_lock(_mutex);
+        s.accesses = _accesses * _sample_every;
+        s.keys     = _keys.sorted(_sample_every);
+        s.prefixes = _prefixes.sorted(_sample_every);
+        ABT_mutex_unlock(_mutex);
+        return s;
+    }
+
+  private:
+    /* Space-Saving counters, kept in a min-heap on count so that the
+     * least frequent entry can be replaced in O(log capacity) */
+    class counters {
+      public:
+        explicit counters(size_t capacity) : _capacity(capacity)
+        {
+            _heap.reserve(capacity);
+        }
+
+        void add(const char* data, size_t size, bool write)
+        {
+            if (_capacity == 0) return;
+            std::string key(data, size);
+            auto        it = _index.find(key);
+            if (it != _index.end()) {
+                entry& e = _heap[it->second];
+                e.count += 1;
+                e.writes += write;
+                sift_down(it->second);
+            } else if (_heap.size() < _capacity) {
+                _heap.push_back(entry{std::move(key), 1, 0, write});
+                _index[_heap.back().key] = _heap.size() - 1;
+                sift_up(_heap.size() - 1);
+            } else {
+                /* the new key takes over the smallest counter */
+                entry& e = _heap[0];
+                _index.erase(e.key);
+                e.key    = std::move(key);
+                e.error  = e.count;
+                e.count  = e.count + 1;
+                e.writes = write;
+                _index[e.key] = 0;
+                sift_down(0);
+            }
+        }
+
+        std::vector<entry> sorted(unsigned scale) const
+        {
+            std::vector<entry> result = _heap;
+            for (auto& e : result) {
+                e.count *= scale;
+                e.error *= scale;
+                e.writes *= scale;
+            }
+            std::sort(result.begin(), result.end(),
+                      [](const entry& a, const entry& b) {
+                          return a.count > b.count;
+                      });
+            return result;
+        }
+
+      private:
+        size_t                                  _capacity;
+        std::vector<entry>                      _heap;
+        std::unordered_map<std::string, size_t> _index;
+
+        void swap_entries(size_t i, size_t j)
+        {
+            std::swap(_heap[i], _heap[j]);
+            _index[_heap[i].key] = i;
+            _index[_heap[j].key] = j;
+        }
+
+        void sift_up(size_t i)
+        {
+            while (i > 0) {
+                size_t parent = (i - 1) / 2;
+                if (_heap[parent].count <= _heap[i].count) break;
+                swap_entries(i, parent);
+                i = parent;
+            }
+        }
+
+        void sift_down(size_t i)
+        {
+            for (;;) {
+                size_t smallest = i;
+                size_t l = 2 * i + 1, r = 2 * i + 2;
+                if (l < _heap.size() && _heap[l].count < _heap[smallest].count)
+                    smallest = l;
+                if (r < _heap.size() && _heap[r].count < _heap[smallest].count)
+                    smallest = r;
+                if (smallest == i) break;
+                swap_entries(i, smallest);
+                i = smallest;
+            }
+        }
+    };
+
+    /* sampling counters of the database, one per execution stream (modulo
+     * num_ticks) on its own cache line so that streams don't contend */
+    static const unsigned num_ticks = 64;
+    struct tick {
+        std::atomic<unsigned> value{0};
+        char                  pad[64 - sizeof(std::atomic<unsigned>)];
+    };
+    tick _ticks[num_ticks];
+
+    ABT_mutex _mutex;
+    counters  _keys;
+    counters  _prefixes;
+    uint64_t  _accesses = 0;
+    size_t    _prefix_length;
+    unsigned  _sample_every;
+};
+
+#endif
@@ -0,0 +1,88 @@
+#ifndef SDSKV_LOCAL_H
+#define SDSKV_LOCAL_H
+
+#include <margo.h>
+#include "sdskv-common.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/* A provider registers an RPC with this name whose registered data is a
+ * sdskv_local_ops_t. The RPC is never sent: a client that finds it in its
+ * own margo instance, for a provider handle pointing to its own address,
+ * calls these functions instead of going through Mercury. They have the
+ * same semantics and return codes as the corresponding RPC handlers, and go
+ * through the same admission control and metrics. */
+#define SDSKV_LOCAL_RPC_NAME "sdskv_local_rpc"
+
+typedef struct sdskv_local_ops_t {
+    void* provider;
+    int (*put)(void*               provider,
+               sdskv_database_id_t db_id,
+               const void*         key,
+               hg_size_t           ksize,
+               const void*         value,
+               hg_size_t           vsize);
+    int (*put_multi)(void*               provider,
+                     sdskv_database_id_t db_id,
+                     size_t              num,
+                     const void* const*  keys,
+                     const hg_size_t*    ksizes,
+                     const void* const*  values,
+                     const hg_size_t*    vsizes);
+    int (*put_packed)(void*               provider,
+                      sdskv_database_id_t db_id,
+                      size_t              num,
+                      const void*         packed_keys,
+                      const hg_size_t*    ksizes,
+                      const void*         packed_values,
+                      const hg_size_t*    vsizes);
+    int (*get)(void*               provider,
+               sdskv_database_id_t db_id,
+               const void*         key,
+               hg_size_t           ksize,
+               void*               value,
+               hg_size_t*          vsize);
+    int (*get_multi)(void*               provider,
+                     sdskv_database_id_t db_id,
+                     size_t              num,
+                     const void* const*  keys,
+                     const hg_size_t*    ksizes,
+                     void**              values,
+                     hg_size_t*          vsizes);
+    int (*get_packed)(void*               provider,
+                      sdskv_database_id_t db_id,
+                      size_t*             num,
+                      const void*         packed_keys,
+                      const hg_size_t*    ksizes,
+                      hg_size_t           vbufsize,
+                      void*               packed_vals,
+                      hg_size_t*          vsizes);
+    int (*length)(void*               provider,
+                  sdskv_database_id_t db_id,
+                  const void*         key,
+                  hg_size_t           ksize,
+                  hg_size_t*          vsize);
+    int (*exists)(void*               provider,
+                  sdskv_database_id_t db_id,
+                  const void*         key,
+                  hg_size_t           ksize,
+                  int*                flag);
+    int (*erase)(void*               provider,
+                 sdskv_database_id_t db_id,
+                 const void*         key,
+                 hg_size_t           ksize);
+    int (*erase_multi)(void*               provider,
+                       sdskv_database_id_t db_id,
+                       size_t              num,
+                       const void* const*  keys,
+                       const hg_size_t*    ksizes,
+                       int*                flags);
+} sdskv_local_ops_t;
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif
@@ -0,0 +1,655 @@
+#ifndef SDSKV_METRICS_H
+#define SDSKV_METRICS_H
+
+#include <abt.h>
+#include <margo.h>
+#include <json/json.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/time.h>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <map>
+#include <vector>
+#include "sdskv-common.h"
+#include "sdskv-trace.h"
+
+/**
+ * Log-linear latency histogram in the spirit of HDR histograms: each power
+ * of two is split into 8 linear sub-buckets, giving a relative error of
+ * at most 12.5% from 1us to about 18 minutes, in 2KB. Recording is a
+ * handful of relaxed atomic increments.
+ */
+class LatencyHistogram {
+  public:
+    static const unsigned sub_bits    = 3;
+    static const unsigned sub_buckets = 1 << sub_bits;
+    static const unsigned min_exp     = 10; // below 2^10 ns, linear buckets
+    static const unsigned max_exp     = 40;
+    static const unsigned num_buckets = (max_exp - min_exp + 2) * sub_buckets;
+
+    LatencyHistogram()
+    {
+        for (auto& c : _counts) c.store(0, std::memory_order_relaxed);
+    }
+
+    void record(uint64_t ns)
+    {
+        _counts[bucket_of(ns)].fetch_add(1, std::memory_order_relaxed);
+        _count.fetch_add(1, std::memory_order_relaxed);
+        _sum.fetch_add(ns, std::memory_order_relaxed);
+        uint64_t max = _max.load(std::memory_order_relaxed);
+        while (ns > max
+               && !_max.compare_exchange_weak(max, ns,
+                                              std::memory_order_relaxed)) {}
+    }
+
+    /* adds the content of this histogram to a plain array of counts
+     * (of num_buckets entries) and to the count/sum/max accumulators */
+    void accumulate(uint64_t* counts,
+                    uint64_t& count,
+                    uint64_t& sum,
+                    uint64_t& max) const
+    {
+        for (unsigned i = 0; i < num_buckets; i++)
+            counts[i] += _counts[i].load(std::memory_order_relaxed);
+        count += _count.load(std::memory_order_relaxed);
+        sum += _sum.load(std::memory_order_relaxed);
+        uint64_t m = _max.load(std::memory_order_relaxed);
+        if (m > max) max = m;
+    }
+
+    static unsigned bucket_of(uint64_t ns)
+    {
+        if (ns < (1ull << min_exp)) return ns >> (min_exp - sub_bits);
+        unsigned e = 63 - __builtin_clzll(ns);
+        if (e > max_exp) return num_buckets - 1;
+        unsigned sub = (ns >> (e - sub_bits)) & (sub_buckets - 1);
+        return (e - min_exp + 1) * sub_buckets + sub;
+    }
+
+    /* smallest value that falls in the bucket after b */
+    static uint64_t upper_bound_of(unsigned b)
+    {
+        b += 1;
+        if (b < sub_buckets) return (uint64_t)b << (min_exp - sub_bits);
+        unsigned e   = b / sub_buckets - 1 + min_exp;
+        unsigned sub = b % sub_buckets;
+        return (uint64_t)(sub_buckets + sub) << (e - sub_bits);
+    }
+
+    /* q-quantile, in us, of accumulated counts (see accumulate) */
+    static double percentile(const uint64_t* counts,
+                             uint64_t        count,
+                             uint64_t        max,
+                             double          q)
+    {
+        uint64_t rank = (uint64_t)(q * count);
+        if (rank >= count) rank = count - 1;
+        uint64_t seen = 0;
+        for (unsigned b = 0; b < num_buckets; b++) {
+            seen += counts[b];
+            if (seen > rank) {
+                uint64_t v = upper_bound_of(b);
+                return (v < max ? v : max) / 1e3;
+            }
+        }
+        return max / 1e3;
+    }
+
+  private:
+    std::atomic<uint64_t> _counts[num_buckets];
+    std::atomic<uint64_t> _count{0};
+    std::atomic<uint64_t> _sum{0};
+    std::atomic<uint64_t> _max{0};
+};
+
+/**
+ * Statistics of one RPC, either for the whole provider or for a single
+ * database. Requests are timed in phases: decoding the input, waiting for
+ * admission, bulk transfers, sending the response, and the rest of the
+ * handler (mostly the engine), plus the total. Counters are sharded by
+ * execution stream so that concurrent handlers don't share cache lines;
+ * shards are allocated on first use.
+ */
+class OpStats {
+  public:
+    enum phase_t {
+        PHASE_TOTAL = 0,
+        PHASE_DECODE,
+        PHASE_QUEUE,
+        PHASE_BULK,
+        PHASE_RESPOND,
+        PHASE_ENGINE,
+        NUM_PHASES
+    };
+
+    static const unsigned num_shards = 64;
+
+    static const char* phase_name(unsigned phase)
+    {
+        static const char* names[NUM_PHASES]
+            = {"total", "decode", "queue", "bulk", "respond", "engine"};
+        return names[phase];
+    }
+
+    OpStats()
+    {
+        for (auto& s : _shards) s.store(nullptr, std::memory_order_relaxed);
+    }
+
+    ~OpStats()
+    {
+        for (auto& s : _shards) delete s.load(std::memory_order_relaxed);
+    }
+
+    /* phases are in seconds */
+    void record(int ret, const double* phases)
+    {
+        shard& s = local_shard();
+        for (unsigned p = 0; p < NUM_PHASES; p++)
+            s.phases[p].record(phases[p] > 0 ? (uint64_t)(phases[p] * 1e9)
+                                             : 0);
+        if (ret != SDSKV_SUCCESS)
+            s.errors.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    uint64_t count() const
+    {
+        uint64_t n = 0;
+        for (auto& sp : _shards) {
+            shard* s = sp.load(std::memory_order_acquire);
+            if (!s) continue;
+            uint64_t counts[LatencyHistogram::num_buckets] = {0};
+            uint64_t c = 0, sum = 0, max = 0;
+            s->phases[PHASE_TOTAL].accumulate(counts, c, sum, max);
+            n += c;
+        }
+        return n;
+    }
+
+    Json::Value to_json() const
+    {
+        Json::Value result(Json::objectValue);
+        uint64_t    errors = 0;
+        for (unsigned p = 0; p < NUM_PHASES; p++) {
+            uint64_t counts[LatencyHistogram::num_buckets] = {0};
+            uint64_t count = 0, sum = 0, max = 0;
+            for (auto& sp : _shards) {
+                shard* s = sp.load(std::memory_order_acquire);
+                if (!s) continue;
+                s->phases[p].accumulate(counts, count, sum, max);
+                if (p == 0) errors += s->errors.load(std::memory_order_relaxed);
+            }
+            if (p == 0) {
+                result["count"]  = (Json::UInt64)count;
+                result["errors"] = (Json::UInt64)errors;
+            }
+            if (count == 0) continue;
+            auto percentile = [&](double q) {
+                return LatencyHistogram::percentile(counts, count, max, q);
+            };
+            Json::Value& phase = result[phase_name(p)];
+            phase["mean_us"]   = sum / 1e3 / count;
+            phase["p50_us"]    = percentile(0.5);
+            phase["p90_us"]    = percentile(0.9);
+            phase["p99_us"]    = percentile(0.99);
+            phase["p999_us"]   = percentile(0.999);
+            phase["max_us"]    = max / 1e3;
+        }
+        return result;
+    }
+
+  private:
+    struct shard {
+        LatencyHistogram      phases[NUM_PHASES];
+        std::atomic<uint64_t> errors{0};
+    };
+    std::atomic<shard*> _shards[num_shards];
+
+    shard& local_shard()
+    {
+        int rank = 0;
+        ABT_self_get_xstream_rank(&rank);
+        auto&  slot = _shards[(unsigned)rank % num_shards];
+        shard* s    = slot.load(std::memory_order_acquire);
+        if (s) return *s;
+        shard* fresh = new shard;
+        if (slot.compare_exchange_strong(s, fresh, std::memory_order_acq_rel))
+            return *fresh;
+        delete fresh;
+        return *s;
+    }
+
+};
+
+/**
+ * Metrics of a provider: one OpStats per RPC for the provider as a whole,
+ * and one per RPC and database. RPCs are added (add_rpc) while the provider
+ * registers them, then seal() makes the table read-only; requests that
+ * complete before that are not recorded. The table of a database is
+ * created when it is attached (add_database) and handed to the requests
+ * on it, so that recording them doesn't need a lock. Requests share the
+ * ownership of the table, since they may complete after the database has
+ * been removed.
+ */
+class MetricsRegistry {
+  public:
+    MetricsRegistry() { ABT_rwlock_create(&_db_lock); }
+    ~MetricsRegistry() { ABT_rwlock_free(&_db_lock); }
+
+    void add_rpc(hg_id_t id, const char* name)
+    {
+        _rpc_index[id] = _rpc_names.size();
+        _rpc_names.push_back(name);
+    }
+
+    /* records the RPC with the given id under the name of another one */
+    void alias_rpc(hg_id_t id, hg_id_t other)
+    {
+        _rpc_index[id] = _rpc_index.at(other);
+    }
+
+    void seal()
+    {
+        _rpc_stats.reset(new OpStats[_rpc_names.size()]);
+        _sealed.store(true, std::memory_order_release);
+    }
+
+    /* name given to add_rpc, which must be a static string */
+    const char* rpc_name(int rpc) const { return _rpc_names[rpc]; }
+
+    /* index of the RPC with the given id, -1 if unknown or not sealed yet */
+    int rpc_index(hg_id_t id) const
+    {
+        if (!_sealed.load(std::memory_order_acquire)) return -1;
+        auto it = _rpc_index.find(id);
+        return it == _rpc_index.end() ? -1 : (int)it->second;
+    }
+
+    /* db_stats is the table of the request's database, if any */
+    void record(int rpc, OpStats* db_stats, int ret, const double* phases)
+    {
+        if (rpc < 0) return;
+        _rpc_stats[rpc].record(ret, phases);
+        if (db_stats) db_stats[rpc].record(ret, phases);
+    }
+
+    /* creates the statistics of a new database, to be given to the
+     * requests on it (see RequestMetrics::set_database); must be called
+     * after seal() */
+    std::shared_ptr<OpStats> add_database(sdskv_database_id_t db_id)
+    {
+        ABT_rwlock_wrlock(_db_lock);
+        auto& stats = _db_stats[db_id];
+        if (!stats)
+            stats.reset(new OpStats[_rpc_names.size()],
+                        std::default_delete<OpStats[]>());
+        std::shared_ptr<OpStats> result = stats;
+        ABT_rwlock_unlock(_db_lock);
+        return result;
+    }
+
+    /* drops the statistics of a database that has been removed */
+    void remove_database(sdskv_database_id_t db_id)
+    {
+        ABT_rwlock_wrlock(_db_lock);
+        _db_stats.erase(db_id);
+        ABT_rwlock_unlock(_db_lock);
+    }
+
+    /* db_names maps database ids to the names used as keys in the
+     * "databases" section; databases missing from it are skipped */
+    Json::Value
+    to_json(const std::map<sdskv_database_id_t, std::string>& db_names)
+    {
+        Json::Value result(Json::objectValue);
+        result["rpcs"]      = Json::Value(Json::objectValue);
+        result["databases"] = Json::Value(Json::objectValue);
+        if (!_sealed.load(std::memory_order_acquire)) return result;
+        for (size_t i = 0; i < _rpc_names.size(); i++) {
+            if (_rpc_stats[i].count() == 0) continue;
+            result["rpcs"][_rpc_names[i]] = _rpc_stats[i].to_json();
+        }
+        ABT_rwlock_rdlock(_db_lock);
+        for (auto& p : _db_stats) {
+            auto name = db_names.find(p.first);
+            if (name == db_names.end()) continue;
+            Json::Value& db = result["databases"][name->second];
+            db              = Json::Value(Json::objectValue);
+            for (size_t i = 0; i < _rpc_names.size(); i++) {
+                const OpStats& stats = p.second.get()[i];
+                if (stats.count() == 0) continue;
+                db[_rpc_names[i]] = stats.to_json();
+            }
+        }
+        ABT_rwlock_unlock(_db_lock);
+        return result;
+    }
+
+  private:
+    std::unordered_map<hg_id_t, size_t> _rpc_index;
+    std::vector<const char*>            _rpc_names;
+    std::unique_ptr<OpStats[]>          _rpc_stats;
+    std::atomic<bool>                   _sealed{false};
+    ABT_rwlock                          _db_lock;
+    /* arrays of OpStats (std::shared_ptr<T[]> needs C++17) */
+    std::unordered_map<sdskv_database_id_t, std::shared_ptr<OpStats>>
+        _db_stats;
+};
+
+/**
+ * Bounded log of the requests whose total or engine time exceeded a
+ * threshold, with what is known about them (RPC, database, first bytes of
+ * the first key, number of keys and bytes, time spent in each phase), to
+ * diagnose stalls after the fact. Once capacity entries are logged, new
+ * ones replace the oldest. If a path is given, entries are also appended
+ * to that file as JSON lines. Slow requests being rare, a mutex is enough.
+ */
+class SlowOpLog {
+  public:
+    static const size_t max_key_prefix = 32;
+
+    struct entry {
+        double              time; /* seconds since the epoch */
+        const char*         rpc;
+        bool                has_db;
+        sdskv_database_id_t db_id;
+        uint64_t            request_id;
+        int                 ret;
+        std::string         key_prefix;
+        size_t              num_keys;
+        size_t              bytes;
+        double              phases[OpStats::NUM_PHASES]; /* seconds */
+    };
+
+    /* thresholds are in seconds, 0 disables them */
+    SlowOpLog(double             total_threshold,
+              double             engine_threshold,
+              size_t             capacity,
+              const std::string& path)
+    : _total_threshold(total_threshold), _engine_threshold(engine_threshold),
+      _capacity(capacity ? capacity : 1), _path(path)
+    {
+        ABT_mutex_create(&_mutex);
+        if (!path.empty()) _file = fopen(path.c_str(), "a");
+    }
+
+    ~SlowOpLog()
+    {
+        if (_file) fclose(_file);
+        ABT_mutex_free(&_mutex);
+    }
+
+    SlowOpLog(const SlowOpLog&) = delete;
+    SlowOpLog& operator=(const SlowOpLog&) = delete;
+
+    /* false if a path was given but could not be opened */
+    bool file_ok() const { return _path.empty() || _file; }
+
+    bool is_slow(const double* phases) const
+    {
+        return (_total_threshold > 0
+                && phases[OpStats::PHASE_TOTAL] >= _total_threshold)
+            || (_engine_threshold > 0
+                && phases[OpStats::PHASE_ENGINE] >= _engine_threshold);
+    }
+
+    void record(entry&& e)
+    {
+        std::string line;
+        if (_file) {
+            Json::StreamWriterBuilder builder;
+            builder["indentation"] = "";
+            line = Json::writeString(builder, to_json(e, nullptr));
+        }
+        ABT_mutex_lock(_mutex);
+        if (_entries.size() < _capacity)
+            _entries.push_back(std::move(e));
+        else
+            _entries[_total % _capacity] = std::move(e);
+        _total += 1;
+        if (_file) {
+            fprintf(_file, "%s\n", line.c_str());
+            fflush(_file);
+        }
+        ABT_mutex_unlock(_mutex);
+    }
+
+    /* entries from oldest to newest, db_names as in MetricsRegistry */
+    Json::Value
+    to_json(const std::map<sdskv_database_id_t, std::string>& db_names)
+    {
+        Json::Value result(Json::objectValue);
+        Json::Value ops(Json::arrayValue);
+        ABT_mutex_lock(_mutex);
+        size_t first = _entries.size() < _capacity ? 0 : _total % _capacity;
+        for (size_t i = 0; i < _entries.size(); i++) {
+            const entry& e    = _entries[(first + i) % _entries.size()];
+            auto         name = db_names.find(e.db_id);
+            ops.append(to_json(e, e.has_db && name != db_names.end()
+                                      ? name->second.c_str()
+                                      : nullptr));
+        }
+        result["total"]   = (Json::UInt64)_total;
+        result["dropped"] = (Json::UInt64)(_total - _entries.size());
+        ABT_mutex_unlock(_mutex);
+        result["total_threshold_ms"]  = _total_threshold * 1e3;
+        result["engine_threshold_ms"] = _engine_threshold * 1e3;
+        result["ops"]                 = ops;
+        return result;
+    }
+
+  private:
+    ABT_mutex          _mutex;
+    double             _total_threshold;
+    double             _engine_threshold;
+    size_t             _capacity;
+    std::string        _path;
+    FILE*              _file = nullptr;
+    std::vector<entry> _entries;
+    uint64_t           _total = 0;
+
+    static Json::Value to_json(const entry& e, const char* db_name)
+    {
+        Json::Value result(Json::objectValue);
+        result["time"] = e.time;
+        result["rpc"]  = e.rpc;
+        if (e.has_db) {
+            result["db_id"] = (Json::UInt64)e.db_id;
+            if (db_name) result["database"] = db_name;
+        }
+        char id[17];
+        snprintf(id, sizeof(id), "%016llx", (unsigned long long)e.request_id);
+        result["request_id"] = id;
+        result["ret"]         = e.ret;
+        if (!e.key_prefix.empty()) {
+            bool printable = true;
+            for (char c : e.key_prefix) printable &= c >= 0x20 && c < 0x7f;
+            if (printable) {
+                result["key_prefix"] = e.key_prefix;
+            } else {
+                static const char digits[] = "0123456789abcdef";
+                std::string       hex;
+                for (unsigned char c : e.key_prefix) {
+                    hex += digits[c >> 4];
+                    hex += digits[c & 0xf];
+                }
+                result["key_prefix_hex"] = hex;
+            }
+        }
+        result["num_keys"] = (Json::UInt64)e.num_keys;
+        result["bytes"]    = (Json::UInt64)e.bytes;
+        for (unsigned p = 0; p < OpStats::NUM_PHASES; p++)
+            result[std::string(OpStats::phase_name(p)) + "_ms"]
+                = e.phases[p] * 1e3;
+        return result;
+    }
+};
+
+/**
+ * Times one request of a handler and records it when destroyed. The
+ * handler macros fill in the phases they know about (see
+ * FIND_MID_AND_PROVIDER, GET_INPUT, ENSURE_ADMITTED, FIND_DATABASE and
+ * TIMED_BULK_TRANSFER in sdskv-server.cc); whatever is left of the total
+ * counts as engine time.
+ * If the provider traces requests and this one is sampled, the request
+ * and each of its phases are also added to the trace as spans, and if it
+ * is slow, it is added to the provider's SlowOpLog.
+ */
+class RequestMetrics {
+  public:
+    static const unsigned max_spans = 16;
+
+    RequestMetrics(MetricsRegistry& registry,
+                   sdskv_trace_t*   trace,
+                   SlowOpLog*       slow_ops,
+                   hg_id_t          rpc_id)
+    : _registry(registry), _trace(trace), _slow_ops(slow_ops),
+      _rpc(registry.rpc_index(rpc_id)), _start(ABT_get_wtime())
+    {
+        for (auto& p : _phases) p = 0.0;
+    }
+
+    /* db_stats is the table returned by MetricsRegistry::add_database */
+    void set_database(sdskv_database_id_t             db_id,
+                      const std::shared_ptr<OpStats>& db_stats)
+    {
+        _has_db   = true;
+        _db_id    = db_id;
+        _db_stats = db_stats;
+    }
+
+    /* id sent by the client, used to correlate client and server spans */
+    void set_request_id(uint64_t request_id) { _request_id = request_id; }
+
+    /* what the request is about, reported if it is slow; key is the first
+     * key of the request, of which only a prefix is kept */
+    void set_key(const void* key, size_t ksize)
+    {
+        if (!_slow_ops || !key) return;
+        _key_size = std::min(ksize, SlowOpLog::max_key_prefix);
+        memcpy(_key_prefix, key, _key_size);
+    }
+    void set_num_keys(size_t num_keys) { _num_keys = num_keys; }
+    /* bytes of keys and values not moved by bulk transfers */
+    void add_bytes(size_t bytes) { _bytes += bytes; }
+
+    /* adds the time from start to now to the given phase */
+    void add(OpStats::phase_t phase, double start)
+    {
+        double end = ABT_get_wtime();
+        _phases[phase] += end - start;
+        if (_trace) add_span(OpStats::phase_name(phase), start, end, 0);
+    }
+
+    hg_return_t bulk_transfer(margo_instance_id mid,
+                              hg_bulk_op_t      op,
+                              hg_addr_t         origin_addr,
+                              hg_bulk_t         origin_handle,
+                              size_t            origin_offset,
+                              hg_bulk_t         local_handle,
+                              size_t            local_offset,
+                              size_t            size)
+    {
+        double      start = ABT_get_wtime();
+        hg_return_t ret
+            = margo_bulk_transfer(mid, op, origin_addr, origin_handle,
+                                  origin_offset, local_handle, local_offset,
+                                  size);
+        double end = ABT_get_wtime();
+        _phases[OpStats::PHASE_BULK] += end - start;
+        _bulk_bytes += size;
+        if (_trace)
+            add_span(op == HG_BULK_PULL ? "bulk_pull" : "bulk_push", start,
+                     end, size);
+        return ret;
+    }
+
+    void finish(int ret)
+    {
+        double end                    = ABT_get_wtime();
+        _phases[OpStats::PHASE_TOTAL] = end - _start;
+        _phases[OpStats::PHASE_ENGINE]
+            = _phases[OpStats::PHASE_TOTAL] - _phases[OpStats::PHASE_DECODE]
+            - _phases[OpStats::PHASE_QUEUE] - _phases[OpStats::PHASE_BULK]
+            - _phases[OpStats::PHASE_RESPOND];
+        _registry.record(_rpc, _db_stats.get(), ret, _phases);
+        if (_rpc < 0) return;
+        if (_trace) trace(end);
+        if (_slow_ops && _slow_ops->is_slow(_phases)) log_slow_op(ret);
+    }
+
+  private:
+    struct span {
+        const char* name;
+        double      start;
+        double      end;
+        size_t      size;
+    };
+
+    MetricsRegistry&         _registry;
+    sdskv_trace_t*           _trace;
+    SlowOpLog*               _slow_ops;
+    int                      _rpc;
+    double                   _start;
+    bool                     _has_db     = false;
+    sdskv_database_id_t      _db_id      = 0;
+    std::shared_ptr<OpStats> _db_stats   = nullptr;
+    uint64_t                 _request_id = 0;
+    size_t                   _bulk_bytes = 0;
+    size_t                   _bytes      = 0;
+    size_t                   _num_keys   = 0;
+    size_t                   _key_size   = 0;
+    char                     _key_prefix[SlowOpLog::max_key_prefix];
+    double                   _phases[OpStats::NUM_PHASES];
+    span                     _spans[max_spans];
+    unsigned                 _num_spans = 0;
+
+    void add_span(const char* name, double start, double end, size_t size)
+    {
+        if (_num_spans < max_spans)
+            _spans[_num_spans++] = span{name, start, end, size};
+    }
+
+    void log_slow_op(int ret)
+    {
+        struct timeval tv;
+        gettimeofday(&tv, NULL);
+        SlowOpLog::entry e;
+        e.time       = tv.tv_sec + tv.tv_usec * 1e-6;
+        e.rpc        = _registry.rpc_name(_rpc);
+        e.has_db     = _has_db;
+        e.db_id      = _db_id;
+        e.request_id = _request_id;
+        e.ret        = ret;
+        e.key_prefix = std::string(_key_prefix, _key_size);
+        e.num_keys   = _num_keys;
+        e.bytes      = _bytes + _bulk_bytes;
+        for (unsigned p = 0; p < OpStats::NUM_PHASES; p++)
+            e.phases[p] = _phases[p];
+        _slow_ops->record(std::move(e));
+    }
+
+    void trace(double end)
+    {
+        if (_request_id == 0) _request_id = sdskv_trace_new_id(_trace);
+        if (!sdskv_trace_sampled(_trace, _request_id)) return;
+        sdskv_trace_event_t event
+            = {_request_id, _registry.rpc_name(_rpc), _start, end, -1, _has_db,
+               _db_id,      _bulk_bytes};
+        sdskv_trace_record(_trace, &event);
+        for (unsigned i = 0; i < _num_spans; i++) {
+            event.name  = _spans[i].name;
+            event.start = _spans[i].start;
+            event.end   = _spans[i].end;
+            event.size  = _spans[i].size;
+            sdskv_trace_record(_trace, &event);
+        }
+    }
+};
+
+#endif
@@ -15,6 +15,9 @@
 // setup to support opaque type handling
 typedef char* kv_ptr_t;
 
+/* On HG_DECODE, data points directly into the Mercury buffer instead of
+ * a copy: it remains valid only until margo_free_input/margo_free_output
+ * is called on the handle, and must be copied if needed for longer. */
 typedef struct {
     hg_size_t size;
     kv_ptr_t  data;
@@ -33,16 +36,18 @@ static inline hg_return_t hg_proc_kv_data_t(hg_proc_t proc, void* arg)
             if (ret != HG_SUCCESS) return ret;
             break;
         case HG_DECODE:
-            in->data = (kv_ptr_t)malloc(in->size);
-            ret      = hg_proc_raw(proc, in->data, in->size);
+            in->data = (kv_ptr_t)hg_proc_save_ptr(proc, in->size);
+            if (in->data == NULL) return HG_NOMEM;
+            /* updates the checksum, if any, over the skipped bytes */
+            ret = hg_proc_restore_ptr(proc, in->data, in->size);
             if (ret != HG_SUCCESS) return ret;
             break;
-        case HG_FREE:
-            free(in->data);
-            break;
         default:
+            /* nothing to free, the data belongs to the handle */
             break;
         }
+    } else if (hg_proc_get_op(proc) == HG_DECODE) {
+        in->data = NULL;
     }
     return HG_SUCCESS;
 }
@@ -54,6 +59,14 @@ MERCURY_GEN_PROC(open_out_t, ((uint64_t)(db_id))((int32_t)(ret)))
 // ------------- COUNT DATABASES - //
 MERCURY_GEN_PROC(count_db_out_t, ((uint64_t)(count))((int32_t)(ret)))
 
+// ------------- GET STATS ------ //
+MERCURY_GEN_PROC(get_stats_out_t, ((int32_t)(ret))((hg_string_t)(stats)))
+
+// ------------- GET TRACE ------ //
+MERCURY_GEN_PROC(get_trace_out_t, ((int32_t)(ret))((hg_string_t)(trace)))
+MERCURY_GEN_PROC(get_slow_ops_out_t,
+                 ((int32_t)(ret))((hg_string_t)(slow_ops)))
+
 // ------------- LIST DATABASES -- //
 MERCURY_GEN_PROC(list_db_in_t, ((uint64_t)(count)))
 
@@ -222,11 +235,91 @@ MERCURY_GEN_PROC(
 MERCURY_GEN_PROC(exists_multi_out_t, ((int32_t)(ret)))
 
 // ------------- ERASE MULTI ------------- //
-MERCURY_GEN_PROC(erase_multi_in_t,
-                 ((uint64_t)(db_id))((hg_size_t)(num_keys))((hg_bulk_t)(
-                     keys_bulk_handle))((hg_size_t)(keys_bulk_size)))
+MERCURY_GEN_PROC(
+    erase_multi_in_t,
+    ((uint64_t)(db_id))((hg_size_t)(num_keys))((hg_bulk_t)(keys_bulk_handle))(
+        (hg_size_t)(keys_bulk_size))((hg_bulk_t)(flags_bulk_handle)))
 MERCURY_GEN_PROC(erase_multi_out_t, ((int32_t)(ret)))
 
+// ------------- ERASE RANGE ------------- //
+MERCURY_GEN_PROC(erase_range_in_t,
+                 ((uint64_t)(db_id))((kv_data_t)(lower_bound))(
+                     (kv_data_t)(upper_bound)))
+MERCURY_GEN_PROC(erase_range_out_t, ((hg_size_t)(num_erased))((int32_t)(ret)))
+
+// ------------- ERASE PREFIX ------------- //
+MERCURY_GEN_PROC(erase_prefix_in_t, ((uint64_t)(db_id))((kv_data_t)(prefix)))
+MERCURY_GEN_PROC(erase_prefix_out_t, ((hg_size_t)(num_erased))((int32_t)(ret)))
+
+// ------------- COMPARE AND SWAP ------------- //
+MERCURY_GEN_PROC(cas_in_t,
+                 ((uint64_t)(db_id))((kv_data_t)(key))((kv_data_t)(expected))(
+                     (kv_data_t)(desired)))
+MERCURY_GEN_PROC(cas_out_t, ((int32_t)(swapped))((int32_t)(ret)))
+
+// ------------- COMPARE AND SWAP PACKED ------------- //
+MERCURY_GEN_PROC(
+    cas_packed_in_t,
+    ((uint64_t)(db_id))((hg_size_t)(num_keys))((hg_size_t)(in_bulk_size))(
+        (hg_bulk_t)(in_bulk_handle))((hg_bulk_t)(out_bulk_handle)))
+MERCURY_GEN_PROC(cas_packed_out_t, ((int32_t)(ret)))
+
+// ------------- FETCH AND ADD ------------- //
+MERCURY_GEN_PROC(fetch_add_in_t,
+                 ((uint64_t)(db_id))((kv_data_t)(key))((int64_t)(delta)))
+MERCURY_GEN_PROC(fetch_add_out_t, ((int64_t)(value))((int32_t)(ret)))
+
+// ------------- FETCH AND ADD PACKED ------------- //
+MERCURY_GEN_PROC(
+    fetch_add_packed_in_t,
+    ((uint64_t)(db_id))((hg_size_t)(num_keys))((hg_size_t)(in_bulk_size))(
+        (hg_bulk_t)(in_bulk_handle))((hg_bulk_t)(out_bulk_handle)))
+MERCURY_GEN_PROC(fetch_add_packed_out_t, ((int32_t)(ret)))
+
+// ------------- APPEND ------------- //
+MERCURY_GEN_PROC(append_in_t,
+                 ((uint64_t)(db_id))((kv_data_t)(key))((kv_data_t)(value)))
+MERCURY_GEN_PROC(append_out_t, ((hg_size_t)(vsize))((int32_t)(ret)))
+
+// ------------- APPEND PACKED ------------- //
+MERCURY_GEN_PROC(
+    append_packed_in_t,
+    ((uint64_t)(db_id))((hg_size_t)(num_keys))((hg_size_t)(in_bulk_size))(
+        (hg_bulk_t)(in_bulk_handle))((hg_bulk_t)(out_bulk_handle)))
+MERCURY_GEN_PROC(append_packed_out_t, ((int32_t)(ret)))
+
+// ------------- BATCH ------------- //
+MERCURY_GEN_PROC(batch_in_t,
+                 ((hg_size_t)(num_ops))((hg_size_t)(in_bulk_size))(
+                     (hg_bulk_t)(in_bulk_handle))((hg_size_t)(out_bulk_size))(
+                     (hg_bulk_t)(out_bulk_handle)))
+MERCURY_GEN_PROC(batch_out_t, ((int32_t)(ret)))
+
+// ------------- PUT PACKED MULTI DB ------------- //
+MERCURY_GEN_PROC(put_packed_multi_db_in_t,
+                 ((hg_size_t)(num_dbs))((hg_size_t)(num_keys))(
+                     (hg_size_t)(bulk_size))((hg_bulk_t)(bulk_handle)))
+MERCURY_GEN_PROC(put_packed_multi_db_out_t, ((int32_t)(ret)))
+
+// ------------- GET PACKED MULTI DB ------------- //
+MERCURY_GEN_PROC(get_packed_multi_db_in_t,
+                 ((hg_size_t)(num_dbs))((hg_size_t)(num_keys))(
+                     (hg_size_t)(keys_bulk_size))((hg_bulk_t)(keys_bulk_handle))(
+                     (hg_size_t)(vals_bulk_size))((hg_bulk_t)(vals_bulk_handle)))
+MERCURY_GEN_PROC(get_packed_multi_db_out_t,
+                 ((int32_t)(ret))((hg_size_t)(num_keys)))
+
+// ------------- EXISTS PACKED MULTI DB ------------- //
+MERCURY_GEN_PROC(exists_packed_multi_db_in_t,
+                 ((hg_size_t)(num_dbs))((hg_size_t)(num_keys))(
+                     (hg_size_t)(keys_bulk_size))((hg_bulk_t)(keys_bulk_handle))(
+                     (hg_bulk_t)(flags_bulk_handle)))
+MERCURY_GEN_PROC(exists_packed_multi_db_out_t, ((int32_t)(ret)))
+
+// ------------- SYNC ------------- //
+MERCURY_GEN_PROC(sync_in_t, ((uint64_t)(db_id)))
+MERCURY_GEN_PROC(sync_out_t, ((int32_t)(ret)))
+
 // ------------- MIGRATE KEYS ----------- //
 MERCURY_GEN_PROC(migrate_keys_in_t,
                  ((uint64_t)(source_db_id))((hg_string_t)(target_addr))(
@@ -262,4 +355,76 @@ MERCURY_GEN_PROC(migrate_database_in_t,
 
 MERCURY_GEN_PROC(migrate_database_out_t, ((int32_t)(ret))((int32_t)(remi_ret)))
 
+// ------------- TRACED REQUESTS ------------- //
+/* Clients with tracing enabled send their requests through "<rpc>_traced"
+ * RPCs, whose input is the regular input followed by the request id, so
+ * that the regular RPCs keep their format. The regular input must be the
+ * first field: the server decodes both variants into the traced structure.
+ * The traced variant of the RPCs without input only carries the id. */
+MERCURY_GEN_PROC(traced_void_in_t, ((uint64_t)(trace_id)))
+MERCURY_GEN_PROC(traced_open_in_t, ((open_in_t)(in))((uint64_t)(trace_id)))
+MERCURY_GEN_PROC(traced_list_db_in_t,
+                 ((list_db_in_t)(in))((uint64_t)(trace_id)))
+MERCURY_GEN_PROC(traced_put_in_t, ((put_in_t)(in))((uint64_t)(trace_id)))
+MERCURY_GEN_PROC(traced_get_in_t, ((get_in_t)(in))((uint64_t)(trace_id)))
+MERCURY_GEN_PROC(traced_length_in_t, ((length_in_t)(in))((uint64_t)(trace_id)))
+MERCURY_GEN_PROC(traced_exists_in_t, ((exists_in_t)(in))((uint64_t)(trace_id)))
+MERCURY_GEN_PROC(traced_erase_in_t, ((erase_in_t)(in))((uint64_t)(trace_id)))
+MERCURY_GEN_PROC(traced_list_keys_in_t,
+                 ((list_keys_in_t)(in))((uint64_t)(trace_id)))
+MERCURY_GEN_PROC(traced_list_keyvals_in_t,
+                 ((list_keyvals_in_t)(in))((uint64_t)(trace_id)))
+MERCURY_GEN_PROC(traced_bulk_put_in_t,
+                 ((bulk_put_in_t)(in))((uint64_t)(trace_id)))
+MERCURY_GEN_PROC(traced_bulk_get_in_t,
+                 ((bulk_get_in_t)(in))((uint64_t)(trace_id)))
+MERCURY_GEN_PROC(traced_put_multi_in_t,
+                 ((put_multi_in_t)(in))((uint64_t)(trace_id)))
+MERCURY_GEN_PROC(traced_get_multi_in_t,
+                 ((get_multi_in_t)(in))((uint64_t)(trace_id)))
+MERCURY_GEN_PROC(traced_put_packed_in_t,
+                 ((put_packed_in_t)(in))((uint64_t)(trace_id)))
+MERCURY_GEN_PROC(traced_get_packed_in_t,
+                 ((get_packed_in_t)(in))((uint64_t)(trace_id)))
+MERCURY_GEN_PROC(traced_length_multi_in_t,
+                 ((length_multi_in_t)(in))((uint64_t)(trace_id)))
+MERCURY_GEN_PROC(traced_length_packed_in_t,
+                 ((length_packed_in_t)(in))((uint64_t)(trace_id)))
+MERCURY_GEN_PROC(traced_exists_multi_in_t,
+                 ((exists_multi_in_t)(in))((uint64_t)(trace_id)))
+MERCURY_GEN_PROC(traced_erase_multi_in_t,
+                 ((erase_multi_in_t)(in))((uint64_t)(trace_id)))
+MERCURY_GEN_PROC(traced_erase_range_in_t,
+                 ((erase_range_in_t)(in))((uint64_t)(trace_id)))
+MERCURY_GEN_PROC(traced_erase_prefix_in_t,
+                 ((erase_prefix_in_t)(in))((uint64_t)(trace_id)))
+MERCURY_GEN_PROC(traced_cas_in_t, ((cas_in_t)(in))((uint64_t)(trace_id)))
+MERCURY_GEN_PROC(traced_cas_packed_in_t,
+                 ((cas_packed_in_t)(in))((uint64_t)(trace_id)))
+MERCURY_GEN_PROC(traced_fetch_add_in_t,
+                 ((fetch_add_in_t)(in))((uint64_t)(trace_id)))
+MERCURY_GEN_PROC(traced_fetch_add_packed_in_t,
+                 ((fetch_add_packed_in_t)(in))((uint64_t)(trace_id)))
+MERCURY_GEN_PROC(traced_append_in_t, ((append_in_t)(in))((uint64_t)(trace_id)))
+MERCURY_GEN_PROC(traced_append_packed_in_t,
+                 ((append_packed_in_t)(in))((uint64_t)(trace_id)))
+MERCURY_GEN_PROC(traced_batch_in_t, ((batch_in_t)(in))((uint64_t)(trace_id)))
+MERCURY_GEN_PROC(traced_put_packed_multi_db_in_t,
+                 ((put_packed_multi_db_in_t)(in))((uint64_t)(trace_id)))
+MERCURY_GEN_PROC(traced_get_packed_multi_db_in_t,
+                 ((get_packed_multi_db_in_t)(in))((uint64_t)(trace_id)))
+MERCURY_GEN_PROC(traced_exists_packed_multi_db_in_t,
+                 ((exists_packed_multi_db_in_t)(in))((uint64_t)(trace_id)))
+MERCURY_GEN_PROC(traced_sync_in_t, ((sync_in_t)(in))((uint64_t)(trace_id)))
+MERCURY_GEN_PROC(traced_migrate_keys_in_t,
+                 ((migrate_keys_in_t)(in))((uint64_t)(trace_id)))
+MERCURY_GEN_PROC(traced_migrate_key_range_in_t,
+                 ((migrate_key_range_in_t)(in))((uint64_t)(trace_id)))
+MERCURY_GEN_PROC(traced_migrate_keys_prefixed_in_t,
+                 ((migrate_keys_prefixed_in_t)(in))((uint64_t)(trace_id)))
+MERCURY_GEN_PROC(traced_migrate_all_keys_in_t,
+                 ((migrate_all_keys_in_t)(in))((uint64_t)(trace_id)))
+MERCURY_GEN_PROC(traced_migrate_database_in_t,
+                 ((migrate_database_in_t)(in))((uint64_t)(trace_id)))
+
 #endif
@@ -9,6 +9,8 @@
 #include <unordered_map>
 #include <unordered_set>
 #include <sstream>
+#include <algorithm>
+#include <atomic>
 #ifdef USE_REMI
     #include <remi/remi-client.h>
     #include <remi/remi-server.h>
@@ -17,6 +19,8 @@
 #include "datastore/datastore_factory.h"
 #include "sdskv-rpc-types.h"
 #include "sdskv-server.h"
+#include "sdskv-local.h"
+#include "sdskv-metrics.h"
 
 #ifdef USE_SYMBIOMON
 #include <symbiomon/symbiomon-metric.h>
@@ -50,7 +54,10 @@ template <typename F> inline scoped_call<F> at_exit(F&& f)
 
 #define ENSURE_MARGO_DESTROY DEFER(margo_destroy, margo_destroy(handle))
 
-#define ENSURE_MARGO_RESPOND DEFER(margo_respond, margo_respond(handle, &out))
+/* responds when the handler returns, unless FIND_MID_AND_PROVIDER has */
+#define ENSURE_MARGO_RESPOND  \
+    bool __responded = false; \
+    DEFER(margo_respond, if (!__responded) margo_respond(handle, &out))
 
 #define ENSURE_MARGO_FREE_INPUT \
     DEFER(margo_free_input, margo_free_input(handle, &in))
@@ -58,36 +65,109 @@ template <typename F> inline scoped_call<F> at_exit(F&& f)
 #define SDSKV_LOG_ERROR(__mid__, __msg__, ...) \
     margo_error(__mid__, "%s:%d: " __msg__, __func__, __LINE__, ##__VA_ARGS__)
 
-#define FIND_MID_AND_PROVIDER                                              \
-    margo_instance_id     mid;                                             \
-    sdskv_provider_t      provider;                                        \
-    const struct hg_info* info;                                            \
-    do {                                                                   \
-        mid = margo_hg_handle_get_instance(handle);                        \
-        if (!mid) {                                                        \
-            margo_critical(                                                \
-                0, "%s:%d: could not get margo instance from RPC handle",  \
-                __func__, __LINE__);                                       \
-            exit(-1);                                                      \
-        }                                                                  \
-        info     = margo_get_info(handle);                                 \
-        provider = (sdskv_provider_t)margo_registered_data(mid, info->id); \
-        if (!provider) {                                                   \
-            SDSKV_LOG_ERROR(mid, "could not find provider with id %d",     \
-                            info->id);                                     \
-            out.ret = SDSKV_ERR_UNKNOWN_PR;                                \
-            return;                                                        \
-        }                                                                  \
-    } while (0)
+#define FIND_MID_AND_PROVIDER                                               \
+    margo_instance_id     mid;                                              \
+    sdskv_provider_t      provider;                                         \
+    const struct hg_info* info;                                             \
+    do {                                                                    \
+        mid = margo_hg_handle_get_instance(handle);                         \
+        if (!mid) {                                                         \
+            margo_critical(                                                 \
+                0, "%s:%d: could not get margo instance from RPC handle",   \
+                __func__, __LINE__);                                        \
+            exit(-1);                                                       \
+        }                                                                   \
+        info     = margo_get_info(handle);                                  \
+        provider = (sdskv_provider_t)margo_registered_data(mid, info->id);  \
+        if (!provider) {                                                    \
+            SDSKV_LOG_ERROR(mid, "could not find provider with id %d",      \
+                            info->id);                                      \
+            out.ret = SDSKV_ERR_UNKNOWN_PR;                                 \
+            return;                                                         \
+        }                                                                   \
+    } while (0);                                                            \
+    RequestMetrics __metrics(provider->metrics, provider->trace,            \
+                             provider->slow_ops, info->id);                 \
+    DEFER(record_metrics, double __t = ABT_get_wtime();                     \
+          margo_respond(handle, &out); __responded = true;                  \
+          __metrics.add(OpStats::PHASE_RESPOND, __t);                       \
+          __metrics.finish(out.ret))
 
 #define GET_INPUT                                                            \
     do {                                                                     \
-        hret = margo_get_input(handle, &in);                                 \
+        double __t = ABT_get_wtime();                                        \
+        hret       = margo_get_input(handle, &in);                           \
+        __metrics.add(OpStats::PHASE_DECODE, __t);                           \
         if (hret != HG_SUCCESS) {                                            \
             SDSKV_LOG_ERROR(mid, "margo_get_input failed (ret = %d)", hret); \
             out.ret = SDSKV_MAKE_HG_ERROR(hret);                             \
             return;                                                          \
         }                                                                    \
+        __metrics.set_request_id(__traced_in.trace_id);                      \
+    } while (0)
+
+/* Declares the input of an RPC inside the input of its "_traced" variant
+ * (see traced_put_in_t), which both variants are decoded into since the
+ * regular input is its first field. GET_INPUT hands the request id to the
+ * metrics; it stays 0 for the regular variant. */
+#define DECLARE_TRACED_INPUT(__type__)     \
+    traced_##__type__ __traced_in;         \
+    __type__&         in = __traced_in.in; \
+    __traced_in.trace_id = 0
+
+/* GET_INPUT for the RPCs without input, whose "_traced" variant only
+ * carries the request id */
+#define GET_TRACED_VOID_INPUT(__rpc__)                                     \
+    do {                                                                   \
+        if (info->id != provider->sdskv_##__rpc__##_traced_id) break;      \
+        traced_void_in_t __traced_in;                                      \
+        double           __t    = ABT_get_wtime();                         \
+        hg_return_t      __hret = margo_get_input(handle, &__traced_in);   \
+        __metrics.add(OpStats::PHASE_DECODE, __t);                         \
+        if (__hret != HG_SUCCESS) {                                        \
+            SDSKV_LOG_ERROR(mid, "margo_get_input failed (ret = %d)",      \
+                            __hret);                                       \
+            out.ret = SDSKV_MAKE_HG_ERROR(__hret);                         \
+            return;                                                        \
+        }                                                                  \
+        __metrics.set_request_id(__traced_in.trace_id);                    \
+        margo_free_input(handle, &__traced_in);                            \
+    } while (0)
+
+/* Registers the "_traced" variant of an RPC, handled like the RPC itself */
+#define REGISTER_TRACED_RPC(__rpc__, __in__, __out__, __ult__, __pool__)    \
+    do {                                                                    \
+        hg_id_t __id = MARGO_REGISTER_PROVIDER(                             \
+            mid, "sdskv_" #__rpc__ "_traced_rpc", traced_##__in__, __out__, \
+            __ult__, provider_id, __pool__);                                \
+        tmp_provider->sdskv_##__rpc__##_traced_id = __id;                   \
+        margo_register_data(mid, __id, (void*)tmp_provider, NULL);          \
+    } while (0)
+
+/* Waits for the database's admission control, if enabled, to let the
+ * request run (see AbstractDataStore::admit), or responds SDSKV_ERR_BUSY */
+#define ENSURE_ADMITTED                                                     \
+    bool __admitted = false;                                                \
+    DEFER(admission_release, if (__admitted) db->release());                \
+    if (db->admission_enabled()) {                                          \
+        double __t = ABT_get_wtime();                                       \
+        out.ret    = db->admit(get_client_name(provider, info->addr));      \
+        __metrics.add(OpStats::PHASE_QUEUE, __t);                           \
+        if (out.ret != SDSKV_SUCCESS) return;                               \
+        __admitted = true;                                                  \
+    }
+
+/* ENSURE_ADMITTED for the databases of a cross-database request (see
+ * admit_databases) */
+#define ENSURE_ADMITTED_MULTI_DB(__dbs__)                                   \
+    std::vector<AbstractDataStore*> __admitted;                             \
+    DEFER(admission_release, for (auto __db : __admitted) __db->release()); \
+    do {                                                                    \
+        double __t = ABT_get_wtime();                                       \
+        out.ret                                                             \
+            = admit_databases(provider, info->addr, __dbs__, __admitted);   \
+        __metrics.add(OpStats::PHASE_QUEUE, __t);                           \
+        if (out.ret != SDSKV_SUCCESS) return;                               \
     } while (0)
 
 #define FIND_DATABASE                                                          \
@@ -100,7 +180,13 @@ template <typename F> inline scoped_call<F> at_exit(F&& f)
         return;                                                                \
     }                                                                          \
     auto db = it->second;                                                      \
-    ABT_rwlock_unlock(provider->lock)
+    ABT_rwlock_unlock(provider->lock);                                         \
+    __metrics.set_database(in.db_id, db->op_stats());                          \
+    ENSURE_ADMITTED
+
+/* margo_bulk_transfer, with the time spent counted as the bulk phase of the
+ * request (see RequestMetrics) */
+#define TIMED_BULK_TRANSFER(...) __metrics.bulk_transfer(__VA_ARGS__)
 
 struct sdskv_server_context_t {
     margo_instance_id mid;
@@ -133,6 +219,26 @@ struct sdskv_server_context_t {
     // operations. There should be something better to avoid locking everything
     // but we are going with that for simplicity for now.
 
+    ABT_pool rpc_pool;
+    /* pools for each class of RPC (see "pools" in the JSON config) */
+    ABT_pool read_pool;
+    ABT_pool write_pool;
+    ABT_pool scan_pool;
+    ABT_pool maintenance_pool;
+
+    /* background ULT syncing the databases with periodic durability */
+    ABT_thread        sync_thread;
+    std::atomic<bool> sync_stop;
+
+    /* put_packed requests larger than put_packed_chunk_size are pulled in
+     * chunks, with up to put_packed_pipeline_depth chunks in flight */
+    size_t   put_packed_chunk_size;
+    unsigned put_packed_pipeline_depth;
+    /* get_packed responses larger than get_packed_chunk_size are pushed in
+     * chunks while the next values are looked up */
+    size_t   get_packed_chunk_size;
+    unsigned get_packed_pipeline_depth;
+
     hg_id_t sdskv_open_id;
     hg_id_t sdskv_count_databases_id;
     hg_id_t sdskv_list_databases_id;
@@ -147,22 +253,165 @@ struct sdskv_server_context_t {
     hg_id_t sdskv_exists_multi_id;
     hg_id_t sdskv_erase_id;
     hg_id_t sdskv_erase_multi_id;
+    hg_id_t sdskv_erase_range_id;
+    hg_id_t sdskv_erase_prefix_id;
+    hg_id_t sdskv_cas_id;
+    hg_id_t sdskv_cas_packed_id;
+    hg_id_t sdskv_fetch_add_id;
+    hg_id_t sdskv_fetch_add_packed_id;
+    hg_id_t sdskv_append_id;
+    hg_id_t sdskv_append_packed_id;
     hg_id_t sdskv_length_id;
     hg_id_t sdskv_length_multi_id;
     hg_id_t sdskv_length_packed_id;
     hg_id_t sdskv_bulk_get_id;
     hg_id_t sdskv_list_keys_id;
     hg_id_t sdskv_list_keyvals_id;
+    hg_id_t sdskv_sync_id;
+    hg_id_t sdskv_batch_id;
+    hg_id_t sdskv_put_packed_multi_db_id;
+    hg_id_t sdskv_get_packed_multi_db_id;
+    hg_id_t sdskv_exists_packed_multi_db_id;
     /* migration */
     hg_id_t sdskv_migrate_keys_id;
     hg_id_t sdskv_migrate_key_range_id;
     hg_id_t sdskv_migrate_keys_prefixed_id;
     hg_id_t sdskv_migrate_all_keys_id;
     hg_id_t sdskv_migrate_database_id;
+    /* "_traced" variants of the RPCs (see DECLARE_TRACED_INPUT) */
+    hg_id_t sdskv_open_traced_id;
+    hg_id_t sdskv_count_databases_traced_id;
+    hg_id_t sdskv_list_databases_traced_id;
+    hg_id_t sdskv_put_traced_id;
+    hg_id_t sdskv_put_multi_traced_id;
+    hg_id_t sdskv_put_packed_traced_id;
+    hg_id_t sdskv_bulk_put_traced_id;
+    hg_id_t sdskv_get_traced_id;
+    hg_id_t sdskv_get_multi_traced_id;
+    hg_id_t sdskv_get_packed_traced_id;
+    hg_id_t sdskv_length_traced_id;
+    hg_id_t sdskv_length_multi_traced_id;
+    hg_id_t sdskv_length_packed_traced_id;
+    hg_id_t sdskv_exists_traced_id;
+    hg_id_t sdskv_exists_multi_traced_id;
+    hg_id_t sdskv_bulk_get_traced_id;
+    hg_id_t sdskv_list_keys_traced_id;
+    hg_id_t sdskv_list_keyvals_traced_id;
+    hg_id_t sdskv_sync_traced_id;
+    hg_id_t sdskv_batch_traced_id;
+    hg_id_t sdskv_put_packed_multi_db_traced_id;
+    hg_id_t sdskv_get_packed_multi_db_traced_id;
+    hg_id_t sdskv_exists_packed_multi_db_traced_id;
+    hg_id_t sdskv_erase_traced_id;
+    hg_id_t sdskv_erase_multi_traced_id;
+    hg_id_t sdskv_erase_range_traced_id;
+    hg_id_t sdskv_erase_prefix_traced_id;
+    hg_id_t sdskv_cas_traced_id;
+    hg_id_t sdskv_cas_packed_traced_id;
+    hg_id_t sdskv_fetch_add_traced_id;
+    hg_id_t sdskv_fetch_add_packed_traced_id;
+    hg_id_t sdskv_append_traced_id;
+    hg_id_t sdskv_append_packed_traced_id;
+    hg_id_t sdskv_migrate_keys_traced_id;
+    hg_id_t sdskv_migrate_key_range_traced_id;
+    hg_id_t sdskv_migrate_keys_prefixed_traced_id;
+    hg_id_t sdskv_migrate_all_keys_traced_id;
+    hg_id_t sdskv_migrate_database_traced_id;
+    hg_id_t sdskv_get_stats_traced_id;
+    hg_id_t sdskv_get_trace_traced_id;
+    hg_id_t sdskv_get_slow_ops_traced_id;
+    /* direct dispatch for clients in the same margo instance */
+    hg_id_t           sdskv_local_id;
+    sdskv_local_ops_t local_ops;
+    std::string       local_client_name;
+
+    /* names of the senders of requests, for admission control (see
+     * get_client_name) */
+    ABT_rwlock client_names_lock;
+    std::unordered_map<hg_addr_t, std::pair<hg_addr_t, std::string>>
+        client_names;
+
+    /* latency and error counts of each RPC, see sdskv_provider_get_stats */
+    hg_id_t         sdskv_get_stats_id;
+    MetricsRegistry metrics;
+    /* spans of sampled requests, NULL if tracing is disabled */
+    hg_id_t        sdskv_get_trace_id;
+    sdskv_trace_t* trace;
+    /* requests slower than the configured thresholds, NULL if disabled */
+    hg_id_t    sdskv_get_slow_ops_id;
+    SlowOpLog* slow_ops;
 
     Json::Value json_cfg;
 };
 
+static std::string addr_to_string(margo_instance_id mid, hg_addr_t addr)
+{
+    char      buf[256];
+    hg_size_t size = sizeof(buf);
+    if (margo_addr_to_string(mid, buf, &size, addr) != HG_SUCCESS)
+        return std::string();
+    return std::string(buf);
+}
+
+#define SDSKV_MAX_CLIENT_NAMES 4096
+
+static void clear_client_names(sdskv_provider_t provider)
+{
+    for (auto& p : provider->client_names)
+        margo_addr_free(provider->mid, p.second.first);
+    provider->client_names.clear();
+}
+
+/* Name used to identify the sender of a request in admission control.
+ * margo_addr_to_string is too costly to call on every request, so names
+ * are cached by address. The address of a request may belong to its
+ * handle, which mercury reuses for other senders, so each entry keeps a
+ * copy of the address it was computed for and is only used if that copy
+ * still compares equal. */
+static std::string get_client_name(sdskv_provider_t provider, hg_addr_t addr)
+{
+    ABT_rwlock_rdlock(provider->client_names_lock);
+    auto it = provider->client_names.find(addr);
+    if (it != provider->client_names.end()
+        && margo_addr_cmp(provider->mid, it->second.first, addr)) {
+        std::string name = it->second.second;
+        ABT_rwlock_unlock(provider->client_names_lock);
+        return name;
+    }
+    ABT_rwlock_unlock(provider->client_names_lock);
+
+    std::string name = addr_to_string(provider->mid, addr);
+    hg_addr_t   copy = HG_ADDR_NULL;
+    if (name.empty()
+        || margo_addr_dup(provider->mid, addr, &copy) != HG_SUCCESS)
+        return name;
+    ABT_rwlock_wrlock(provider->client_names_lock);
+    if (provider->client_names.size() >= SDSKV_MAX_CLIENT_NAMES)
+        clear_client_names(provider);
+    auto& entry = provider->client_names[addr];
+    if (entry.first != HG_ADDR_NULL)
+        margo_addr_free(provider->mid, entry.first);
+    entry = std::make_pair(copy, name);
+    ABT_rwlock_unlock(provider->client_names_lock);
+    return name;
+}
+
+/* subtracts the n sizes from *remaining, returning false if they add up to
+ * more than *remaining; used to check the sizes found in a bulk buffer
+ * against the size of that buffer before following them */
+static bool consume_sizes(const hg_size_t* sizes, hg_size_t n,
+                          hg_size_t* remaining)
+{
+    for (hg_size_t i = 0; i < n; i++) {
+        if (sizes[i] > *remaining) return false;
+        *remaining -= sizes[i];
+    }
+    return true;
+}
+
+DECLARE_MARGO_RPC_HANDLER(sdskv_get_stats_ult)
+DECLARE_MARGO_RPC_HANDLER(sdskv_get_trace_ult)
+DECLARE_MARGO_RPC_HANDLER(sdskv_get_slow_ops_ult)
 DECLARE_MARGO_RPC_HANDLER(sdskv_open_ult)
 DECLARE_MARGO_RPC_HANDLER(sdskv_count_db_ult)
 DECLARE_MARGO_RPC_HANDLER(sdskv_list_db_ult)
@@ -179,10 +428,23 @@ DECLARE_MARGO_RPC_HANDLER(sdskv_bulk_put_ult)
 DECLARE_MARGO_RPC_HANDLER(sdskv_bulk_get_ult)
 DECLARE_MARGO_RPC_HANDLER(sdskv_list_keys_ult)
 DECLARE_MARGO_RPC_HANDLER(sdskv_list_keyvals_ult)
+DECLARE_MARGO_RPC_HANDLER(sdskv_sync_ult)
+DECLARE_MARGO_RPC_HANDLER(sdskv_batch_ult)
+DECLARE_MARGO_RPC_HANDLER(sdskv_put_packed_multi_db_ult)
+DECLARE_MARGO_RPC_HANDLER(sdskv_get_packed_multi_db_ult)
+DECLARE_MARGO_RPC_HANDLER(sdskv_exists_packed_multi_db_ult)
 DECLARE_MARGO_RPC_HANDLER(sdskv_erase_ult)
 DECLARE_MARGO_RPC_HANDLER(sdskv_erase_multi_ult)
+DECLARE_MARGO_RPC_HANDLER(sdskv_erase_range_ult)
+DECLARE_MARGO_RPC_HANDLER(sdskv_erase_prefix_ult)
 DECLARE_MARGO_RPC_HANDLER(sdskv_exists_ult)
 DECLARE_MARGO_RPC_HANDLER(sdskv_exists_multi_ult)
+DECLARE_MARGO_RPC_HANDLER(sdskv_cas_ult)
+DECLARE_MARGO_RPC_HANDLER(sdskv_cas_packed_ult)
+DECLARE_MARGO_RPC_HANDLER(sdskv_fetch_add_ult)
+DECLARE_MARGO_RPC_HANDLER(sdskv_fetch_add_packed_ult)
+DECLARE_MARGO_RPC_HANDLER(sdskv_append_ult)
+DECLARE_MARGO_RPC_HANDLER(sdskv_append_packed_ult)
 DECLARE_MARGO_RPC_HANDLER(sdskv_migrate_keys_ult)
 DECLARE_MARGO_RPC_HANDLER(sdskv_migrate_key_range_ult)
 DECLARE_MARGO_RPC_HANDLER(sdskv_migrate_keys_prefixed_ult)
@@ -191,6 +453,10 @@ DECLARE_MARGO_RPC_HANDLER(sdskv_migrate_database_ult)
 
 static void sdskv_server_finalize_cb(void* data);
 
+static int sdskv_start_sync_thread(sdskv_provider_t provider);
+
+static void sdskv_init_local_ops(sdskv_provider_t provider);
+
 #ifdef USE_REMI
 
 static int sdskv_pre_migration_callback(remi_fileset_t fileset, void* uargs);
@@ -201,6 +467,22 @@ static int sdskv_post_migration_callback(remi_fileset_t fileset, void* uargs);
 
 static int populate_provider_from_config(sdskv_provider_t provider);
 
+static bool parse_durability(const std::string&               name,
+                             AbstractDataStore::durability_t* durability)
+{
+    AbstractDataStore::durability_t d;
+    if (name == "none")
+        d = AbstractDataStore::DURABILITY_NONE;
+    else if (name == "periodic")
+        d = AbstractDataStore::DURABILITY_PERIODIC;
+    else if (name == "sync")
+        d = AbstractDataStore::DURABILITY_SYNC;
+    else
+        return false;
+    if (durability) *durability = d;
+    return true;
+}
+
 static int validate_and_complete_config(margo_instance_id mid,
                                         Json::Value&      config)
 {
@@ -216,13 +498,142 @@ static int validate_and_complete_config(margo_instance_id mid,
      *         "type" : "<database-type>",         (required)
      *         "path" : "<database-path>",         (required for some backends)
      *         "comparator" : "<comparator-name>", (optional, default to "")
-     *         "no_overwrite" : true/false         (optional, default to false)
+     *         "no_overwrite" : true/false,        (optional, default to false)
+     *         "group_commit" : true/false,        (optional, default to false)
+     *         "durability" : "none"/"periodic"/"sync", (optional, "none")
+     *         "sync_interval_ms" : <interval>,    (optional, default to 1000)
+     *         "max_inflight" : <n>,               (optional, default to 0)
+     *         "max_queued_per_client" : <n>,      (optional, default to 0)
+     *         "client_weights" : { "<address>" : <weight>, ... } (optional)
+     *         "hot_keys" : <n>,                   (optional, default to 0)
+     *         "hot_key_prefix_length" : <bytes>,  (optional, default to 0)
+     *         "hot_key_sample_every" : <n>,       (optional, default to 1)
      *       },
      *       ...
-     *    ]
+     *    ],
+     *    "put_packed_chunk_size" : <bytes>,       (optional, default to 4 MiB)
+     *    "put_packed_pipeline_depth" : <chunks>,  (optional, default to 2)
+     *    "get_packed_chunk_size" : <bytes>,       (optional, default to 4 MiB)
+     *    "get_packed_pipeline_depth" : <chunks>,  (optional, default to 2)
+     *    "pools" : {                              (optional)
+     *       "read" : "<pool-name>",        (gets, lengths, exists)
+     *       "write" : "<pool-name>",       (puts, erases, batches, RMW)
+     *       "scan" : "<pool-name>",        (key listings, range/prefix erases)
+     *       "maintenance" : "<pool-name>"  (sync, migrations, sync thread)
+     *    },
+     *    "tracing" : {                            (optional)
+     *       "sample_rate" : <0 to 1>,             (optional, default to 0)
+     *       "buffer_size" : <events>              (optional, default to 65536)
+     *    },
+     *    "slow_ops" : {                           (optional)
+     *       "total_threshold_ms" : <ms>,          (optional, default to 0)
+     *       "engine_threshold_ms" : <ms>,         (optional, default to 0)
+     *       "buffer_size" : <entries>,            (optional, default to 1024)
+     *       "path" : "<file>"                     (optional, default to "")
+     *    }
      * }
+     * Pools are looked up by name in the margo instance; a missing entry
+     * means the provider's rpc_pool. Giving point operations their own pool,
+     * and a "prio_wait" scheduler that lists it first, keeps them from
+     * queuing behind long scans or migrations.
+     * With a positive sample_rate, that fraction of the requests is traced
+     * (see sdskv_provider_get_trace); clients with the same rate trace the
+     * same requests.
+     * Requests whose total or engine time reaches a positive threshold are
+     * logged (see sdskv_provider_get_slow_ops), and appended as JSON lines
+     * to path if it is not empty.
      **/
     if (config.isNull()) { config = Json::Value(Json::objectValue); }
+    // check pools
+    if (config.isMember("pools")) {
+        auto& pools = config["pools"];
+        if (!pools.isObject()) {
+            SDSKV_LOG_ERROR(mid, "\"pools\" field should be an object");
+            return SDSKV_ERR_CONFIG;
+        }
+        for (const auto& cls : pools.getMemberNames()) {
+            if (cls != "read" && cls != "write" && cls != "scan"
+                && cls != "maintenance") {
+                SDSKV_LOG_ERROR(mid, "unknown class of RPC \"%s\" in pools",
+                                cls.c_str());
+                return SDSKV_ERR_CONFIG;
+            }
+            if (!pools[cls].isString()) {
+                SDSKV_LOG_ERROR(mid, "pool name for \"%s\" should be a string",
+                                cls.c_str());
+                return SDSKV_ERR_CONFIG;
+            }
+        }
+    }
+    // check put_packed/get_packed pipelining parameters
+    for (const char* field :
+         {"put_packed_chunk_size", "get_packed_chunk_size"}) {
+        if (!config.isMember(field)) config[field] = 4 * 1024 * 1024;
+        if (!config[field].isUInt64() || config[field].asUInt64() == 0) {
+            SDSKV_LOG_ERROR(mid, "%s field should be a positive integer",
+                            field);
+            return SDSKV_ERR_CONFIG;
+        }
+    }
+    for (const char* field :
+         {"put_packed_pipeline_depth", "get_packed_pipeline_depth"}) {
+        if (!config.isMember(field)) config[field] = 2;
+        if (!config[field].isUInt() || config[field].asUInt() == 0) {
+            SDSKV_LOG_ERROR(mid, "%s field should be a positive integer",
+                            field);
+            return SDSKV_ERR_CONFIG;
+        }
+    }
+    // check tracing parameters
+    if (!config.isMember("tracing")) {
+        config["tracing"] = Json::Value(Json::objectValue);
+    }
+    auto& tracing = config["tracing"];
+    if (!tracing.isObject()) {
+        SDSKV_LOG_ERROR(mid, "\"tracing\" field should be an object");
+        return SDSKV_ERR_CONFIG;
+    }
+    if (!tracing.isMember("sample_rate")) tracing["sample_rate"] = 0.0;
+    if (!tracing["sample_rate"].isNumeric()
+        || tracing["sample_rate"].asDouble() < 0.0
+        || tracing["sample_rate"].asDouble() > 1.0) {
+        SDSKV_LOG_ERROR(mid, "sample_rate field should be between 0 and 1");
+        return SDSKV_ERR_CONFIG;
+    }
+    if (!tracing.isMember("buffer_size")) tracing["buffer_size"] = 65536;
+    if (!tracing["buffer_size"].isUInt64()
+        || tracing["buffer_size"].asUInt64() == 0) {
+        SDSKV_LOG_ERROR(mid, "buffer_size field should be a positive integer");
+        return SDSKV_ERR_CONFIG;
+    }
+    // check slow operation log parameters
+    if (!config.isMember("slow_ops")) {
+        config["slow_ops"] = Json::Value(Json::objectValue);
+    }
+    auto& slow_ops = config["slow_ops"];
+    if (!slow_ops.isObject()) {
+        SDSKV_LOG_ERROR(mid, "\"slow_ops\" field should be an object");
+        return SDSKV_ERR_CONFIG;
+    }
+    for (const char* field : {"total_threshold_ms", "engine_threshold_ms"}) {
+        if (!slow_ops.isMember(field)) slow_ops[field] = 0.0;
+        if (!slow_ops[field].isNumeric() || slow_ops[field].asDouble() < 0.0) {
+            SDSKV_LOG_ERROR(mid, "%s field should be a non-negative number",
+                            field);
+            return SDSKV_ERR_CONFIG;
+        }
+    }
+    if (!slow_ops.isMember("buffer_size")) slow_ops["buffer_size"] = 1024;
+    if (!slow_ops["buffer_size"].isUInt64()
+        || slow_ops["buffer_size"].asUInt64() == 0) {
+        SDSKV_LOG_ERROR(mid, "buffer_size field should be a positive integer");
+        return SDSKV_ERR_CONFIG;
+    }
+    if (!slow_ops.isMember("path")) slow_ops["path"] = "";
+    if (!slow_ops["path"].isString()) {
+        SDSKV_LOG_ERROR(mid, "path field should be a string");
+        return SDSKV_ERR_CONFIG;
+    }
     // validate comparators
     if (config.isMember("comparators")) {
         if (!config["comparators"].isArray()) {
@@ -311,9 +722,31 @@ static int validate_and_complete_config(margo_instance_id mid,
         if (!db.isMember("path")) db["path"] = "";
         if (!db.isMember("comparator")) db["comparator"] = "";
         if (!db.isMember("no_overwrite")) db["no_overwrite"] = false;
-        auto& path         = db["path"];
-        auto& comparator   = db["comparator"];
-        auto& no_overwrite = db["no_overwrite"];
+        if (!db.isMember("group_commit")) db["group_commit"] = false;
+        if (!db.isMember("durability")) db["durability"] = "none";
+        if (!db.isMember("sync_interval_ms")) db["sync_interval_ms"] = 1000;
+        if (!db.isMember("max_inflight")) db["max_inflight"] = 0;
+        if (!db.isMember("max_queued_per_client"))
+            db["max_queued_per_client"] = 0;
+        if (!db.isMember("client_weights"))
+            db["client_weights"] = Json::Value(Json::objectValue);
+        if (!db.isMember("hot_keys")) db["hot_keys"] = 0;
+        if (!db.isMember("hot_key_prefix_length"))
+            db["hot_key_prefix_length"] = 0;
+        if (!db.isMember("hot_key_sample_every"))
+            db["hot_key_sample_every"] = 1;
+        auto& path             = db["path"];
+        auto& comparator       = db["comparator"];
+        auto& no_overwrite     = db["no_overwrite"];
+        auto& group_commit     = db["group_commit"];
+        auto& durability       = db["durability"];
+        auto& sync_interval_ms = db["sync_interval_ms"];
+        auto& max_inflight     = db["max_inflight"];
+        auto& max_queued       = db["max_queued_per_client"];
+        auto& client_weights   = db["client_weights"];
+        auto& hot_keys         = db["hot_keys"];
+        auto& hot_key_prefix   = db["hot_key_prefix_length"];
+        auto& hot_key_sampling = db["hot_key_sample_every"];
         if (!path.isString()) {
             SDSKV_LOG_ERROR(mid, "database path should be a string");
             return SDSKV_ERR_CONFIG;
@@ -326,6 +759,55 @@ static int validate_and_complete_config(margo_instance_id mid,
             SDSKV_LOG_ERROR(mid, "no_overwrite field should be a boolean");
             return SDSKV_ERR_CONFIG;
         }
+        if (!group_commit.isBool()) {
+            SDSKV_LOG_ERROR(mid, "group_commit field should be a boolean");
+            return SDSKV_ERR_CONFIG;
+        }
+        if (!durability.isString()
+            || !parse_durability(durability.asString(), nullptr)) {
+            SDSKV_LOG_ERROR(mid,
+                            "durability field should be one of \"none\", "
+                            "\"periodic\" or \"sync\"");
+            return SDSKV_ERR_CONFIG;
+        }
+        if (!sync_interval_ms.isUInt() || sync_interval_ms.asUInt() == 0) {
+            SDSKV_LOG_ERROR(mid,
+                            "sync_interval_ms field should be a positive "
+                            "integer");
+            return SDSKV_ERR_CONFIG;
+        }
+        if (!max_inflight.isUInt() || !max_queued.isUInt()) {
+            SDSKV_LOG_ERROR(mid,
+                            "max_inflight and max_queued_per_client fields "
+                            "should be non-negative integers");
+            return SDSKV_ERR_CONFIG;
+        }
+        if (!client_weights.isObject()) {
+            SDSKV_LOG_ERROR(mid, "client_weights field should be an object");
+            return SDSKV_ERR_CONFIG;
+        }
+        for (const auto& client : client_weights.getMemberNames()) {
+            if (!client_weights[client].isNumeric()
+                || client_weights[client].asDouble() <= 0) {
+                SDSKV_LOG_ERROR(mid,
+                                "weight of client \"%s\" should be a "
+                                "positive number",
+                                client.c_str());
+                return SDSKV_ERR_CONFIG;
+            }
+        }
+        if (!hot_keys.isUInt() || !hot_key_prefix.isUInt()) {
+            SDSKV_LOG_ERROR(mid,
+                            "hot_keys and hot_key_prefix_length fields "
+                            "should be non-negative integers");
+            return SDSKV_ERR_CONFIG;
+        }
+        if (!hot_key_sampling.isUInt() || hot_key_sampling.asUInt() == 0) {
+            SDSKV_LOG_ERROR(mid,
+                            "hot_key_sample_every field should be a positive "
+                            "integer");
+            return SDSKV_ERR_CONFIG;
+        }
         if (database_names.count(name.asString())) {
             SDSKV_LOG_ERROR(mid, "multiple databases with name \"%s\" found",
                             name.asString().c_str());
@@ -337,6 +819,31 @@ static int validate_and_complete_config(margo_instance_id mid,
     return SDSKV_SUCCESS;
 }
 
+/* Resolves the pool for a class of RPC: the pool given in the init info
+ * first, then the pool named in the config, then the default pool. */
+static int find_class_pool(margo_instance_id  mid,
+                           const Json::Value& config,
+                           const char*        cls,
+                           ABT_pool           arg_pool,
+                           ABT_pool           default_pool,
+                           ABT_pool*          pool)
+{
+    *pool = default_pool;
+    if (arg_pool != ABT_POOL_NULL) {
+        *pool = arg_pool;
+        return SDSKV_SUCCESS;
+    }
+    if (!config.isMember("pools") || !config["pools"].isMember(cls))
+        return SDSKV_SUCCESS;
+    const std::string name = config["pools"][cls].asString();
+    if (margo_get_pool_by_name(mid, name.c_str(), pool) != 0) {
+        SDSKV_LOG_ERROR(mid, "could not find pool \"%s\" for %s RPCs",
+                        name.c_str(), cls);
+        return SDSKV_ERR_CONFIG;
+    }
+    return SDSKV_SUCCESS;
+}
+
 extern "C" int
 sdskv_provider_register(margo_instance_id                      mid,
                         uint16_t                               provider_id,
@@ -379,6 +886,23 @@ sdskv_provider_register(margo_instance_id                      mid,
     ret = validate_and_complete_config(mid, config);
     if (ret != SDSKV_SUCCESS) return ret;
 
+    /* find the pools for each class of RPC */
+    ABT_pool read_pool, write_pool, scan_pool, maintenance_pool;
+    if ((ret = find_class_pool(mid, config, "read", args->read_pool,
+                               args->rpc_pool, &read_pool))
+            != SDSKV_SUCCESS
+        || (ret = find_class_pool(mid, config, "write", args->write_pool,
+                                  args->rpc_pool, &write_pool))
+               != SDSKV_SUCCESS
+        || (ret = find_class_pool(mid, config, "scan", args->scan_pool,
+                                  args->rpc_pool, &scan_pool))
+               != SDSKV_SUCCESS
+        || (ret = find_class_pool(mid, config, "maintenance",
+                                  args->maintenance_pool, args->rpc_pool,
+                                  &maintenance_pool))
+               != SDSKV_SUCCESS)
+        return ret;
+
     /* allocate the resulting structure */
     tmp_provider = new sdskv_server_context_t;
     if (!tmp_provider) return SDSKV_ERR_ALLOCATION;
@@ -401,163 +925,524 @@ sdskv_provider_register(margo_instance_id                      mid,
         SDSKV_LOG_ERROR(mid, "failed to create rwlock");
         return SDSKV_MAKE_ABT_ERROR(ret);
     }
+    ABT_rwlock_create(&(tmp_provider->client_names_lock));
+
+    tmp_provider->rpc_pool         = args->rpc_pool;
+    tmp_provider->read_pool        = read_pool;
+    tmp_provider->write_pool       = write_pool;
+    tmp_provider->scan_pool        = scan_pool;
+    tmp_provider->maintenance_pool = maintenance_pool;
+    tmp_provider->sync_thread      = ABT_THREAD_NULL;
+    tmp_provider->sync_stop        = false;
+    tmp_provider->put_packed_chunk_size
+        = config["put_packed_chunk_size"].asUInt64();
+    tmp_provider->put_packed_pipeline_depth
+        = config["put_packed_pipeline_depth"].asUInt();
+    tmp_provider->get_packed_chunk_size
+        = config["get_packed_chunk_size"].asUInt64();
+    tmp_provider->get_packed_pipeline_depth
+        = config["get_packed_pipeline_depth"].asUInt();
+    tmp_provider->trace
+        = sdskv_trace_create(config["tracing"]["sample_rate"].asDouble(),
+                             config["tracing"]["buffer_size"].asUInt64(), 0);
+    tmp_provider->slow_ops = nullptr;
+    {
+        auto&  slow_ops = config["slow_ops"];
+        double total    = slow_ops["total_threshold_ms"].asDouble() / 1e3;
+        double engine   = slow_ops["engine_threshold_ms"].asDouble() / 1e3;
+        if (total > 0 || engine > 0) {
+            tmp_provider->slow_ops
+                = new SlowOpLog(total, engine,
+                                slow_ops["buffer_size"].asUInt64(),
+                                slow_ops["path"].asString());
+            if (!tmp_provider->slow_ops->file_ok())
+                margo_warning(mid, "could not open slow operation log %s",
+                              slow_ops["path"].asString().c_str());
+        }
+    }
 
     /* register RPCs */
     hg_id_t rpc_id;
     rpc_id
         = MARGO_REGISTER_PROVIDER(mid, "sdskv_open_rpc", open_in_t, open_out_t,
-                                  sdskv_open_ult, provider_id, args->rpc_pool);
+                                  sdskv_open_ult, provider_id, read_pool);
     tmp_provider->sdskv_open_id = rpc_id;
     margo_register_data(mid, rpc_id, (void*)tmp_provider, NULL);
+    REGISTER_TRACED_RPC(open, open_in_t, open_out_t, sdskv_open_ult, read_pool);
 
     rpc_id = MARGO_REGISTER_PROVIDER(mid, "sdskv_count_databases_rpc", void,
                                      count_db_out_t, sdskv_count_db_ult,
-                                     provider_id, args->rpc_pool);
+                                     provider_id, read_pool);
     tmp_provider->sdskv_count_databases_id = rpc_id;
     margo_register_data(mid, rpc_id, (void*)tmp_provider, NULL);
+    REGISTER_TRACED_RPC(count_databases, void_in_t, count_db_out_t,
+                        sdskv_count_db_ult, read_pool);
 
     rpc_id = MARGO_REGISTER_PROVIDER(
         mid, "sdskv_list_databases_rpc", list_db_in_t, list_db_out_t,
-        sdskv_list_db_ult, provider_id, args->rpc_pool);
+        sdskv_list_db_ult, provider_id, read_pool);
     tmp_provider->sdskv_list_databases_id = rpc_id;
     margo_register_data(mid, rpc_id, (void*)tmp_provider, NULL);
+    REGISTER_TRACED_RPC(list_databases, list_db_in_t, list_db_out_t,
+                        sdskv_list_db_ult, read_pool);
 
     rpc_id
         = MARGO_REGISTER_PROVIDER(mid, "sdskv_put_rpc", put_in_t, put_out_t,
-                                  sdskv_put_ult, provider_id, args->rpc_pool);
+                                  sdskv_put_ult, provider_id, write_pool);
     tmp_provider->sdskv_put_id = rpc_id;
     margo_register_data(mid, rpc_id, (void*)tmp_provider, NULL);
+    REGISTER_TRACED_RPC(put, put_in_t, put_out_t, sdskv_put_ult, write_pool);
 
     rpc_id = MARGO_REGISTER_PROVIDER(mid, "sdskv_put_multi_rpc", put_multi_in_t,
                                      put_multi_out_t, sdskv_put_multi_ult,
-                                     provider_id, args->rpc_pool);
+                                     provider_id, write_pool);
     tmp_provider->sdskv_put_multi_id = rpc_id;
     margo_register_data(mid, rpc_id, (void*)tmp_provider, NULL);
+    REGISTER_TRACED_RPC(put_multi, put_multi_in_t, put_multi_out_t,
+                        sdskv_put_multi_ult, write_pool);
 
     rpc_id = MARGO_REGISTER_PROVIDER(
         mid, "sdskv_put_packed_rpc", put_packed_in_t, put_packed_out_t,
-        sdskv_put_packed_ult, provider_id, args->rpc_pool);
+        sdskv_put_packed_ult, provider_id, write_pool);
     tmp_provider->sdskv_put_packed_id = rpc_id;
     margo_register_data(mid, rpc_id, (void*)tmp_provider, NULL);
+    REGISTER_TRACED_RPC(put_packed, put_packed_in_t, put_packed_out_t,
+                        sdskv_put_packed_ult, write_pool);
 
     rpc_id = MARGO_REGISTER_PROVIDER(mid, "sdskv_bulk_put_rpc", bulk_put_in_t,
                                      bulk_put_out_t, sdskv_bulk_put_ult,
-                                     provider_id, args->rpc_pool);
+                                     provider_id, write_pool);
     tmp_provider->sdskv_bulk_put_id = rpc_id;
     margo_register_data(mid, rpc_id, (void*)tmp_provider, NULL);
+    REGISTER_TRACED_RPC(bulk_put, bulk_put_in_t, bulk_put_out_t,
+                        sdskv_bulk_put_ult, write_pool);
 
     rpc_id
         = MARGO_REGISTER_PROVIDER(mid, "sdskv_get_rpc", get_in_t, get_out_t,
-                                  sdskv_get_ult, provider_id, args->rpc_pool);
+                                  sdskv_get_ult, provider_id, read_pool);
     tmp_provider->sdskv_get_id = rpc_id;
     margo_register_data(mid, rpc_id, (void*)tmp_provider, NULL);
+    REGISTER_TRACED_RPC(get, get_in_t, get_out_t, sdskv_get_ult, read_pool);
 
     rpc_id = MARGO_REGISTER_PROVIDER(mid, "sdskv_get_multi_rpc", get_multi_in_t,
                                      get_multi_out_t, sdskv_get_multi_ult,
-                                     provider_id, args->rpc_pool);
+                                     provider_id, read_pool);
     tmp_provider->sdskv_get_multi_id = rpc_id;
     margo_register_data(mid, rpc_id, (void*)tmp_provider, NULL);
+    REGISTER_TRACED_RPC(get_multi, get_multi_in_t, get_multi_out_t,
+                        sdskv_get_multi_ult, read_pool);
 
     rpc_id = MARGO_REGISTER_PROVIDER(
         mid, "sdskv_get_packed_rpc", get_packed_in_t, get_packed_out_t,
-        sdskv_get_packed_ult, provider_id, args->rpc_pool);
+        sdskv_get_packed_ult, provider_id, read_pool);
     tmp_provider->sdskv_get_packed_id = rpc_id;
     margo_register_data(mid, rpc_id, (void*)tmp_provider, NULL);
+    REGISTER_TRACED_RPC(get_packed, get_packed_in_t, get_packed_out_t,
+                        sdskv_get_packed_ult, read_pool);
 
     rpc_id = MARGO_REGISTER_PROVIDER(mid, "sdskv_length_rpc", length_in_t,
                                      length_out_t, sdskv_length_ult,
-                                     provider_id, args->rpc_pool);
+                                     provider_id, read_pool);
     tmp_provider->sdskv_length_id = rpc_id;
     margo_register_data(mid, rpc_id, (void*)tmp_provider, NULL);
+    REGISTER_TRACED_RPC(length, length_in_t, length_out_t, sdskv_length_ult,
+                        read_pool);
 
     rpc_id = MARGO_REGISTER_PROVIDER(
         mid, "sdskv_length_multi_rpc", length_multi_in_t, length_multi_out_t,
-        sdskv_length_multi_ult, provider_id, args->rpc_pool);
+        sdskv_length_multi_ult, provider_id, read_pool);
     tmp_provider->sdskv_length_multi_id = rpc_id;
     margo_register_data(mid, rpc_id, (void*)tmp_provider, NULL);
+    REGISTER_TRACED_RPC(length_multi, length_multi_in_t, length_multi_out_t,
+                        sdskv_length_multi_ult, read_pool);
 
     rpc_id = MARGO_REGISTER_PROVIDER(
         mid, "sdskv_length_packed_rpc", length_packed_in_t, length_packed_out_t,
-        sdskv_length_packed_ult, provider_id, args->rpc_pool);
+        sdskv_length_packed_ult, provider_id, read_pool);
     tmp_provider->sdskv_length_packed_id = rpc_id;
     margo_register_data(mid, rpc_id, (void*)tmp_provider, NULL);
+    REGISTER_TRACED_RPC(length_packed, length_packed_in_t, length_packed_out_t,
+                        sdskv_length_packed_ult, read_pool);
 
     rpc_id = MARGO_REGISTER_PROVIDER(mid, "sdskv_exists_rpc", exists_in_t,
                                      exists_out_t, sdskv_exists_ult,
-                                     provider_id, args->rpc_pool);
+                                     provider_id, read_pool);
     tmp_provider->sdskv_exists_id = rpc_id;
     margo_register_data(mid, rpc_id, (void*)tmp_provider, NULL);
+    REGISTER_TRACED_RPC(exists, exists_in_t, exists_out_t, sdskv_exists_ult,
+                        read_pool);
 
     rpc_id = MARGO_REGISTER_PROVIDER(
         mid, "sdskv_exists_multi_rpc", exists_multi_in_t, exists_multi_out_t,
-        sdskv_exists_multi_ult, provider_id, args->rpc_pool);
+        sdskv_exists_multi_ult, provider_id, read_pool);
     tmp_provider->sdskv_exists_multi_id = rpc_id;
     margo_register_data(mid, rpc_id, (void*)tmp_provider, NULL);
+    REGISTER_TRACED_RPC(exists_multi, exists_multi_in_t, exists_multi_out_t,
+                        sdskv_exists_multi_ult, read_pool);
 
     rpc_id = MARGO_REGISTER_PROVIDER(mid, "sdskv_bulk_get_rpc", bulk_get_in_t,
                                      bulk_get_out_t, sdskv_bulk_get_ult,
-                                     provider_id, args->rpc_pool);
+                                     provider_id, read_pool);
     tmp_provider->sdskv_bulk_get_id = rpc_id;
     margo_register_data(mid, rpc_id, (void*)tmp_provider, NULL);
+    REGISTER_TRACED_RPC(bulk_get, bulk_get_in_t, bulk_get_out_t,
+                        sdskv_bulk_get_ult, read_pool);
 
     rpc_id = MARGO_REGISTER_PROVIDER(mid, "sdskv_list_keys_rpc", list_keys_in_t,
                                      list_keys_out_t, sdskv_list_keys_ult,
-                                     provider_id, args->rpc_pool);
+                                     provider_id, scan_pool);
     tmp_provider->sdskv_list_keys_id = rpc_id;
     margo_register_data(mid, rpc_id, (void*)tmp_provider, NULL);
+    REGISTER_TRACED_RPC(list_keys, list_keys_in_t, list_keys_out_t,
+                        sdskv_list_keys_ult, scan_pool);
 
     rpc_id = MARGO_REGISTER_PROVIDER(
         mid, "sdskv_list_keyvals_rpc", list_keyvals_in_t, list_keyvals_out_t,
-        sdskv_list_keyvals_ult, provider_id, args->rpc_pool);
+        sdskv_list_keyvals_ult, provider_id, scan_pool);
     tmp_provider->sdskv_list_keyvals_id = rpc_id;
     margo_register_data(mid, rpc_id, (void*)tmp_provider, NULL);
+    REGISTER_TRACED_RPC(list_keyvals, list_keyvals_in_t, list_keyvals_out_t,
+                        sdskv_list_keyvals_ult, scan_pool);
+
+    rpc_id = MARGO_REGISTER_PROVIDER(mid, "sdskv_sync_rpc", sync_in_t,
+                                     sync_out_t, sdskv_sync_ult, provider_id,
+                                     maintenance_pool);
+    tmp_provider->sdskv_sync_id = rpc_id;
+    margo_register_data(mid, rpc_id, (void*)tmp_provider, NULL);
+    REGISTER_TRACED_RPC(sync, sync_in_t, sync_out_t, sdskv_sync_ult,
+                        maintenance_pool);
+
+    rpc_id = MARGO_REGISTER_PROVIDER(mid, "sdskv_batch_rpc", batch_in_t,
+                                     batch_out_t, sdskv_batch_ult, provider_id,
+                                     write_pool);
+    tmp_provider->sdskv_batch_id = rpc_id;
+    margo_register_data(mid, rpc_id, (void*)tmp_provider, NULL);
+    REGISTER_TRACED_RPC(batch, batch_in_t, batch_out_t, sdskv_batch_ult,
+                        write_pool);
+
+    /* cross-database packed RPCs */
+    rpc_id = MARGO_REGISTER_PROVIDER(
+        mid, "sdskv_put_packed_multi_db_rpc", put_packed_multi_db_in_t,
+        put_packed_multi_db_out_t, sdskv_put_packed_multi_db_ult, provider_id,
+        write_pool);
+    tmp_provider->sdskv_put_packed_multi_db_id = rpc_id;
+    margo_register_data(mid, rpc_id, (void*)tmp_provider, NULL);
+    REGISTER_TRACED_RPC(put_packed_multi_db, put_packed_multi_db_in_t,
+                        put_packed_multi_db_out_t,
+                        sdskv_put_packed_multi_db_ult, write_pool);
+
+    rpc_id = MARGO_REGISTER_PROVIDER(
+        mid, "sdskv_get_packed_multi_db_rpc", get_packed_multi_db_in_t,
+        get_packed_multi_db_out_t, sdskv_get_packed_multi_db_ult, provider_id,
+        read_pool);
+    tmp_provider->sdskv_get_packed_multi_db_id = rpc_id;
+    margo_register_data(mid, rpc_id, (void*)tmp_provider, NULL);
+    REGISTER_TRACED_RPC(get_packed_multi_db, get_packed_multi_db_in_t,
+                        get_packed_multi_db_out_t,
+                        sdskv_get_packed_multi_db_ult, read_pool);
+
+    rpc_id = MARGO_REGISTER_PROVIDER(
+        mid, "sdskv_exists_packed_multi_db_rpc", exists_packed_multi_db_in_t,
+        exists_packed_multi_db_out_t, sdskv_exists_packed_multi_db_ult,
+        provider_id, read_pool);
+    tmp_provider->sdskv_exists_packed_multi_db_id = rpc_id;
+    margo_register_data(mid, rpc_id, (void*)tmp_provider, NULL);
+    REGISTER_TRACED_RPC(exists_packed_multi_db, exists_packed_multi_db_in_t,
+                        exists_packed_multi_db_out_t,
+                        sdskv_exists_packed_multi_db_ult, read_pool);
 
     rpc_id = MARGO_REGISTER_PROVIDER(mid, "sdskv_erase_rpc", erase_in_t,
                                      erase_out_t, sdskv_erase_ult, provider_id,
-                                     args->rpc_pool);
+                                     write_pool);
     tmp_provider->sdskv_erase_id = rpc_id;
     margo_register_data(mid, rpc_id, (void*)tmp_provider, NULL);
+    REGISTER_TRACED_RPC(erase, erase_in_t, erase_out_t, sdskv_erase_ult,
+                        write_pool);
 
     rpc_id = MARGO_REGISTER_PROVIDER(
         mid, "sdskv_erase_multi_rpc", erase_multi_in_t, erase_multi_out_t,
-        sdskv_erase_multi_ult, provider_id, args->rpc_pool);
+        sdskv_erase_multi_ult, provider_id, write_pool);
     tmp_provider->sdskv_erase_multi_id = rpc_id;
     margo_register_data(mid, rpc_id, (void*)tmp_provider, NULL);
+    REGISTER_TRACED_RPC(erase_multi, erase_multi_in_t, erase_multi_out_t,
+                        sdskv_erase_multi_ult, write_pool);
+
+    rpc_id = MARGO_REGISTER_PROVIDER(
+        mid, "sdskv_erase_range_rpc", erase_range_in_t, erase_range_out_t,
+        sdskv_erase_range_ult, provider_id, scan_pool);
+    tmp_provider->sdskv_erase_range_id = rpc_id;
+    margo_register_data(mid, rpc_id, (void*)tmp_provider, NULL);
+    REGISTER_TRACED_RPC(erase_range, erase_range_in_t, erase_range_out_t,
+                        sdskv_erase_range_ult, scan_pool);
+
+    rpc_id = MARGO_REGISTER_PROVIDER(
+        mid, "sdskv_erase_prefix_rpc", erase_prefix_in_t, erase_prefix_out_t,
+        sdskv_erase_prefix_ult, provider_id, scan_pool);
+    tmp_provider->sdskv_erase_prefix_id = rpc_id;
+    margo_register_data(mid, rpc_id, (void*)tmp_provider, NULL);
+    REGISTER_TRACED_RPC(erase_prefix, erase_prefix_in_t, erase_prefix_out_t,
+                        sdskv_erase_prefix_ult, scan_pool);
+
+    /* read-modify-write RPCs */
+    rpc_id = MARGO_REGISTER_PROVIDER(mid, "sdskv_cas_rpc", cas_in_t, cas_out_t,
+                                     sdskv_cas_ult, provider_id,
+                                     write_pool);
+    tmp_provider->sdskv_cas_id = rpc_id;
+    margo_register_data(mid, rpc_id, (void*)tmp_provider, NULL);
+    REGISTER_TRACED_RPC(cas, cas_in_t, cas_out_t, sdskv_cas_ult, write_pool);
+
+    rpc_id = MARGO_REGISTER_PROVIDER(
+        mid, "sdskv_cas_packed_rpc", cas_packed_in_t, cas_packed_out_t,
+        sdskv_cas_packed_ult, provider_id, write_pool);
+    tmp_provider->sdskv_cas_packed_id = rpc_id;
+    margo_register_data(mid, rpc_id, (void*)tmp_provider, NULL);
+    REGISTER_TRACED_RPC(cas_packed, cas_packed_in_t, cas_packed_out_t,
+                        sdskv_cas_packed_ult, write_pool);
+
+    rpc_id = MARGO_REGISTER_PROVIDER(
+        mid, "sdskv_fetch_add_rpc", fetch_add_in_t, fetch_add_out_t,
+        sdskv_fetch_add_ult, provider_id, write_pool);
+    tmp_provider->sdskv_fetch_add_id = rpc_id;
+    margo_register_data(mid, rpc_id, (void*)tmp_provider, NULL);
+    REGISTER_TRACED_RPC(fetch_add, fetch_add_in_t, fetch_add_out_t,
+                        sdskv_fetch_add_ult, write_pool);
+
+    rpc_id = MARGO_REGISTER_PROVIDER(mid, "sdskv_fetch_add_packed_rpc",
+                                     fetch_add_packed_in_t,
+                                     fetch_add_packed_out_t,
+                                     sdskv_fetch_add_packed_ult, provider_id,
+                                     write_pool);
+    tmp_provider->sdskv_fetch_add_packed_id = rpc_id;
+    margo_register_data(mid, rpc_id, (void*)tmp_provider, NULL);
+    REGISTER_TRACED_RPC(fetch_add_packed, fetch_add_packed_in_t,
+                        fetch_add_packed_out_t, sdskv_fetch_add_packed_ult,
+                        write_pool);
+
+    rpc_id = MARGO_REGISTER_PROVIDER(mid, "sdskv_append_rpc", append_in_t,
+                                     append_out_t, sdskv_append_ult,
+                                     provider_id, write_pool);
+    tmp_provider->sdskv_append_id = rpc_id;
+    margo_register_data(mid, rpc_id, (void*)tmp_provider, NULL);
+    REGISTER_TRACED_RPC(append, append_in_t, append_out_t, sdskv_append_ult,
+                        write_pool);
+
+    rpc_id = MARGO_REGISTER_PROVIDER(
+        mid, "sdskv_append_packed_rpc", append_packed_in_t, append_packed_out_t,
+        sdskv_append_packed_ult, provider_id, write_pool);
+    tmp_provider->sdskv_append_packed_id = rpc_id;
+    margo_register_data(mid, rpc_id, (void*)tmp_provider, NULL);
+    REGISTER_TRACED_RPC(append_packed, append_packed_in_t, append_packed_out_t,
+                        sdskv_append_packed_ult, write_pool);
 
     /* migration RPC */
     rpc_id = MARGO_REGISTER_PROVIDER(
         mid, "sdskv_migrate_keys_rpc", migrate_keys_in_t, migrate_keys_out_t,
-        sdskv_migrate_keys_ult, provider_id, args->rpc_pool);
+        sdskv_migrate_keys_ult, provider_id, maintenance_pool);
     tmp_provider->sdskv_migrate_keys_id = rpc_id;
     margo_register_data(mid, rpc_id, (void*)tmp_provider, NULL);
+    REGISTER_TRACED_RPC(migrate_keys, migrate_keys_in_t, migrate_keys_out_t,
+                        sdskv_migrate_keys_ult, maintenance_pool);
 
     rpc_id = MARGO_REGISTER_PROVIDER(mid, "sdskv_migrate_key_range_rpc",
                                      migrate_key_range_in_t, migrate_keys_out_t,
                                      sdskv_migrate_key_range_ult, provider_id,
-                                     args->rpc_pool);
+                                     maintenance_pool);
     tmp_provider->sdskv_migrate_key_range_id = rpc_id;
     margo_register_data(mid, rpc_id, (void*)tmp_provider, NULL);
+    REGISTER_TRACED_RPC(migrate_key_range, migrate_key_range_in_t,
+                        migrate_keys_out_t, sdskv_migrate_key_range_ult,
+                        maintenance_pool);
 
     rpc_id = MARGO_REGISTER_PROVIDER(
         mid, "sdskv_migrate_keys_prefixed_rpc", migrate_keys_prefixed_in_t,
         migrate_keys_out_t, sdskv_migrate_keys_prefixed_ult, provider_id,
-        args->rpc_pool);
+        maintenance_pool);
     tmp_provider->sdskv_migrate_keys_prefixed_id = rpc_id;
     margo_register_data(mid, rpc_id, (void*)tmp_provider, NULL);
+    REGISTER_TRACED_RPC(migrate_keys_prefixed, migrate_keys_prefixed_in_t,
+                        migrate_keys_out_t, sdskv_migrate_keys_prefixed_ult,
+                        maintenance_pool);
 
     rpc_id = MARGO_REGISTER_PROVIDER(mid, "sdskv_migrate_all_keys_rpc",
                                      migrate_all_keys_in_t, migrate_keys_out_t,
                                      sdskv_migrate_all_keys_ult, provider_id,
-                                     args->rpc_pool);
+                                     maintenance_pool);
     tmp_provider->sdskv_migrate_all_keys_id = rpc_id;
     margo_register_data(mid, rpc_id, (void*)tmp_provider, NULL);
+    REGISTER_TRACED_RPC(migrate_all_keys, migrate_all_keys_in_t,
+                        migrate_keys_out_t, sdskv_migrate_all_keys_ult,
+                        maintenance_pool);
 
     rpc_id = MARGO_REGISTER_PROVIDER(
         mid, "sdskv_migrate_database_rpc", migrate_database_in_t,
         migrate_database_out_t, sdskv_migrate_database_ult, provider_id,
-        args->rpc_pool);
+        maintenance_pool);
     tmp_provider->sdskv_migrate_database_id = rpc_id;
     margo_register_data(mid, rpc_id, (void*)tmp_provider, NULL);
+    REGISTER_TRACED_RPC(migrate_database, migrate_database_in_t,
+                        migrate_database_out_t, sdskv_migrate_database_ult,
+                        maintenance_pool);
+
+    /* this RPC has no handler and is never sent; clients living in the
+     * same margo instance look up its data to call the provider directly */
+    sdskv_init_local_ops(tmp_provider);
+    rpc_id = margo_provider_register_name(mid, SDSKV_LOCAL_RPC_NAME, NULL,
+                                          NULL, NULL, provider_id,
+                                          args->rpc_pool);
+    tmp_provider->sdskv_local_id = rpc_id;
+    margo_register_data(mid, rpc_id, (void*)&tmp_provider->local_ops, NULL);
+
+    rpc_id = MARGO_REGISTER_PROVIDER(mid, "sdskv_get_stats_rpc", void,
+                                     get_stats_out_t, sdskv_get_stats_ult,
+                                     provider_id, maintenance_pool);
+    tmp_provider->sdskv_get_stats_id = rpc_id;
+    margo_register_data(mid, rpc_id, (void*)tmp_provider, NULL);
+    REGISTER_TRACED_RPC(get_stats, void_in_t, get_stats_out_t,
+                        sdskv_get_stats_ult, maintenance_pool);
+
+    rpc_id = MARGO_REGISTER_PROVIDER(mid, "sdskv_get_trace_rpc", void,
+                                     get_trace_out_t, sdskv_get_trace_ult,
+                                     provider_id, maintenance_pool);
+    tmp_provider->sdskv_get_trace_id = rpc_id;
+    margo_register_data(mid, rpc_id, (void*)tmp_provider, NULL);
+    REGISTER_TRACED_RPC(get_trace, void_in_t, get_trace_out_t,
+                        sdskv_get_trace_ult, maintenance_pool);
+
+    rpc_id = MARGO_REGISTER_PROVIDER(mid, "sdskv_get_slow_ops_rpc", void,
+                                     get_slow_ops_out_t,
+                                     sdskv_get_slow_ops_ult, provider_id,
+                                     maintenance_pool);
+    tmp_provider->sdskv_get_slow_ops_id = rpc_id;
+    margo_register_data(mid, rpc_id, (void*)tmp_provider, NULL);
+    REGISTER_TRACED_RPC(get_slow_ops, void_in_t, get_slow_ops_out_t,
+                        sdskv_get_slow_ops_ult, maintenance_pool);
+
+    /* names under which each RPC appears in sdskv_provider_get_stats */
+    const std::pair<hg_id_t, const char*> metrics_rpcs[] = {
+        {tmp_provider->sdskv_open_id, "open"},
+        {tmp_provider->sdskv_count_databases_id, "count_databases"},
+        {tmp_provider->sdskv_list_databases_id, "list_databases"},
+        {tmp_provider->sdskv_put_id, "put"},
+        {tmp_provider->sdskv_put_multi_id, "put_multi"},
+        {tmp_provider->sdskv_put_packed_id, "put_packed"},
+        {tmp_provider->sdskv_bulk_put_id, "bulk_put"},
+        {tmp_provider->sdskv_get_id, "get"},
+        {tmp_provider->sdskv_get_multi_id, "get_multi"},
+        {tmp_provider->sdskv_get_packed_id, "get_packed"},
+        {tmp_provider->sdskv_exists_id, "exists"},
+        {tmp_provider->sdskv_exists_multi_id, "exists_multi"},
+        {tmp_provider->sdskv_erase_id, "erase"},
+        {tmp_provider->sdskv_erase_multi_id, "erase_multi"},
+        {tmp_provider->sdskv_erase_range_id, "erase_range"},
+        {tmp_provider->sdskv_erase_prefix_id, "erase_prefix"},
+        {tmp_provider->sdskv_cas_id, "cas"},
+        {tmp_provider->sdskv_cas_packed_id, "cas_packed"},
+        {tmp_provider->sdskv_fetch_add_id, "fetch_add"},
+        {tmp_provider->sdskv_fetch_add_packed_id, "fetch_add_packed"},
+        {tmp_provider->sdskv_append_id, "append"},
+        {tmp_provider->sdskv_append_packed_id, "append_packed"},
+        {tmp_provider->sdskv_length_id, "length"},
+        {tmp_provider->sdskv_length_multi_id, "length_multi"},
+        {tmp_provider->sdskv_length_packed_id, "length_packed"},
+        {tmp_provider->sdskv_bulk_get_id, "bulk_get"},
+        {tmp_provider->sdskv_list_keys_id, "list_keys"},
+        {tmp_provider->sdskv_list_keyvals_id, "list_keyvals"},
+        {tmp_provider->sdskv_sync_id, "sync"},
+        {tmp_provider->sdskv_batch_id, "batch"},
+        {tmp_provider->sdskv_put_packed_multi_db_id, "put_packed_multi_db"},
+        {tmp_provider->sdskv_get_packed_multi_db_id, "get_packed_multi_db"},
+        {tmp_provider->sdskv_exists_packed_multi_db_id,
+         "exists_packed_multi_db"},
+        {tmp_provider->sdskv_migrate_keys_id, "migrate_keys"},
+        {tmp_provider->sdskv_migrate_key_range_id, "migrate_key_range"},
+        {tmp_provider->sdskv_migrate_keys_prefixed_id,
+         "migrate_keys_prefixed"},
+        {tmp_provider->sdskv_migrate_all_keys_id, "migrate_all_keys"},
+        {tmp_provider->sdskv_migrate_database_id, "migrate_database"},
+        {tmp_provider->sdskv_get_stats_id, "get_stats"},
+        {tmp_provider->sdskv_get_trace_id, "get_trace"},
+        {tmp_provider->sdskv_get_slow_ops_id, "get_slow_ops"},
+    };
+    for (auto& rpc : metrics_rpcs)
+        tmp_provider->metrics.add_rpc(rpc.first, rpc.second);
+    /* traced requests are counted with the regular ones */
+    const std::pair<hg_id_t, hg_id_t> traced_rpcs[] = {
+        {tmp_provider->sdskv_open_traced_id, tmp_provider->sdskv_open_id},
+        {tmp_provider->sdskv_count_databases_traced_id,
+         tmp_provider->sdskv_count_databases_id},
+        {tmp_provider->sdskv_list_databases_traced_id,
+         tmp_provider->sdskv_list_databases_id},
+        {tmp_provider->sdskv_put_traced_id, tmp_provider->sdskv_put_id},
+        {tmp_provider->sdskv_put_multi_traced_id,
+         tmp_provider->sdskv_put_multi_id},
+        {tmp_provider->sdskv_put_packed_traced_id,
+         tmp_provider->sdskv_put_packed_id},
+        {tmp_provider->sdskv_bulk_put_traced_id,
+         tmp_provider->sdskv_bulk_put_id},
+        {tmp_provider->sdskv_get_traced_id, tmp_provider->sdskv_get_id},
+        {tmp_provider->sdskv_get_multi_traced_id,
+         tmp_provider->sdskv_get_multi_id},
+        {tmp_provider->sdskv_get_packed_traced_id,
+         tmp_provider->sdskv_get_packed_id},
+        {tmp_provider->sdskv_length_traced_id, tmp_provider->sdskv_length_id},
+        {tmp_provider->sdskv_length_multi_traced_id,
+         tmp_provider->sdskv_length_multi_id},
+        {tmp_provider->sdskv_length_packed_traced_id,
+         tmp_provider->sdskv_length_packed_id},
+        {tmp_provider->sdskv_exists_traced_id, tmp_provider->sdskv_exists_id},
+        {tmp_provider->sdskv_exists_multi_traced_id,
+         tmp_provider->sdskv_exists_multi_id},
+        {tmp_provider->sdskv_bulk_get_traced_id,
+         tmp_provider->sdskv_bulk_get_id},
+        {tmp_provider->sdskv_list_keys_traced_id,
+         tmp_provider->sdskv_list_keys_id},
+        {tmp_provider->sdskv_list_keyvals_traced_id,
+         tmp_provider->sdskv_list_keyvals_id},
+        {tmp_provider->sdskv_sync_traced_id, tmp_provider->sdskv_sync_id},
+        {tmp_provider->sdskv_batch_traced_id, tmp_provider->sdskv_batch_id},
+        {tmp_provider->sdskv_put_packed_multi_db_traced_id,
+         tmp_provider->sdskv_put_packed_multi_db_id},
+        {tmp_provider->sdskv_get_packed_multi_db_traced_id,
+         tmp_provider->sdskv_get_packed_multi_db_id},
+        {tmp_provider->sdskv_exists_packed_multi_db_traced_id,
+         tmp_provider->sdskv_exists_packed_multi_db_id},
+        {tmp_provider->sdskv_erase_traced_id, tmp_provider->sdskv_erase_id},
+        {tmp_provider->sdskv_erase_multi_traced_id,
+         tmp_provider->sdskv_erase_multi_id},
+        {tmp_provider->sdskv_erase_range_traced_id,
+         tmp_provider->sdskv_erase_range_id},
+        {tmp_provider->sdskv_erase_prefix_traced_id,
+         tmp_provider->sdskv_erase_prefix_id},
+        {tmp_provider->sdskv_cas_traced_id, tmp_provider->sdskv_cas_id},
+        {tmp_provider->sdskv_cas_packed_traced_id,
+         tmp_provider->sdskv_cas_packed_id},
+        {tmp_provider->sdskv_fetch_add_traced_id,
+         tmp_provider->sdskv_fetch_add_id},
+        {tmp_provider->sdskv_fetch_add_packed_traced_id,
+         tmp_provider->sdskv_fetch_add_packed_id},
+        {tmp_provider->sdskv_append_traced_id, tmp_provider->sdskv_append_id},
+        {tmp_provider->sdskv_append_packed_traced_id,
+         tmp_provider->sdskv_append_packed_id},
+        {tmp_provider->sdskv_migrate_keys_traced_id,
+         tmp_provider->sdskv_migrate_keys_id},
+        {tmp_provider->sdskv_migrate_key_range_traced_id,
+         tmp_provider->sdskv_migrate_key_range_id},
+        {tmp_provider->sdskv_migrate_keys_prefixed_traced_id,
+         tmp_provider->sdskv_migrate_keys_prefixed_id},
+        {tmp_provider->sdskv_migrate_all_keys_traced_id,
+         tmp_provider->sdskv_migrate_all_keys_id},
+        {tmp_provider->sdskv_migrate_database_traced_id,
+         tmp_provider->sdskv_migrate_database_id},
+        {tmp_provider->sdskv_get_stats_traced_id,
+         tmp_provider->sdskv_get_stats_id},
+        {tmp_provider->sdskv_get_trace_traced_id,
+         tmp_provider->sdskv_get_trace_id},
+        {tmp_provider->sdskv_get_slow_ops_traced_id,
+         tmp_provider->sdskv_get_slow_ops_id},
+    };
+    for (auto& rpc : traced_rpcs)
+        tmp_provider->metrics.alias_rpc(rpc.first, rpc.second);
+    tmp_provider->metrics.seal();
 
 #ifdef USE_REMI
     tmp_provider->remi_client   = (remi_client_t)(args->remi_client);
@@ -604,6 +1489,76 @@ extern "C" char* sdskv_provider_get_config(sdskv_provider_t provider)
     return strdup(config.c_str());
 }
 
+static Json::Value hot_keys_to_json(const std::vector<HotKeys::entry>& entries,
+                                    uint64_t accesses)
+{
+    Json::Value result(Json::arrayValue);
+    for (const auto& e : entries) {
+        Json::Value entry(Json::objectValue);
+        bool printable = std::all_of(e.key.begin(), e.key.end(), [](char c) {
+            return c >= 0x20 && c < 0x7f;
+        });
+        if (printable) {
+            entry["key"] = e.key;
+        } else {
+            static const char digits[] = "0123456789abcdef";
+            std::string       hex;
+            for (unsigned char c : e.key) {
+                hex += digits[c >> 4];
+                hex += digits[c & 0xf];
+            }
+            entry["key_hex"] = hex;
+        }
+        entry["count"]  = (Json::UInt64)e.count;
+        entry["error"]  = (Json::UInt64)e.error;
+        entry["writes"] = (Json::UInt64)e.writes;
+        entry["share"]  = accesses ? (double)e.count / accesses : 0.0;
+        result.append(entry);
+    }
+    return result;
+}
+
+extern "C" char* sdskv_provider_get_stats(sdskv_provider_t provider)
+{
+    Json::StreamWriterBuilder builder;
+    builder["indentation"] = "";
+    ABT_rwlock_rdlock(provider->lock);
+    Json::Value stats = provider->metrics.to_json(provider->id2name);
+    stats["hot_keys"] = Json::Value(Json::objectValue);
+    for (const auto& p : provider->databases) {
+        const HotKeys* hot_keys = p.second->hot_keys();
+        auto           name     = provider->id2name.find(p.first);
+        if (!hot_keys || name == provider->id2name.end()) continue;
+        HotKeys::summary summary = hot_keys->snapshot();
+        Json::Value&     db      = stats["hot_keys"][name->second];
+        db["accesses"] = (Json::UInt64)summary.accesses;
+        db["keys"]     = hot_keys_to_json(summary.keys, summary.accesses);
+        db["prefixes"] = hot_keys_to_json(summary.prefixes, summary.accesses);
+    }
+    ABT_rwlock_unlock(provider->lock);
+    return strdup(Json::writeString(builder, stats).c_str());
+}
+
+extern "C" char* sdskv_provider_get_trace(sdskv_provider_t provider)
+{
+    return sdskv_trace_to_json(provider->trace, "sdskv provider");
+}
+
+extern "C" char* sdskv_provider_get_slow_ops(sdskv_provider_t provider)
+{
+    Json::StreamWriterBuilder builder;
+    builder["indentation"] = "";
+    Json::Value slow_ops(Json::objectValue);
+    if (provider->slow_ops) {
+        ABT_rwlock_rdlock(provider->lock);
+        slow_ops = provider->slow_ops->to_json(provider->id2name);
+        ABT_rwlock_unlock(provider->lock);
+    } else {
+        slow_ops["ops"] = Json::Value(Json::arrayValue);
+    }
+    return strdup(Json::writeString(builder, slow_ops).c_str());
+}
+
 extern "C" margo_instance_id sdskv_provider_get_mid(sdskv_provider_t provider)
 {
     return (provider->mid);
@@ -700,6 +1655,29 @@ extern "C" int sdskv_provider_attach_database(sdskv_provider_t      provider,
         comp_fn = it->second;
     }
 
+    AbstractDataStore::durability_t durability;
+    switch (config->db_durability) {
+    case SDSKV_DURABILITY_NONE:
+        durability = AbstractDataStore::DURABILITY_NONE;
+        break;
+    case SDSKV_DURABILITY_PERIODIC:
+        durability = AbstractDataStore::DURABILITY_PERIODIC;
+        break;
+    case SDSKV_DURABILITY_SYNC:
+        durability = AbstractDataStore::DURABILITY_SYNC;
+        break;
+    default:
+        SDSKV_LOG_ERROR(provider->mid, "invalid durability mode %d",
+                        (int)config->db_durability);
+        return SDSKV_ERR_INVALID_ARG;
+    }
+    for (size_t i = 0; i < config->db_num_client_weights; i++) {
+        if (!(config->db_client_weights[i] > 0)) {
+            SDSKV_LOG_ERROR(provider->mid, "client weights should be positive");
+            return SDSKV_ERR_INVALID_ARG;
+        }
+    }
+
     auto db = datastore_factory::open_datastore(config->db_type,
                                                 std::string(config->db_name),
                                                 std::string(config->db_path));
@@ -714,11 +1692,34 @@ extern "C" int sdskv_provider_attach_database(sdskv_provider_t      provider,
     }
     sdskv_database_id_t id = (sdskv_database_id_t)(db);
     if (config->db_no_overwrite) { db->set_no_overwrite(); }
+    /* 0 means the default for the fields below, as in the JSON config */
+    db->set_group_commit(config->db_group_commit);
+    db->set_durability(durability);
+    db->set_sync_interval(
+        (config->db_sync_interval_ms ? config->db_sync_interval_ms : 1000)
+        / 1000.0);
+    db->set_admission_limits(config->db_max_inflight,
+                             config->db_max_queued_per_client);
+    for (size_t i = 0; i < config->db_num_client_weights; i++)
+        db->set_client_weight(config->db_client_addresses[i],
+                              config->db_client_weights[i]);
+    db->set_hot_keys(config->db_hot_keys, config->db_hot_key_prefix_length,
+                     config->db_hot_key_sample_every
+                         ? config->db_hot_key_sample_every
+                         : 1);
+    if (durability == AbstractDataStore::DURABILITY_PERIODIC) {
+        int ret = sdskv_start_sync_thread(provider);
+        if (ret != SDSKV_SUCCESS) {
+            delete db;
+            return ret;
+        }
+    }
 
     ABT_rwlock_wrlock(provider->lock);
     provider->name2id[std::string(config->db_name)] = id;
     provider->id2name[id]   = std::string(config->db_name);
     provider->databases[id] = db;
+    db->set_op_stats(provider->metrics.add_database(id));
     ABT_rwlock_unlock(provider->lock);
 
     *db_id = id;
@@ -742,6 +1743,7 @@ extern "C" int sdskv_provider_remove_database(sdskv_provider_t    provider,
         auto db = provider->databases[db_id];
         delete db;
         provider->databases.erase(db_id);
+        provider->metrics.remove_database(db_id);
         margo_trace(provider->mid,
                     "Successfully removed database %lu from provider", db_id);
         return SDSKV_SUCCESS;
@@ -755,7 +1757,10 @@ extern "C" int sdskv_provider_remove_database(sdskv_provider_t    provider,
 extern "C" int sdskv_provider_remove_all_databases(sdskv_provider_t provider)
 {
     ABT_rwlock_wrlock(provider->lock);
-    for (auto db : provider->databases) { delete db.second; }
+    for (auto db : provider->databases) {
+        provider->metrics.remove_database(db.first);
+        delete db.second;
+    }
     provider->databases.clear();
     provider->name2id.clear();
     provider->id2name.clear();
@@ -801,7 +1806,8 @@ extern "C" int sdskv_provider_compute_database_size(
     auto database = it->second;
     ABT_rwlock_unlock(provider->lock);
 
-    database->sync();
+    ret = database->sync();
+    if (ret != SDSKV_SUCCESS) return ret;
 
     /* create a fileset */
     remi_fileset_t fileset = database->create_and_populate_fileset();
@@ -840,7 +1846,7 @@ static void sdskv_open_ult(hg_handle_t handle)
 {
 
     hg_return_t hret;
-    open_in_t   in;
+    DECLARE_TRACED_INPUT(open_in_t);
     open_out_t  out;
 
     ENSURE_MARGO_DESTROY;
@@ -875,6 +1881,7 @@ static void sdskv_count_db_ult(hg_handle_t handle)
     ENSURE_MARGO_DESTROY;
     ENSURE_MARGO_RESPOND;
     FIND_MID_AND_PROVIDER;
+    GET_TRACED_VOID_INPUT(count_databases);
 
     uint64_t count;
     sdskv_provider_count_databases(provider, &count);
@@ -884,11 +1891,72 @@ static void sdskv_count_db_ult(hg_handle_t handle)
 }
 DEFINE_MARGO_RPC_HANDLER(sdskv_count_db_ult)
 
+static void sdskv_get_stats_ult(hg_handle_t handle)
+{
+
+    char*           stats = NULL;
+    get_stats_out_t out;
+
+    DEFER(free_stats, free(stats));
+    ENSURE_MARGO_DESTROY;
+    ENSURE_MARGO_RESPOND;
+    out.stats = (char*)"";
+    FIND_MID_AND_PROVIDER;
+    GET_TRACED_VOID_INPUT(get_stats);
+
+    stats     = sdskv_provider_get_stats(provider);
+    out.stats = stats;
+    out.ret   = SDSKV_SUCCESS;
+}
+DEFINE_MARGO_RPC_HANDLER(sdskv_get_stats_ult)
+
+static void sdskv_get_trace_ult(hg_handle_t handle)
+{
+
+    char*           trace = NULL;
+    get_trace_out_t out;
+
+    DEFER(free_trace, free(trace));
+    ENSURE_MARGO_DESTROY;
+    ENSURE_MARGO_RESPOND;
+    out.trace = (char*)"";
+    FIND_MID_AND_PROVIDER;
+    GET_TRACED_VOID_INPUT(get_trace);
+
+    trace = sdskv_provider_get_trace(provider);
+    if (!trace) {
+        out.ret = SDSKV_ERR_ALLOCATION;
+        return;
+    }
+    out.trace = trace;
+    out.ret   = SDSKV_SUCCESS;
+}
+DEFINE_MARGO_RPC_HANDLER(sdskv_get_trace_ult)
+
+static void sdskv_get_slow_ops_ult(hg_handle_t handle)
+{
+
+    char*              slow_ops = NULL;
+    get_slow_ops_out_t out;
+
+    DEFER(free_slow_ops, free(slow_ops));
+    ENSURE_MARGO_DESTROY;
+    ENSURE_MARGO_RESPOND;
+    out.slow_ops = (char*)"";
+    FIND_MID_AND_PROVIDER;
+    GET_TRACED_VOID_INPUT(get_slow_ops);
+
+    slow_ops     = sdskv_provider_get_slow_ops(provider);
+    out.slow_ops = slow_ops;
+    out.ret      = SDSKV_SUCCESS;
+}
+DEFINE_MARGO_RPC_HANDLER(sdskv_get_slow_ops_ult)
+
 static void sdskv_list_db_ult(hg_handle_t handle)
 {
 
     hg_return_t   hret;
-    list_db_in_t  in;
+    DECLARE_TRACED_INPUT(list_db_in_t);
     list_db_out_t out;
 
     std::vector<std::string> db_names;
@@ -926,7 +1994,7 @@ DEFINE_MARGO_RPC_HANDLER(sdskv_list_db_ult)
 static void sdskv_put_ult(hg_handle_t handle)
 {
     hg_return_t hret;
-    put_in_t    in;
+    DECLARE_TRACED_INPUT(put_in_t);
     put_out_t   out;
 
     ENSURE_MARGO_DESTROY;
@@ -936,15 +2004,17 @@ static void sdskv_put_ult(hg_handle_t handle)
     ENSURE_MARGO_FREE_INPUT;
     FIND_DATABASE;
 
-    ds_bulk_t kdata(in.key.data, in.key.data + in.key.size);
-    ds_bulk_t vdata(in.value.data, in.value.data + in.value.size);
-
     double start = ABT_get_wtime();
 
 #ifdef USE_SYMBIOMON
     symbiomon_metric_update_gauge_by_fixed_amount(provider->put_num_entrants, 1);
 #endif
-    out.ret = db->put(kdata, vdata);
+    __metrics.set_key(in.key.data, in.key.size);
+    __metrics.set_num_keys(1);
+    __metrics.add_bytes(in.key.size + in.value.size);
+    db->record_access(in.key.data, in.key.size, true);
+    out.ret = db->grouped_put(in.key.data, in.key.size, in.value.data,
+                              in.value.size);
 
     double end = ABT_get_wtime();
 
@@ -959,7 +2029,7 @@ DEFINE_MARGO_RPC_HANDLER(sdskv_put_ult)
 static void sdskv_put_multi_ult(hg_handle_t handle)
 {
     hg_return_t     hret;
-    put_multi_in_t  in;
+    DECLARE_TRACED_INPUT(put_multi_in_t);
     put_multi_out_t out;
     out.ret = SDSKV_SUCCESS;
     std::vector<char> local_keys_buffer;
@@ -1003,7 +2073,7 @@ static void sdskv_put_multi_ult(hg_handle_t handle)
     DEFER(margo_bulk_free_local_vals, margo_bulk_free(local_vals_bulk_handle));
 
     /* transfer keys */
-    hret = margo_bulk_transfer(mid, HG_BULK_PULL, info->addr,
+    hret = TIMED_BULK_TRANSFER(mid, HG_BULK_PULL, info->addr,
                                in.keys_bulk_handle, 0, local_keys_bulk_handle,
                                0, in.keys_bulk_size);
     if (hret != HG_SUCCESS) {
@@ -1013,7 +2083,7 @@ static void sdskv_put_multi_ult(hg_handle_t handle)
     }
 
     /* transfer values */
-    hret = margo_bulk_transfer(mid, HG_BULK_PULL, info->addr,
+    hret = TIMED_BULK_TRANSFER(mid, HG_BULK_PULL, info->addr,
                                in.vals_bulk_handle, 0, local_vals_bulk_handle,
                                0, in.vals_bulk_size);
     if (hret != HG_SUCCESS) {
@@ -1050,6 +2120,9 @@ static void sdskv_put_multi_ult(hg_handle_t handle)
 #ifdef USE_SYMBIOMON
     symbiomon_metric_update_gauge_by_fixed_amount(provider->putpacked_num_entrants, 1);
 #endif
+    if (in.num_keys) __metrics.set_key(kptrs[0], key_sizes[0]);
+    __metrics.set_num_keys(in.num_keys);
+    db->record_accesses(in.num_keys, kptrs.data(), key_sizes, true);
     out.ret = db->put_multi(in.num_keys, kptrs.data(), key_sizes, vptrs.data(),
                             val_sizes);
     end = ABT_get_wtime();
@@ -1062,10 +2135,162 @@ static void sdskv_put_multi_ult(hg_handle_t handle)
 }
 DEFINE_MARGO_RPC_HANDLER(sdskv_put_multi_ult)
 
+/* Pulls a put_packed buffer of bulk_size bytes in chunks of complete
+ * entries of about provider->put_packed_chunk_size bytes, keeping up to
+ * provider->put_packed_pipeline_depth chunks in flight and inserting each
+ * chunk as soon as it has arrived. The buffer's layout is the one built by
+ * sdskv_put_packed: key sizes, value sizes, keys, then values. */
+/* num_keys and bulk_size must have been checked by the caller (see
+ * sdskv_put_packed_ult) */
+static int put_packed_pipelined(sdskv_provider_t   provider,
+                                AbstractDataStore* db,
+                                RequestMetrics&    metrics,
+                                hg_addr_t          origin_addr,
+                                hg_bulk_t          remote_bulk,
+                                hg_size_t          num_keys,
+                                hg_size_t          bulk_size)
+{
+    margo_instance_id mid = provider->mid;
+    hg_return_t       hret;
+
+    /* pull the key and value sizes first */
+    hg_size_t              sizes_size = 2 * num_keys * sizeof(hg_size_t);
+    std::vector<hg_size_t> sizes(2 * num_keys);
+    void*     sizes_ptr = sizes.data();
+    hg_bulk_t sizes_bulk;
+    hret = margo_bulk_create(mid, 1, &sizes_ptr, &sizes_size,
+                             HG_BULK_WRITE_ONLY, &sizes_bulk);
+    if (hret != HG_SUCCESS) return SDSKV_MAKE_HG_ERROR(hret);
+    hret = metrics.bulk_transfer(mid, HG_BULK_PULL, origin_addr, remote_bulk,
+                                 0, sizes_bulk, 0, sizes_size);
+    margo_bulk_free(sizes_bulk);
+    if (hret != HG_SUCCESS) return SDSKV_MAKE_HG_ERROR(hret);
+    const hg_size_t* key_sizes = sizes.data();
+    const hg_size_t* val_sizes = key_sizes + num_keys;
+
+    hg_size_t remaining = bulk_size - sizes_size;
+    if (!consume_sizes(sizes.data(), 2 * num_keys, &remaining)
+        || remaining != 0) {
+        SDSKV_LOG_ERROR(mid, "inconsistent sizes in put_packed buffer");
+        return SDSKV_ERR_INVALID_ARG;
+    }
+
+    /* split the entries into chunks, each chunk being a range of keys and
+     * the matching range of values in the remote buffer */
+    struct chunk {
+        hg_size_t first, count;
+        hg_size_t koffset, ksize;
+        hg_size_t voffset, vsize;
+    };
+    std::vector<chunk> chunks;
+    hg_size_t          keys_offset = sizes_size;
+    hg_size_t          total_ksize = 0;
+    for (hg_size_t i = 0; i < num_keys; i++) total_ksize += key_sizes[i];
+    hg_size_t vals_offset = keys_offset + total_ksize;
+    for (hg_size_t i = 0; i < num_keys;) {
+        chunk c = {i, 0, keys_offset, 0, vals_offset, 0};
+        while (i < num_keys
+               && (c.count == 0
+                   || c.ksize + c.vsize + key_sizes[i] + val_sizes[i]
+                          <= provider->put_packed_chunk_size)) {
+            c.ksize += key_sizes[i];
+            c.vsize += val_sizes[i];
+            c.count += 1;
+            i += 1;
+        }
+        keys_offset += c.ksize;
+        vals_offset += c.vsize;
+        chunks.push_back(c);
+    }
+
+    /* each slot has its own buffer and pair of requests (keys, values) */
+    struct slot {
+        std::vector<char> buffer;
+        hg_bulk_t         bulk = HG_BULK_NULL;
+        margo_request     reqs[2] = {MARGO_REQUEST_NULL, MARGO_REQUEST_NULL};
+    };
+    std::vector<slot> slots(
+        std::min<size_t>(provider->put_packed_pipeline_depth, chunks.size()));
+
+    auto issue = [&](size_t c) -> hg_return_t {
+        slot&        sl   = slots[c % slots.size()];
+        const chunk& ch   = chunks[c];
+        hg_size_t    size = ch.ksize + ch.vsize;
+        hg_return_t  ret  = HG_SUCCESS;
+        if (sl.buffer.size() < size) {
+            /* first use of the slot, or an entry larger than a chunk */
+            if (sl.bulk != HG_BULK_NULL) margo_bulk_free(sl.bulk);
+            sl.bulk = HG_BULK_NULL;
+            sl.buffer.resize(
+                std::max<size_t>(size, provider->put_packed_chunk_size));
+            void*     ptr      = sl.buffer.data();
+            hg_size_t buf_size = sl.buffer.size();
+            ret = margo_bulk_create(mid, 1, &ptr, &buf_size,
+                                    HG_BULK_WRITE_ONLY, &sl.bulk);
+            if (ret != HG_SUCCESS) return ret;
+        }
+        if (ch.ksize)
+            ret = margo_bulk_itransfer(mid, HG_BULK_PULL, origin_addr,
+                                       remote_bulk, ch.koffset, sl.bulk, 0,
+                                       ch.ksize, &sl.reqs[0]);
+        if (ret == HG_SUCCESS && ch.vsize)
+            ret = margo_bulk_itransfer(mid, HG_BULK_PULL, origin_addr,
+                                       remote_bulk, ch.voffset, sl.bulk,
+                                       ch.ksize, ch.vsize, &sl.reqs[1]);
+        return ret;
+    };
+    auto wait = [&metrics](slot& sl) -> hg_return_t {
+        double      start = ABT_get_wtime();
+        DEFER(record_bulk, metrics.add(OpStats::PHASE_BULK, start));
+        hg_return_t ret = HG_SUCCESS;
+        for (auto& req : sl.reqs) {
+            if (req == MARGO_REQUEST_NULL) continue;
+            hg_return_t hret = margo_wait(req);
+            req              = MARGO_REQUEST_NULL;
+            if (ret == HG_SUCCESS) ret = hret;
+        }
+        return ret;
+    };
+
+    int    ret = SDSKV_SUCCESS;
+    size_t next_issue = 0;
+    hret              = HG_SUCCESS;
+    for (; next_issue < slots.size() && hret == HG_SUCCESS; next_issue++)
+        hret = issue(next_issue);
+
+    for (size_t c = 0; c < chunks.size() && hret == HG_SUCCESS; c++) {
+        slot& sl = slots[c % slots.size()];
+        hret     = wait(sl);
+        if (hret != HG_SUCCESS) break;
+        const chunk& ch = chunks[c];
+        /* the first key is only known once the first chunk has arrived */
+        if (c == 0) metrics.set_key(sl.buffer.data(), key_sizes[0]);
+        int r = db->put_packed(ch.count, sl.buffer.data(),
+                               key_sizes + ch.first,
+                               sl.buffer.data() + ch.ksize,
+                               val_sizes + ch.first);
+        db->record_packed_accesses(ch.count, sl.buffer.data(),
+                                   key_sizes + ch.first, true);
+        if (ret == SDSKV_SUCCESS) ret = r;
+        if (next_issue < chunks.size()) hret = issue(next_issue++);
+    }
+
+    /* on error, wait for the transfers still in flight before freeing */
+    for (auto& sl : slots) {
+        wait(sl);
+        if (sl.bulk != HG_BULK_NULL) margo_bulk_free(sl.bulk);
+    }
+    if (hret != HG_SUCCESS) {
+        SDSKV_LOG_ERROR(mid, "failed to issue bulk transfer (hret = %d)", hret);
+        return SDSKV_MAKE_HG_ERROR(hret);
+    }
+    return ret;
+}
+
 static void sdskv_put_packed_ult(hg_handle_t handle)
 {
     hg_return_t      hret;
-    put_packed_in_t  in;
+    DECLARE_TRACED_INPUT(put_packed_in_t);
     put_packed_out_t out;
     out.ret = SDSKV_SUCCESS;
     std::vector<char> local_buffer;
@@ -1076,9 +2301,19 @@ static void sdskv_put_packed_ult(hg_handle_t handle)
     ENSURE_MARGO_RESPOND;
     FIND_MID_AND_PROVIDER;
     GET_INPUT;
+    __metrics.set_num_keys(in.num_keys);
     ENSURE_MARGO_FREE_INPUT;
     FIND_DATABASE;
 
+    /* the buffer starts with the key sizes and the value sizes, and must
+     * fit in the client's bulk handle */
+    if (in.num_keys > in.bulk_size / (2 * sizeof(hg_size_t))
+        || in.bulk_size > HG_Bulk_get_size(in.bulk_handle)) {
+        SDSKV_LOG_ERROR(mid, "invalid bulk size for %lu keys", in.num_keys);
+        out.ret = SDSKV_ERR_INVALID_ARG;
+        return;
+    }
+
     // find out the address of the origin
     if (in.origin_addr != NULL) {
         hret = margo_addr_lookup(mid, in.origin_addr, &origin_addr);
@@ -1099,54 +2334,83 @@ static void sdskv_put_packed_ult(hg_handle_t handle)
     }
     DEFER(margo_addr_free, margo_addr_free(mid, origin_addr));
 
-    // allocate a buffer to receive the keys and a buffer to receive the values
-    local_buffer.resize(in.bulk_size);
-    void*     buf_ptr  = local_buffer.data();
-    hg_size_t buf_size = in.bulk_size;
-
-    /* create bulk handle to receive keys */
-    hret = margo_bulk_create(mid, 1, &buf_ptr, &buf_size, HG_BULK_WRITE_ONLY,
-                             &local_bulk_handle);
-    if (hret != HG_SUCCESS) {
-        SDSKV_LOG_ERROR(mid, "failed to create bulk handle (hret = %d)", hret);
-        out.ret = SDSKV_MAKE_HG_ERROR(hret);
-        return;
-    }
-    DEFER(margo_bulk_free, margo_bulk_free(local_bulk_handle));
-
-    /* transfer data */
-    hret = margo_bulk_transfer(mid, HG_BULK_PULL, origin_addr, in.bulk_handle,
-                               0, local_bulk_handle, 0, in.bulk_size);
-    if (hret != HG_SUCCESS) {
-        SDSKV_LOG_ERROR(mid, "failed to issue bulk transfer (hret = %d)", hret);
-        out.ret = SDSKV_MAKE_HG_ERROR(hret);
-        return;
-    }
-
-    /* interpret buffer as a list of key sizes */
-    hg_size_t* key_sizes = (hg_size_t*)local_buffer.data();
-    /* interpret buffer as a list of value sizes */
-    hg_size_t* val_sizes = key_sizes + in.num_keys;
-    /* interpret buffer as list of keys */
-    char* packed_keys = (char*)(val_sizes + in.num_keys);
-    /* compute the size of part of the buffer that contain keys */
-    size_t k = 0, v = 0;
-    for (unsigned i = 0; i < in.num_keys; i++) k += key_sizes[i];
-    /* interpret the rest of the buffer as list of values */
-    char* packed_vals = packed_keys + k;
-    for(unsigned i=0; i < in.num_keys; i++) v += val_sizes[i];
-
-    /* insert key/vals into the DB */
-    double data_size = (double)v+k;
+    double data_size = 0;
     double start, end;
-    /* insert key/vals into the DB */
-    start = ABT_get_wtime();
+
+    if (in.bulk_size > provider->put_packed_chunk_size) {
+        /* large request: insert each chunk while the next ones are being
+         * transferred, instead of buffering the whole request */
+        start = ABT_get_wtime();
 #ifdef USE_SYMBIOMON
-    symbiomon_metric_update_gauge_by_fixed_amount(provider->putpacked_num_entrants, 1);
+        symbiomon_metric_update_gauge_by_fixed_amount(provider->putpacked_num_entrants, 1);
 #endif
-    out.ret = db->put_packed(in.num_keys, packed_keys, key_sizes, packed_vals,
-                             val_sizes);
-    end = ABT_get_wtime();
+        out.ret = put_packed_pipelined(provider, db, __metrics, origin_addr,
+                                       in.bulk_handle, in.num_keys,
+                                       in.bulk_size);
+        end = ABT_get_wtime();
+        data_size = (double)in.bulk_size;
+    } else {
+        // allocate a buffer to receive the keys and a buffer to receive the values
+        local_buffer.resize(in.bulk_size);
+        void*     buf_ptr  = local_buffer.data();
+        hg_size_t buf_size = in.bulk_size;
+
+        /* create bulk handle to receive keys */
+        hret = margo_bulk_create(mid, 1, &buf_ptr, &buf_size,
+                                 HG_BULK_WRITE_ONLY, &local_bulk_handle);
+        if (hret != HG_SUCCESS) {
+            SDSKV_LOG_ERROR(mid, "failed to create bulk handle (hret = %d)",
+                            hret);
+            out.ret = SDSKV_MAKE_HG_ERROR(hret);
+            return;
+        }
+        DEFER(margo_bulk_free, margo_bulk_free(local_bulk_handle));
+
+        /* transfer data */
+        hret = TIMED_BULK_TRANSFER(mid, HG_BULK_PULL, origin_addr,
+                                   in.bulk_handle, 0, local_bulk_handle, 0,
+                                   in.bulk_size);
+        if (hret != HG_SUCCESS) {
+            SDSKV_LOG_ERROR(mid, "failed to issue bulk transfer (hret = %d)",
+                            hret);
+            out.ret = SDSKV_MAKE_HG_ERROR(hret);
+            return;
+        }
+
+        /* interpret buffer as a list of key sizes */
+        hg_size_t* key_sizes = (hg_size_t*)local_buffer.data();
+        /* interpret buffer as a list of value sizes */
+        hg_size_t* val_sizes = key_sizes + in.num_keys;
+        /* interpret buffer as list of keys */
+        char* packed_keys = (char*)(val_sizes + in.num_keys);
+        /* the keys and values must take the rest of the buffer */
+        hg_size_t remaining
+            = in.bulk_size - 2 * in.num_keys * sizeof(hg_size_t);
+        if (!consume_sizes(key_sizes, 2 * in.num_keys, &remaining)
+            || remaining != 0) {
+            SDSKV_LOG_ERROR(mid, "inconsistent sizes in put_packed buffer");
+            out.ret = SDSKV_ERR_INVALID_ARG;
+            return;
+        }
+        /* compute the size of part of the buffer that contain keys */
+        size_t k = 0, v = 0;
+        for (unsigned i = 0; i < in.num_keys; i++) k += key_sizes[i];
+        /* interpret the rest of the buffer as list of values */
+        char* packed_vals = packed_keys + k;
+        for(unsigned i=0; i < in.num_keys; i++) v += val_sizes[i];
+
+        /* insert key/vals into the DB */
+        data_size = (double)v+k;
+        start = ABT_get_wtime();
+#ifdef USE_SYMBIOMON
+        symbiomon_metric_update_gauge_by_fixed_amount(provider->putpacked_num_entrants, 1);
+#endif
+        if (in.num_keys) __metrics.set_key(packed_keys, key_sizes[0]);
+        db->record_packed_accesses(in.num_keys, packed_keys, key_sizes, true);
+        out.ret = db->put_packed(in.num_keys, packed_keys, key_sizes,
+                                 packed_vals, val_sizes);
+        end = ABT_get_wtime();
+    }
 #ifdef USE_SYMBIOMON
     symbiomon_metric_update_gauge_by_fixed_amount(provider->putpacked_num_entrants, -1);
     symbiomon_metric_update(provider->put_packed_latency, (end-start));
@@ -1159,7 +2423,7 @@ DEFINE_MARGO_RPC_HANDLER(sdskv_put_packed_ult)
 static void sdskv_length_ult(hg_handle_t handle)
 {
     hg_return_t  hret;
-    length_in_t  in;
+    DECLARE_TRACED_INPUT(length_in_t);
     length_out_t out;
 
     ENSURE_MARGO_DESTROY;
@@ -1169,10 +2433,8 @@ static void sdskv_length_ult(hg_handle_t handle)
     ENSURE_MARGO_FREE_INPUT;
     FIND_DATABASE;
 
-    ds_bulk_t kdata(in.key.data, in.key.data + in.key.size);
-
     size_t vsize;
-    if (db->length(kdata, &vsize)) {
+    if (db->length(in.key.data, in.key.size, &vsize)) {
         out.size = vsize;
         out.ret  = SDSKV_SUCCESS;
     } else {
@@ -1185,7 +2447,7 @@ DEFINE_MARGO_RPC_HANDLER(sdskv_length_ult)
 static void sdskv_get_ult(hg_handle_t handle)
 {
     hg_return_t hret;
-    get_in_t    in;
+    DECLARE_TRACED_INPUT(get_in_t);
     get_out_t   out;
     ds_bulk_t   kdata;
     ds_bulk_t   vdata;
@@ -1201,6 +2463,9 @@ static void sdskv_get_ult(hg_handle_t handle)
 
     kdata = ds_bulk_t(in.key.data, in.key.data + in.key.size);
 
+    __metrics.set_key(in.key.data, in.key.size);
+    __metrics.set_num_keys(1);
+    db->record_access(kdata.data(), kdata.size(), false);
     if (db->get(kdata, vdata)) {
         if (vdata.size() <= in.vsize) {
             out.vsize      = vdata.size();
@@ -1226,7 +2491,7 @@ static void sdskv_get_multi_ult(hg_handle_t handle)
 {
 
     hg_return_t     hret;
-    get_multi_in_t  in;
+    DECLARE_TRACED_INPUT(get_multi_in_t);
     get_multi_out_t out;
     out.ret = SDSKV_SUCCESS;
     std::vector<char> local_keys_buffer;
@@ -1238,6 +2503,7 @@ static void sdskv_get_multi_ult(hg_handle_t handle)
     ENSURE_MARGO_RESPOND;
     FIND_MID_AND_PROVIDER;
     GET_INPUT;
+    __metrics.set_num_keys(in.num_keys);
     ENSURE_MARGO_FREE_INPUT;
     FIND_DATABASE;
 
@@ -1272,7 +2538,7 @@ static void sdskv_get_multi_ult(hg_handle_t handle)
     DEFER(margo_bulk_free_local_valss, margo_bulk_free(local_vals_bulk_handle));
 
     /* transfer keys */
-    hret = margo_bulk_transfer(mid, HG_BULK_PULL, info->addr,
+    hret = TIMED_BULK_TRANSFER(mid, HG_BULK_PULL, info->addr,
                                in.keys_bulk_handle, 0, local_keys_bulk_handle,
                                0, in.keys_bulk_size);
     if (hret != HG_SUCCESS) {
@@ -1283,7 +2549,7 @@ static void sdskv_get_multi_ult(hg_handle_t handle)
 
     /* transfer sizes allocated by user for the values (beginning of value
      * segment) */
-    hret = margo_bulk_transfer(mid, HG_BULK_PULL, info->addr,
+    hret = TIMED_BULK_TRANSFER(mid, HG_BULK_PULL, info->addr,
                                in.vals_bulk_handle, 0, local_vals_bulk_handle,
                                0, in.num_keys * sizeof(hg_size_t));
     if (hret != HG_SUCCESS) {
@@ -1297,6 +2563,7 @@ static void sdskv_get_multi_ult(hg_handle_t handle)
     /* find beginning of packed keys */
     char* packed_keys
         = local_keys_buffer.data() + in.num_keys * sizeof(hg_size_t);
+    if (in.num_keys) __metrics.set_key(packed_keys, key_sizes[0]);
     /* interpret beginning of the value buffer as a list of value sizes */
     hg_size_t* val_sizes = (hg_size_t*)local_vals_buffer.data();
     /* find beginning of region where to pack values */
@@ -1308,6 +2575,7 @@ static void sdskv_get_multi_ult(hg_handle_t handle)
         ds_bulk_t kdata(packed_keys, packed_keys + key_sizes[i]);
         ds_bulk_t vdata;
         size_t    client_allocated_value_size = val_sizes[i];
+        db->record_access(kdata.data(), kdata.size(), false);
         if (db->get(kdata, vdata)) {
             size_t old_vsize = val_sizes[i];
             if (vdata.size() > val_sizes[i]) {
@@ -1324,7 +2592,7 @@ static void sdskv_get_multi_ult(hg_handle_t handle)
     }
 
     /* do a PUSH operation to push back the values to the client */
-    hret = margo_bulk_transfer(mid, HG_BULK_PUSH, info->addr,
+    hret = TIMED_BULK_TRANSFER(mid, HG_BULK_PUSH, info->addr,
                                in.vals_bulk_handle, 0, local_vals_bulk_handle,
                                0, in.vals_bulk_size);
     if (hret != HG_SUCCESS) {
@@ -1335,11 +2603,141 @@ static void sdskv_get_multi_ult(hg_handle_t handle)
 }
 DEFINE_MARGO_RPC_HANDLER(sdskv_get_multi_ult)
 
+/* Looks up the values of a get_packed request and pushes them to the
+ * client's buffer in chunks of about provider->get_packed_chunk_size
+ * bytes, the lookup of a chunk overlapping with the transfer of up to
+ * provider->get_packed_pipeline_depth - 1 previous ones. The value sizes
+ * at the beginning of the client's buffer are pushed last, so the client
+ * sees the same layout as with a single transfer. */
+static int get_packed_pipelined(sdskv_provider_t   provider,
+                                AbstractDataStore* db,
+                                hg_addr_t          origin_addr,
+                                hg_bulk_t          remote_bulk,
+                                hg_size_t          remote_size,
+                                hg_size_t          num_keys,
+                                const hg_size_t*   key_sizes,
+                                const char*        packed_keys,
+                                hg_size_t*         num_found)
+{
+    margo_instance_id mid    = provider->mid;
+    hg_size_t         header = num_keys * sizeof(hg_size_t);
+    if (remote_size < header) return SDSKV_ERR_SIZE;
+
+    struct slot {
+        std::vector<char> buffer;
+        size_t            used = 0;
+        hg_bulk_t         bulk = HG_BULK_NULL;
+        margo_request     req  = MARGO_REQUEST_NULL;
+    };
+    std::vector<slot> slots(provider->get_packed_pipeline_depth);
+    size_t            current       = 0;
+    hg_size_t         remote_offset = header;
+    hg_return_t       hret          = HG_SUCCESS;
+
+    auto wait = [](slot& sl) -> hg_return_t {
+        if (sl.req == MARGO_REQUEST_NULL) return HG_SUCCESS;
+        hg_return_t ret = margo_wait(sl.req);
+        sl.req          = MARGO_REQUEST_NULL;
+        return ret;
+    };
+    /* sends the current slot and moves on to the next one */
+    auto flush = [&]() -> hg_return_t {
+        slot& sl = slots[current];
+        if (sl.used == 0) return HG_SUCCESS;
+        hg_return_t ret = margo_bulk_itransfer(
+            mid, HG_BULK_PUSH, origin_addr, remote_bulk, remote_offset,
+            sl.bulk, 0, sl.used, &sl.req);
+        remote_offset += sl.used;
+        sl.used = 0;
+        current = (current + 1) % slots.size();
+        if (ret != HG_SUCCESS) return ret;
+        return wait(slots[current]);
+    };
+    /* makes sure the current slot can hold size more bytes */
+    auto reserve = [&](size_t size) -> hg_return_t {
+        if (slots[current].used + size > slots[current].buffer.size()
+            && slots[current].used != 0) {
+            hg_return_t ret = flush();
+            if (ret != HG_SUCCESS) return ret;
+        }
+        slot& sl = slots[current];
+        if (sl.buffer.size() >= size) return HG_SUCCESS;
+        /* first use of the slot, or a value larger than a chunk */
+        if (sl.bulk != HG_BULK_NULL) margo_bulk_free(sl.bulk);
+        sl.bulk = HG_BULK_NULL;
+        sl.buffer.resize(
+            std::max<size_t>(size, provider->get_packed_chunk_size));
+        void*     ptr      = sl.buffer.data();
+        hg_size_t buf_size = sl.buffer.size();
+        return margo_bulk_create(mid, 1, &ptr, &buf_size, HG_BULK_READ_ONLY,
+                                 &sl.bulk);
+    };
+
+    int                    ret = SDSKV_SUCCESS;
+    std::vector<hg_size_t> val_sizes(num_keys);
+    size_t                 available_client_memory = remote_size - header;
+    *num_found                                      = 0;
+    for (hg_size_t i = 0; i < num_keys && hret == HG_SUCCESS; i++) {
+        ds_bulk_t kdata(packed_keys, packed_keys + key_sizes[i]);
+        ds_bulk_t vdata;
+        packed_keys += key_sizes[i];
+        if (available_client_memory == 0) {
+            val_sizes[i] = 0;
+            ret          = SDSKV_ERR_SIZE;
+            continue;
+        }
+        db->record_access(kdata.data(), kdata.size(), false);
+        if (!db->get(kdata, vdata)) {
+            val_sizes[i] = (hg_size_t)(-1);
+            continue;
+        }
+        if (vdata.size() > available_client_memory) {
+            available_client_memory = 0;
+            ret                     = SDSKV_ERR_SIZE;
+            val_sizes[i]            = 0;
+            continue;
+        }
+        hret = reserve(vdata.size());
+        if (hret != HG_SUCCESS) break;
+        slot& sl = slots[current];
+        memcpy(sl.buffer.data() + sl.used, vdata.data(), vdata.size());
+        sl.used += vdata.size();
+        available_client_memory -= vdata.size();
+        val_sizes[i] = vdata.size();
+        *num_found += 1;
+    }
+    if (hret == HG_SUCCESS) hret = flush();
+
+    for (auto& sl : slots) {
+        hg_return_t r = wait(sl);
+        if (hret == HG_SUCCESS) hret = r;
+        if (sl.bulk != HG_BULK_NULL) margo_bulk_free(sl.bulk);
+    }
+
+    /* completion header: the value sizes */
+    if (hret == HG_SUCCESS && header) {
+        void*     ptr = val_sizes.data();
+        hg_bulk_t header_bulk;
+        hret = margo_bulk_create(mid, 1, &ptr, &header, HG_BULK_READ_ONLY,
+                                 &header_bulk);
+        if (hret == HG_SUCCESS) {
+            hret = margo_bulk_transfer(mid, HG_BULK_PUSH, origin_addr,
+                                       remote_bulk, 0, header_bulk, 0, header);
+            margo_bulk_free(header_bulk);
+        }
+    }
+    if (hret != HG_SUCCESS) {
+        SDSKV_LOG_ERROR(mid, "failed to issue bulk transfer (hret = %d)", hret);
+        return SDSKV_MAKE_HG_ERROR(hret);
+    }
+    return ret;
+}
+
 static void sdskv_get_packed_ult(hg_handle_t handle)
 {
 
     hg_return_t      hret;
-    get_packed_in_t  in;
+    DECLARE_TRACED_INPUT(get_packed_in_t);
     get_packed_out_t out;
     out.ret      = SDSKV_SUCCESS;
     out.num_keys = 0;
@@ -1352,6 +2750,7 @@ static void sdskv_get_packed_ult(hg_handle_t handle)
     ENSURE_MARGO_RESPOND;
     FIND_MID_AND_PROVIDER;
     GET_INPUT;
+    __metrics.set_num_keys(in.num_keys);
     ENSURE_MARGO_FREE_INPUT;
     FIND_DATABASE;
 
@@ -1370,6 +2769,33 @@ static void sdskv_get_packed_ult(hg_handle_t handle)
     }
     DEFER(margo_bulk_free_local_keys, margo_bulk_free(local_keys_bulk_handle));
 
+    /* transfer keys and key sizes */
+    hret = TIMED_BULK_TRANSFER(mid, HG_BULK_PULL, info->addr,
+                               in.keys_bulk_handle, 0, local_keys_bulk_handle,
+                               0, in.keys_bulk_size);
+    if (hret != HG_SUCCESS) {
+        SDSKV_LOG_ERROR(mid, "failed to issue bulk transfer (hret = %d)", hret);
+        out.ret = SDSKV_MAKE_HG_ERROR(hret);
+        return;
+    }
+
+    /* interpret beginning of the key buffer as a list of key sizes */
+    hg_size_t* key_sizes = (hg_size_t*)local_keys_buffer.data();
+    /* find beginning of packed keys */
+    char* packed_keys
+        = local_keys_buffer.data() + in.num_keys * sizeof(hg_size_t);
+    if (in.num_keys) __metrics.set_key(packed_keys, key_sizes[0]);
+
+    if (in.vals_bulk_size > provider->get_packed_chunk_size) {
+        /* large response: push values while the next ones are looked up,
+         * instead of buffering the whole response */
+        out.ret = get_packed_pipelined(provider, db, info->addr,
+                                       in.vals_bulk_handle, in.vals_bulk_size,
+                                       in.num_keys, key_sizes, packed_keys,
+                                       &out.num_keys);
+        return;
+    }
+
     /* allocate buffer to send the values */
     local_vals_buffer.resize(in.vals_bulk_size);
     std::vector<void*> vals_addr(1);
@@ -1385,21 +2811,6 @@ static void sdskv_get_packed_ult(hg_handle_t handle)
     }
     DEFER(margo_bulk_free_local_vals, margo_bulk_free(local_vals_bulk_handle));
 
-    /* transfer keys and key sizes */
-    hret = margo_bulk_transfer(mid, HG_BULK_PULL, info->addr,
-                               in.keys_bulk_handle, 0, local_keys_bulk_handle,
-                               0, in.keys_bulk_size);
-    if (hret != HG_SUCCESS) {
-        SDSKV_LOG_ERROR(mid, "failed to issue bulk transfer (hret = %d)", hret);
-        out.ret = SDSKV_MAKE_HG_ERROR(hret);
-        return;
-    }
-
-    /* interpret beginning of the key buffer as a list of key sizes */
-    hg_size_t* key_sizes = (hg_size_t*)local_keys_buffer.data();
-    /* find beginning of packed keys */
-    char* packed_keys
-        = local_keys_buffer.data() + in.num_keys * sizeof(hg_size_t);
     /* interpret beginning of the value buffer as a list of value sizes */
     hg_size_t* val_sizes = (hg_size_t*)local_vals_buffer.data();
     /* find beginning of region where to pack values */
@@ -1418,6 +2829,7 @@ static void sdskv_get_packed_ult(hg_handle_t handle)
             out.ret      = SDSKV_ERR_SIZE;
             continue;
         }
+        db->record_access(kdata.data(), kdata.size(), false);
         if (db->get(kdata, vdata)) {
             if (vdata.size() > available_client_memory) {
                 available_client_memory = 0;
@@ -1436,7 +2848,7 @@ static void sdskv_get_packed_ult(hg_handle_t handle)
     }
 
     /* do a PUSH operation to push back the values to the client */
-    hret = margo_bulk_transfer(mid, HG_BULK_PUSH, info->addr,
+    hret = TIMED_BULK_TRANSFER(mid, HG_BULK_PUSH, info->addr,
                                in.vals_bulk_handle, 0, local_vals_bulk_handle,
                                0, in.vals_bulk_size);
     if (hret != HG_SUCCESS) {
@@ -1451,7 +2863,7 @@ static void sdskv_length_multi_ult(hg_handle_t handle)
 {
 
     hg_return_t        hret;
-    length_multi_in_t  in;
+    DECLARE_TRACED_INPUT(length_multi_in_t);
     length_multi_out_t out;
     out.ret = SDSKV_SUCCESS;
     std::vector<char>      local_keys_buffer;
@@ -1500,7 +2912,7 @@ static void sdskv_length_multi_ult(hg_handle_t handle)
           margo_bulk_free(local_vals_size_bulk_handle));
 
     /* transfer keys */
-    hret = margo_bulk_transfer(mid, HG_BULK_PULL, info->addr,
+    hret = TIMED_BULK_TRANSFER(mid, HG_BULK_PULL, info->addr,
                                in.keys_bulk_handle, 0, local_keys_bulk_handle,
                                0, in.keys_bulk_size);
     if (hret != HG_SUCCESS) {
@@ -1517,9 +2929,8 @@ static void sdskv_length_multi_ult(hg_handle_t handle)
 
     /* go through the key/value pairs and get the values from the database */
     for (unsigned i = 0; i < in.num_keys; i++) {
-        ds_bulk_t kdata(packed_keys, packed_keys + key_sizes[i]);
-        size_t    vsize;
-        if (db->length(kdata, &vsize)) {
+        size_t vsize;
+        if (db->length(packed_keys, key_sizes[i], &vsize)) {
             local_vals_size_buffer[i] = vsize;
         } else {
             local_vals_size_buffer[i] = 0;
@@ -1528,7 +2939,7 @@ static void sdskv_length_multi_ult(hg_handle_t handle)
     }
 
     /* do a PUSH operation to push back the value sizes to the client */
-    hret = margo_bulk_transfer(
+    hret = TIMED_BULK_TRANSFER(
         mid, HG_BULK_PUSH, info->addr, in.vals_size_bulk_handle, 0,
         local_vals_size_bulk_handle, 0, local_vals_size_buffer_size);
     if (hret != HG_SUCCESS) {
@@ -1543,7 +2954,7 @@ static void sdskv_exists_multi_ult(hg_handle_t handle)
 {
 
     hg_return_t        hret;
-    exists_multi_in_t  in;
+    DECLARE_TRACED_INPUT(exists_multi_in_t);
     exists_multi_out_t out;
     out.ret = SDSKV_SUCCESS;
     std::vector<char>    local_keys_buffer;
@@ -1593,7 +3004,7 @@ static void sdskv_exists_multi_ult(hg_handle_t handle)
           margo_bulk_free(local_flags_bulk_handle));
 
     /* transfer keys */
-    hret = margo_bulk_transfer(mid, HG_BULK_PULL, info->addr,
+    hret = TIMED_BULK_TRANSFER(mid, HG_BULK_PULL, info->addr,
                                in.keys_bulk_handle, 0, local_keys_bulk_handle,
                                0, in.keys_bulk_size);
     if (hret != HG_SUCCESS) {
@@ -1622,7 +3033,7 @@ static void sdskv_exists_multi_ult(hg_handle_t handle)
     }
 
     /* do a PUSH operation to push back the value sizes to the client */
-    hret = margo_bulk_transfer(mid, HG_BULK_PUSH, info->addr,
+    hret = TIMED_BULK_TRANSFER(mid, HG_BULK_PUSH, info->addr,
                                in.flags_bulk_handle, 0, local_flags_bulk_handle,
                                0, local_flags_buffer_size);
     if (hret != HG_SUCCESS) {
@@ -1637,7 +3048,7 @@ static void sdskv_length_packed_ult(hg_handle_t handle)
 {
 
     hg_return_t         hret;
-    length_packed_in_t  in;
+    DECLARE_TRACED_INPUT(length_packed_in_t);
     length_packed_out_t out;
     out.ret = SDSKV_SUCCESS;
     std::vector<char>      local_keys_buffer;
@@ -1686,7 +3097,7 @@ static void sdskv_length_packed_ult(hg_handle_t handle)
           margo_bulk_free(local_vals_size_bulk_handle));
 
     /* transfer keys and ksizes */
-    hret = margo_bulk_transfer(mid, HG_BULK_PULL, info->addr, in.in_bulk_handle,
+    hret = TIMED_BULK_TRANSFER(mid, HG_BULK_PULL, info->addr, in.in_bulk_handle,
                                0, local_keys_bulk_handle, 0, in.in_bulk_size);
     if (hret != HG_SUCCESS) {
         SDSKV_LOG_ERROR(mid, "failed to issue bulk transfer (hret = %d)", hret);
@@ -1702,9 +3113,8 @@ static void sdskv_length_packed_ult(hg_handle_t handle)
 
     /* go through the key/value pairs and get the values from the database */
     for (unsigned i = 0; i < in.num_keys; i++) {
-        ds_bulk_t kdata(packed_keys, packed_keys + key_sizes[i]);
-        size_t    vsize;
-        if (db->length(kdata, &vsize)) {
+        size_t vsize;
+        if (db->length(packed_keys, key_sizes[i], &vsize)) {
             local_vals_size_buffer[i] = vsize;
         } else {
             local_vals_size_buffer[i] = 0;
@@ -1713,7 +3123,7 @@ static void sdskv_length_packed_ult(hg_handle_t handle)
     }
 
     /* do a PUSH operation to push back the value sizes to the client */
-    hret = margo_bulk_transfer(
+    hret = TIMED_BULK_TRANSFER(
         mid, HG_BULK_PUSH, info->addr, in.out_bulk_handle, 0,
         local_vals_size_bulk_handle, 0, local_vals_size_buffer_size);
     if (hret != HG_SUCCESS) {
@@ -1728,7 +3138,7 @@ static void sdskv_bulk_put_ult(hg_handle_t handle)
 {
 
     hg_return_t    hret;
-    bulk_put_in_t  in;
+    DECLARE_TRACED_INPUT(bulk_put_in_t);
     bulk_put_out_t out;
     hg_bulk_t      bulk_handle;
 
@@ -1755,7 +3165,7 @@ static void sdskv_bulk_put_ult(hg_handle_t handle)
         }
         DEFER(margo_bulk_free, margo_bulk_free(bulk_handle));
 
-        hret = margo_bulk_transfer(mid, HG_BULK_PULL, info->addr, in.handle, 0,
+        hret = TIMED_BULK_TRANSFER(mid, HG_BULK_PULL, info->addr, in.handle, 0,
                                    bulk_handle, 0, vdata.size());
         if (hret != HG_SUCCESS) {
             SDSKV_LOG_ERROR(mid, "failed to issue bulk transfer (hret = %d)",
@@ -1771,6 +3181,7 @@ static void sdskv_bulk_put_ult(hg_handle_t handle)
 #ifdef USE_SYMBIOMON
     symbiomon_metric_update_gauge_by_fixed_amount(provider->put_num_entrants, 1);
 #endif
+    db->record_access(kdata.data(), kdata.size(), true);
     out.ret = db->put(kdata, vdata);
     double end = ABT_get_wtime();
 
@@ -1786,7 +3197,7 @@ static void sdskv_bulk_get_ult(hg_handle_t handle)
 {
 
     hg_return_t    hret;
-    bulk_get_in_t  in;
+    DECLARE_TRACED_INPUT(bulk_get_in_t);
     bulk_get_out_t out;
     hg_bulk_t      bulk_handle;
 
@@ -1802,6 +3213,7 @@ static void sdskv_bulk_get_ult(hg_handle_t handle)
     ds_bulk_t kdata(in.key.data, in.key.data + in.key.size);
 
     ds_bulk_t vdata;
+    db->record_access(kdata.data(), kdata.size(), false);
     auto      b = db->get(kdata, vdata);
 
     if (!b) {
@@ -1830,7 +3242,7 @@ static void sdskv_bulk_get_ult(hg_handle_t handle)
         }
         DEFER(margo_bulk_free, margo_bulk_free(bulk_handle));
 
-        hret = margo_bulk_transfer(mid, HG_BULK_PUSH, info->addr, in.handle, 0,
+        hret = TIMED_BULK_TRANSFER(mid, HG_BULK_PUSH, info->addr, in.handle, 0,
                                    bulk_handle, 0, vdata.size());
         if (hret != HG_SUCCESS) {
             SDSKV_LOG_ERROR(mid, "failed to issue bulk transfer (hret = %d)",
@@ -1850,7 +3262,7 @@ static void sdskv_erase_ult(hg_handle_t handle)
 {
 
     hg_return_t hret;
-    erase_in_t  in;
+    DECLARE_TRACED_INPUT(erase_in_t);
     erase_out_t out;
 
     ENSURE_MARGO_DESTROY;
@@ -1860,13 +3272,7 @@ static void sdskv_erase_ult(hg_handle_t handle)
     ENSURE_MARGO_FREE_INPUT;
     FIND_DATABASE;
 
-    ds_bulk_t kdata(in.key.data, in.key.data + in.key.size);
-
-    if (db->erase(kdata)) {
-        out.ret = SDSKV_SUCCESS;
-    } else {
-        out.ret = SDSKV_ERR_ERASE;
-    }
+    out.ret = db->grouped_erase(in.key.data, in.key.size);
 }
 DEFINE_MARGO_RPC_HANDLER(sdskv_erase_ult)
 
@@ -1874,7 +3280,7 @@ static void sdskv_erase_multi_ult(hg_handle_t handle)
 {
 
     hg_return_t       hret;
-    erase_multi_in_t  in;
+    DECLARE_TRACED_INPUT(erase_multi_in_t);
     erase_multi_out_t out;
     out.ret = SDSKV_SUCCESS;
     std::vector<char> local_keys_buffer;
@@ -1903,7 +3309,7 @@ static void sdskv_erase_multi_ult(hg_handle_t handle)
     DEFER(margo_bulk_free_local_keys, margo_bulk_free(local_keys_bulk_handle));
 
     /* transfer keys */
-    hret = margo_bulk_transfer(mid, HG_BULK_PULL, info->addr,
+    hret = TIMED_BULK_TRANSFER(mid, HG_BULK_PULL, info->addr,
                                in.keys_bulk_handle, 0, local_keys_bulk_handle,
                                0, in.keys_bulk_size);
     if (hret != HG_SUCCESS) {
@@ -1918,20 +3324,100 @@ static void sdskv_erase_multi_ult(hg_handle_t handle)
     char* packed_keys
         = local_keys_buffer.data() + in.num_keys * sizeof(hg_size_t);
 
-    /* go through the key/value pairs and erase them */
+    /* build the array of key pointers and erase the keys in one batch */
+    std::vector<const void*> keys(in.num_keys);
     for (unsigned i = 0; i < in.num_keys; i++) {
-        ds_bulk_t kdata(packed_keys, packed_keys + key_sizes[i]);
-        db->erase(kdata);
+        keys[i] = packed_keys;
         packed_keys += key_sizes[i];
     }
+    std::vector<uint8_t> erased(in.num_keys, 0);
+    out.ret = db->erase_multi(in.num_keys, keys.data(), key_sizes,
+                              erased.data());
+
+    /* the client did not ask which keys were erased */
+    if (in.flags_bulk_handle == HG_BULK_NULL) return;
+
+    /* pack the results as a bitfield, as in sdskv_exists_multi_ult */
+    hg_size_t local_flags_buffer_size
+        = in.num_keys / 8 + (in.num_keys % 8 == 0 ? 0 : 1);
+    std::vector<uint8_t> local_flags_buffer(local_flags_buffer_size, 0);
+    for (unsigned i = 0; i < in.num_keys; i++) {
+        if (erased[i]) local_flags_buffer[i / 8] |= (1 << (i % 8));
+    }
+    void*     flags_addr = (void*)local_flags_buffer.data();
+    hg_bulk_t local_flags_bulk_handle;
+
+    hret = margo_bulk_create(mid, 1, &flags_addr, &local_flags_buffer_size,
+                             HG_BULK_READ_ONLY, &local_flags_bulk_handle);
+    if (hret != HG_SUCCESS) {
+        SDSKV_LOG_ERROR(mid, "failed to create bulk handle (hret = %d)", hret);
+        out.ret = SDSKV_MAKE_HG_ERROR(hret);
+        return;
+    }
+    DEFER(margo_bulk_free_local_flags,
+          margo_bulk_free(local_flags_bulk_handle));
+
+    hret = TIMED_BULK_TRANSFER(mid, HG_BULK_PUSH, info->addr,
+                               in.flags_bulk_handle, 0, local_flags_bulk_handle,
+                               0, local_flags_buffer_size);
+    if (hret != HG_SUCCESS) {
+        SDSKV_LOG_ERROR(mid, "failed to issue bulk transfer (hret = %d)", hret);
+        out.ret = SDSKV_MAKE_HG_ERROR(hret);
+        return;
+    }
 }
 DEFINE_MARGO_RPC_HANDLER(sdskv_erase_multi_ult)
 
+static void sdskv_erase_range_ult(hg_handle_t handle)
+{
+
+    hg_return_t       hret;
+    DECLARE_TRACED_INPUT(erase_range_in_t);
+    erase_range_out_t out;
+    out.num_erased = 0;
+
+    ENSURE_MARGO_DESTROY;
+    ENSURE_MARGO_RESPOND;
+    FIND_MID_AND_PROVIDER;
+    GET_INPUT;
+    ENSURE_MARGO_FREE_INPUT;
+    FIND_DATABASE;
+
+    ds_bulk_t lower_bound(in.lower_bound.data,
+                          in.lower_bound.data + in.lower_bound.size);
+    ds_bulk_t upper_bound(in.upper_bound.data,
+                          in.upper_bound.data + in.upper_bound.size);
+
+    out.ret = db->erase_range(lower_bound, upper_bound, &out.num_erased);
+}
+DEFINE_MARGO_RPC_HANDLER(sdskv_erase_range_ult)
+
+static void sdskv_erase_prefix_ult(hg_handle_t handle)
+{
+
+    hg_return_t        hret;
+    DECLARE_TRACED_INPUT(erase_prefix_in_t);
+    erase_prefix_out_t out;
+    out.num_erased = 0;
+
+    ENSURE_MARGO_DESTROY;
+    ENSURE_MARGO_RESPOND;
+    FIND_MID_AND_PROVIDER;
+    GET_INPUT;
+    ENSURE_MARGO_FREE_INPUT;
+    FIND_DATABASE;
+
+    ds_bulk_t prefix(in.prefix.data, in.prefix.data + in.prefix.size);
+
+    out.ret = db->erase_prefix(prefix, &out.num_erased);
+}
+DEFINE_MARGO_RPC_HANDLER(sdskv_erase_prefix_ult)
+
 static void sdskv_exists_ult(hg_handle_t handle)
 {
 
     hg_return_t  hret;
-    exists_in_t  in;
+    DECLARE_TRACED_INPUT(exists_in_t);
     exists_out_t out;
 
     ENSURE_MARGO_DESTROY;
@@ -1946,17 +3432,39 @@ static void sdskv_exists_ult(hg_handle_t handle)
 }
 DEFINE_MARGO_RPC_HANDLER(sdskv_exists_ult)
 
-static void sdskv_list_keys_ult(hg_handle_t handle)
+static void sdskv_cas_ult(hg_handle_t handle)
 {
 
-    hg_return_t     hret;
-    list_keys_in_t  in;
-    list_keys_out_t out;
-    hg_bulk_t       ksizes_local_bulk = HG_BULK_NULL;
-    hg_bulk_t       keys_local_bulk   = HG_BULK_NULL;
+    hg_return_t hret;
+    DECLARE_TRACED_INPUT(cas_in_t);
+    cas_out_t   out;
 
-    out.ret   = SDSKV_SUCCESS;
-    out.nkeys = 0;
+    ENSURE_MARGO_DESTROY;
+    ENSURE_MARGO_RESPOND;
+    FIND_MID_AND_PROVIDER;
+    GET_INPUT;
+    ENSURE_MARGO_FREE_INPUT;
+    FIND_DATABASE;
+
+    bool swapped = false;
+    out.ret      = db->compare_and_swap(in.key.data, in.key.size,
+                                   in.expected.data, in.expected.size,
+                                   in.desired.data, in.desired.size, &swapped);
+    out.swapped  = swapped ? 1 : 0;
+}
+DEFINE_MARGO_RPC_HANDLER(sdskv_cas_ult)
+
+static void sdskv_cas_packed_ult(hg_handle_t handle)
+{
+
+    hg_return_t          hret;
+    DECLARE_TRACED_INPUT(cas_packed_in_t);
+    cas_packed_out_t     out;
+    out.ret = SDSKV_SUCCESS;
+    std::vector<char>    local_in_buffer;
+    std::vector<uint8_t> local_swapped_buffer;
+    hg_bulk_t            local_in_bulk_handle;
+    hg_bulk_t            local_swapped_bulk_handle;
 
     ENSURE_MARGO_DESTROY;
     ENSURE_MARGO_RESPOND;
@@ -1965,134 +3473,126 @@ static void sdskv_list_keys_ult(hg_handle_t handle)
     ENSURE_MARGO_FREE_INPUT;
     FIND_DATABASE;
 
-    /* create a bulk handle to receive and send key sizes from client */
-    std::vector<hg_size_t> ksizes(in.max_keys);
-    std::vector<void*>     ksizes_addr(1);
-    ksizes_addr[0]             = (void*)ksizes.data();
-    hg_size_t ksizes_bulk_size = ksizes.size() * sizeof(hg_size_t);
-    hret = margo_bulk_create(mid, 1, ksizes_addr.data(), &ksizes_bulk_size,
-                             HG_BULK_READWRITE, &ksizes_local_bulk);
-    if (hret != HG_SUCCESS) {
-        SDSKV_LOG_ERROR(mid, "failed to create bulk handle (hret = %d)", hret);
-        out.ret = SDSKV_MAKE_HG_ERROR(hret);
+    /* the buffer starts with the key sizes, the expected value sizes and
+     * the desired value sizes, followed by the packed keys, the packed
+     * expected values and the packed desired values */
+    const hg_size_t entry_size = 3 * sizeof(hg_size_t);
+    if (in.num_keys > in.in_bulk_size / entry_size) {
+        SDSKV_LOG_ERROR(mid, "invalid bulk size for %lu keys", in.num_keys);
+        out.ret = SDSKV_ERR_INVALID_ARG;
         return;
     }
-    DEFER(margo_bulk_free_ksizes, margo_bulk_free(ksizes_local_bulk));
 
-    /* receive the key sizes from the client */
-    hg_addr_t origin_addr = info->addr;
-    hret                  = margo_bulk_transfer(mid, HG_BULK_PULL, origin_addr,
-                               in.ksizes_bulk_handle, 0, ksizes_local_bulk, 0,
-                               ksizes_bulk_size);
+    /* allocate buffer to receive sizes, keys and values */
+    local_in_buffer.resize(in.in_bulk_size);
+    void* in_addr = (void*)local_in_buffer.data();
+
+    hret = margo_bulk_create(mid, 1, &in_addr, &in.in_bulk_size,
+                             HG_BULK_WRITE_ONLY, &local_in_bulk_handle);
     if (hret != HG_SUCCESS) {
-        SDSKV_LOG_ERROR(mid, "failed to issue bulk transfer (hret = %d)", hret);
+        SDSKV_LOG_ERROR(mid, "failed to create bulk handle (hret = %d)", hret);
         out.ret = SDSKV_MAKE_HG_ERROR(hret);
         return;
     }
+    DEFER(margo_bulk_free_local_in, margo_bulk_free(local_in_bulk_handle));
 
-    /* make a copy of the remote key sizes */
-    std::vector<hg_size_t> remote_ksizes(ksizes.begin(), ksizes.end());
-
-    /* get the keys from the underlying database */
-    ds_bulk_t start_kdata(in.start_key.data,
-                          in.start_key.data + in.start_key.size);
-    ds_bulk_t prefix(in.prefix.data, in.prefix.data + in.prefix.size);
-    auto      keys     = db->list_keys(start_kdata, in.max_keys, prefix);
-    hg_size_t num_keys = std::min((size_t)keys.size(), (size_t)in.max_keys);
+    /* allocate buffer to send one swapped flag per key */
+    local_swapped_buffer.resize(in.num_keys);
+    void*     swapped_addr = (void*)local_swapped_buffer.data();
+    hg_size_t swapped_size = in.num_keys;
 
-    if (num_keys == 0) {
-        out.ret = SDSKV_SUCCESS;
+    hret = margo_bulk_create(mid, 1, &swapped_addr, &swapped_size,
+                             HG_BULK_READ_ONLY, &local_swapped_bulk_handle);
+    if (hret != HG_SUCCESS) {
+        SDSKV_LOG_ERROR(mid, "failed to create bulk handle (hret = %d)", hret);
+        out.ret = SDSKV_MAKE_HG_ERROR(hret);
         return;
     }
+    DEFER(margo_bulk_free_local_swapped,
+          margo_bulk_free(local_swapped_bulk_handle));
 
-    /* create the array of actual sizes */
-    std::vector<hg_size_t> true_ksizes(num_keys);
-    hg_size_t              keys_bulk_size = 0;
-    bool                   size_error     = false;
-    for (unsigned i = 0; i < num_keys; i++) {
-        true_ksizes[i] = keys[i].size();
-        if (true_ksizes[i] > ksizes[i]) {
-            // this key has a size that exceeds the allocated size on client
-            size_error = true;
-        }
-        ksizes[i] = true_ksizes[i];
-        keys_bulk_size += ksizes[i];
-    }
-    for (unsigned i = num_keys; i < in.max_keys; i++) { ksizes[i] = 0; }
-    out.nkeys = num_keys;
-
-    /* transfer the ksizes back to the client */
-    hret = margo_bulk_transfer(mid, HG_BULK_PUSH, origin_addr,
-                               in.ksizes_bulk_handle, 0, ksizes_local_bulk, 0,
-                               ksizes_bulk_size);
+    hret = TIMED_BULK_TRANSFER(mid, HG_BULK_PULL, info->addr, in.in_bulk_handle,
+                               0, local_in_bulk_handle, 0, in.in_bulk_size);
     if (hret != HG_SUCCESS) {
         SDSKV_LOG_ERROR(mid, "failed to issue bulk transfer (hret = %d)", hret);
         out.ret = SDSKV_MAKE_HG_ERROR(hret);
         return;
     }
 
-    /* if user provided a size too small for some key, return error (we
-     * already set the right key sizes) */
-    if (size_error) {
-        out.ret = SDSKV_ERR_SIZE;
+    hg_size_t* key_sizes      = (hg_size_t*)local_in_buffer.data();
+    hg_size_t* expected_sizes = key_sizes + in.num_keys;
+    hg_size_t* desired_sizes  = expected_sizes + in.num_keys;
+    char*      packed_keys    = (char*)(desired_sizes + in.num_keys);
+
+    hg_size_t remaining = in.in_bulk_size - in.num_keys * entry_size;
+    if (!consume_sizes(key_sizes, in.num_keys, &remaining)
+        || !consume_sizes(expected_sizes, in.num_keys, &remaining)
+        || !consume_sizes(desired_sizes, in.num_keys, &remaining)
+        || remaining != 0) {
+        SDSKV_LOG_ERROR(mid, "inconsistent sizes in cas_packed buffer");
+        out.ret = SDSKV_ERR_INVALID_ARG;
         return;
     }
+    char* packed_expected = packed_keys;
+    for (unsigned i = 0; i < in.num_keys; i++) packed_expected += key_sizes[i];
+    char* packed_desired = packed_expected;
+    for (unsigned i = 0; i < in.num_keys; i++)
+        packed_desired += expected_sizes[i];
 
-    /* create an array of addresses pointing to keys */
-    std::vector<void*> keys_addr(num_keys);
-    for (unsigned i = 0; i < num_keys; i++) {
-        keys_addr[i] = (void*)(keys[i].data());
+    /* keys are processed independently; the first failure is reported */
+    for (unsigned i = 0; i < in.num_keys; i++) {
+        bool swapped = false;
+        int  r       = db->compare_and_swap(
+            packed_keys, key_sizes[i], packed_expected, expected_sizes[i],
+            packed_desired, desired_sizes[i], &swapped);
+        local_swapped_buffer[i] = (r == SDSKV_SUCCESS && swapped) ? 1 : 0;
+        if (r != SDSKV_SUCCESS && out.ret == SDSKV_SUCCESS) out.ret = r;
+        packed_keys += key_sizes[i];
+        packed_expected += expected_sizes[i];
+        packed_desired += desired_sizes[i];
     }
 
-    /* expose the keys for bulk transfer */
-    hret
-        = margo_bulk_create(mid, num_keys, keys_addr.data(), true_ksizes.data(),
-                            HG_BULK_READ_ONLY, &keys_local_bulk);
+    hret = TIMED_BULK_TRANSFER(mid, HG_BULK_PUSH, info->addr,
+                               in.out_bulk_handle, 0, local_swapped_bulk_handle,
+                               0, swapped_size);
     if (hret != HG_SUCCESS) {
-        SDSKV_LOG_ERROR(mid, "failed to create bulk handle (hret = %d)", hret);
+        SDSKV_LOG_ERROR(mid, "failed to issue bulk transfer (hret = %d)", hret);
         out.ret = SDSKV_MAKE_HG_ERROR(hret);
         return;
     }
-    DEFER(margo_bulk_free_keys, margo_bulk_free(keys_local_bulk));
+}
+DEFINE_MARGO_RPC_HANDLER(sdskv_cas_packed_ult)
 
-    /* transfer the keys to the client */
-    uint64_t remote_offset = 0;
-    uint64_t local_offset  = 0;
-    for (unsigned i = 0; i < num_keys; i++) {
+static void sdskv_fetch_add_ult(hg_handle_t handle)
+{
 
-        if (true_ksizes[i] > 0) {
-            hret = margo_bulk_transfer(
-                mid, HG_BULK_PUSH, origin_addr, in.keys_bulk_handle,
-                remote_offset, keys_local_bulk, local_offset, true_ksizes[i]);
-            if (hret != HG_SUCCESS) {
-                SDSKV_LOG_ERROR(
-                    mid, "failed to issue bulk transfer (hret = %d)", hret);
-                out.ret = SDSKV_MAKE_HG_ERROR(hret);
-                return;
-            }
-        }
+    hg_return_t     hret;
+    DECLARE_TRACED_INPUT(fetch_add_in_t);
+    fetch_add_out_t out;
+    out.value = 0;
 
-        remote_offset += remote_ksizes[i];
-        local_offset += true_ksizes[i];
-    }
+    ENSURE_MARGO_DESTROY;
+    ENSURE_MARGO_RESPOND;
+    FIND_MID_AND_PROVIDER;
+    GET_INPUT;
+    ENSURE_MARGO_FREE_INPUT;
+    FIND_DATABASE;
 
-    out.ret = SDSKV_SUCCESS;
+    out.ret = db->fetch_and_add(in.key.data, in.key.size, in.delta, &out.value);
 }
-DEFINE_MARGO_RPC_HANDLER(sdskv_list_keys_ult)
+DEFINE_MARGO_RPC_HANDLER(sdskv_fetch_add_ult)
 
-static void sdskv_list_keyvals_ult(hg_handle_t handle)
+static void sdskv_fetch_add_packed_ult(hg_handle_t handle)
 {
 
-    hg_return_t        hret;
-    list_keyvals_in_t  in;
-    list_keyvals_out_t out;
-    hg_bulk_t          ksizes_local_bulk = HG_BULK_NULL;
-    hg_bulk_t          keys_local_bulk   = HG_BULK_NULL;
-    hg_bulk_t          vsizes_local_bulk = HG_BULK_NULL;
-    hg_bulk_t          vals_local_bulk   = HG_BULK_NULL;
-
-    out.ret   = SDSKV_SUCCESS;
-    out.nkeys = 0;
+    hg_return_t            hret;
+    DECLARE_TRACED_INPUT(fetch_add_packed_in_t);
+    fetch_add_packed_out_t out;
+    out.ret = SDSKV_SUCCESS;
+    std::vector<char>    local_in_buffer;
+    std::vector<int64_t> local_values_buffer;
+    hg_bulk_t            local_in_bulk_handle;
+    hg_bulk_t            local_values_bulk_handle;
 
     ENSURE_MARGO_DESTROY;
     ENSURE_MARGO_RESPOND;
@@ -2101,13 +3601,400 @@ static void sdskv_list_keyvals_ult(hg_handle_t handle)
     ENSURE_MARGO_FREE_INPUT;
     FIND_DATABASE;
 
-    /* create a bulk handle to receive and send key sizes from client */
-    std::vector<hg_size_t> ksizes(in.max_keys);
-    std::vector<void*>     ksizes_addr(1);
-    ksizes_addr[0]             = (void*)ksizes.data();
-    hg_size_t ksizes_bulk_size = ksizes.size() * sizeof(hg_size_t);
-    hret = margo_bulk_create(mid, 1, ksizes_addr.data(), &ksizes_bulk_size,
-                             HG_BULK_READWRITE, &ksizes_local_bulk);
+    /* the buffer starts with the key sizes, followed by the deltas,
+     * followed by the packed keys */
+    const hg_size_t entry_size = sizeof(hg_size_t) + sizeof(int64_t);
+    if (in.num_keys > in.in_bulk_size / entry_size) {
+        SDSKV_LOG_ERROR(mid, "invalid bulk size for %lu keys", in.num_keys);
+        out.ret = SDSKV_ERR_INVALID_ARG;
+        return;
+    }
+
+    /* allocate buffer to receive key sizes, deltas and packed keys */
+    local_in_buffer.resize(in.in_bulk_size);
+    void* in_addr = (void*)local_in_buffer.data();
+
+    hret = margo_bulk_create(mid, 1, &in_addr, &in.in_bulk_size,
+                             HG_BULK_WRITE_ONLY, &local_in_bulk_handle);
+    if (hret != HG_SUCCESS) {
+        SDSKV_LOG_ERROR(mid, "failed to create bulk handle (hret = %d)", hret);
+        out.ret = SDSKV_MAKE_HG_ERROR(hret);
+        return;
+    }
+    DEFER(margo_bulk_free_local_in, margo_bulk_free(local_in_bulk_handle));
+
+    /* allocate buffer to send the previous values */
+    local_values_buffer.resize(in.num_keys);
+    void*     values_addr = (void*)local_values_buffer.data();
+    hg_size_t values_size = in.num_keys * sizeof(int64_t);
+
+    hret = margo_bulk_create(mid, 1, &values_addr, &values_size,
+                             HG_BULK_READ_ONLY, &local_values_bulk_handle);
+    if (hret != HG_SUCCESS) {
+        SDSKV_LOG_ERROR(mid, "failed to create bulk handle (hret = %d)", hret);
+        out.ret = SDSKV_MAKE_HG_ERROR(hret);
+        return;
+    }
+    DEFER(margo_bulk_free_local_values,
+          margo_bulk_free(local_values_bulk_handle));
+
+    hret = TIMED_BULK_TRANSFER(mid, HG_BULK_PULL, info->addr, in.in_bulk_handle,
+                               0, local_in_bulk_handle, 0, in.in_bulk_size);
+    if (hret != HG_SUCCESS) {
+        SDSKV_LOG_ERROR(mid, "failed to issue bulk transfer (hret = %d)", hret);
+        out.ret = SDSKV_MAKE_HG_ERROR(hret);
+        return;
+    }
+
+    hg_size_t* key_sizes = (hg_size_t*)local_in_buffer.data();
+    int64_t*   deltas    = (int64_t*)(key_sizes + in.num_keys);
+    char*      packed_keys = (char*)(deltas + in.num_keys);
+
+    hg_size_t remaining = in.in_bulk_size - in.num_keys * entry_size;
+    if (!consume_sizes(key_sizes, in.num_keys, &remaining) || remaining != 0) {
+        SDSKV_LOG_ERROR(mid, "inconsistent sizes in fetch_add_packed buffer");
+        out.ret = SDSKV_ERR_INVALID_ARG;
+        return;
+    }
+
+    /* keys are processed independently; the first failure is reported */
+    for (unsigned i = 0; i < in.num_keys; i++) {
+        int r = db->fetch_and_add(packed_keys, key_sizes[i], deltas[i],
+                                  &local_values_buffer[i]);
+        if (r != SDSKV_SUCCESS) {
+            local_values_buffer[i] = 0;
+            if (out.ret == SDSKV_SUCCESS) out.ret = r;
+        }
+        packed_keys += key_sizes[i];
+    }
+
+    hret = TIMED_BULK_TRANSFER(mid, HG_BULK_PUSH, info->addr,
+                               in.out_bulk_handle, 0, local_values_bulk_handle,
+                               0, values_size);
+    if (hret != HG_SUCCESS) {
+        SDSKV_LOG_ERROR(mid, "failed to issue bulk transfer (hret = %d)", hret);
+        out.ret = SDSKV_MAKE_HG_ERROR(hret);
+        return;
+    }
+}
+DEFINE_MARGO_RPC_HANDLER(sdskv_fetch_add_packed_ult)
+
+static void sdskv_append_ult(hg_handle_t handle)
+{
+
+    hg_return_t  hret;
+    DECLARE_TRACED_INPUT(append_in_t);
+    append_out_t out;
+    out.vsize = 0;
+
+    ENSURE_MARGO_DESTROY;
+    ENSURE_MARGO_RESPOND;
+    FIND_MID_AND_PROVIDER;
+    GET_INPUT;
+    ENSURE_MARGO_FREE_INPUT;
+    FIND_DATABASE;
+
+    out.ret = db->append(in.key.data, in.key.size, in.value.data,
+                         in.value.size, &out.vsize);
+}
+DEFINE_MARGO_RPC_HANDLER(sdskv_append_ult)
+
+static void sdskv_append_packed_ult(hg_handle_t handle)
+{
+
+    hg_return_t            hret;
+    DECLARE_TRACED_INPUT(append_packed_in_t);
+    append_packed_out_t    out;
+    out.ret = SDSKV_SUCCESS;
+    std::vector<char>      local_in_buffer;
+    std::vector<hg_size_t> local_sizes_buffer;
+    hg_bulk_t              local_in_bulk_handle;
+    hg_bulk_t              local_sizes_bulk_handle;
+
+    ENSURE_MARGO_DESTROY;
+    ENSURE_MARGO_RESPOND;
+    FIND_MID_AND_PROVIDER;
+    GET_INPUT;
+    ENSURE_MARGO_FREE_INPUT;
+    FIND_DATABASE;
+
+    /* the buffer starts with the key sizes, followed by the data sizes,
+     * followed by the packed keys and the packed data */
+    const hg_size_t entry_size = 2 * sizeof(hg_size_t);
+    if (in.num_keys > in.in_bulk_size / entry_size) {
+        SDSKV_LOG_ERROR(mid, "invalid bulk size for %lu keys", in.num_keys);
+        out.ret = SDSKV_ERR_INVALID_ARG;
+        return;
+    }
+
+    /* allocate buffer to receive sizes, packed keys and packed data */
+    local_in_buffer.resize(in.in_bulk_size);
+    void* in_addr = (void*)local_in_buffer.data();
+
+    hret = margo_bulk_create(mid, 1, &in_addr, &in.in_bulk_size,
+                             HG_BULK_WRITE_ONLY, &local_in_bulk_handle);
+    if (hret != HG_SUCCESS) {
+        SDSKV_LOG_ERROR(mid, "failed to create bulk handle (hret = %d)", hret);
+        out.ret = SDSKV_MAKE_HG_ERROR(hret);
+        return;
+    }
+    DEFER(margo_bulk_free_local_in, margo_bulk_free(local_in_bulk_handle));
+
+    /* allocate buffer to send the resulting value sizes */
+    local_sizes_buffer.resize(in.num_keys);
+    void*     sizes_addr = (void*)local_sizes_buffer.data();
+    hg_size_t sizes_size = in.num_keys * sizeof(hg_size_t);
+
+    hret = margo_bulk_create(mid, 1, &sizes_addr, &sizes_size,
+                             HG_BULK_READ_ONLY, &local_sizes_bulk_handle);
+    if (hret != HG_SUCCESS) {
+        SDSKV_LOG_ERROR(mid, "failed to create bulk handle (hret = %d)", hret);
+        out.ret = SDSKV_MAKE_HG_ERROR(hret);
+        return;
+    }
+    DEFER(margo_bulk_free_local_sizes,
+          margo_bulk_free(local_sizes_bulk_handle));
+
+    hret = TIMED_BULK_TRANSFER(mid, HG_BULK_PULL, info->addr, in.in_bulk_handle,
+                               0, local_in_bulk_handle, 0, in.in_bulk_size);
+    if (hret != HG_SUCCESS) {
+        SDSKV_LOG_ERROR(mid, "failed to issue bulk transfer (hret = %d)", hret);
+        out.ret = SDSKV_MAKE_HG_ERROR(hret);
+        return;
+    }
+
+    hg_size_t* key_sizes   = (hg_size_t*)local_in_buffer.data();
+    hg_size_t* data_sizes  = key_sizes + in.num_keys;
+    char*      packed_keys = (char*)(data_sizes + in.num_keys);
+
+    hg_size_t remaining = in.in_bulk_size - in.num_keys * entry_size;
+    if (!consume_sizes(key_sizes, in.num_keys, &remaining)
+        || !consume_sizes(data_sizes, in.num_keys, &remaining)
+        || remaining != 0) {
+        SDSKV_LOG_ERROR(mid, "inconsistent sizes in append_packed buffer");
+        out.ret = SDSKV_ERR_INVALID_ARG;
+        return;
+    }
+    char* packed_data = packed_keys;
+    for (unsigned i = 0; i < in.num_keys; i++) packed_data += key_sizes[i];
+
+    /* keys are processed independently; the first failure is reported */
+    for (unsigned i = 0; i < in.num_keys; i++) {
+        int r = db->append(packed_keys, key_sizes[i], packed_data,
+                           data_sizes[i], &local_sizes_buffer[i]);
+        if (r != SDSKV_SUCCESS) {
+            local_sizes_buffer[i] = 0;
+            if (out.ret == SDSKV_SUCCESS) out.ret = r;
+        }
+        packed_keys += key_sizes[i];
+        packed_data += data_sizes[i];
+    }
+
+    hret = TIMED_BULK_TRANSFER(mid, HG_BULK_PUSH, info->addr,
+                               in.out_bulk_handle, 0, local_sizes_bulk_handle,
+                               0, sizes_size);
+    if (hret != HG_SUCCESS) {
+        SDSKV_LOG_ERROR(mid, "failed to issue bulk transfer (hret = %d)", hret);
+        out.ret = SDSKV_MAKE_HG_ERROR(hret);
+        return;
+    }
+}
+DEFINE_MARGO_RPC_HANDLER(sdskv_append_packed_ult)
+
+static void sdskv_list_keys_ult(hg_handle_t handle)
+{
+
+    hg_return_t     hret;
+    DECLARE_TRACED_INPUT(list_keys_in_t);
+    list_keys_out_t out;
+    hg_bulk_t       ksizes_local_bulk = HG_BULK_NULL;
+    hg_bulk_t       keys_local_bulk   = HG_BULK_NULL;
+
+    out.ret   = SDSKV_SUCCESS;
+    out.nkeys = 0;
+
+    ENSURE_MARGO_DESTROY;
+    ENSURE_MARGO_RESPOND;
+    FIND_MID_AND_PROVIDER;
+    GET_INPUT;
+    ENSURE_MARGO_FREE_INPUT;
+    FIND_DATABASE;
+
+    /* max_keys can't exceed what the client's buffer of sizes holds */
+    if (in.max_keys
+        > HG_Bulk_get_size(in.ksizes_bulk_handle) / sizeof(hg_size_t)) {
+        SDSKV_LOG_ERROR(mid, "invalid bulk size for %lu keys", in.max_keys);
+        out.ret = SDSKV_ERR_INVALID_ARG;
+        return;
+    }
+
+    /* create a bulk handle to receive and send key sizes from client */
+    std::vector<hg_size_t> ksizes(in.max_keys);
+    std::vector<void*>     ksizes_addr(1);
+    ksizes_addr[0]             = (void*)ksizes.data();
+    hg_size_t ksizes_bulk_size = ksizes.size() * sizeof(hg_size_t);
+    hret = margo_bulk_create(mid, 1, ksizes_addr.data(), &ksizes_bulk_size,
+                             HG_BULK_READWRITE, &ksizes_local_bulk);
+    if (hret != HG_SUCCESS) {
+        SDSKV_LOG_ERROR(mid, "failed to create bulk handle (hret = %d)", hret);
+        out.ret = SDSKV_MAKE_HG_ERROR(hret);
+        return;
+    }
+    DEFER(margo_bulk_free_ksizes, margo_bulk_free(ksizes_local_bulk));
+
+    /* receive the key sizes from the client */
+    hg_addr_t origin_addr = info->addr;
+    hret                  = TIMED_BULK_TRANSFER(mid, HG_BULK_PULL, origin_addr,
+                               in.ksizes_bulk_handle, 0, ksizes_local_bulk, 0,
+                               ksizes_bulk_size);
+    if (hret != HG_SUCCESS) {
+        SDSKV_LOG_ERROR(mid, "failed to issue bulk transfer (hret = %d)", hret);
+        out.ret = SDSKV_MAKE_HG_ERROR(hret);
+        return;
+    }
+
+    /* make a copy of the remote key sizes; the space reserved for the keys
+     * is bounded by the size of the client's key buffer (which is NULL if
+     * the client only requests the sizes) */
+    std::vector<hg_size_t> remote_ksizes(ksizes.begin(), ksizes.end());
+    hg_size_t keys_capacity = HG_Bulk_get_size(in.keys_bulk_handle);
+    hg_size_t keys_left     = keys_capacity;
+    consume_sizes(remote_ksizes.data(), in.max_keys, &keys_left);
+
+    /* serialize the keys from the underlying database directly into
+     * a contiguous buffer, recording their actual sizes */
+    ds_bulk_t start_kdata(in.start_key.data,
+                          in.start_key.data + in.start_key.size);
+    ds_bulk_t prefix(in.prefix.data, in.prefix.data + in.prefix.size);
+    std::vector<hg_size_t> true_ksizes;
+    std::vector<char>      keys_buffer;
+    bool                   size_error = false;
+    if (in.max_keys != 0) {
+        true_ksizes.reserve(in.max_keys);
+        keys_buffer.reserve(keys_capacity - keys_left);
+        db->visit_keys(start_kdata, prefix,
+                       [&](const void* key, hg_size_t ksize, const void*,
+                           hg_size_t) {
+                           // this key may exceed the allocated size on client
+                           if (ksize > remote_ksizes[true_ksizes.size()])
+                               size_error = true;
+                           keys_buffer.insert(keys_buffer.end(),
+                                              (const char*)key,
+                                              (const char*)key + ksize);
+                           true_ksizes.push_back(ksize);
+                           return true_ksizes.size() < in.max_keys;
+                       });
+    }
+    hg_size_t num_keys = true_ksizes.size();
+
+    if (num_keys == 0) {
+        out.ret = SDSKV_SUCCESS;
+        return;
+    }
+
+    /* set the actual sizes */
+    for (unsigned i = 0; i < num_keys; i++) { ksizes[i] = true_ksizes[i]; }
+    for (unsigned i = num_keys; i < in.max_keys; i++) { ksizes[i] = 0; }
+    out.nkeys = num_keys;
+
+    /* transfer the ksizes back to the client */
+    hret = TIMED_BULK_TRANSFER(mid, HG_BULK_PUSH, origin_addr,
+                               in.ksizes_bulk_handle, 0, ksizes_local_bulk, 0,
+                               ksizes_bulk_size);
+    if (hret != HG_SUCCESS) {
+        SDSKV_LOG_ERROR(mid, "failed to issue bulk transfer (hret = %d)", hret);
+        out.ret = SDSKV_MAKE_HG_ERROR(hret);
+        return;
+    }
+
+    /* if user provided a size too small for some key, return error (we
+     * already set the right key sizes) */
+    if (size_error) {
+        out.ret = SDSKV_ERR_SIZE;
+        return;
+    }
+
+    /* nothing more to send if all the keys are empty */
+    if (keys_buffer.empty()) {
+        out.ret = SDSKV_SUCCESS;
+        return;
+    }
+
+    /* expose the keys for bulk transfer */
+    void*     keys_addr      = (void*)keys_buffer.data();
+    hg_size_t keys_bulk_size = keys_buffer.size();
+    hret = margo_bulk_create(mid, 1, &keys_addr, &keys_bulk_size,
+                             HG_BULK_READ_ONLY, &keys_local_bulk);
+    if (hret != HG_SUCCESS) {
+        SDSKV_LOG_ERROR(mid, "failed to create bulk handle (hret = %d)", hret);
+        out.ret = SDSKV_MAKE_HG_ERROR(hret);
+        return;
+    }
+    DEFER(margo_bulk_free_keys, margo_bulk_free(keys_local_bulk));
+
+    /* transfer the keys to the client */
+    uint64_t remote_offset = 0;
+    uint64_t local_offset  = 0;
+    for (unsigned i = 0; i < num_keys; i++) {
+
+        if (true_ksizes[i] > 0) {
+            hret = TIMED_BULK_TRANSFER(
+                mid, HG_BULK_PUSH, origin_addr, in.keys_bulk_handle,
+                remote_offset, keys_local_bulk, local_offset, true_ksizes[i]);
+            if (hret != HG_SUCCESS) {
+                SDSKV_LOG_ERROR(
+                    mid, "failed to issue bulk transfer (hret = %d)", hret);
+                out.ret = SDSKV_MAKE_HG_ERROR(hret);
+                return;
+            }
+        }
+
+        remote_offset += remote_ksizes[i];
+        local_offset += true_ksizes[i];
+    }
+
+    out.ret = SDSKV_SUCCESS;
+}
+DEFINE_MARGO_RPC_HANDLER(sdskv_list_keys_ult)
+
+static void sdskv_list_keyvals_ult(hg_handle_t handle)
+{
+
+    hg_return_t        hret;
+    DECLARE_TRACED_INPUT(list_keyvals_in_t);
+    list_keyvals_out_t out;
+    hg_bulk_t          ksizes_local_bulk = HG_BULK_NULL;
+    hg_bulk_t          keys_local_bulk   = HG_BULK_NULL;
+    hg_bulk_t          vsizes_local_bulk = HG_BULK_NULL;
+    hg_bulk_t          vals_local_bulk   = HG_BULK_NULL;
+
+    out.ret   = SDSKV_SUCCESS;
+    out.nkeys = 0;
+
+    ENSURE_MARGO_DESTROY;
+    ENSURE_MARGO_RESPOND;
+    FIND_MID_AND_PROVIDER;
+    GET_INPUT;
+    ENSURE_MARGO_FREE_INPUT;
+    FIND_DATABASE;
+
+    /* max_keys can't exceed what the client's buffers of sizes hold */
+    if (in.max_keys
+            > HG_Bulk_get_size(in.ksizes_bulk_handle) / sizeof(hg_size_t)
+        || in.max_keys
+               > HG_Bulk_get_size(in.vsizes_bulk_handle) / sizeof(hg_size_t)) {
+        SDSKV_LOG_ERROR(mid, "invalid bulk sizes for %lu keys", in.max_keys);
+        out.ret = SDSKV_ERR_INVALID_ARG;
+        return;
+    }
+
+    /* create a bulk handle to receive and send key sizes from client */
+    std::vector<hg_size_t> ksizes(in.max_keys);
+    std::vector<void*>     ksizes_addr(1);
+    ksizes_addr[0]             = (void*)ksizes.data();
+    hg_size_t ksizes_bulk_size = ksizes.size() * sizeof(hg_size_t);
+    hret = margo_bulk_create(mid, 1, ksizes_addr.data(), &ksizes_bulk_size,
+                             HG_BULK_READWRITE, &ksizes_local_bulk);
     if (hret != HG_SUCCESS) {
         SDSKV_LOG_ERROR(mid, "failed to create bulk handle (hret = %d)", hret);
         out.ret = SDSKV_MAKE_HG_ERROR(hret);
@@ -2131,7 +4018,7 @@ static void sdskv_list_keyvals_ult(hg_handle_t handle)
 
     /* receive the key sizes from the client */
     hg_addr_t origin_addr = info->addr;
-    hret                  = margo_bulk_transfer(mid, HG_BULK_PULL, origin_addr,
+    hret                  = TIMED_BULK_TRANSFER(mid, HG_BULK_PULL, origin_addr,
                                in.ksizes_bulk_handle, 0, ksizes_local_bulk, 0,
                                ksizes_bulk_size);
     if (hret != HG_SUCCESS) {
@@ -2140,175 +4027,815 @@ static void sdskv_list_keyvals_ult(hg_handle_t handle)
         return;
     }
 
-    /* receive the values sizes from the client */
-    hret = margo_bulk_transfer(mid, HG_BULK_PULL, origin_addr,
-                               in.vsizes_bulk_handle, 0, vsizes_local_bulk, 0,
-                               vsizes_bulk_size);
+    /* receive the values sizes from the client */
+    hret = TIMED_BULK_TRANSFER(mid, HG_BULK_PULL, origin_addr,
+                               in.vsizes_bulk_handle, 0, vsizes_local_bulk, 0,
+                               vsizes_bulk_size);
+    if (hret != HG_SUCCESS) {
+        SDSKV_LOG_ERROR(mid, "failed to issue bulk transfer (hret = %d)", hret);
+        out.ret = SDSKV_MAKE_HG_ERROR(hret);
+        return;
+    }
+
+    /* make a copy of the remote key sizes and value sizes; the space
+     * reserved for the keys and values is bounded by the size of the
+     * client's buffers (which are NULL if the client only requests the
+     * sizes) */
+    std::vector<hg_size_t> remote_ksizes(ksizes.begin(), ksizes.end());
+    std::vector<hg_size_t> remote_vsizes(vsizes.begin(), vsizes.end());
+    hg_size_t keys_capacity = HG_Bulk_get_size(in.keys_bulk_handle);
+    hg_size_t vals_capacity = HG_Bulk_get_size(in.vals_bulk_handle);
+    hg_size_t keys_left     = keys_capacity;
+    hg_size_t vals_left     = vals_capacity;
+    consume_sizes(remote_ksizes.data(), in.max_keys, &keys_left);
+    consume_sizes(remote_vsizes.data(), in.max_keys, &vals_left);
+
+    /* serialize the keys and values from the underlying database
+     * directly into contiguous buffers, recording their actual sizes */
+    ds_bulk_t start_kdata(in.start_key.data,
+                          in.start_key.data + in.start_key.size);
+    ds_bulk_t prefix(in.prefix.data, in.prefix.data + in.prefix.size);
+    std::vector<hg_size_t> true_ksizes;
+    std::vector<hg_size_t> true_vsizes;
+    std::vector<char>      keys_buffer;
+    std::vector<char>      vals_buffer;
+    bool                   size_error = false;
+    if (in.max_keys != 0) {
+        true_ksizes.reserve(in.max_keys);
+        true_vsizes.reserve(in.max_keys);
+        keys_buffer.reserve(keys_capacity - keys_left);
+        vals_buffer.reserve(vals_capacity - vals_left);
+        db->visit_keyvals(
+            start_kdata, prefix,
+            [&](const void* key, hg_size_t ksize, const void* val,
+                hg_size_t vsize) {
+                // this key or value may exceed the allocated size on client
+                size_t i = true_ksizes.size();
+                if (ksize > remote_ksizes[i] || vsize > remote_vsizes[i])
+                    size_error = true;
+                keys_buffer.insert(keys_buffer.end(), (const char*)key,
+                                   (const char*)key + ksize);
+                vals_buffer.insert(vals_buffer.end(), (const char*)val,
+                                   (const char*)val + vsize);
+                true_ksizes.push_back(ksize);
+                true_vsizes.push_back(vsize);
+                return true_ksizes.size() < in.max_keys;
+            });
+    }
+    hg_size_t num_keys = true_ksizes.size();
+
+    out.nkeys = num_keys;
+
+    if (num_keys == 0) {
+        out.ret = SDSKV_SUCCESS;
+        return;
+    }
+
+    /* set the actual key and value sizes */
+    for (unsigned i = 0; i < num_keys; i++) {
+        ksizes[i] = true_ksizes[i];
+        vsizes[i] = true_vsizes[i];
+    }
+    for (unsigned i = num_keys; i < ksizes.size(); i++) ksizes[i] = 0;
+    for (unsigned i = num_keys; i < vsizes.size(); i++) vsizes[i] = 0;
+
+    /* transfer the ksizes back to the client */
+    if (ksizes_bulk_size) {
+        hret = TIMED_BULK_TRANSFER(mid, HG_BULK_PUSH, origin_addr,
+                                   in.ksizes_bulk_handle, 0, ksizes_local_bulk,
+                                   0, ksizes_bulk_size);
+        if (hret != HG_SUCCESS) {
+            SDSKV_LOG_ERROR(mid, "failed to issue bulk transfer (hret = %d)",
+                            hret);
+            out.ret = SDSKV_MAKE_HG_ERROR(hret);
+            return;
+        }
+    }
+
+    /* transfer the vsizes back to the client */
+    if (vsizes_bulk_size) {
+        hret = TIMED_BULK_TRANSFER(mid, HG_BULK_PUSH, origin_addr,
+                                   in.vsizes_bulk_handle, 0, vsizes_local_bulk,
+                                   0, vsizes_bulk_size);
+        if (hret != HG_SUCCESS) {
+            SDSKV_LOG_ERROR(mid, "failed to issue bulk transfer (hret = %d)",
+                            hret);
+            out.ret = SDSKV_MAKE_HG_ERROR(hret);
+            return;
+        }
+    }
+
+    /* if user provided a size too small for some key or value, return
+     * error (we already set the right sizes) */
+    if (size_error) {
+        out.ret = SDSKV_ERR_SIZE;
+        return;
+    }
+
+    /* expose the keys for bulk transfer */
+    void*     keys_addr      = (void*)keys_buffer.data();
+    hg_size_t keys_bulk_size = keys_buffer.size();
+    if (keys_bulk_size) {
+        hret = margo_bulk_create(mid, 1, &keys_addr, &keys_bulk_size,
+                                 HG_BULK_READ_ONLY, &keys_local_bulk);
+        if (hret != HG_SUCCESS) {
+            SDSKV_LOG_ERROR(mid, "could not create bulk");
+            out.ret = SDSKV_MAKE_HG_ERROR(hret);
+            return;
+        }
+    }
+    DEFER(margo_bulk_free_keys_local, margo_bulk_free(keys_local_bulk));
+
+    /* expose the values for bulk transfer */
+    void*     vals_addr      = (void*)vals_buffer.data();
+    hg_size_t vals_bulk_size = vals_buffer.size();
+    if (vals_bulk_size) {
+        hret = margo_bulk_create(mid, 1, &vals_addr, &vals_bulk_size,
+                                 HG_BULK_READ_ONLY, &vals_local_bulk);
+        if (hret != HG_SUCCESS) {
+            SDSKV_LOG_ERROR(mid, "could not create bulk");
+            out.ret = SDSKV_MAKE_HG_ERROR(hret);
+            return;
+        }
+    }
+    DEFER(margo_bulk_free_vals_local, margo_bulk_free(vals_local_bulk));
+
+    uint64_t remote_offset = 0;
+    uint64_t local_offset  = 0;
+
+    /* transfer the keys to the client */
+    for (unsigned i = 0; i < num_keys; i++) {
+        if (true_ksizes[i] > 0) {
+            hret = TIMED_BULK_TRANSFER(
+                mid, HG_BULK_PUSH, origin_addr, in.keys_bulk_handle,
+                remote_offset, keys_local_bulk, local_offset, true_ksizes[i]);
+            if (hret != HG_SUCCESS) {
+                SDSKV_LOG_ERROR(
+                    mid, "failed to issue bulk transfer (hret = %d)", hret);
+                out.ret = SDSKV_MAKE_HG_ERROR(hret);
+                return;
+            }
+        }
+        remote_offset += remote_ksizes[i];
+        local_offset += true_ksizes[i];
+    }
+
+    remote_offset = 0;
+    local_offset  = 0;
+
+    /* transfer the values to the client */
+    for (unsigned i = 0; i < num_keys; i++) {
+        if (true_vsizes[i] > 0) {
+            hret = TIMED_BULK_TRANSFER(
+                mid, HG_BULK_PUSH, origin_addr, in.vals_bulk_handle,
+                remote_offset, vals_local_bulk, local_offset, true_vsizes[i]);
+            if (hret != HG_SUCCESS) {
+                SDSKV_LOG_ERROR(
+                    mid, "failed to issue bulk transfer (hret = %d)", hret);
+                out.ret = SDSKV_MAKE_HG_ERROR(hret);
+                return;
+            }
+        }
+        remote_offset += remote_vsizes[i];
+        local_offset += true_vsizes[i];
+    }
+
+    out.ret = SDSKV_SUCCESS;
+}
+DEFINE_MARGO_RPC_HANDLER(sdskv_list_keyvals_ult)
+
+static void sdskv_sync_ult(hg_handle_t handle)
+{
+    hg_return_t hret;
+    DECLARE_TRACED_INPUT(sync_in_t);
+    sync_out_t  out;
+
+    ENSURE_MARGO_DESTROY;
+    ENSURE_MARGO_RESPOND;
+    FIND_MID_AND_PROVIDER;
+    GET_INPUT;
+    ENSURE_MARGO_FREE_INPUT;
+    FIND_DATABASE;
+
+    out.ret = db->sync();
+    if (out.ret != SDSKV_SUCCESS)
+        SDSKV_LOG_ERROR(mid, "failed to sync database %lu (ret = %d)",
+                        in.db_id, out.ret);
+}
+DEFINE_MARGO_RPC_HANDLER(sdskv_sync_ult)
+
+static void sdskv_batch_ult(hg_handle_t handle)
+{
+    hg_return_t       hret;
+    DECLARE_TRACED_INPUT(batch_in_t);
+    batch_out_t       out;
+    std::vector<char> local_in_buffer;
+    std::vector<char> local_out_buffer;
+    hg_bulk_t         local_in_bulk_handle;
+    hg_bulk_t         local_out_bulk_handle;
+    out.ret = SDSKV_SUCCESS;
+
+    ENSURE_MARGO_DESTROY;
+    ENSURE_MARGO_RESPOND;
+    FIND_MID_AND_PROVIDER;
+    GET_INPUT;
+    ENSURE_MARGO_FREE_INPUT;
+
+    hg_size_t n = in.num_ops;
+    /* the request holds the database ids, key sizes, value sizes and
+     * operation types, followed by the packed keys and the packed values
+     * of the puts; the reply holds the value sizes and return codes,
+     * followed by one slot per get, of the size requested by the client */
+    hg_size_t header_size = n * (sizeof(uint64_t) + 2 * sizeof(hg_size_t)
+                                 + sizeof(int32_t));
+    hg_size_t reply_header_size = n * (sizeof(hg_size_t) + sizeof(int32_t));
+    if (in.in_bulk_size < header_size
+        || in.out_bulk_size < reply_header_size) {
+        SDSKV_LOG_ERROR(mid, "invalid bulk sizes for batch of %lu operations",
+                        n);
+        out.ret = SDSKV_ERR_INVALID_ARG;
+        return;
+    }
+
+    local_in_buffer.resize(in.in_bulk_size);
+    void* in_addr = (void*)local_in_buffer.data();
+    hret = margo_bulk_create(mid, 1, &in_addr, &in.in_bulk_size,
+                             HG_BULK_WRITE_ONLY, &local_in_bulk_handle);
+    if (hret != HG_SUCCESS) {
+        SDSKV_LOG_ERROR(mid, "failed to create bulk handle (hret = %d)", hret);
+        out.ret = SDSKV_MAKE_HG_ERROR(hret);
+        return;
+    }
+    DEFER(margo_bulk_free_local_in, margo_bulk_free(local_in_bulk_handle));
+
+    local_out_buffer.resize(in.out_bulk_size);
+    void* out_addr = (void*)local_out_buffer.data();
+    hret = margo_bulk_create(mid, 1, &out_addr, &in.out_bulk_size,
+                             HG_BULK_READ_ONLY, &local_out_bulk_handle);
+    if (hret != HG_SUCCESS) {
+        SDSKV_LOG_ERROR(mid, "failed to create bulk handle (hret = %d)", hret);
+        out.ret = SDSKV_MAKE_HG_ERROR(hret);
+        return;
+    }
+    DEFER(margo_bulk_free_local_out, margo_bulk_free(local_out_bulk_handle));
+
+    hret = TIMED_BULK_TRANSFER(mid, HG_BULK_PULL, info->addr, in.in_bulk_handle,
+                               0, local_in_bulk_handle, 0, in.in_bulk_size);
+    if (hret != HG_SUCCESS) {
+        SDSKV_LOG_ERROR(mid, "failed to issue bulk transfer (hret = %d)", hret);
+        out.ret = SDSKV_MAKE_HG_ERROR(hret);
+        return;
+    }
+
+    uint64_t*  db_ids  = (uint64_t*)local_in_buffer.data();
+    hg_size_t* ksizes  = (hg_size_t*)(db_ids + n);
+    hg_size_t* vsizes  = ksizes + n;
+    int32_t*   types   = (int32_t*)(vsizes + n);
+    char*      keys    = (char*)(types + n);
+    char*      in_end  = local_in_buffer.data() + in.in_bulk_size;
+    hg_size_t* rsizes  = (hg_size_t*)local_out_buffer.data();
+    int32_t*   rets    = (int32_t*)(rsizes + n);
+    char*      slots   = (char*)(rets + n);
+    char*      out_end = local_out_buffer.data() + in.out_bulk_size;
+
+    /* check the sizes against the buffers before touching any database */
+    hg_size_t total_ksize = 0, total_put_size = 0, total_get_size = 0;
+    for (hg_size_t i = 0; i < n; i++) {
+        total_ksize += ksizes[i];
+        if (types[i] == SDSKV_BATCH_PUT) total_put_size += vsizes[i];
+        if (types[i] == SDSKV_BATCH_GET) total_get_size += vsizes[i];
+    }
+    if (total_ksize + total_put_size != (hg_size_t)(in_end - keys)
+        || total_get_size != (hg_size_t)(out_end - slots)) {
+        SDSKV_LOG_ERROR(mid, "inconsistent sizes in batch request");
+        out.ret = SDSKV_ERR_INVALID_ARG;
+        return;
+    }
+    char* values = keys + total_ksize;
+
+    /* resolve all the databases at once */
+    std::vector<AbstractDataStore*> dbs(n, nullptr);
+    ABT_rwlock_rdlock(provider->lock);
+    for (hg_size_t i = 0; i < n; i++) {
+        auto it = provider->databases.find(db_ids[i]);
+        if (it != provider->databases.end()) dbs[i] = it->second;
+    }
+    ABT_rwlock_unlock(provider->lock);
+
+    /* operations are executed in order, each with its own result */
+    for (hg_size_t i = 0; i < n; i++) {
+        auto db   = dbs[i];
+        rsizes[i] = 0;
+        if (!db) {
+            rets[i] = SDSKV_ERR_UNKNOWN_DB;
+        } else {
+            switch (types[i]) {
+            case SDSKV_BATCH_PUT:
+                db->record_access(keys, ksizes[i], true);
+                rets[i] = db->put(keys, ksizes[i], values, vsizes[i]);
+                break;
+            case SDSKV_BATCH_GET: {
+                ds_bulk_t k(keys, keys + ksizes[i]);
+                ds_bulk_t v;
+                db->record_access(keys, ksizes[i], false);
+                if (!db->get(k, v)) {
+                    rets[i] = SDSKV_ERR_UNKNOWN_KEY;
+                } else {
+                    rsizes[i] = v.size();
+                    if (v.size() > vsizes[i]) {
+                        rets[i] = SDSKV_ERR_SIZE;
+                    } else {
+                        std::memcpy(slots, v.data(), v.size());
+                        rets[i] = SDSKV_SUCCESS;
+                    }
+                }
+            } break;
+            case SDSKV_BATCH_ERASE: {
+                ds_bulk_t k(keys, keys + ksizes[i]);
+                rets[i] = db->erase(k) ? SDSKV_SUCCESS : SDSKV_ERR_ERASE;
+            } break;
+            case SDSKV_BATCH_EXISTS:
+                rsizes[i] = db->exists(keys, ksizes[i]) ? 1 : 0;
+                rets[i]   = SDSKV_SUCCESS;
+                break;
+            case SDSKV_BATCH_LENGTH: {
+                size_t vsize;
+                if (db->length(keys, ksizes[i], &vsize)) {
+                    rsizes[i] = vsize;
+                    rets[i]   = SDSKV_SUCCESS;
+                } else {
+                    rets[i] = SDSKV_ERR_UNKNOWN_KEY;
+                }
+            } break;
+            default:
+                rets[i] = SDSKV_ERR_INVALID_ARG;
+            }
+        }
+        keys += ksizes[i];
+        if (types[i] == SDSKV_BATCH_PUT) values += vsizes[i];
+        if (types[i] == SDSKV_BATCH_GET) slots += vsizes[i];
+    }
+
+    hret = TIMED_BULK_TRANSFER(mid, HG_BULK_PUSH, info->addr,
+                               in.out_bulk_handle, 0, local_out_bulk_handle, 0,
+                               in.out_bulk_size);
+    if (hret != HG_SUCCESS) {
+        SDSKV_LOG_ERROR(mid, "failed to issue bulk transfer (hret = %d)", hret);
+        out.ret = SDSKV_MAKE_HG_ERROR(hret);
+        return;
+    }
+}
+DEFINE_MARGO_RPC_HANDLER(sdskv_batch_ult)
+
+/* computes the size of the header of a cross-database request, made of
+ * num_dbs database ids followed by num_keys entries of entry_size bytes,
+ * returning false if it does not fit in bulk_size */
+static bool multi_db_header_size(hg_size_t  num_dbs,
+                                 hg_size_t  num_keys,
+                                 hg_size_t  entry_size,
+                                 hg_size_t  bulk_size,
+                                 hg_size_t* header_size)
+{
+    if (num_dbs > bulk_size / sizeof(uint64_t)) return false;
+    hg_size_t remaining = bulk_size - num_dbs * sizeof(uint64_t);
+    if (num_keys > remaining / entry_size) return false;
+    *header_size = num_dbs * sizeof(uint64_t) + num_keys * entry_size;
+    return true;
+}
+
+/* resolves the database table of a cross-database request and checks
+ * the per-entry indices against it */
+static int find_databases(sdskv_provider_t                 provider,
+                          hg_size_t                        num_dbs,
+                          const uint64_t*                  db_ids,
+                          hg_size_t                        num_keys,
+                          const uint32_t*                  db_indices,
+                          std::vector<AbstractDataStore*>& dbs)
+{
+    dbs.resize(num_dbs);
+    ABT_rwlock_rdlock(provider->lock);
+    for (hg_size_t i = 0; i < num_dbs; i++) {
+        auto it = provider->databases.find(db_ids[i]);
+        if (it == provider->databases.end()) {
+            ABT_rwlock_unlock(provider->lock);
+            SDSKV_LOG_ERROR(provider->mid,
+                            "could not find database with id %lu", db_ids[i]);
+            return SDSKV_ERR_UNKNOWN_DB;
+        }
+        dbs[i] = it->second;
+    }
+    ABT_rwlock_unlock(provider->lock);
+    for (hg_size_t i = 0; i < num_keys; i++) {
+        if (db_indices[i] >= num_dbs) {
+            SDSKV_LOG_ERROR(provider->mid, "invalid database index %u",
+                            db_indices[i]);
+            return SDSKV_ERR_INVALID_ARG;
+        }
+    }
+    return SDSKV_SUCCESS;
+}
+
+/* admits a cross-database request into each of its databases that has
+ * admission control, in address order so that two such requests can't
+ * each hold a slot that the other waits for; the databases admitted into
+ * are added to admitted, to be released even if a later one is busy */
+static int admit_databases(sdskv_provider_t                 provider,
+                           hg_addr_t                        addr,
+                           std::vector<AbstractDataStore*>  dbs,
+                           std::vector<AbstractDataStore*>& admitted)
+{
+    std::sort(dbs.begin(), dbs.end());
+    dbs.erase(std::unique(dbs.begin(), dbs.end()), dbs.end());
+    std::string client;
+    for (auto db : dbs) {
+        if (!db->admission_enabled()) continue;
+        if (client.empty()) client = get_client_name(provider, addr);
+        int ret = db->admit(client);
+        if (ret != SDSKV_SUCCESS) return ret;
+        admitted.push_back(db);
+    }
+    return SDSKV_SUCCESS;
+}
+
+static void sdskv_put_packed_multi_db_ult(hg_handle_t handle)
+{
+    hg_return_t               hret;
+    DECLARE_TRACED_INPUT(put_packed_multi_db_in_t);
+    put_packed_multi_db_out_t out;
+    out.ret = SDSKV_SUCCESS;
+    std::vector<char> local_buffer;
+    hg_bulk_t         local_bulk_handle;
+
+    ENSURE_MARGO_DESTROY;
+    ENSURE_MARGO_RESPOND;
+    FIND_MID_AND_PROVIDER;
+    GET_INPUT;
+    ENSURE_MARGO_FREE_INPUT;
+
+    hg_size_t header_size;
+    if (!multi_db_header_size(in.num_dbs, in.num_keys,
+                              2 * sizeof(hg_size_t) + sizeof(uint32_t),
+                              in.bulk_size, &header_size)) {
+        SDSKV_LOG_ERROR(mid, "invalid bulk size for %lu keys in %lu databases",
+                        in.num_keys, in.num_dbs);
+        out.ret = SDSKV_ERR_INVALID_ARG;
+        return;
+    }
+
+    local_buffer.resize(in.bulk_size);
+    void* buf_ptr = local_buffer.data();
+    hret = margo_bulk_create(mid, 1, &buf_ptr, &in.bulk_size,
+                             HG_BULK_WRITE_ONLY, &local_bulk_handle);
+    if (hret != HG_SUCCESS) {
+        SDSKV_LOG_ERROR(mid, "failed to create bulk handle (hret = %d)", hret);
+        out.ret = SDSKV_MAKE_HG_ERROR(hret);
+        return;
+    }
+    DEFER(margo_bulk_free, margo_bulk_free(local_bulk_handle));
+
+    hret = TIMED_BULK_TRANSFER(mid, HG_BULK_PULL, info->addr, in.bulk_handle,
+                               0, local_bulk_handle, 0, in.bulk_size);
+    if (hret != HG_SUCCESS) {
+        SDSKV_LOG_ERROR(mid, "failed to issue bulk transfer (hret = %d)", hret);
+        out.ret = SDSKV_MAKE_HG_ERROR(hret);
+        return;
+    }
+
+    /* the buffer holds the database ids, the key sizes, the value sizes,
+     * the database index of each pair, the packed keys and the packed
+     * values */
+    uint64_t*  db_ids     = (uint64_t*)local_buffer.data();
+    hg_size_t* key_sizes  = (hg_size_t*)(db_ids + in.num_dbs);
+    hg_size_t* val_sizes  = key_sizes + in.num_keys;
+    uint32_t*  db_indices = (uint32_t*)(val_sizes + in.num_keys);
+    char*      key        = (char*)(db_indices + in.num_keys);
+
+    hg_size_t remaining = in.bulk_size - header_size;
+    if (!consume_sizes(key_sizes, in.num_keys, &remaining)
+        || !consume_sizes(val_sizes, in.num_keys, &remaining)
+        || remaining != 0) {
+        SDSKV_LOG_ERROR(mid, "inconsistent sizes in put_packed_multi_db");
+        out.ret = SDSKV_ERR_INVALID_ARG;
+        return;
+    }
+    char* val = key;
+    for (hg_size_t i = 0; i < in.num_keys; i++) val += key_sizes[i];
+
+    std::vector<AbstractDataStore*> dbs;
+    out.ret = find_databases(provider, in.num_dbs, db_ids, in.num_keys,
+                             db_indices, dbs);
+    if (out.ret != SDSKV_SUCCESS) return;
+    ENSURE_ADMITTED_MULTI_DB(dbs);
+
+    /* gather the pairs of each database so that each backend gets a
+     * single put_multi */
+    std::vector<std::vector<const void*>> keys(in.num_dbs), vals(in.num_dbs);
+    std::vector<std::vector<hg_size_t>>   ksizes(in.num_dbs),
+        vsizes(in.num_dbs);
+    for (hg_size_t i = 0; i < in.num_keys; i++) {
+        auto d = db_indices[i];
+        keys[d].push_back(key);
+        ksizes[d].push_back(key_sizes[i]);
+        vals[d].push_back(val);
+        vsizes[d].push_back(val_sizes[i]);
+        key += key_sizes[i];
+        val += val_sizes[i];
+    }
+    for (hg_size_t d = 0; d < in.num_dbs; d++) {
+        if (keys[d].empty()) continue;
+        int r = dbs[d]->put_multi(keys[d].size(), keys[d].data(),
+                                  ksizes[d].data(), vals[d].data(),
+                                  vsizes[d].data());
+        if (r != SDSKV_SUCCESS && out.ret == SDSKV_SUCCESS) out.ret = r;
+    }
+}
+DEFINE_MARGO_RPC_HANDLER(sdskv_put_packed_multi_db_ult)
+
+static void sdskv_get_packed_multi_db_ult(hg_handle_t handle)
+{
+    hg_return_t               hret;
+    DECLARE_TRACED_INPUT(get_packed_multi_db_in_t);
+    get_packed_multi_db_out_t out;
+    out.ret      = SDSKV_SUCCESS;
+    out.num_keys = 0;
+    std::vector<char> local_keys_buffer;
+    std::vector<char> local_vals_buffer;
+    hg_bulk_t         local_keys_bulk_handle;
+    hg_bulk_t         local_vals_bulk_handle;
+
+    ENSURE_MARGO_DESTROY;
+    ENSURE_MARGO_RESPOND;
+    FIND_MID_AND_PROVIDER;
+    GET_INPUT;
+    ENSURE_MARGO_FREE_INPUT;
+
+    hg_size_t header_size;
+    if (!multi_db_header_size(in.num_dbs, in.num_keys,
+                              sizeof(hg_size_t) + sizeof(uint32_t),
+                              in.keys_bulk_size, &header_size)
+        || in.num_keys > in.vals_bulk_size / sizeof(hg_size_t)) {
+        SDSKV_LOG_ERROR(mid, "invalid bulk sizes for %lu keys in %lu databases",
+                        in.num_keys, in.num_dbs);
+        out.ret = SDSKV_ERR_INVALID_ARG;
+        return;
+    }
+
+    local_keys_buffer.resize(in.keys_bulk_size);
+    void* keys_addr = (void*)local_keys_buffer.data();
+    hret = margo_bulk_create(mid, 1, &keys_addr, &in.keys_bulk_size,
+                             HG_BULK_WRITE_ONLY, &local_keys_bulk_handle);
+    if (hret != HG_SUCCESS) {
+        SDSKV_LOG_ERROR(mid, "failed to create bulk handle (hret = %d)", hret);
+        out.ret = SDSKV_MAKE_HG_ERROR(hret);
+        return;
+    }
+    DEFER(margo_bulk_free_local_keys, margo_bulk_free(local_keys_bulk_handle));
+
+    local_vals_buffer.resize(in.vals_bulk_size);
+    void* vals_addr = (void*)local_vals_buffer.data();
+    hret = margo_bulk_create(mid, 1, &vals_addr, &in.vals_bulk_size,
+                             HG_BULK_READ_ONLY, &local_vals_bulk_handle);
+    if (hret != HG_SUCCESS) {
+        SDSKV_LOG_ERROR(mid, "failed to create bulk handle (hret = %d)", hret);
+        out.ret = SDSKV_MAKE_HG_ERROR(hret);
+        return;
+    }
+    DEFER(margo_bulk_free_local_vals, margo_bulk_free(local_vals_bulk_handle));
+
+    hret = TIMED_BULK_TRANSFER(mid, HG_BULK_PULL, info->addr,
+                               in.keys_bulk_handle, 0, local_keys_bulk_handle,
+                               0, in.keys_bulk_size);
     if (hret != HG_SUCCESS) {
         SDSKV_LOG_ERROR(mid, "failed to issue bulk transfer (hret = %d)", hret);
         out.ret = SDSKV_MAKE_HG_ERROR(hret);
         return;
     }
 
-    /* make a copy of the remote key sizes and value sizes */
-    std::vector<hg_size_t> remote_ksizes(ksizes.begin(), ksizes.end());
-    std::vector<hg_size_t> remote_vsizes(vsizes.begin(), vsizes.end());
-
-    /* get the keys and values from the underlying database */
-    ds_bulk_t start_kdata(in.start_key.data,
-                          in.start_key.data + in.start_key.size);
-    ds_bulk_t prefix(in.prefix.data, in.prefix.data + in.prefix.size);
-    auto      keyvals  = db->list_keyvals(start_kdata, in.max_keys, prefix);
-    hg_size_t num_keys = std::min((size_t)keyvals.size(), (size_t)in.max_keys);
-
-    out.nkeys = num_keys;
-
-    if (num_keys == 0) {
-        out.ret = SDSKV_SUCCESS;
+    /* the key buffer holds the database ids, the key sizes, the database
+     * index of each key and the packed keys; the value buffer is laid out
+     * as for get_packed */
+    uint64_t*  db_ids        = (uint64_t*)local_keys_buffer.data();
+    hg_size_t* key_sizes     = (hg_size_t*)(db_ids + in.num_dbs);
+    uint32_t*  db_indices    = (uint32_t*)(key_sizes + in.num_keys);
+    char*      packed_keys   = (char*)(db_indices + in.num_keys);
+    hg_size_t* val_sizes     = (hg_size_t*)local_vals_buffer.data();
+    char*      packed_values = (char*)(val_sizes + in.num_keys);
+
+    hg_size_t remaining = in.keys_bulk_size - header_size;
+    if (!consume_sizes(key_sizes, in.num_keys, &remaining) || remaining != 0) {
+        SDSKV_LOG_ERROR(mid, "inconsistent sizes in get_packed_multi_db");
+        out.ret = SDSKV_ERR_INVALID_ARG;
         return;
     }
 
-    bool size_error = false;
+    std::vector<AbstractDataStore*> dbs;
+    out.ret = find_databases(provider, in.num_dbs, db_ids, in.num_keys,
+                             db_indices, dbs);
+    if (out.ret != SDSKV_SUCCESS) return;
+    ENSURE_ADMITTED_MULTI_DB(dbs);
 
-    /* create the array of actual key sizes */
-    std::vector<hg_size_t> true_ksizes(num_keys);
-    hg_size_t              keys_bulk_size = 0;
-    for (unsigned i = 0; i < num_keys; i++) {
-        true_ksizes[i] = keyvals[i].first.size();
-        if (true_ksizes[i] > ksizes[i]) {
-            // this key has a size that exceeds the allocated size on client
-            size_error = true;
+    /* same semantics as get_packed: values are packed until the client's
+     * buffer is full, missing keys get a size of -1 */
+    size_t available_client_memory
+        = in.vals_bulk_size - in.num_keys * sizeof(hg_size_t);
+    for (hg_size_t i = 0; i < in.num_keys; i++) {
+        ds_bulk_t kdata(packed_keys, packed_keys + key_sizes[i]);
+        ds_bulk_t vdata;
+        packed_keys += key_sizes[i];
+        if (available_client_memory == 0) {
+            val_sizes[i] = 0;
+            out.ret      = SDSKV_ERR_SIZE;
+            continue;
         }
-        ksizes[i] = true_ksizes[i];
-        keys_bulk_size += ksizes[i];
-    }
-    for (unsigned i = num_keys; i < ksizes.size(); i++) ksizes[i] = 0;
-
-    /* create the array of actual value sizes */
-    std::vector<hg_size_t> true_vsizes(num_keys);
-    hg_size_t              vals_bulk_size = 0;
-    for (unsigned i = 0; i < num_keys; i++) {
-        true_vsizes[i] = keyvals[i].second.size();
-        if (true_vsizes[i] > vsizes[i]) {
-            // this value has a size that exceeds the allocated size on
-            // client
-            size_error = true;
+        if (dbs[db_indices[i]]->get(kdata, vdata)) {
+            if (vdata.size() > available_client_memory) {
+                available_client_memory = 0;
+                out.ret                 = SDSKV_ERR_SIZE;
+                val_sizes[i]            = 0;
+            } else {
+                out.num_keys += 1;
+                val_sizes[i] = vdata.size();
+                memcpy(packed_values, vdata.data(), val_sizes[i]);
+                packed_values += val_sizes[i];
+                available_client_memory -= val_sizes[i];
+            }
+        } else {
+            val_sizes[i] = (hg_size_t)(-1);
         }
-        vsizes[i] = true_vsizes[i];
-        vals_bulk_size += vsizes[i];
     }
-    for (unsigned i = num_keys; i < vsizes.size(); i++) vsizes[i] = 0;
 
-    /* transfer the ksizes back to the client */
-    if (ksizes_bulk_size) {
-        hret = margo_bulk_transfer(mid, HG_BULK_PUSH, origin_addr,
-                                   in.ksizes_bulk_handle, 0, ksizes_local_bulk,
-                                   0, ksizes_bulk_size);
-        if (hret != HG_SUCCESS) {
-            SDSKV_LOG_ERROR(mid, "failed to issue bulk transfer (hret = %d)",
-                            hret);
-            out.ret = SDSKV_MAKE_HG_ERROR(hret);
-            return;
-        }
+    hret = TIMED_BULK_TRANSFER(mid, HG_BULK_PUSH, info->addr,
+                               in.vals_bulk_handle, 0, local_vals_bulk_handle,
+                               0, in.vals_bulk_size);
+    if (hret != HG_SUCCESS) {
+        SDSKV_LOG_ERROR(mid, "failed to issue bulk transfer (hret = %d)", hret);
+        out.ret = SDSKV_MAKE_HG_ERROR(hret);
+        return;
     }
+}
+DEFINE_MARGO_RPC_HANDLER(sdskv_get_packed_multi_db_ult)
 
-    /* transfer the vsizes back to the client */
-    if (vsizes_bulk_size) {
-        hret = margo_bulk_transfer(mid, HG_BULK_PUSH, origin_addr,
-                                   in.vsizes_bulk_handle, 0, vsizes_local_bulk,
-                                   0, vsizes_bulk_size);
-        if (hret != HG_SUCCESS) {
-            SDSKV_LOG_ERROR(mid, "failed to issue bulk transfer (hret = %d)",
-                            hret);
-            out.ret = SDSKV_MAKE_HG_ERROR(hret);
-            return;
-        }
-    }
+static void sdskv_exists_packed_multi_db_ult(hg_handle_t handle)
+{
+    hg_return_t                  hret;
+    DECLARE_TRACED_INPUT(exists_packed_multi_db_in_t);
+    exists_packed_multi_db_out_t out;
+    out.ret = SDSKV_SUCCESS;
+    std::vector<char>    local_keys_buffer;
+    std::vector<uint8_t> local_flags_buffer;
+    hg_bulk_t            local_keys_bulk_handle;
+    hg_bulk_t            local_flags_bulk_handle;
 
-    if (size_error) out.ret = SDSKV_ERR_SIZE;
+    ENSURE_MARGO_DESTROY;
+    ENSURE_MARGO_RESPOND;
+    FIND_MID_AND_PROVIDER;
+    GET_INPUT;
+    ENSURE_MARGO_FREE_INPUT;
 
-    /* create an array of addresses pointing to keys */
-    std::vector<void*> keys_addr(num_keys);
-    for (unsigned i = 0; i < num_keys; i++) {
-        keys_addr[i] = (void*)(keyvals[i].first.data());
+    hg_size_t header_size;
+    if (!multi_db_header_size(in.num_dbs, in.num_keys,
+                              sizeof(hg_size_t) + sizeof(uint32_t),
+                              in.keys_bulk_size, &header_size)) {
+        SDSKV_LOG_ERROR(mid, "invalid bulk size for %lu keys in %lu databases",
+                        in.num_keys, in.num_dbs);
+        out.ret = SDSKV_ERR_INVALID_ARG;
+        return;
     }
 
-    /* create an array of addresses pointing to values */
-    std::vector<void*> vals_addr(num_keys);
-    for (unsigned i = 0; i < num_keys; i++) {
-        vals_addr[i] = (void*)(keyvals[i].second.data());
+    local_keys_buffer.resize(in.keys_bulk_size);
+    void* keys_addr = (void*)local_keys_buffer.data();
+    hret = margo_bulk_create(mid, 1, &keys_addr, &in.keys_bulk_size,
+                             HG_BULK_WRITE_ONLY, &local_keys_bulk_handle);
+    if (hret != HG_SUCCESS) {
+        SDSKV_LOG_ERROR(mid, "failed to create bulk handle (hret = %d)", hret);
+        out.ret = SDSKV_MAKE_HG_ERROR(hret);
+        return;
     }
+    DEFER(margo_bulk_free_local_keys, margo_bulk_free(local_keys_bulk_handle));
 
-    /* expose the keys for bulk transfer */
-    hret
-        = margo_bulk_create(mid, num_keys, keys_addr.data(), true_ksizes.data(),
-                            HG_BULK_READ_ONLY, &keys_local_bulk);
+    hg_size_t flags_size = in.num_keys / 8 + (in.num_keys % 8 == 0 ? 0 : 1);
+    local_flags_buffer.resize(flags_size, 0);
+    void* flags_addr = (void*)local_flags_buffer.data();
+    hret = margo_bulk_create(mid, 1, &flags_addr, &flags_size,
+                             HG_BULK_READ_ONLY, &local_flags_bulk_handle);
     if (hret != HG_SUCCESS) {
-        SDSKV_LOG_ERROR(mid, "could not create bulk");
+        SDSKV_LOG_ERROR(mid, "failed to create bulk handle (hret = %d)", hret);
         out.ret = SDSKV_MAKE_HG_ERROR(hret);
         return;
     }
-    DEFER(margo_bulk_free_keys_local, margo_bulk_free(keys_local_bulk));
+    DEFER(margo_bulk_free_local_flags,
+          margo_bulk_free(local_flags_bulk_handle));
 
-    /* expose the values for bulk transfer */
-    hret
-        = margo_bulk_create(mid, num_keys, vals_addr.data(), true_vsizes.data(),
-                            HG_BULK_READ_ONLY, &vals_local_bulk);
+    hret = TIMED_BULK_TRANSFER(mid, HG_BULK_PULL, info->addr,
+                               in.keys_bulk_handle, 0, local_keys_bulk_handle,
+                               0, in.keys_bulk_size);
     if (hret != HG_SUCCESS) {
-        SDSKV_LOG_ERROR(mid, "could not create bulk");
+        SDSKV_LOG_ERROR(mid, "failed to issue bulk transfer (hret = %d)", hret);
         out.ret = SDSKV_MAKE_HG_ERROR(hret);
         return;
     }
-    DEFER(margo_bulk_free_vals_local, margo_bulk_free(vals_local_bulk));
 
-    uint64_t remote_offset = 0;
-    uint64_t local_offset  = 0;
+    uint64_t*  db_ids      = (uint64_t*)local_keys_buffer.data();
+    hg_size_t* key_sizes   = (hg_size_t*)(db_ids + in.num_dbs);
+    uint32_t*  db_indices  = (uint32_t*)(key_sizes + in.num_keys);
+    char*      packed_keys = (char*)(db_indices + in.num_keys);
 
-    /* transfer the keys to the client */
-    for (unsigned i = 0; i < num_keys; i++) {
-        if (true_ksizes[i] > 0) {
-            hret = margo_bulk_transfer(
-                mid, HG_BULK_PUSH, origin_addr, in.keys_bulk_handle,
-                remote_offset, keys_local_bulk, local_offset, true_ksizes[i]);
-            if (hret != HG_SUCCESS) {
-                SDSKV_LOG_ERROR(
-                    mid, "failed to issue bulk transfer (hret = %d)", hret);
-                out.ret = SDSKV_MAKE_HG_ERROR(hret);
-                return;
-            }
-        }
-        remote_offset += remote_ksizes[i];
-        local_offset += true_ksizes[i];
+    hg_size_t remaining = in.keys_bulk_size - header_size;
+    if (!consume_sizes(key_sizes, in.num_keys, &remaining) || remaining != 0) {
+        SDSKV_LOG_ERROR(mid, "inconsistent sizes in exists_packed_multi_db");
+        out.ret = SDSKV_ERR_INVALID_ARG;
+        return;
     }
 
-    remote_offset = 0;
-    local_offset  = 0;
+    std::vector<AbstractDataStore*> dbs;
+    out.ret = find_databases(provider, in.num_dbs, db_ids, in.num_keys,
+                             db_indices, dbs);
+    if (out.ret != SDSKV_SUCCESS) return;
+    ENSURE_ADMITTED_MULTI_DB(dbs);
 
-    /* transfer the values to the client */
-    for (unsigned i = 0; i < num_keys; i++) {
-        if (true_vsizes[i] > 0) {
-            hret = margo_bulk_transfer(
-                mid, HG_BULK_PUSH, origin_addr, in.vals_bulk_handle,
-                remote_offset, vals_local_bulk, local_offset, true_vsizes[i]);
-            if (hret != HG_SUCCESS) {
-                SDSKV_LOG_ERROR(
-                    mid, "failed to issue bulk transfer (hret = %d)", hret);
-                out.ret = SDSKV_MAKE_HG_ERROR(hret);
-                return;
+    for (hg_size_t i = 0; i < in.num_keys; i++) {
+        if (dbs[db_indices[i]]->exists(packed_keys, key_sizes[i]))
+            local_flags_buffer[i / 8] |= (1 << (i % 8));
+        packed_keys += key_sizes[i];
+    }
+
+    hret = TIMED_BULK_TRANSFER(mid, HG_BULK_PUSH, info->addr,
+                               in.flags_bulk_handle, 0, local_flags_bulk_handle,
+                               0, flags_size);
+    if (hret != HG_SUCCESS) {
+        SDSKV_LOG_ERROR(mid, "failed to issue bulk transfer (hret = %d)", hret);
+        out.ret = SDSKV_MAKE_HG_ERROR(hret);
+        return;
+    }
+}
+DEFINE_MARGO_RPC_HANDLER(sdskv_exists_packed_multi_db_ult)
+
+static void sdskv_sync_thread(void* arg)
+{
+    sdskv_provider_t provider = (sdskv_provider_t)arg;
+    /* time of the last sync of each database */
+    std::unordered_map<sdskv_database_id_t, double> last_sync;
+
+    while (!provider->sync_stop) {
+        /* wake up at least every second to notice new databases */
+        double now  = ABT_get_wtime();
+        double next = now + 1.0;
+        /* the databases are synced without holding the provider lock, which
+         * would block migrations and database creation for the whole flush;
+         * like the RPC handlers, this relies on databases not being removed
+         * while they are in use */
+        std::vector<std::pair<sdskv_database_id_t, AbstractDataStore*>> dbs;
+        ABT_rwlock_rdlock(provider->lock);
+        for (auto& p : provider->databases) {
+            if (p.second->get_durability()
+                == AbstractDataStore::DURABILITY_PERIODIC)
+                dbs.push_back(p);
+        }
+        ABT_rwlock_unlock(provider->lock);
+
+        for (auto& p : dbs) {
+            auto db = p.second;
+            auto it = last_sync.find(p.first);
+            if (it == last_sync.end())
+                it = last_sync.insert(std::make_pair(p.first, now)).first;
+            if (now - it->second >= db->get_sync_interval()) {
+                int ret = db->sync();
+                if (ret != SDSKV_SUCCESS)
+                    SDSKV_LOG_ERROR(provider->mid,
+                                    "failed to sync database %lu (ret = %d)",
+                                    p.first, ret);
+                it->second = ABT_get_wtime();
             }
+            next = std::min(next, it->second + db->get_sync_interval());
         }
-        remote_offset += remote_vsizes[i];
-        local_offset += true_vsizes[i];
+
+        /* margo_thread_sleep lets the pool run other ULTs in the meantime;
+         * sleep in short steps so that provider destruction is not delayed */
+        double wait;
+        while (!provider->sync_stop && (wait = next - ABT_get_wtime()) > 0)
+            margo_thread_sleep(provider->mid, std::min(wait, 0.1) * 1000.0);
     }
+}
 
-    out.ret = SDSKV_SUCCESS;
+static int sdskv_start_sync_thread(sdskv_provider_t provider)
+{
+    if (provider->sync_thread != ABT_THREAD_NULL) return SDSKV_SUCCESS;
+    ABT_pool pool = provider->maintenance_pool;
+    if (pool == ABT_POOL_NULL) margo_get_handler_pool(provider->mid, &pool);
+    int ret = ABT_thread_create(pool, sdskv_sync_thread, provider,
+                                ABT_THREAD_ATTR_NULL, &provider->sync_thread);
+    if (ret != ABT_SUCCESS) {
+        SDSKV_LOG_ERROR(provider->mid, "failed to create sync thread");
+        provider->sync_thread = ABT_THREAD_NULL;
+        return SDSKV_MAKE_ABT_ERROR(ret);
+    }
+    return SDSKV_SUCCESS;
 }
-DEFINE_MARGO_RPC_HANDLER(sdskv_list_keyvals_ult)
 
 static void sdskv_migrate_keys_ult(hg_handle_t handle)
 {
     hg_return_t        hret;
-    migrate_keys_in_t  in;
+    DECLARE_TRACED_INPUT(migrate_keys_in_t);
     migrate_keys_out_t out;
     out.ret = SDSKV_SUCCESS;
 
@@ -2356,7 +4883,7 @@ static void sdskv_migrate_keys_ult(hg_handle_t handle)
     DEFER(margo_bulk_free, margo_bulk_free(bulk_handle));
 
     /* issue a bulk pull */
-    hret = margo_bulk_transfer(mid, HG_BULK_PULL, info->addr, in.keys_bulk, 0,
+    hret = TIMED_BULK_TRANSFER(mid, HG_BULK_PULL, info->addr, in.keys_bulk, 0,
                                bulk_handle, 0, in.bulk_size);
     if (hret != HG_SUCCESS) {
         SDSKV_LOG_ERROR(mid, "failed to issue bulk transfer (hret = %d)", hret);
@@ -2429,7 +4956,7 @@ DEFINE_MARGO_RPC_HANDLER(sdskv_migrate_keys_ult)
 static void sdskv_migrate_key_range_ult(hg_handle_t handle)
 {
     hg_return_t            hret;
-    migrate_key_range_in_t in;
+    DECLARE_TRACED_INPUT(migrate_key_range_in_t);
     migrate_keys_out_t     out;
 
     ENSURE_MARGO_DESTROY;
@@ -2459,10 +4986,63 @@ static void sdskv_migrate_key_range_ult(hg_handle_t handle)
 }
 DEFINE_MARGO_RPC_HANDLER(sdskv_migrate_key_range_ult)
 
+/* page of key/value pairs read from a database for migration, stored
+ * packed in two buffers instead of one heap allocation per key and value */
+struct migration_batch {
+    size_t                 capacity;
+    std::vector<char>      keys;
+    std::vector<char>      vals;
+    std::vector<hg_size_t> ksizes;
+    std::vector<hg_size_t> vsizes;
+    std::vector<size_t>    koffsets;
+    std::vector<size_t>    voffsets;
+
+    migration_batch(size_t max_items) : capacity(max_items) {}
+
+    size_t size() const { return ksizes.size(); }
+
+    const char* key(size_t i) const { return keys.data() + koffsets[i]; }
+
+    const char* value(size_t i) const { return vals.data() + voffsets[i]; }
+
+    /* last key of the batch, empty if the batch is empty */
+    ds_bulk_t last_key() const
+    {
+        if (ksizes.empty()) return ds_bulk_t();
+        size_t last = ksizes.size() - 1;
+        return ds_bulk_t(key(last), key(last) + ksizes[last]);
+    }
+
+    void fill(AbstractDataStore* db,
+              const ds_bulk_t& start_key,
+              const ds_bulk_t& prefix)
+    {
+        keys.clear();
+        vals.clear();
+        ksizes.clear();
+        vsizes.clear();
+        koffsets.clear();
+        voffsets.clear();
+        db->visit_keyvals(start_key, prefix,
+                          [this](const void* key, hg_size_t ksize,
+                                 const void* val, hg_size_t vsize) {
+                              koffsets.push_back(keys.size());
+                              voffsets.push_back(vals.size());
+                              keys.insert(keys.end(), (const char*)key,
+                                          (const char*)key + ksize);
+                              vals.insert(vals.end(), (const char*)val,
+                                          (const char*)val + vsize);
+                              ksizes.push_back(ksize);
+                              vsizes.push_back(vsize);
+                              return ksizes.size() < capacity;
+                          });
+    }
+};
+
 static void sdskv_migrate_keys_prefixed_ult(hg_handle_t handle)
 {
     hg_return_t                hret;
-    migrate_keys_prefixed_in_t in;
+    DECLARE_TRACED_INPUT(migrate_keys_prefixed_in_t);
     migrate_keys_out_t         out;
 
     ENSURE_MARGO_DESTROY;
@@ -2507,13 +5087,12 @@ static void sdskv_migrate_keys_prefixed_ult(hg_handle_t handle)
 
     /* iterate over the keys by packets of 64 */
     /* XXX make this number configurable */
-    std::vector<std::pair<ds_bulk_t, ds_bulk_t>> batch;
-    ds_bulk_t                                    start_key;
-    ds_bulk_t                                    prefix(in.key_prefix.data,
-                     in.key_prefix.data + in.key_prefix.size);
+    migration_batch batch(64);
+    ds_bulk_t       start_key;
+    ds_bulk_t prefix(in.key_prefix.data, in.key_prefix.data + in.key_prefix.size);
     do {
         try {
-            batch = db->list_keyvals(start_key, 64, prefix);
+            batch.fill(db, start_key, prefix);
         } catch (int err) {
             out.ret = err;
             return;
@@ -2522,12 +5101,12 @@ static void sdskv_migrate_keys_prefixed_ult(hg_handle_t handle)
         /* issue a put for all the keys in this batch */
         put_in_t  put_in;
         put_out_t put_out;
-        for (auto& kv : batch) {
+        for (size_t i = 0; i < batch.size(); i++) {
             put_in.db_id      = in.target_db_id;
-            put_in.key.data   = (kv_ptr_t)kv.first.data();
-            put_in.key.size   = kv.first.size();
-            put_in.value.data = (kv_ptr_t)kv.second.data();
-            put_in.value.size = kv.second.size();
+            put_in.key.data   = (kv_ptr_t)batch.key(i);
+            put_in.key.size   = batch.ksizes[i];
+            put_in.value.data = (kv_ptr_t)batch.value(i);
+            put_in.value.size = batch.vsizes[i];
             /* forward put call */
             hret = margo_provider_forward(in.target_provider_id, put_handle,
                                           &put_in);
@@ -2545,24 +5124,25 @@ static void sdskv_migrate_keys_prefixed_ult(hg_handle_t handle)
                 out.ret = SDSKV_ERR_MIGRATION;
                 return;
             }
-            margo_free_output(put_handle, &out);
+            margo_free_output(put_handle, &put_out);
             /* remove the key if needed */
-            if (in.flag == SDSKV_REMOVE_ORIGINAL) { db->erase(kv.first); }
+            if (in.flag == SDSKV_REMOVE_ORIGINAL) {
+                db->erase(ds_bulk_t(batch.key(i),
+                                    batch.key(i) + batch.ksizes[i]));
+            }
         }
         /* if original is removed, start_key can stay empty since we
            keep taking the beginning of the container, otherwise
            we need to update start_key. */
-        if (in.flag != SDSKV_REMOVE_ORIGINAL) {
-            start_key = std::move(batch.rbegin()->first);
-        }
-    } while (batch.size() == 64);
+        if (in.flag != SDSKV_REMOVE_ORIGINAL) start_key = batch.last_key();
+    } while (batch.size() == batch.capacity);
 }
 DEFINE_MARGO_RPC_HANDLER(sdskv_migrate_keys_prefixed_ult)
 
 static void sdskv_migrate_all_keys_ult(hg_handle_t handle)
 {
     hg_return_t           hret;
-    migrate_all_keys_in_t in;
+    DECLARE_TRACED_INPUT(migrate_all_keys_in_t);
     migrate_keys_out_t    out;
     out.ret = SDSKV_SUCCESS;
 
@@ -2608,11 +5188,12 @@ static void sdskv_migrate_all_keys_ult(hg_handle_t handle)
 
     /* iterate over the keys by packets of 64 */
     /* XXX make this number configurable */
-    std::vector<std::pair<ds_bulk_t, ds_bulk_t>> batch;
-    ds_bulk_t                                    start_key;
+    migration_batch batch(64);
+    ds_bulk_t       start_key;
+    ds_bulk_t       prefix;
     do {
         try {
-            batch = db->list_keyvals(start_key, 64);
+            batch.fill(db, start_key, prefix);
         } catch (int err) {
             SDSKV_LOG_ERROR(mid, "list_keyvals failed (err = %d)", err);
             out.ret = err;
@@ -2622,12 +5203,12 @@ static void sdskv_migrate_all_keys_ult(hg_handle_t handle)
         /* issue a put for all the keys in this batch */
         put_in_t  put_in;
         put_out_t put_out;
-        for (auto& kv : batch) {
+        for (size_t i = 0; i < batch.size(); i++) {
             put_in.db_id      = in.target_db_id;
-            put_in.key.data   = (kv_ptr_t)kv.first.data();
-            put_in.key.size   = kv.first.size();
-            put_in.value.data = (kv_ptr_t)kv.second.data();
-            put_in.value.size = kv.second.size();
+            put_in.key.data   = (kv_ptr_t)batch.key(i);
+            put_in.key.size   = batch.ksizes[i];
+            put_in.value.data = (kv_ptr_t)batch.value(i);
+            put_in.value.size = batch.vsizes[i];
             /* forward put call */
             hret = margo_provider_forward(in.target_provider_id, put_handle,
                                           &put_in);
@@ -2645,23 +5226,24 @@ static void sdskv_migrate_all_keys_ult(hg_handle_t handle)
                 out.ret = SDSKV_ERR_MIGRATION;
                 return;
             }
-            margo_free_output(put_handle, &out);
+            margo_free_output(put_handle, &put_out);
             /* remove the key if needed */
-            if (in.flag == SDSKV_REMOVE_ORIGINAL) { db->erase(kv.first); }
+            if (in.flag == SDSKV_REMOVE_ORIGINAL) {
+                db->erase(ds_bulk_t(batch.key(i),
+                                    batch.key(i) + batch.ksizes[i]));
+            }
         }
         /* if original is removed, start_key can stay empty since we
            keep taking the beginning of the container, otherwise
            we need to update start_key. */
-        if (in.flag != SDSKV_REMOVE_ORIGINAL) {
-            start_key = std::move(batch.rbegin()->first);
-        }
-    } while (batch.size() == 64);
+        if (in.flag != SDSKV_REMOVE_ORIGINAL) start_key = batch.last_key();
+    } while (batch.size() == batch.capacity);
 }
 DEFINE_MARGO_RPC_HANDLER(sdskv_migrate_all_keys_ult)
 
 static void sdskv_migrate_database_ult(hg_handle_t handle)
 {
-    migrate_database_in_t in;
+    DECLARE_TRACED_INPUT(migrate_database_in_t);
     in.dest_remi_addr = NULL;
     in.dest_root      = NULL;
     migrate_database_out_t out;
@@ -2700,7 +5282,13 @@ static void sdskv_migrate_database_ult(hg_handle_t handle)
     }
 
     /* sync the database */
-    db->sync();
+    ret = db->sync();
+    if (ret != SDSKV_SUCCESS) {
+        SDSKV_LOG_ERROR(mid, "failed to sync database %lu (ret = %d)",
+                        in.source_db_id, ret);
+        out.ret = ret;
+        return;
+    }
 
     /* lookup the address of the destination REMI provider */
     hret = margo_addr_lookup(mid, in.dest_remi_addr, &dest_addr);
@@ -2758,6 +5346,308 @@ static void sdskv_migrate_database_ult(hg_handle_t handle)
 }
 DEFINE_MARGO_RPC_HANDLER(sdskv_migrate_database_ult)
 
+/* Runs a request of a client in the same margo instance as the handler of
+ * the RPC rpc_id would: the request waits for the database's admission
+ * control, as a client with the provider's own address, and is recorded in
+ * the provider's metrics, trace and slow-op log under that RPC. op(db,
+ * metrics) does the work and returns the result. */
+template <typename F>
+static int sdskv_local_request(void*               p,
+                               hg_id_t             rpc_id,
+                               sdskv_database_id_t db_id,
+                               F&&                 op)
+{
+    sdskv_provider_t provider = (sdskv_provider_t)p;
+    int              ret      = SDSKV_SUCCESS;
+    RequestMetrics   metrics(provider->metrics, provider->trace,
+                           provider->slow_ops, rpc_id);
+    DEFER(record_metrics, metrics.finish(ret));
+
+    AbstractDataStore* db = nullptr;
+    ABT_rwlock_rdlock(provider->lock);
+    auto it = provider->databases.find(db_id);
+    if (it != provider->databases.end()) db = it->second;
+    ABT_rwlock_unlock(provider->lock);
+    if (!db) return ret = SDSKV_ERR_UNKNOWN_DB;
+    metrics.set_database(db_id, db->op_stats());
+
+    bool admitted = false;
+    DEFER(admission_release, if (admitted) db->release());
+    if (db->admission_enabled()) {
+        double t = ABT_get_wtime();
+        ret      = db->admit(provider->local_client_name);
+        metrics.add(OpStats::PHASE_QUEUE, t);
+        if (ret != SDSKV_SUCCESS) return ret;
+        admitted = true;
+    }
+    return ret = op(db, metrics);
+}
+
+static int sdskv_local_put(void*               p,
+                           sdskv_database_id_t db_id,
+                           const void*         key,
+                           hg_size_t           ksize,
+                           const void*         value,
+                           hg_size_t           vsize)
+{
+    sdskv_provider_t provider = (sdskv_provider_t)p;
+    return sdskv_local_request(
+        p, provider->sdskv_put_id, db_id,
+        [&](AbstractDataStore* db, RequestMetrics& metrics) {
+            metrics.set_key(key, ksize);
+            metrics.set_num_keys(1);
+            metrics.add_bytes(ksize + vsize);
+            db->record_access(key, ksize, true);
+            return db->grouped_put(key, ksize, value, vsize);
+        });
+}
+
+static int sdskv_local_put_multi(void*               p,
+                                 sdskv_database_id_t db_id,
+                                 size_t              num,
+                                 const void* const*  keys,
+                                 const hg_size_t*    ksizes,
+                                 const void* const*  values,
+                                 const hg_size_t*    vsizes)
+{
+    sdskv_provider_t provider = (sdskv_provider_t)p;
+    return sdskv_local_request(
+        p, provider->sdskv_put_multi_id, db_id,
+        [&](AbstractDataStore* db, RequestMetrics& metrics) {
+            if (num) metrics.set_key(keys[0], ksizes[0]);
+            metrics.set_num_keys(num);
+            db->record_accesses(num, keys, ksizes, true);
+            return db->put_multi(num, keys, ksizes, values, vsizes);
+        });
+}
+
+static int sdskv_local_put_packed(void*               p,
+                                  sdskv_database_id_t db_id,
+                                  size_t              num,
+                                  const void*         packed_keys,
+                                  const hg_size_t*    ksizes,
+                                  const void*         packed_values,
+                                  const hg_size_t*    vsizes)
+{
+    sdskv_provider_t provider = (sdskv_provider_t)p;
+    return sdskv_local_request(
+        p, provider->sdskv_put_packed_id, db_id,
+        [&](AbstractDataStore* db, RequestMetrics& metrics) {
+            const char* keys = (const char*)packed_keys;
+            if (num) metrics.set_key(keys, ksizes[0]);
+            metrics.set_num_keys(num);
+            db->record_packed_accesses(num, keys, ksizes, true);
+            return db->put_packed(num, keys, ksizes,
+                                  (const char*)packed_values, vsizes);
+        });
+}
+
+static int sdskv_local_get(void*               p,
+                           sdskv_database_id_t db_id,
+                           const void*         key,
+                           hg_size_t           ksize,
+                           void*               value,
+                           hg_size_t*          vsize)
+{
+    sdskv_provider_t provider = (sdskv_provider_t)p;
+    return sdskv_local_request(
+        p, provider->sdskv_get_id, db_id,
+        [&](AbstractDataStore* db, RequestMetrics& metrics) {
+            metrics.set_key(key, ksize);
+            metrics.set_num_keys(1);
+            ds_bulk_t kdata((const char*)key, (const char*)key + ksize);
+            ds_bulk_t vdata;
+            db->record_access(key, ksize, false);
+            if (!db->get(kdata, vdata)) return (int)SDSKV_ERR_UNKNOWN_KEY;
+            metrics.add_bytes(ksize + vdata.size());
+            if (vdata.size() > *vsize) {
+                *vsize = vdata.size();
+                return (int)SDSKV_ERR_SIZE;
+            }
+            memcpy(value, vdata.data(), vdata.size());
+            *vsize = vdata.size();
+            return (int)SDSKV_SUCCESS;
+        });
+}
+
+static int sdskv_local_get_multi(void*               p,
+                                 sdskv_database_id_t db_id,
+                                 size_t              num,
+                                 const void* const*  keys,
+                                 const hg_size_t*    ksizes,
+                                 void**              values,
+                                 hg_size_t*          vsizes)
+{
+    sdskv_provider_t provider = (sdskv_provider_t)p;
+    return sdskv_local_request(
+        p, provider->sdskv_get_multi_id, db_id,
+        [&](AbstractDataStore* db, RequestMetrics& metrics) {
+            if (num) metrics.set_key(keys[0], ksizes[0]);
+            metrics.set_num_keys(num);
+            /* as in sdskv_get_multi_ult, missing keys and values that
+             * don't fit in the provided buffer get a size of 0 */
+            for (size_t i = 0; i < num; i++) {
+                ds_bulk_t kdata((const char*)keys[i],
+                                (const char*)keys[i] + ksizes[i]);
+                ds_bulk_t vdata;
+                db->record_access(keys[i], ksizes[i], false);
+                if (db->get(kdata, vdata) && vdata.size() <= vsizes[i]) {
+                    memcpy(values[i], vdata.data(), vdata.size());
+                    vsizes[i] = vdata.size();
+                } else {
+                    vsizes[i] = 0;
+                }
+            }
+            return (int)SDSKV_SUCCESS;
+        });
+}
+
+static int sdskv_local_get_packed(void*               p,
+                                  sdskv_database_id_t db_id,
+                                  size_t*             num,
+                                  const void*         packed_keys,
+                                  const hg_size_t*    ksizes,
+                                  hg_size_t           vbufsize,
+                                  void*               packed_vals,
+                                  hg_size_t*          vsizes)
+{
+    sdskv_provider_t provider = (sdskv_provider_t)p;
+    size_t           num_keys = *num;
+    *num                      = 0;
+    return sdskv_local_request(
+        p, provider->sdskv_get_packed_id, db_id,
+        [&](AbstractDataStore* db, RequestMetrics& metrics) {
+            const char* key = (const char*)packed_keys;
+            char*       val = (char*)packed_vals;
+            if (num_keys) metrics.set_key(key, ksizes[0]);
+            metrics.set_num_keys(num_keys);
+            /* as in sdskv_get_packed_ult: missing keys get a size of -1,
+             * and once a value doesn't fit, the remaining ones get 0 */
+            int       ret       = SDSKV_SUCCESS;
+            hg_size_t available = vbufsize;
+            for (size_t i = 0; i < num_keys; i++) {
+                ds_bulk_t kdata(key, key + ksizes[i]);
+                ds_bulk_t vdata;
+                key += ksizes[i];
+                if (available == 0) {
+                    vsizes[i] = 0;
+                    ret       = SDSKV_ERR_SIZE;
+                    continue;
+                }
+                db->record_access(kdata.data(), kdata.size(), false);
+                if (!db->get(kdata, vdata)) {
+                    vsizes[i] = (hg_size_t)(-1);
+                } else if (vdata.size() > available) {
+                    available = 0;
+                    vsizes[i] = 0;
+                    ret       = SDSKV_ERR_SIZE;
+                } else {
+                    *num += 1;
+                    vsizes[i] = vdata.size();
+                    memcpy(val, vdata.data(), vdata.size());
+                    val += vdata.size();
+                    available -= vdata.size();
+                }
+            }
+            return ret;
+        });
+}
+
+static int sdskv_local_length(void*               p,
+                              sdskv_database_id_t db_id,
+                              const void*         key,
+                              hg_size_t           ksize,
+                              hg_size_t*          vsize)
+{
+    sdskv_provider_t provider = (sdskv_provider_t)p;
+    return sdskv_local_request(
+        p, provider->sdskv_length_id, db_id,
+        [&](AbstractDataStore* db, RequestMetrics& metrics) {
+            metrics.set_key(key, ksize);
+            metrics.set_num_keys(1);
+            size_t size = 0;
+            if (!db->length(key, ksize, &size))
+                return (int)SDSKV_ERR_UNKNOWN_KEY;
+            *vsize = size;
+            return (int)SDSKV_SUCCESS;
+        });
+}
+
+static int sdskv_local_exists(void*               p,
+                              sdskv_database_id_t db_id,
+                              const void*         key,
+                              hg_size_t           ksize,
+                              int*                flag)
+{
+    sdskv_provider_t provider = (sdskv_provider_t)p;
+    return sdskv_local_request(
+        p, provider->sdskv_exists_id, db_id,
+        [&](AbstractDataStore* db, RequestMetrics& metrics) {
+            metrics.set_key(key, ksize);
+            metrics.set_num_keys(1);
+            *flag = db->exists(key, ksize) ? 1 : 0;
+            return (int)SDSKV_SUCCESS;
+        });
+}
+
+static int sdskv_local_erase(void*               p,
+                             sdskv_database_id_t db_id,
+                             const void*         key,
+                             hg_size_t           ksize)
+{
+    sdskv_provider_t provider = (sdskv_provider_t)p;
+    return sdskv_local_request(
+        p, provider->sdskv_erase_id, db_id,
+        [&](AbstractDataStore* db, RequestMetrics& metrics) {
+            metrics.set_key(key, ksize);
+            metrics.set_num_keys(1);
+            return db->grouped_erase(key, ksize);
+        });
+}
+
+static int sdskv_local_erase_multi(void*               p,
+                                   sdskv_database_id_t db_id,
+                                   size_t              num,
+                                   const void* const*  keys,
+                                   const hg_size_t*    ksizes,
+                                   int*                flags)
+{
+    sdskv_provider_t provider = (sdskv_provider_t)p;
+    return sdskv_local_request(
+        p, provider->sdskv_erase_multi_id, db_id,
+        [&](AbstractDataStore* db, RequestMetrics& metrics) {
+            if (num) metrics.set_key(keys[0], ksizes[0]);
+            metrics.set_num_keys(num);
+            std::vector<uint8_t> erased(num, 0);
+            int ret = db->erase_multi(num, keys, ksizes, erased.data());
+            if (flags)
+                for (size_t i = 0; i < num; i++) flags[i] = erased[i];
+            return ret;
+        });
+}
+
+static void sdskv_init_local_ops(sdskv_provider_t provider)
+{
+    provider->local_ops.provider    = (void*)provider;
+    provider->local_ops.put         = sdskv_local_put;
+    provider->local_ops.put_multi   = sdskv_local_put_multi;
+    provider->local_ops.put_packed  = sdskv_local_put_packed;
+    provider->local_ops.get         = sdskv_local_get;
+    provider->local_ops.get_multi   = sdskv_local_get_multi;
+    provider->local_ops.get_packed  = sdskv_local_get_packed;
+    provider->local_ops.length      = sdskv_local_length;
+    provider->local_ops.exists      = sdskv_local_exists;
+    provider->local_ops.erase       = sdskv_local_erase;
+    provider->local_ops.erase_multi = sdskv_local_erase_multi;
+
+    /* local clients are admitted under the provider's own address */
+    hg_addr_t self_addr = HG_ADDR_NULL;
+    if (margo_addr_self(provider->mid, &self_addr) == HG_SUCCESS) {
+        provider->local_client_name = addr_to_string(provider->mid, self_addr);
+        margo_addr_free(provider->mid, self_addr);
+    }
+}
+
 static void sdskv_server_finalize_cb(void* data)
 {
     sdskv_provider_t provider = (sdskv_provider_t)data;
@@ -2795,6 +5685,12 @@ static void sdskv_server_finalize_cb(void* data)
     free(pid_pl); free(pid_pne);
 #endif
 
+    if (provider->sync_thread != ABT_THREAD_NULL) {
+        provider->sync_stop = true;
+        ABT_thread_join(provider->sync_thread);
+        ABT_thread_free(&provider->sync_thread);
+    }
+
     sdskv_provider_remove_all_databases(provider);
 
     margo_deregister(mid, provider->sdskv_open_id);
@@ -2808,17 +5704,79 @@ static void sdskv_server_finalize_cb(void* data)
     margo_deregister(mid, provider->sdskv_exists_id);
     margo_deregister(mid, provider->sdskv_erase_id);
     margo_deregister(mid, provider->sdskv_erase_multi_id);
+    margo_deregister(mid, provider->sdskv_erase_range_id);
+    margo_deregister(mid, provider->sdskv_erase_prefix_id);
+    margo_deregister(mid, provider->sdskv_cas_id);
+    margo_deregister(mid, provider->sdskv_cas_packed_id);
+    margo_deregister(mid, provider->sdskv_fetch_add_id);
+    margo_deregister(mid, provider->sdskv_fetch_add_packed_id);
+    margo_deregister(mid, provider->sdskv_append_id);
+    margo_deregister(mid, provider->sdskv_append_packed_id);
     margo_deregister(mid, provider->sdskv_length_id);
     margo_deregister(mid, provider->sdskv_length_multi_id);
     margo_deregister(mid, provider->sdskv_bulk_get_id);
     margo_deregister(mid, provider->sdskv_list_keys_id);
     margo_deregister(mid, provider->sdskv_list_keyvals_id);
+    margo_deregister(mid, provider->sdskv_sync_id);
+    margo_deregister(mid, provider->sdskv_batch_id);
+    margo_deregister(mid, provider->sdskv_put_packed_multi_db_id);
+    margo_deregister(mid, provider->sdskv_get_packed_multi_db_id);
+    margo_deregister(mid, provider->sdskv_exists_packed_multi_db_id);
     margo_deregister(mid, provider->sdskv_migrate_keys_id);
     margo_deregister(mid, provider->sdskv_migrate_key_range_id);
     margo_deregister(mid, provider->sdskv_migrate_keys_prefixed_id);
     margo_deregister(mid, provider->sdskv_migrate_all_keys_id);
     margo_deregister(mid, provider->sdskv_migrate_database_id);
-
+    margo_deregister(mid, provider->sdskv_local_id);
+    margo_deregister(mid, provider->sdskv_get_stats_id);
+    margo_deregister(mid, provider->sdskv_get_trace_id);
+    margo_deregister(mid, provider->sdskv_get_slow_ops_id);
+    margo_deregister(mid, provider->sdskv_open_traced_id);
+    margo_deregister(mid, provider->sdskv_count_databases_traced_id);
+    margo_deregister(mid, provider->sdskv_list_databases_traced_id);
+    margo_deregister(mid, provider->sdskv_put_traced_id);
+    margo_deregister(mid, provider->sdskv_put_multi_traced_id);
+    margo_deregister(mid, provider->sdskv_put_packed_traced_id);
+    margo_deregister(mid, provider->sdskv_bulk_put_traced_id);
+    margo_deregister(mid, provider->sdskv_get_traced_id);
+    margo_deregister(mid, provider->sdskv_get_multi_traced_id);
+    margo_deregister(mid, provider->sdskv_get_packed_traced_id);
+    margo_deregister(mid, provider->sdskv_length_traced_id);
+    margo_deregister(mid, provider->sdskv_length_multi_traced_id);
+    margo_deregister(mid, provider->sdskv_length_packed_traced_id);
+    margo_deregister(mid, provider->sdskv_exists_traced_id);
+    margo_deregister(mid, provider->sdskv_exists_multi_traced_id);
+    margo_deregister(mid, provider->sdskv_bulk_get_traced_id);
+    margo_deregister(mid, provider->sdskv_list_keys_traced_id);
+    margo_deregister(mid, provider->sdskv_list_keyvals_traced_id);
+    margo_deregister(mid, provider->sdskv_sync_traced_id);
+    margo_deregister(mid, provider->sdskv_batch_traced_id);
+    margo_deregister(mid, provider->sdskv_put_packed_multi_db_traced_id);
+    margo_deregister(mid, provider->sdskv_get_packed_multi_db_traced_id);
+    margo_deregister(mid, provider->sdskv_exists_packed_multi_db_traced_id);
+    margo_deregister(mid, provider->sdskv_erase_traced_id);
+    margo_deregister(mid, provider->sdskv_erase_multi_traced_id);
+    margo_deregister(mid, provider->sdskv_erase_range_traced_id);
+    margo_deregister(mid, provider->sdskv_erase_prefix_traced_id);
+    margo_deregister(mid, provider->sdskv_cas_traced_id);
+    margo_deregister(mid, provider->sdskv_cas_packed_traced_id);
+    margo_deregister(mid, provider->sdskv_fetch_add_traced_id);
+    margo_deregister(mid, provider->sdskv_fetch_add_packed_traced_id);
+    margo_deregister(mid, provider->sdskv_append_traced_id);
+    margo_deregister(mid, provider->sdskv_append_packed_traced_id);
+    margo_deregister(mid, provider->sdskv_migrate_keys_traced_id);
+    margo_deregister(mid, provider->sdskv_migrate_key_range_traced_id);
+    margo_deregister(mid, provider->sdskv_migrate_keys_prefixed_traced_id);
+    margo_deregister(mid, provider->sdskv_migrate_all_keys_traced_id);
+    margo_deregister(mid, provider->sdskv_migrate_database_traced_id);
+    margo_deregister(mid, provider->sdskv_get_stats_traced_id);
+    margo_deregister(mid, provider->sdskv_get_trace_traced_id);
+    margo_deregister(mid, provider->sdskv_get_slow_ops_traced_id);
+
+    sdskv_trace_free(provider->trace);
+    delete provider->slow_ops;
+    clear_client_names(provider);
+    ABT_rwlock_free(&(provider->client_names_lock));
     ABT_rwlock_free(&(provider->lock));
 
     delete provider;
@@ -2880,7 +5838,8 @@ static int sdskv_pre_migration_callback(remi_fileset_t fileset, void* uargs)
     // (5) fill up a config structure and call the user-defined pre-migration
     // callback
     if (provider->pre_migration_callback) {
-        sdskv_config_t config;
+        sdskv_config_t config = SDSKV_CONFIG_DEFAULT;
+
         config.db_name = db_name.c_str();
         config.db_path = db_root.data();
         if (db_type == "berkeleydb")
@@ -2919,7 +5878,8 @@ static int sdskv_post_migration_callback(remi_fileset_t fileset, void* uargs)
     db_root.resize(root_size + 1);
     remi_fileset_get_root(fileset, db_root.data(), &root_size);
 
-    sdskv_config_t config;
+    sdskv_config_t config = SDSKV_CONFIG_DEFAULT;
+
     config.db_name = db_name.c_str();
     config.db_path = db_root.data();
     if (db_type == "berkeleydb")
@@ -3047,6 +6007,77 @@ static int check_provider_config(sdskv_provider_t provider)
                     "database no_overwrite field should be a boolean");
                 return SDSKV_ERR_CONFIG;
             }
+            // check group_commit
+            if (!it->isMember("group_commit")) {
+                (*it)["group_commit"] = false;
+            }
+            if (!(*it)["group_commit"].isBool()) {
+                SDSKV_LOG_ERROR(
+                    provider->mid,
+                    "database group_commit field should be a boolean");
+                return SDSKV_ERR_CONFIG;
+            }
+            // check durability
+            if (!it->isMember("durability")) { (*it)["durability"] = "none"; }
+            if (!(*it)["durability"].isString()
+                || !parse_durability((*it)["durability"].asString(),
+                                     nullptr)) {
+                SDSKV_LOG_ERROR(provider->mid,
+                                "database durability field should be one of "
+                                "\"none\", \"periodic\" or \"sync\"");
+                return SDSKV_ERR_CONFIG;
+            }
+            if (!it->isMember("sync_interval_ms")) {
+                (*it)["sync_interval_ms"] = 1000;
+            }
+            if (!(*it)["sync_interval_ms"].isUInt()
+                || (*it)["sync_interval_ms"].asUInt() == 0) {
+                SDSKV_LOG_ERROR(provider->mid,
+                                "database sync_interval_ms field should be a "
+                                "positive integer");
+                return SDSKV_ERR_CONFIG;
+            }
+            // check admission control
+            if (!it->isMember("max_inflight")) { (*it)["max_inflight"] = 0; }
+            if (!it->isMember("max_queued_per_client")) {
+                (*it)["max_queued_per_client"] = 0;
+            }
+            if (!(*it)["max_inflight"].isUInt()
+                || !(*it)["max_queued_per_client"].isUInt()) {
+                SDSKV_LOG_ERROR(provider->mid,
+                                "database max_inflight and "
+                                "max_queued_per_client fields should be "
+                                "non-negative integers");
+                return SDSKV_ERR_CONFIG;
+            }
+            if (!it->isMember("client_weights")) {
+                (*it)["client_weights"] = Json::Value(Json::objectValue);
+            }
+            if (!(*it)["client_weights"].isObject()) {
+                SDSKV_LOG_ERROR(provider->mid,
+                                "database client_weights field should be an "
+                                "object");
+                return SDSKV_ERR_CONFIG;
+            }
+            // check hot-key tracking
+            if (!it->isMember("hot_keys")) { (*it)["hot_keys"] = 0; }
+            if (!it->isMember("hot_key_prefix_length")) {
+                (*it)["hot_key_prefix_length"] = 0;
+            }
+            if (!it->isMember("hot_key_sample_every")) {
+                (*it)["hot_key_sample_every"] = 1;
+            }
+            if (!(*it)["hot_keys"].isUInt()
+                || !(*it)["hot_key_prefix_length"].isUInt()
+                || !(*it)["hot_key_sample_every"].isUInt()
+                || (*it)["hot_key_sample_every"].asUInt() == 0) {
+                SDSKV_LOG_ERROR(provider->mid,
+                                "database hot_keys, hot_key_prefix_length and "
+                                "hot_key_sample_every fields should be "
+                                "non-negative integers (positive for "
+                                "hot_key_sample_every)");
+                return SDSKV_ERR_CONFIG;
+            }
             // check comparator
             if (!it->isMember("comparator")) { (*it)["comparator"] = ""; }
             if (!(*it)["comparator"].isString()) {
@@ -3074,18 +6105,47 @@ static int populate_provider_from_config(sdskv_provider_t provider)
         if (ret != SDSKV_SUCCESS) { return ret; }
     }
     sdskv_database_id_t id;
-    sdskv_config_t      db_cfg;
     auto&               databases = provider->json_cfg["databases"];
     for (auto it = databases.begin(); it != databases.end(); it++) {
-        std::string name         = (*it)["name"].asString();
-        std::string type         = (*it)["type"].asString();
-        std::string path         = (*it)["path"].asString();
-        std::string comp         = (*it)["comparator"].asString();
-        bool        no_overwrite = (*it)["no_overwrite"].asBool();
+        auto&          db     = *it;
+        sdskv_config_t db_cfg = SDSKV_CONFIG_DEFAULT;
+
+        std::string name         = db["name"].asString();
+        std::string type         = db["type"].asString();
+        std::string path         = db["path"].asString();
+        std::string comp         = db["comparator"].asString();
+        bool        no_overwrite = db["no_overwrite"].asBool();
         db_cfg.db_name           = name.c_str();
         db_cfg.db_path           = path.c_str();
         db_cfg.db_comp_fn_name   = comp.c_str();
         db_cfg.db_no_overwrite   = no_overwrite;
+        db_cfg.db_group_commit   = db["group_commit"].asBool();
+
+        AbstractDataStore::durability_t durability;
+        parse_durability(db["durability"].asString(), &durability);
+        if (durability == AbstractDataStore::DURABILITY_PERIODIC)
+            db_cfg.db_durability = SDSKV_DURABILITY_PERIODIC;
+        else if (durability == AbstractDataStore::DURABILITY_SYNC)
+            db_cfg.db_durability = SDSKV_DURABILITY_SYNC;
+        db_cfg.db_sync_interval_ms      = db["sync_interval_ms"].asUInt();
+        db_cfg.db_max_inflight          = db["max_inflight"].asUInt();
+        db_cfg.db_max_queued_per_client = db["max_queued_per_client"].asUInt();
+        db_cfg.db_hot_keys              = db["hot_keys"].asUInt();
+        db_cfg.db_hot_key_prefix_length = db["hot_key_prefix_length"].asUInt();
+        db_cfg.db_hot_key_sample_every  = db["hot_key_sample_every"].asUInt();
+
+        auto&                    weights = db["client_weights"];
+        std::vector<std::string> clients = weights.getMemberNames();
+        std::vector<const char*> client_addresses;
+        std::vector<double>      client_weights;
+        for (const auto& client : clients) {
+            client_addresses.push_back(client.c_str());
+            client_weights.push_back(weights[client].asDouble());
+        }
+        db_cfg.db_num_client_weights = clients.size();
+        db_cfg.db_client_addresses   = client_addresses.data();
+        db_cfg.db_client_weights     = client_weights.data();
+
         if (type == "map")
             db_cfg.db_type = KVDB_MAP;
         else if (type == "null")
@@ -3103,7 +6163,8 @@ static int populate_provider_from_config(sdskv_provider_t provider)
             break;
         }
         ret = sdskv_provider_attach_database(provider, &db_cfg, &id);
-        if (ret == SDSKV_SUCCESS) { (*it)["__database_id__"] = id; }
+        if (ret != SDSKV_SUCCESS) break;
+        db["__database_id__"] = id;
     }
     if (ret != SDSKV_SUCCESS) sdskv_provider_remove_all_databases(provider);
     return ret;
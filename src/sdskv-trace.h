@@ -0,0 +1,205 @@
+#ifndef SDSKV_TRACE_H
+#define SDSKV_TRACE_H
+
+#include <abt.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/* Request tracing shared by the client and the server. Each request
+ * carries a 64-bit id chosen by the client; a request is sampled if a hash
+ * of its id falls below the configured rate, so that a client and a
+ * provider with the same rate trace the same requests. Spans of sampled
+ * requests go into a fixed-size ring buffer (the oldest are overwritten)
+ * that writers fill without locks, and that can be exported in the Chrome
+ * trace event format, loadable in chrome://tracing or Perfetto. */
+
+typedef struct sdskv_trace_event_t {
+    uint64_t    request_id;
+    const char* name;  /* must be a static string */
+    double      start; /* ABT_get_wtime() */
+    double      end;
+    int         xstream;
+    int         has_db; /* db_id is only exported if set */
+    uint64_t    db_id;
+    uint64_t    size; /* bytes transferred, if any */
+} sdskv_trace_event_t;
+
+typedef struct sdskv_trace_slot_t {
+    uint64_t            seq; /* 0: empty, odd: being written */
+    sdskv_trace_event_t event;
+} sdskv_trace_slot_t;
+
+typedef struct sdskv_trace_t {
+    uint64_t            threshold; /* requests whose hash is <= are sampled */
+    uint64_t            mask;
+    uint64_t            head;
+    uint64_t            next_id;
+    double              clock_offset; /* wall-clock time - ABT_get_wtime() */
+    int                 tid_base;
+    sdskv_trace_slot_t* slots;
+} sdskv_trace_t;
+
+static inline uint64_t sdskv_trace_hash(uint64_t x)
+{
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+/* Creates a trace buffer holding at least capacity events. tid_base is
+ * added to the execution stream rank to form the thread id of the events,
+ * so that a client and a provider in the same process use different
+ * tracks. Returns NULL if sample_rate is not positive. */
+static inline sdskv_trace_t*
+sdskv_trace_create(double sample_rate, size_t capacity, int tid_base)
+{
+    if (sample_rate <= 0.0 || capacity == 0) return NULL;
+    sdskv_trace_t* trace = (sdskv_trace_t*)calloc(1, sizeof(*trace));
+    if (!trace) return NULL;
+    size_t n = 1;
+    while (n < capacity) n <<= 1;
+    trace->slots = (sdskv_trace_slot_t*)calloc(n, sizeof(sdskv_trace_slot_t));
+    if (!trace->slots) {
+        free(trace);
+        return NULL;
+    }
+    trace->mask      = n - 1;
+    trace->threshold = sample_rate >= 1.0
+                         ? UINT64_MAX
+                         : (uint64_t)(sample_rate * 18446744073709551616.0);
+    /* server-generated ids have their top bit set, see sdskv_trace_new_id */
+    trace->next_id   = (1ULL << 63) | ((uint64_t)getpid() << 32);
+    trace->tid_base  = tid_base;
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    trace->clock_offset = tv.tv_sec + tv.tv_usec * 1e-6 - ABT_get_wtime();
+    return trace;
+}
+
+static inline void sdskv_trace_free(sdskv_trace_t* trace)
+{
+    if (!trace) return;
+    free(trace->slots);
+    free(trace);
+}
+
+/* id for a request that did not come with one */
+static inline uint64_t sdskv_trace_new_id(sdskv_trace_t* trace)
+{
+    return __atomic_fetch_add(&trace->next_id, 1, __ATOMIC_RELAXED);
+}
+
+static inline int sdskv_trace_sampled(const sdskv_trace_t* trace,
+                                      uint64_t             request_id)
+{
+    return trace && sdskv_trace_hash(request_id) <= trace->threshold;
+}
+
+static inline void sdskv_trace_record(sdskv_trace_t*             trace,
+                                      const sdskv_trace_event_t* event)
+{
+    uint64_t pos = __atomic_fetch_add(&trace->head, 1, __ATOMIC_RELAXED);
+    sdskv_trace_slot_t* slot  = &trace->slots[pos & trace->mask];
+    uint64_t            claim = 2 * pos + 1;
+    /* seqlock: odd while the event is written, so readers skip it. The
+     * slot is claimed with a CAS since a writer that wrapped around the
+     * buffer may target it at the same time: if the slot is being written
+     * or already holds a more recent event, this one is dropped */
+    uint64_t seq = __atomic_load_n(&slot->seq, __ATOMIC_RELAXED);
+    do {
+        if ((seq & 1) || seq > claim) return;
+    } while (!__atomic_compare_exchange_n(&slot->seq, &seq, claim, 1,
+                                          __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    slot->event = *event;
+    if (slot->event.xstream < 0) {
+        int rank = 0;
+        ABT_self_get_xstream_rank(&rank);
+        slot->event.xstream = rank;
+    }
+    __atomic_store_n(&slot->seq, 2 * pos + 2, __ATOMIC_RELEASE);
+}
+
+typedef struct sdskv_trace_string_t {
+    char*  data;
+    size_t size;
+    size_t capacity;
+} sdskv_trace_string_t;
+
+static inline void
+sdskv_trace_append(sdskv_trace_string_t* str, const char* fmt, ...)
+{
+    va_list args;
+    while (str->data) {
+        va_start(args, fmt);
+        int n = vsnprintf(str->data + str->size, str->capacity - str->size,
+                          fmt, args);
+        va_end(args);
+        if (n < 0) return;
+        if (str->size + n < str->capacity) {
+            str->size += n;
+            return;
+        }
+        str->capacity = 2 * (str->size + n + 1);
+        char* data    = (char*)realloc(str->data, str->capacity);
+        if (!data) free(str->data);
+        str->data = data;
+    }
+}
+
+/* Returns the events currently in the buffer as a Chrome trace (JSON
+ * object format), or NULL on allocation failure. Events being written
+ * concurrently are skipped. The caller must free the string. */
+static inline char* sdskv_trace_to_json(sdskv_trace_t* trace,
+                                        const char*    process_name)
+{
+    sdskv_trace_string_t str = {(char*)malloc(4096), 0, 4096};
+    int                  pid = (int)getpid();
+    sdskv_trace_append(&str,
+                       "{\"displayTimeUnit\":\"ns\",\"traceEvents\":["
+                       "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,"
+                       "\"args\":{\"name\":\"%s (%d)\"}}",
+                       pid, process_name, pid);
+    uint64_t n = trace ? trace->mask + 1 : 0;
+    for (uint64_t i = 0; i < n; i++) {
+        sdskv_trace_slot_t* slot = &trace->slots[i];
+        uint64_t seq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+        if (seq == 0 || (seq & 1)) continue;
+        sdskv_trace_event_t e = slot->event;
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&slot->seq, __ATOMIC_RELAXED) != seq) continue;
+        sdskv_trace_append(
+            &str,
+            ",{\"name\":\"%s\",\"cat\":\"sdskv\",\"ph\":\"X\","
+            "\"ts\":%.3f,\"dur\":%.3f,\"pid\":%d,\"tid\":%d,"
+            "\"args\":{\"request_id\":\"%016llx\",",
+            e.name, (e.start + trace->clock_offset) * 1e6,
+            (e.end - e.start) * 1e6, pid, trace->tid_base + e.xstream,
+            (unsigned long long)e.request_id);
+        if (e.has_db)
+            sdskv_trace_append(&str, "\"db_id\":%llu,",
+                               (unsigned long long)e.db_id);
+        sdskv_trace_append(&str, "\"size\":%llu}}",
+                           (unsigned long long)e.size);
+    }
+    sdskv_trace_append(&str, "]}");
+    return str.data;
+}
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif
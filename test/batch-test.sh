@@ -0,0 +1,9 @@
+#!/bin/bash -x
+
+if [ -z $srcdir ]; then
+    echo srcdir variable not set.
+    exit 1
+fi
+source $srcdir/test/test-util.sh
+
+test_run_with_servers 1 test/sdskv-batch-test 10
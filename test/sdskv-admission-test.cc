@@ -0,0 +1,130 @@
+/*
+ * (C) 2015 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include <unistd.h>
+#include <margo.h>
+#include <string>
+#include <vector>
+
+#include "sdskv-test-util.h"
+
+/* Runs a provider whose database admits one request at a time, with at
+ * most two waiting requests per client, and sends it concurrent RPCs:
+ * each must either succeed or be rejected with SDSKV_ERR_BUSY, and the
+ * data of the successful ones must be there. Also checks that invalid
+ * admission control settings are rejected. */
+
+static const char* provider_config
+    = "{ \"databases\" : [ {"
+      "    \"name\" : \"admission-test-db\", \"type\" : \"map\","
+      "    \"max_inflight\" : 1, \"max_queued_per_client\" : 2,"
+      "    \"client_weights\" : { \"some-other-client\" : 2.5 } } ] }";
+
+static const char* bad_configs[]
+    = {"{ \"databases\" : [ { \"name\" : \"a\", \"type\" : \"map\","
+       "  \"max_inflight\" : -1 } ] }",
+       "{ \"databases\" : [ { \"name\" : \"a\", \"type\" : \"map\","
+       "  \"client_weights\" : { \"x\" : 0 } } ] }",
+       "{ \"databases\" : [ { \"name\" : \"a\", \"type\" : \"map\","
+       "  \"client_weights\" : [ 1 ] } ] }"};
+
+#define NUM_WRITERS 16
+#define KEYS_PER_WRITER 32
+
+struct writer_args {
+    sdskv_provider_handle_t kvph;
+    sdskv_database_id_t     db_id;
+    unsigned                rank;
+    int                     ret;
+};
+
+static void writer(void* a)
+{
+    writer_args*           args = (writer_args*)a;
+    std::string            keys, values;
+    std::vector<hg_size_t> ksizes, vsizes;
+    for (unsigned i = 0; i < KEYS_PER_WRITER; i++) {
+        std::string k = "key-" + std::to_string(args->rank) + "-"
+                      + std::to_string(i);
+        keys += k;
+        values += k;
+        ksizes.push_back(k.size());
+        vsizes.push_back(k.size());
+    }
+    args->ret = sdskv_put_packed(args->kvph, args->db_id, KEYS_PER_WRITER,
+                                 keys.data(), ksizes.data(), values.data(),
+                                 vsizes.data());
+}
+
+static int run_test(margo_instance_id       mid,
+                    sdskv_provider_handle_t kvph,
+                    sdskv_database_id_t     db_id)
+{
+    ABT_pool pool;
+    margo_get_handler_pool(mid, &pool);
+
+    std::vector<writer_args> args(NUM_WRITERS);
+    std::vector<ABT_thread>  threads(NUM_WRITERS);
+    for (unsigned i = 0; i < NUM_WRITERS; i++) {
+        args[i] = {kvph, db_id, i, SDSKV_SUCCESS};
+        ABT_thread_create(pool, writer, &args[i], ABT_THREAD_ATTR_NULL,
+                          &threads[i]);
+    }
+    unsigned num_busy = 0;
+    for (unsigned i = 0; i < NUM_WRITERS; i++) {
+        ABT_thread_join(threads[i]);
+        ABT_thread_free(&threads[i]);
+        if (args[i].ret == SDSKV_ERR_BUSY) {
+            num_busy += 1;
+            continue;
+        }
+        if (args[i].ret != SDSKV_SUCCESS) {
+            fprintf(stderr, "Error: sdskv_put_packed() returned %d\n",
+                    args[i].ret);
+            return -1;
+        }
+        /* the writes of admitted requests must all be there */
+        for (unsigned j = 0; j < KEYS_PER_WRITER; j++) {
+            std::string k
+                = "key-" + std::to_string(i) + "-" + std::to_string(j);
+            std::vector<char> v(64);
+            hg_size_t         vsize = v.size();
+            int ret = sdskv_get(kvph, db_id, k.data(), k.size(), v.data(),
+                                &vsize);
+            if (ret != SDSKV_SUCCESS || std::string(v.data(), vsize) != k) {
+                fprintf(stderr, "Error: key %s not found (%d)\n", k.c_str(),
+                        ret);
+                return -1;
+            }
+        }
+    }
+    printf("%u out of %u requests were rejected\n", num_busy, NUM_WRITERS);
+    if (num_busy == NUM_WRITERS) {
+        fprintf(stderr, "Error: all the requests were rejected\n");
+        return -1;
+    }
+    return 0;
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc != 2) {
+        fprintf(stderr, "Usage: %s <protocol>\n", argv[0]);
+        fprintf(stderr, "  Example: %s na+sm\n", argv[0]);
+        return (-1);
+    }
+
+    sdskv_test_provider env;
+    if (env.init(argv[1], 4, true) != 0
+        || env.reject_configs(bad_configs, sizeof(bad_configs) / sizeof(char*))
+               != 0
+        || env.start(provider_config, "admission-test-db", false) != 0)
+        return (-1);
+    return run_test(env.mid, env.kvph, env.db_id);
+}
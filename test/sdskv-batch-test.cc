@@ -0,0 +1,88 @@
+/*
+ * (C) 2015 The University of Chicago
+ * 
+ * See COPYRIGHT in top-level directory.
+ */
+
+#include <stdio.h>
+#include <assert.h>
+#include <unistd.h>
+#include <margo.h>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <map>
+
+#include "sdskv-test-util.h"
+
+static int batch_test(sdskv::database& DB, uint32_t num_keys);
+
+static int batch_test(sdskv::database& DB, uint32_t num_keys) {
+
+    std::cout << "============== batch_test ==============" << std::endl;
+    std::vector<std::string> keys, vals;
+    for(unsigned i=0; i < num_keys; i++) {
+        keys.push_back(gen_random_string(16));
+        vals.push_back(gen_random_string(8 + rand() % 16));
+    }
+
+    /* interleave puts, gets, lengths and exists in a single batch:
+     * each get follows the put of its key, so it must see its value */
+    sdskv::batch b;
+    for(unsigned i=0; i < num_keys; i++) {
+        b.put(DB, keys[i], vals[i]);
+        b.get(DB, keys[i], 64);
+        b.length(DB, keys[i]);
+        b.exists(DB, keys[i]);
+    }
+    /* a get with a buffer too small and a get of a missing key */
+    b.get(DB, keys[0], 1);
+    b.get(DB, std::string("missing-key"), 64);
+    b.execute();
+
+    for(unsigned i=0; i < num_keys; i++) {
+        if(b.status(4*i) != SDSKV_SUCCESS)
+            throw std::runtime_error("put failed in batch");
+        if(b.value(4*i+1) != vals[i])
+            throw std::runtime_error("get returned a wrong value in batch");
+        if(b.vsize(4*i+2) != vals[i].size())
+            throw std::runtime_error("length returned a wrong size in batch");
+        if(!b.found(4*i+3))
+            throw std::runtime_error("exists did not find a key in batch");
+    }
+    if(b.status(4*num_keys) != SDSKV_ERR_SIZE)
+        throw std::runtime_error("get with small buffer should fail with SDSKV_ERR_SIZE");
+    if(b.status(4*num_keys+1) != SDSKV_ERR_UNKNOWN_KEY)
+        throw std::runtime_error("get of missing key should fail with SDSKV_ERR_UNKNOWN_KEY");
+
+    /* erase everything, checking that the keys are gone in the same batch */
+    sdskv::batch e;
+    for(unsigned i=0; i < num_keys; i++) {
+        e.erase(DB, keys[i]);
+        e.exists(DB, keys[i]);
+    }
+    e.execute();
+    for(unsigned i=0; i < num_keys; i++) {
+        if(e.status(2*i) != SDSKV_SUCCESS)
+            throw std::runtime_error("erase failed in batch");
+        if(e.found(2*i+1))
+            throw std::runtime_error("key still exists after erase in batch");
+    }
+
+    /* executing an empty batch, which has no provider handle, is a no-op */
+    sdskv::batch empty;
+    empty.execute();
+
+    std::cout << "batch_test OK" << std::endl;
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    return sdskv_test_run_client(argc, argv, 1,
+        [](sdskv::client&, std::vector<sdskv::database>& dbs,
+           uint32_t num_keys) {
+            batch_test(dbs[0], num_keys);
+        });
+}
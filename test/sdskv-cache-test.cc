@@ -0,0 +1,123 @@
+/*
+ * (C) 2015 The University of Chicago
+ * 
+ * See COPYRIGHT in top-level directory.
+ */
+
+#include <stdio.h>
+#include <assert.h>
+#include <unistd.h>
+#include <margo.h>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <map>
+
+#include "sdskv-test-util.h"
+#include "sdskv-cache.hpp"
+
+static int cache_test(sdskv::database& DB, uint32_t num_keys);
+
+static int cache_test(sdskv::database& DB, uint32_t num_keys) {
+
+    std::cout << "============== cache_test ==============" << std::endl;
+    std::map<std::string, std::string> reference;
+    for(unsigned i=0; i < num_keys; i++) {
+        auto k = gen_random_string(16);
+        /* some values are larger than the size hint */
+        auto v = gen_random_string(i % 3 == 0 ? 100 : 8);
+        reference[k] = v;
+        DB.put(k, v);
+    }
+    std::vector<std::string> keys;
+    for(auto& p : reference) keys.push_back(p.first);
+    keys.push_back("missing-key");
+
+    sdskv::cache_options opts;
+    opts.value_size_hint = 16;
+    opts.version_key     = "version";
+    opts.version_check_interval = std::chrono::milliseconds(0);
+    DB.put(std::string("version"), std::string("1"));
+    sdskv::cached_database CDB(DB, opts);
+
+    /* first read: all misses, fetched in one batch */
+    std::vector<std::string> values;
+    auto found = CDB.get_multi(keys, values);
+    for(size_t i=0; i < keys.size() - 1; i++) {
+        if(!found[i] || values[i] != reference[keys[i]])
+            throw std::runtime_error("get_multi returned a wrong value");
+    }
+    if(found.back())
+        throw std::runtime_error("missing key reported as found");
+    auto st = CDB.stats();
+    if(st.misses != keys.size() || st.hits != 0)
+        throw std::runtime_error("unexpected counters after first read");
+
+    /* second read: all hits, including the negative entry */
+    found = CDB.get_multi(keys, values);
+    st = CDB.stats();
+    if(st.hits != keys.size() - 1 || st.negative_hits != 1 || st.misses != keys.size())
+        throw std::runtime_error("unexpected counters after second read");
+
+    /* a write from outside is only seen after invalidation */
+    auto k0 = keys[0];
+    DB.put(k0, std::string("updated"));
+    std::string v;
+    CDB.get(k0, v);
+    if(v != reference[k0])
+        throw std::runtime_error("cache did not return the cached value");
+    CDB.invalidate(k0);
+    CDB.get(k0, v);
+    if(v != "updated")
+        throw std::runtime_error("invalidate did not drop the entry");
+
+    /* writes through the cache are visible right away */
+    CDB.put(k0, std::string("through"));
+    CDB.get(k0, v);
+    if(v != "through")
+        throw std::runtime_error("put did not update the cache");
+    CDB.erase(k0);
+    if(CDB.exists(k0))
+        throw std::runtime_error("erase did not update the cache");
+
+    /* exists asks the database on a miss, without caching the value */
+    auto k2 = gen_random_string(16);
+    DB.put(k2, std::string("value"));
+    auto misses = CDB.stats().misses;
+    auto bytes  = CDB.size_bytes();
+    if(!CDB.exists(k2))
+        throw std::runtime_error("exists did not find a key");
+    if(CDB.stats().misses != misses + 1 || CDB.size_bytes() != bytes)
+        throw std::runtime_error("exists cached an existing key");
+    DB.erase(k2);
+
+    /* bumping the version drops everything */
+    auto k1 = keys[1];
+    DB.put(k1, std::string("new"));
+    DB.put(std::string("version"), std::string("2"));
+    CDB.get(k1, v);
+    if(v != "new" || CDB.stats().invalidations != 1)
+        throw std::runtime_error("version change did not drop the cache");
+
+    /* a tiny cache stays within its budget */
+    sdskv::cache_options small;
+    small.capacity = 1024;
+    small.eviction = sdskv::cache_eviction::lru;
+    sdskv::cached_database SDB(DB, small);
+    SDB.get_multi(keys, values);
+    if(SDB.size_bytes() > small.capacity || SDB.stats().evictions == 0)
+        throw std::runtime_error("cache exceeded its capacity");
+
+    std::cout << "cache_test: ok" << std::endl;
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    return sdskv_test_run_client(argc, argv, 1,
+        [](sdskv::client&, std::vector<sdskv::database>& dbs,
+           uint32_t num_keys) {
+            cache_test(dbs[0], num_keys);
+        });
+}
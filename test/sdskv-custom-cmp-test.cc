@@ -203,6 +203,37 @@ int main(int argc, char *argv[])
         }
     }
 
+    /* **** list keys with a prefix **** */
+    /* keys starting with "XYZ_" are not contiguous in the order of the
+     * case-insensitive comparator, they are interleaved with "xyz_" keys */
+    for(unsigned i=0; i < 6; i++) {
+        std::string k = (i % 2 ? "xyz_" : "XYZ_") + std::to_string(i);
+        ret = sdskv_put(kvph, db_id, k.data(), k.size(), k.data(), k.size());
+        if(ret != 0) break;
+    }
+    std::string prefix("XYZ_");
+    std::vector<std::vector<char>> prefixed_keys(6, std::vector<char>(max_key_size+1));
+    std::vector<void*> prefixed_ptrs(6);
+    std::vector<hg_size_t> prefixed_ksizes(6, max_key_size+1);
+    for(unsigned i=0; i < 6; i++)
+        prefixed_ptrs[i] = (void*)prefixed_keys[i].data();
+    max_keys = 6;
+    if(ret == 0) {
+        ret = sdskv_list_keys_with_prefix(kvph, db_id, NULL, 0,
+                prefix.data(), prefix.size(),
+                prefixed_ptrs.data(), prefixed_ksizes.data(), &max_keys);
+    }
+    if(ret != 0 || max_keys != 3) {
+        fprintf(stderr, "Error: sdskv_list_keys_with_prefix() returned %ld keys"
+                " instead of 3\n", ret == 0 ? max_keys : 0);
+        sdskv_shutdown_service(kvcl, svr_addr);
+        sdskv_provider_handle_release(kvph);
+        margo_addr_free(mid, svr_addr);
+        sdskv_client_finalize(kvcl);
+        margo_finalize(mid);
+        return -1;
+    }
+
     /* shutdown the server */
     ret = sdskv_shutdown_service(kvcl, svr_addr);
 
@@ -204,7 +204,17 @@ static int put_get_erase_multi_test(sdskv::database& DB, uint32_t num_keys) {
     for(auto& k : keys)
         DB.erase(k);
     */
-    DB.erase_multi(keys);
+    auto erased = DB.erase_multi(keys);
+    for(unsigned i=0; i < erased.size(); i++) {
+        if(!erased[i])
+            throw std::runtime_error("erase_multi did not report an existing key as erased");
+    }
+    /* erasing again should report that none of the keys existed */
+    erased = DB.erase_multi(keys);
+    for(unsigned i=0; i < erased.size(); i++) {
+        if(erased[i])
+            throw std::runtime_error("erase_multi reported a missing key as erased");
+    }
     return 0;
 }
 
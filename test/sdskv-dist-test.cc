@@ -0,0 +1,102 @@
+/*
+ * (C) 2015 The University of Chicago
+ * 
+ * See COPYRIGHT in top-level directory.
+ */
+
+#include <stdio.h>
+#include <assert.h>
+#include <unistd.h>
+#include <margo.h>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <map>
+
+#include "sdskv-test-util.h"
+
+static int dist_test(const std::vector<sdskv::database>& shards,
+                     sdskv_partitioner_type_t type, uint32_t num_keys);
+
+static int dist_test(const std::vector<sdskv::database>& shards,
+                     sdskv_partitioner_type_t type, uint32_t num_keys) {
+
+    std::cout << "============== dist_test (" << type << ") ==============" << std::endl;
+    sdskv::distributed_database DDB(shards, type);
+    if(type == SDSKV_PARTITION_RANGE)
+        DDB.set_ranges(std::vector<std::string>{ "M" });
+
+    std::map<std::string, std::string> reference;
+    for(unsigned i=0; i < num_keys; i++) {
+        auto k = gen_random_string(16);
+        auto v = gen_random_string(32);
+        reference[k] = v;
+    }
+    std::vector<std::string> keys, values;
+    for(auto& p : reference) {
+        keys.push_back(p.first);
+        values.push_back(p.second);
+    }
+    /* half of the keys are put one by one, the other half in a batch */
+    size_t half = keys.size() / 2;
+    for(size_t i=0; i < half; i++)
+        DDB.put(keys[i], values[i]);
+    DDB.put_multi(std::vector<std::string>(keys.begin() + half, keys.end()),
+                  std::vector<std::string>(values.begin() + half, values.end()));
+
+    /* every key must be stored in the shard it belongs to, and only there */
+    for(auto& k : keys) {
+        size_t s = DDB.locate(k.data(), k.size());
+        if(type == SDSKV_PARTITION_RANGE && s != (k < "M" ? 0u : 1u))
+            throw std::runtime_error("key located in the wrong range");
+        for(size_t j=0; j < DDB.num_shards(); j++) {
+            if(DDB.shard(j).exists(k) != (j == s))
+                throw std::runtime_error("key stored in the wrong shard");
+        }
+    }
+
+    std::vector<std::string> out(keys.size(), std::string(32, '\0'));
+    DDB.get_multi(keys, out);
+    if(out != values)
+        throw std::runtime_error("get_multi returned wrong values");
+    for(size_t i=0; i < keys.size(); i++) {
+        std::string v;
+        DDB.get(keys[i], v);
+        if(v != values[i])
+            throw std::runtime_error("get returned a wrong value");
+    }
+
+    auto lengths = DDB.length_multi(keys);
+    for(auto l : lengths)
+        if(l != 32) throw std::runtime_error("length_multi returned a wrong size");
+
+    std::vector<std::string> probe = keys;
+    probe.push_back("non-existing-key");
+    auto flags = DDB.exists_multi(probe);
+    for(size_t i=0; i < probe.size(); i++)
+        if(flags[i] != (i < keys.size()))
+            throw std::runtime_error("exists_multi returned a wrong flag");
+
+    auto erased = DDB.erase_multi(probe);
+    for(size_t i=0; i < probe.size(); i++)
+        if(erased[i] != (i < keys.size()))
+            throw std::runtime_error("erase_multi returned a wrong flag");
+    for(auto& k : keys)
+        if(DDB.exists(k))
+            throw std::runtime_error("key still exists after erase_multi");
+
+    std::cout << "dist_test: ok" << std::endl;
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    return sdskv_test_run_client(argc, argv, 2,
+        [](sdskv::client&, std::vector<sdskv::database>& dbs,
+           uint32_t num_keys) {
+            dist_test(dbs, SDSKV_PARTITION_CONSISTENT_HASH, num_keys);
+            dist_test(dbs, SDSKV_PARTITION_JUMP_HASH, num_keys);
+            dist_test(dbs, SDSKV_PARTITION_RANGE, num_keys);
+        });
+}
@@ -0,0 +1,84 @@
+/*
+ * (C) 2015 The University of Chicago
+ * 
+ * See COPYRIGHT in top-level directory.
+ */
+
+#include <stdio.h>
+#include <assert.h>
+#include <unistd.h>
+#include <margo.h>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <map>
+
+#include "sdskv-test-util.h"
+
+static int erase_prefix_test(sdskv::database& DB, uint32_t num_keys);
+static int erase_range_test(sdskv::database& DB, uint32_t num_keys);
+
+static int erase_prefix_test(sdskv::database& DB, uint32_t num_keys) {
+
+    std::cout << "============== erase_prefix_test ==============" << std::endl;
+    std::vector<std::string> keys_a, keys_b;
+    for(unsigned i=0; i < num_keys; i++) {
+        keys_a.push_back("run_a/" + gen_random_string(16));
+        keys_b.push_back("run_b/" + gen_random_string(16));
+        DB.put(keys_a.back(), gen_random_string(8));
+        DB.put(keys_b.back(), gen_random_string(8));
+    }
+    if(DB.erase_prefix(std::string("run_a/")) != num_keys)
+        throw std::runtime_error("erase_prefix returned a wrong number of keys");
+    for(unsigned i=0; i < num_keys; i++) {
+        if(DB.exists(keys_a[i]))
+            throw std::runtime_error("erase_prefix did not erase a matching key");
+        if(!DB.exists(keys_b[i]))
+            throw std::runtime_error("erase_prefix erased a key that did not match");
+    }
+    DB.erase_multi(keys_b);
+    std::cout << "erase_prefix_test OK" << std::endl;
+    return 0;
+}
+
+static int erase_range_test(sdskv::database& DB, uint32_t num_keys) {
+
+    std::cout << "============== erase_range_test ==============" << std::endl;
+    std::vector<std::string> keys;
+    for(unsigned i=0; i < num_keys; i++) {
+        char k[32];
+        sprintf(k, "range/%08u", i);
+        keys.push_back(k);
+        DB.put(keys.back(), gen_random_string(8));
+    }
+    /* bounds are excluded */
+    unsigned lb = num_keys/4;
+    unsigned ub = 3*num_keys/4;
+    hg_size_t expected = ub > lb ? ub - lb - 1 : 0;
+    if(DB.erase_range(keys[lb], keys[ub]) != expected)
+        throw std::runtime_error("erase_range returned a wrong number of keys");
+    for(unsigned i=0; i < num_keys; i++) {
+        bool erased = i > lb && i < ub;
+        if(DB.exists(keys[i]) == erased)
+            throw std::runtime_error("erase_range erased the wrong keys");
+    }
+    /* an empty upper bound erases up to the end of the database */
+    DB.erase_range(std::string(), std::string());
+    for(unsigned i=0; i < num_keys; i++) {
+        if(DB.exists(keys[i]))
+            throw std::runtime_error("unbounded erase_range did not erase all keys");
+    }
+    std::cout << "erase_range_test OK" << std::endl;
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    return sdskv_test_run_client(argc, argv, 1,
+        [](sdskv::client&, std::vector<sdskv::database>& dbs,
+           uint32_t num_keys) {
+            erase_prefix_test(dbs[0], num_keys);
+            erase_range_test(dbs[0], num_keys);
+        });
+}
@@ -0,0 +1,147 @@
+/*
+ * (C) 2015 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <margo.h>
+#include <json/json.h>
+#include <string>
+#include <vector>
+
+#include "sdskv-test-util.h"
+
+/* Sends a skewed workload to a database with hot-key tracking enabled and
+ * checks that sdskv_get_stats reports the hot key and the hot prefix
+ * first, with the expected counts, for a database of the JSON config and
+ * one given to sdskv_provider_attach_database. Also checks that invalid
+ * hot-key settings are rejected. */
+
+static const char* provider_config
+    = "{ \"databases\" : [ {"
+      "    \"name\" : \"hotkeys-test-db\", \"type\" : \"map\","
+      "    \"hot_keys\" : 4, \"hot_key_prefix_length\" : 4 } ] }";
+
+static const char* bad_configs[]
+    = {"{ \"databases\" : [ { \"name\" : \"a\", \"type\" : \"map\","
+       "  \"hot_keys\" : -1 } ] }",
+       "{ \"databases\" : [ { \"name\" : \"a\", \"type\" : \"map\","
+       "  \"hot_keys\" : 4, \"hot_key_sample_every\" : 0 } ] }"};
+
+#define NUM_COLD_KEYS 100
+#define NUM_ROUNDS 20
+#define HOT_PER_ROUND 8
+
+static void add_key(std::string&            keys,
+                    std::vector<hg_size_t>& ksizes,
+                    const std::string&      k)
+{
+    keys += k;
+    ksizes.push_back(k.size());
+}
+
+static int run_test(sdskv_provider_handle_t kvph, sdskv_database_id_t db_id)
+{
+    int ret;
+
+    /* write the hot key and the cold keys once (the client shares the
+     * provider's margo instance, so this also covers the local calls) */
+    std::string            keys;
+    std::vector<hg_size_t> ksizes;
+    add_key(keys, ksizes, "hot-key");
+    for (unsigned i = 0; i < NUM_COLD_KEYS; i++)
+        add_key(keys, ksizes, "cold-" + std::to_string(i));
+    ret = sdskv_put_packed(kvph, db_id, ksizes.size(), keys.data(),
+                           ksizes.data(), keys.data(), ksizes.data());
+    CHECK(ret == SDSKV_SUCCESS, "Error: sdskv_put_packed() returned %d\n",
+          ret);
+
+    /* then read the hot key many times, and each cold key at most once */
+    for (unsigned r = 0; r < NUM_ROUNDS; r++) {
+        keys.clear();
+        ksizes.clear();
+        for (unsigned i = 0; i < HOT_PER_ROUND; i++)
+            add_key(keys, ksizes, "hot-key");
+        add_key(keys, ksizes, "cold-" + std::to_string(r));
+        size_t                 num = ksizes.size();
+        std::vector<char>      values(keys.size());
+        std::vector<hg_size_t> vsizes(num);
+        ret = sdskv_get_packed(kvph, db_id, &num, keys.data(), ksizes.data(),
+                               values.size(), values.data(), vsizes.data());
+        CHECK(ret == SDSKV_SUCCESS, "Error: sdskv_get_packed() returned %d\n",
+              ret);
+    }
+
+    char* str = NULL;
+    ret       = sdskv_get_stats(kvph, &str);
+    CHECK(ret == SDSKV_SUCCESS, "Error: sdskv_get_stats() returned %d\n", ret);
+    printf("%s\n", str);
+
+    Json::Value  stats;
+    Json::Reader reader;
+    bool         parsed = reader.parse(str, stats);
+    free(str);
+    CHECK(parsed, "Error: sdskv_get_stats() returned invalid JSON\n");
+
+    const Json::Value& hot = stats["hot_keys"]["hotkeys-test-db"];
+    uint64_t           accesses
+        = 1 + NUM_COLD_KEYS + NUM_ROUNDS * (HOT_PER_ROUND + 1);
+    CHECK(hot["accesses"].asUInt64() == accesses,
+          "Error: expected %lu accesses, got %lu\n", (unsigned long)accesses,
+          (unsigned long)hot["accesses"].asUInt64());
+
+    /* Space-Saving counts never underestimate, and a key accessed more
+     * than accesses/capacity times is always tracked */
+    const Json::Value& top = hot["keys"][0];
+    CHECK(top["key"].asString() == "hot-key",
+          "Error: hottest key is \"%s\"\n", top["key"].asString().c_str());
+    CHECK(top["count"].asUInt64() >= NUM_ROUNDS * HOT_PER_ROUND,
+          "Error: hot key count is %lu\n",
+          (unsigned long)top["count"].asUInt64());
+    CHECK(top["share"].asDouble() > 0.5, "Error: hot key share is %f\n",
+          top["share"].asDouble());
+
+    /* there are only two prefixes, so their counts are exact */
+    const Json::Value& prefixes = hot["prefixes"];
+    CHECK(prefixes.size() == 2, "Error: expected 2 prefixes, got %u\n",
+          prefixes.size());
+    CHECK(prefixes[0]["key"].asString() == "hot-"
+              && prefixes[0]["count"].asUInt64()
+                     == 1 + NUM_ROUNDS * HOT_PER_ROUND
+              && prefixes[0]["writes"].asUInt64() == 1,
+          "Error: unexpected statistics for prefix \"hot-\"\n");
+    CHECK(prefixes[1]["key"].asString() == "cold"
+              && prefixes[1]["count"].asUInt64() == NUM_COLD_KEYS + NUM_ROUNDS
+              && prefixes[1]["writes"].asUInt64() == NUM_COLD_KEYS
+              && prefixes[1]["error"].asUInt64() == 0,
+          "Error: unexpected statistics for prefix \"cold\"\n");
+
+    return 0;
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc != 2) {
+        fprintf(stderr, "Usage: %s <protocol>\n", argv[0]);
+        fprintf(stderr, "  Example: %s na+sm\n", argv[0]);
+        return (-1);
+    }
+
+    sdskv_test_provider env;
+    if (env.init(argv[1]) != 0
+        || env.reject_configs(bad_configs, sizeof(bad_configs) / sizeof(char*))
+               != 0
+        || env.start(provider_config, "hotkeys-test-db", false) != 0
+        || run_test(env.kvph, env.db_id) != 0)
+        return (-1);
+
+    env.stop();
+    env.attach_config.db_hot_keys              = 4;
+    env.attach_config.db_hot_key_prefix_length = 4;
+    if (env.start((const char*)NULL, "hotkeys-test-db", true) != 0)
+        return (-1);
+    return run_test(env.kvph, env.db_id);
+}
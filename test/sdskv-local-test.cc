@@ -0,0 +1,175 @@
+/*
+ * (C) 2015 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include <unistd.h>
+#include <margo.h>
+#include <json/json.h>
+#include <string>
+#include <vector>
+#include <map>
+
+#include "sdskv-test-util.h"
+
+/* Runs a provider and a client in the same margo instance, so that the
+ * client dispatches calls directly to the provider, and checks that the
+ * results and error codes are the same as through RPCs, and that the
+ * calls are reported in the provider's statistics. */
+
+static int run_test(sdskv_provider_handle_t kvph,
+                    sdskv_database_id_t     db_id,
+                    uint32_t                num_keys)
+{
+    int ret;
+    std::map<std::string, std::string> reference;
+
+    /* put */
+    for (unsigned i = 0; i < num_keys; i++) {
+        auto k = gen_random_string(16);
+        auto v = gen_random_string(1 + rand() % 64);
+        ret = sdskv_put(kvph, db_id, k.data(), k.size(), v.data(), v.size());
+        CHECK(ret == SDSKV_SUCCESS, "Error: sdskv_put() returned %d\n", ret);
+        reference[k] = v;
+    }
+
+    /* put_multi */
+    std::vector<std::string> mkeys, mvals;
+    for (unsigned i = 0; i < num_keys; i++) {
+        mkeys.push_back(gen_random_string(16));
+        mvals.push_back(gen_random_string(1 + rand() % 64));
+        reference[mkeys.back()] = mvals.back();
+    }
+    std::vector<const void*> kptrs, vptrs;
+    std::vector<hg_size_t>   ksizes, vsizes;
+    for (unsigned i = 0; i < num_keys; i++) {
+        kptrs.push_back(mkeys[i].data());
+        ksizes.push_back(mkeys[i].size());
+        vptrs.push_back(mvals[i].data());
+        vsizes.push_back(mvals[i].size());
+    }
+    ret = sdskv_put_multi(kvph, db_id, num_keys, kptrs.data(), ksizes.data(),
+                          vptrs.data(), vsizes.data());
+    CHECK(ret == SDSKV_SUCCESS, "Error: sdskv_put_multi() returned %d\n", ret);
+
+    /* get, length, exists */
+    for (auto& p : reference) {
+        hg_size_t len = 0;
+        ret = sdskv_length(kvph, db_id, p.first.data(), p.first.size(), &len);
+        CHECK(ret == SDSKV_SUCCESS && len == p.second.size(),
+              "Error: sdskv_length() returned %d\n", ret);
+        int flag = 0;
+        ret = sdskv_exists(kvph, db_id, p.first.data(), p.first.size(), &flag);
+        CHECK(ret == SDSKV_SUCCESS && flag == 1,
+              "Error: sdskv_exists() returned %d\n", ret);
+        std::vector<char> value(64);
+        hg_size_t         vsize = value.size();
+        ret = sdskv_get(kvph, db_id, p.first.data(), p.first.size(),
+                        value.data(), &vsize);
+        CHECK(ret == SDSKV_SUCCESS, "Error: sdskv_get() returned %d\n", ret);
+        CHECK(std::string(value.data(), vsize) == p.second,
+              "Error: sdskv_get() returned an unexpected value\n");
+    }
+
+    /* error codes */
+    auto      missing = gen_random_string(20);
+    hg_size_t vsize   = 8;
+    char      buf[8];
+    ret = sdskv_get(kvph, db_id, missing.data(), missing.size(), buf, &vsize);
+    CHECK(ret == SDSKV_ERR_UNKNOWN_KEY,
+          "Error: sdskv_get() on a missing key returned %d\n", ret);
+    ret = sdskv_length(kvph, db_id, missing.data(), missing.size(), &vsize);
+    CHECK(ret == SDSKV_ERR_UNKNOWN_KEY,
+          "Error: sdskv_length() on a missing key returned %d\n", ret);
+    int flag = 1;
+    ret = sdskv_exists(kvph, db_id, missing.data(), missing.size(), &flag);
+    CHECK(ret == SDSKV_SUCCESS && flag == 0,
+          "Error: sdskv_exists() on a missing key returned %d\n", ret);
+    auto big = gen_random_string(32);
+    ret      = sdskv_put(kvph, db_id, big.data(), big.size(), big.data(),
+                    big.size());
+    CHECK(ret == SDSKV_SUCCESS, "Error: sdskv_put() returned %d\n", ret);
+    vsize = sizeof(buf);
+    ret   = sdskv_get(kvph, db_id, big.data(), big.size(), buf, &vsize);
+    CHECK(ret == SDSKV_ERR_SIZE && vsize == big.size(),
+          "Error: sdskv_get() with a small buffer returned %d\n", ret);
+    ret = sdskv_get(kvph, db_id + 1234, big.data(), big.size(), buf, &vsize);
+    CHECK(ret == SDSKV_ERR_UNKNOWN_DB,
+          "Error: sdskv_get() on an unknown database returned %d\n", ret);
+
+    /* get_multi, with one missing key */
+    kptrs[0]  = missing.data();
+    ksizes[0] = missing.size();
+    std::vector<std::vector<char>> values(num_keys, std::vector<char>(64));
+    std::vector<void*>             value_ptrs;
+    for (auto& v : values) value_ptrs.push_back(v.data());
+    std::vector<hg_size_t> value_sizes(num_keys, 64);
+    ret = sdskv_get_multi(kvph, db_id, num_keys, kptrs.data(), ksizes.data(),
+                          value_ptrs.data(), value_sizes.data());
+    CHECK(ret == SDSKV_SUCCESS, "Error: sdskv_get_multi() returned %d\n", ret);
+    CHECK(value_sizes[0] == 0,
+          "Error: sdskv_get_multi() returned a value for a missing key\n");
+    for (unsigned i = 1; i < num_keys; i++) {
+        CHECK(std::string(values[i].data(), value_sizes[i]) == mvals[i],
+              "Error: sdskv_get_multi() returned an unexpected value\n");
+    }
+
+    /* erase and erase_multi */
+    ret = sdskv_erase(kvph, db_id, big.data(), big.size());
+    CHECK(ret == SDSKV_SUCCESS, "Error: sdskv_erase() returned %d\n", ret);
+    std::vector<int> flags(num_keys, -1);
+    ret = sdskv_erase_multi_with_flags(kvph, db_id, num_keys, kptrs.data(),
+                                       ksizes.data(), flags.data());
+    CHECK(ret == SDSKV_SUCCESS,
+          "Error: sdskv_erase_multi_with_flags() returned %d\n", ret);
+    CHECK(flags[0] == 0,
+          "Error: sdskv_erase_multi_with_flags() erased a missing key\n");
+    for (unsigned i = 1; i < num_keys; i++) {
+        CHECK(flags[i] == 1,
+              "Error: sdskv_erase_multi_with_flags() did not erase a key\n");
+    }
+    ret = sdskv_exists(kvph, db_id, big.data(), big.size(), &flag);
+    CHECK(ret == SDSKV_SUCCESS && flag == 0,
+          "Error: key still exists after sdskv_erase()\n");
+
+    /* statistics */
+    char* str = NULL;
+    ret       = sdskv_get_stats(kvph, &str);
+    CHECK(ret == SDSKV_SUCCESS, "Error: sdskv_get_stats() returned %d\n", ret);
+    Json::Value  stats;
+    Json::Reader reader;
+    bool         parsed = reader.parse(str, stats);
+    free(str);
+    CHECK(parsed, "Error: sdskv_get_stats() returned invalid JSON\n");
+    const Json::Value& put = stats["databases"]["local-test-db"]["put"];
+    CHECK(put["count"].asUInt64() == num_keys + 1,
+          "Error: expected %u local puts, got %lu\n", num_keys + 1,
+          (unsigned long)put["count"].asUInt64());
+    const Json::Value& get = stats["rpcs"]["get"];
+    CHECK(get["errors"].asUInt64() == 3,
+          "Error: expected 3 failed local gets, got %lu\n",
+          (unsigned long)get["errors"].asUInt64());
+
+    return 0;
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc != 3) {
+        fprintf(stderr, "Usage: %s <protocol> <num_keys>\n", argv[0]);
+        fprintf(stderr, "  Example: %s na+sm 1000\n", argv[0]);
+        return (-1);
+    }
+    uint32_t num_keys = atoi(argv[2]);
+    if (num_keys < 2) num_keys = 2;
+
+    sdskv_test_provider env;
+    if (env.init(argv[1]) != 0
+        || env.start((const char*)NULL, "local-test-db", true) != 0)
+        return (-1);
+    return run_test(env.kvph, env.db_id, num_keys);
+}
@@ -0,0 +1,108 @@
+/*
+ * (C) 2015 The University of Chicago
+ * 
+ * See COPYRIGHT in top-level directory.
+ */
+
+#include <stdio.h>
+#include <assert.h>
+#include <unistd.h>
+#include <margo.h>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <map>
+
+#include "sdskv-test-util.h"
+
+static int packed_multi_db_test(sdskv::client& kvcl, sdskv::database& DB, uint32_t num_keys);
+
+static int packed_multi_db_test(sdskv::client& kvcl, sdskv::database& DB, uint32_t num_keys) {
+
+    std::cout << "============== packed_multi_db_test ==============" << std::endl;
+    /* the test server only opens one database, so the table lists it twice;
+     * the server still has to resolve both entries */
+    std::vector<sdskv::database> dbs = { DB, DB };
+
+    std::map<std::string, std::string> reference;
+    std::string packed_keys, packed_vals;
+    std::vector<hg_size_t> ksizes, vsizes;
+    std::vector<uint32_t> db_indices;
+    for(unsigned i=0; i < num_keys; i++) {
+        auto k = gen_random_string(16);
+        auto v = gen_random_string(8 + rand() % 32);
+        if(reference.count(k)) continue;
+        reference[k] = v;
+        packed_keys += k;
+        packed_vals += v;
+        ksizes.push_back(k.size());
+        vsizes.push_back(v.size());
+        db_indices.push_back(i % 2);
+    }
+    kvcl.put_packed(dbs, ksizes.size(), db_indices.data(), packed_keys.data(),
+                    ksizes.data(), packed_vals.data(), vsizes.data());
+
+    /* read back the keys, plus one key that does not exist */
+    std::string missing = "missing-key-xyz";
+    packed_keys += missing;
+    ksizes.push_back(missing.size());
+    db_indices.push_back(1);
+
+    hg_size_t count = ksizes.size();
+    std::vector<hg_size_t> out_vsizes(count);
+    std::string out_vals(packed_vals.size() + 64, '\0');
+    kvcl.get_packed(dbs, &count, db_indices.data(), packed_keys.data(),
+                    ksizes.data(), out_vals.size(), &out_vals[0],
+                    out_vsizes.data());
+    /* count only includes the keys that were found */
+    if(count != ksizes.size() - 1)
+        throw std::runtime_error("get_packed did not return all the keys");
+
+    size_t koff = 0, voff = 0;
+    for(unsigned i=0; i < ksizes.size(); i++) {
+        std::string k = packed_keys.substr(koff, ksizes[i]);
+        koff += ksizes[i];
+        if(k == missing) {
+            if(out_vsizes[i] != (hg_size_t)(-1))
+                throw std::runtime_error("missing key reported as found");
+            continue;
+        }
+        std::string v = out_vals.substr(voff, out_vsizes[i]);
+        voff += out_vsizes[i];
+        if(v != reference[k])
+            throw std::runtime_error("value does not match for key " + k);
+    }
+
+    auto flags = kvcl.exists_packed(dbs, ksizes.size(), db_indices.data(),
+                                    packed_keys.data(), ksizes.data());
+    for(unsigned i=0; i < flags.size(); i++) {
+        bool expected = (i != flags.size() - 1);
+        if(flags[i] != expected)
+            throw std::runtime_error("exists_packed returned a wrong flag");
+    }
+
+    /* an out-of-range index must be rejected */
+    db_indices[0] = 2;
+    bool failed = false;
+    try {
+        kvcl.exists_packed(dbs, ksizes.size(), db_indices.data(),
+                           packed_keys.data(), ksizes.data());
+    } catch(sdskv::exception& ex) {
+        failed = true;
+    }
+    if(!failed)
+        throw std::runtime_error("invalid database index was accepted");
+
+    std::cout << "packed_multi_db_test: ok" << std::endl;
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    return sdskv_test_run_client(argc, argv, 1,
+        [](sdskv::client& kvcl, std::vector<sdskv::database>& dbs,
+           uint32_t num_keys) {
+            packed_multi_db_test(kvcl, dbs[0], num_keys);
+        });
+}
@@ -0,0 +1,121 @@
+/*
+ * (C) 2015 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include <unistd.h>
+#include <margo.h>
+#include <string>
+#include <vector>
+#include <map>
+
+#include "sdskv-test-util.h"
+
+/* Runs a provider configured with small put_packed/get_packed chunk sizes
+ * and sends it put_packed and get_packed requests spanning many chunks,
+ * including entries larger than a chunk, then checks the results. */
+
+static const char* provider_config
+    = "{ \"put_packed_chunk_size\" : 1024,"
+      "  \"put_packed_pipeline_depth\" : 3,"
+      "  \"get_packed_chunk_size\" : 1024,"
+      "  \"get_packed_pipeline_depth\" : 3 }";
+
+static int run_test(sdskv_provider_handle_t kvph,
+                    sdskv_database_id_t     db_id,
+                    uint32_t                num_keys)
+{
+    int                                ret;
+    std::string                        packed_keys, packed_vals;
+    std::vector<hg_size_t>             ksizes, vsizes;
+    std::map<std::string, std::string> reference;
+
+    for (unsigned i = 0; i < num_keys; i++) {
+        auto k = gen_random_string(16);
+        /* every 10th value is larger than a chunk */
+        auto v = gen_random_string(i % 10 == 0 ? 3000 : 1 + rand() % 200);
+        if (reference.count(k)) continue;
+        reference[k] = v;
+        packed_keys += k;
+        packed_vals += v;
+        ksizes.push_back(k.size());
+        vsizes.push_back(v.size());
+    }
+
+    ret = sdskv_put_packed(kvph, db_id, ksizes.size(), packed_keys.data(),
+                           ksizes.data(), packed_vals.data(), vsizes.data());
+    if (ret != SDSKV_SUCCESS) {
+        fprintf(stderr, "Error: sdskv_put_packed() returned %d\n", ret);
+        return -1;
+    }
+
+    std::vector<char> value(4096);
+    for (auto& p : reference) {
+        hg_size_t vsize = value.size();
+        ret = sdskv_get(kvph, db_id, p.first.data(), p.first.size(),
+                        value.data(), &vsize);
+        if (ret != SDSKV_SUCCESS) {
+            fprintf(stderr, "Error: sdskv_get() returned %d\n", ret);
+            return -1;
+        }
+        if (std::string(value.data(), vsize) != p.second) {
+            fprintf(stderr, "Error: unexpected value for key %s\n",
+                    p.first.c_str());
+            return -1;
+        }
+    }
+
+    /* read everything back in one get_packed, plus a missing key */
+    auto missing = gen_random_string(20);
+    packed_keys += missing;
+    ksizes.push_back(missing.size());
+    size_t                 num = ksizes.size();
+    std::vector<char>      values(packed_vals.size() + 64);
+    std::vector<hg_size_t> rsizes(num);
+    ret = sdskv_get_packed(kvph, db_id, &num, packed_keys.data(),
+                           ksizes.data(), values.size(), values.data(),
+                           rsizes.data());
+    if (ret != SDSKV_SUCCESS || num != ksizes.size() - 1) {
+        fprintf(stderr, "Error: sdskv_get_packed() returned %d\n", ret);
+        return -1;
+    }
+    if (rsizes.back() != (hg_size_t)(-1)) {
+        fprintf(stderr, "Error: sdskv_get_packed() found a missing key\n");
+        return -1;
+    }
+    size_t offset = 0;
+    for (size_t i = 0; i < vsizes.size(); i++) {
+        if (rsizes[i] != vsizes[i]) {
+            fprintf(stderr, "Error: sdskv_get_packed() returned size %lu "
+                    "instead of %lu\n", rsizes[i], vsizes[i]);
+            return -1;
+        }
+        offset += rsizes[i];
+    }
+    if (std::string(values.data(), offset) != packed_vals) {
+        fprintf(stderr, "Error: sdskv_get_packed() returned wrong values\n");
+        return -1;
+    }
+    return 0;
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc != 3) {
+        fprintf(stderr, "Usage: %s <protocol> <num_keys>\n", argv[0]);
+        fprintf(stderr, "  Example: %s na+sm 1000\n", argv[0]);
+        return (-1);
+    }
+    uint32_t num_keys = atoi(argv[2]);
+    if (num_keys < 2) num_keys = 2;
+
+    sdskv_test_provider env;
+    if (env.init(argv[1], -1, true) != 0
+        || env.start(provider_config, "packed-pipeline-test-db", true) != 0)
+        return (-1);
+    return run_test(env.kvph, env.db_id, num_keys);
+}
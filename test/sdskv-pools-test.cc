@@ -0,0 +1,144 @@
+/*
+ * (C) 2015 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include <unistd.h>
+#include <margo.h>
+#include <string>
+#include <vector>
+
+#include "sdskv-server.hpp"
+#include "sdskv-test-util.h"
+
+/* Runs a provider whose read, write, scan and maintenance RPCs are served
+ * from four pools attached to an execution stream with a priority
+ * scheduler, checks that RPCs of each class complete, and that invalid
+ * "pools" sections are rejected. Also checks that a provider created with
+ * the C++ API, which leaves the pools to their defaults, serves RPCs. */
+
+static const char* bad_configs[]
+    = {"{ \"pools\" : { \"read\" : \"nope\" } }",
+       "{ \"pools\" : { \"other\" : \"x\" } }"};
+
+static int run_test(sdskv_provider_handle_t kvph, sdskv_database_id_t db_id)
+{
+    int ret;
+
+    /* write */
+    std::string            keys, values;
+    std::vector<hg_size_t> ksizes, vsizes;
+    for (unsigned i = 0; i < 10; i++) {
+        std::string k = "key" + std::to_string(i);
+        std::string v = "value" + std::to_string(i);
+        keys += k;
+        values += v;
+        ksizes.push_back(k.size());
+        vsizes.push_back(v.size());
+    }
+    ret = sdskv_put_packed(kvph, db_id, ksizes.size(), keys.data(),
+                           ksizes.data(), values.data(), vsizes.data());
+    if (ret != SDSKV_SUCCESS) {
+        fprintf(stderr, "Error: sdskv_put_packed() returned %d\n", ret);
+        return -1;
+    }
+
+    /* read */
+    size_t                 num = ksizes.size();
+    std::vector<char>      rvalues(values.size() + 64);
+    std::vector<hg_size_t> rsizes(num);
+    ret = sdskv_get_packed(kvph, db_id, &num, keys.data(), ksizes.data(),
+                           rvalues.size(), rvalues.data(), rsizes.data());
+    if (ret != SDSKV_SUCCESS || num != ksizes.size()
+        || std::string(rvalues.data(), values.size()) != values) {
+        fprintf(stderr, "Error: sdskv_get_packed() returned %d\n", ret);
+        return -1;
+    }
+
+    /* scan */
+    std::vector<std::vector<char>> lkeys(20, std::vector<char>(16));
+    std::vector<void*>             lkey_ptrs;
+    for (auto& k : lkeys) lkey_ptrs.push_back(k.data());
+    std::vector<hg_size_t> lksizes(20, 16);
+    hg_size_t              max_keys = 20;
+    ret = sdskv_list_keys(kvph, db_id, NULL, 0, lkey_ptrs.data(),
+                          lksizes.data(), &max_keys);
+    if (ret != SDSKV_SUCCESS || max_keys != ksizes.size()) {
+        fprintf(stderr, "Error: sdskv_list_keys() returned %d\n", ret);
+        return -1;
+    }
+
+    /* maintenance */
+    ret = sdskv_sync(kvph, db_id);
+    if (ret != SDSKV_SUCCESS) {
+        fprintf(stderr, "Error: sdskv_sync() returned %d\n", ret);
+        return -1;
+    }
+    return 0;
+}
+
+static int run_cxx_test(sdskv_test_provider& env)
+{
+    int ret;
+    try {
+        auto*          provider  = sdskv::provider::create(env.mid, 3);
+        sdskv_config_t db_config = SDSKV_CONFIG_DEFAULT;
+        db_config.db_name        = "pools-cxx-test-db";
+        db_config.db_type        = KVDB_MAP;
+        sdskv_database_id_t     db_id = provider->attach_database(db_config);
+        sdskv_provider_handle_t kvph;
+        sdskv_provider_handle_create(env.kvcl, env.addr, 3, &kvph);
+        ret = run_test(kvph, db_id);
+        sdskv_provider_handle_release(kvph);
+        delete provider;
+    } catch (const sdskv::exception& ex) {
+        fprintf(stderr, "Error: C++ provider: %s\n", ex.what());
+        ret = -1;
+    }
+    return ret;
+}
+
+int main(int argc, char* argv[])
+{
+    ABT_pool    pools[4];
+    ABT_xstream xstream;
+    int         ret;
+
+    if (argc != 2) {
+        fprintf(stderr, "Usage: %s <protocol>\n", argv[0]);
+        fprintf(stderr, "  Example: %s na+sm\n", argv[0]);
+        return (-1);
+    }
+
+    sdskv_test_provider env;
+    if (env.init(argv[1], -1, true) != 0
+        || env.reject_configs(bad_configs, sizeof(bad_configs) / sizeof(char*))
+               != 0)
+        return (-1);
+
+    /* read, write, scan and maintenance pools, in decreasing priority */
+    for (int i = 0; i < 4; i++)
+        ABT_pool_create_basic(ABT_POOL_FIFO, ABT_POOL_ACCESS_MPMC, ABT_FALSE,
+                              &pools[i]);
+    ABT_xstream_create_basic(ABT_SCHED_PRIO, 4, pools, ABT_SCHED_CONFIG_NULL,
+                             &xstream);
+
+    struct sdskv_provider_init_info args = SDSKV_PROVIDER_INIT_INFO_INIT;
+    args.read_pool                       = pools[0];
+    args.write_pool                      = pools[1];
+    args.scan_pool                       = pools[2];
+    args.maintenance_pool                = pools[3];
+    ret = env.start(args, "pools-test-db", true);
+    if (ret == 0) ret = run_test(env.kvph, env.db_id);
+    if (ret == 0) ret = run_cxx_test(env);
+    env.stop();
+
+    ABT_xstream_join(xstream);
+    ABT_xstream_free(&xstream);
+    for (int i = 0; i < 4; i++) ABT_pool_free(&pools[i]);
+    return ret;
+}
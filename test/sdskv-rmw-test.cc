@@ -0,0 +1,224 @@
+/*
+ * (C) 2015 The University of Chicago
+ * 
+ * See COPYRIGHT in top-level directory.
+ */
+
+#include <stdio.h>
+#include <assert.h>
+#include <unistd.h>
+#include <margo.h>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <map>
+#include <limits>
+
+#include "sdskv-test-util.h"
+
+static int compare_and_swap_test(sdskv::database& DB, uint32_t num_keys);
+static int compare_and_swap_packed_test(sdskv::database& DB, uint32_t num_keys);
+static int fetch_and_add_test(sdskv::database& DB, uint32_t num_keys);
+static int append_test(sdskv::database& DB, uint32_t num_keys);
+static int concurrent_test(sdskv::database& DB, uint32_t num_keys);
+
+static int compare_and_swap_test(sdskv::database& DB, uint32_t num_keys) {
+
+    std::cout << "============== compare_and_swap_test ==============" << std::endl;
+    for(unsigned i=0; i < num_keys; i++) {
+        auto k  = gen_random_string(16);
+        auto v1 = gen_random_string(8);
+        auto v2 = gen_random_string(12);
+        /* an empty expected value creates the key */
+        if(!DB.compare_and_swap(k, std::string(), v1))
+            throw std::runtime_error("compare_and_swap failed to create key");
+        /* a wrong expected value must not replace the value */
+        if(DB.compare_and_swap(k, v2, v2))
+            throw std::runtime_error("compare_and_swap swapped with wrong expected value");
+        if(!DB.compare_and_swap(k, v1, v2))
+            throw std::runtime_error("compare_and_swap failed with right expected value");
+        std::string v(v2.size(), 0);
+        DB.get(k, v);
+        if(v != v2)
+            throw std::runtime_error("compare_and_swap did not store the new value");
+        DB.erase(k);
+    }
+    std::cout << "compare_and_swap_test OK" << std::endl;
+    return 0;
+}
+
+static int compare_and_swap_packed_test(sdskv::database& DB, uint32_t num_keys) {
+
+    std::cout << "============== compare_and_swap_packed_test ==============" << std::endl;
+    std::vector<std::string> keys, empty(num_keys), v1, v2, wrong;
+    for(unsigned i=0; i < num_keys; i++) {
+        keys.push_back(gen_random_string(16));
+        v1.push_back(gen_random_string(8));
+        v2.push_back(gen_random_string(1+i));
+        wrong.push_back(i % 2 ? v1.back() : v2.back());
+    }
+    /* empty expected values create the keys */
+    auto swapped = DB.compare_and_swap_packed(keys, empty, v1);
+    for(unsigned i=0; i < num_keys; i++) {
+        if(!swapped[i])
+            throw std::runtime_error("compare_and_swap_packed failed to create key");
+    }
+    /* only the keys whose expected value matches are replaced */
+    swapped = DB.compare_and_swap_packed(keys, wrong, v2);
+    for(unsigned i=0; i < num_keys; i++) {
+        if(swapped[i] != (i % 2 == 1))
+            throw std::runtime_error("compare_and_swap_packed returned a wrong flag");
+        auto& expected = i % 2 ? v2[i] : v1[i];
+        std::string v(expected.size(), 0);
+        DB.get(keys[i], v);
+        if(v != expected)
+            throw std::runtime_error("compare_and_swap_packed stored a wrong value");
+    }
+    DB.erase_multi(keys);
+    std::cout << "compare_and_swap_packed_test OK" << std::endl;
+    return 0;
+}
+
+static int fetch_and_add_test(sdskv::database& DB, uint32_t num_keys) {
+
+    std::cout << "============== fetch_and_add_test ==============" << std::endl;
+    std::vector<std::string> keys;
+    std::vector<int64_t>     deltas;
+    for(unsigned i=0; i < num_keys; i++) {
+        keys.push_back(gen_random_string(16));
+        deltas.push_back(i+1);
+    }
+    /* missing keys start at 0 */
+    for(unsigned i=0; i < num_keys; i++) {
+        if(DB.fetch_and_add(keys[i], deltas[i]) != 0)
+            throw std::runtime_error("fetch_and_add on a new key did not return 0");
+    }
+    auto previous = DB.fetch_and_add_packed(keys, deltas);
+    for(unsigned i=0; i < num_keys; i++) {
+        if(previous[i] != deltas[i])
+            throw std::runtime_error("fetch_and_add_packed returned a wrong previous value");
+        if(DB.fetch_and_add(keys[i], 0) != 2*deltas[i])
+            throw std::runtime_error("fetch_and_add returned a wrong value");
+    }
+    /* a value that is not an int64_t must be rejected */
+    std::string k = gen_random_string(16);
+    DB.put(k, std::string("abc"));
+    try {
+        DB.fetch_and_add(k, 1);
+        throw std::runtime_error("fetch_and_add succeeded on a non-integer value");
+    } catch(sdskv::exception& ex) {
+        std::cout << "Correctly thrown exception: " << ex.what() << std::endl;
+    }
+    DB.erase(k);
+    /* overflow wraps around */
+    DB.fetch_and_add(k, std::numeric_limits<int64_t>::max());
+    DB.fetch_and_add(k, 1);
+    if(DB.fetch_and_add(k, 0) != std::numeric_limits<int64_t>::min())
+        throw std::runtime_error("fetch_and_add did not wrap around on overflow");
+    DB.erase(k);
+    DB.erase_multi(keys);
+    std::cout << "fetch_and_add_test OK" << std::endl;
+    return 0;
+}
+
+static int append_test(sdskv::database& DB, uint32_t num_keys) {
+
+    std::cout << "============== append_test ==============" << std::endl;
+    std::vector<std::string> keys;
+    std::vector<std::string> parts;
+    std::map<std::string, std::string> reference;
+    for(unsigned i=0; i < num_keys; i++) {
+        auto k = gen_random_string(16);
+        auto v = gen_random_string(1+i);
+        if(DB.append(k, v) != v.size())
+            throw std::runtime_error("append returned a wrong size");
+        keys.push_back(k);
+        parts.push_back(gen_random_string(3));
+        reference[k] = v + parts.back();
+    }
+    auto sizes = DB.append_packed(keys, parts);
+    for(unsigned i=0; i < num_keys; i++) {
+        auto& expected = reference[keys[i]];
+        if(sizes[i] != expected.size())
+            throw std::runtime_error("append_packed returned a wrong size");
+        std::string v(expected.size(), 0);
+        DB.get(keys[i], v);
+        if(v != expected)
+            throw std::runtime_error("append_packed produced a wrong value");
+    }
+    DB.erase_multi(keys);
+    std::cout << "append_test OK" << std::endl;
+    return 0;
+}
+
+struct adder_args {
+    sdskv::database* DB;
+    std::string      counter;
+    std::string      log;
+    uint32_t         num_ops;
+    bool             failed;
+};
+
+static void adder(void* a) {
+    adder_args* args = (adder_args*)a;
+    try {
+        for(unsigned i=0; i < args->num_ops; i++) {
+            args->DB->fetch_and_add(args->counter, 1);
+            args->DB->append(args->log, std::string("x"));
+        }
+    } catch(std::exception& ex) {
+        std::cerr << "Error: " << ex.what() << std::endl;
+        args->failed = true;
+    }
+}
+
+/* read-modify-write operations from concurrent ULTs on the same keys
+ * must not lose any update */
+static int concurrent_test(sdskv::database& DB, uint32_t num_keys) {
+
+    std::cout << "============== concurrent_test ==============" << std::endl;
+    const unsigned num_ults = 8;
+    ABT_xstream xstream;
+    ABT_pool    pool;
+    ABT_self_get_xstream(&xstream);
+    ABT_xstream_get_main_pools(xstream, 1, &pool);
+
+    std::string counter = gen_random_string(16);
+    std::string log     = gen_random_string(16);
+    std::vector<adder_args> args(num_ults);
+    std::vector<ABT_thread> threads(num_ults);
+    for(unsigned i=0; i < num_ults; i++) {
+        args[i] = {&DB, counter, log, num_keys, false};
+        ABT_thread_create(pool, adder, &args[i], ABT_THREAD_ATTR_NULL, &threads[i]);
+    }
+    bool failed = false;
+    for(unsigned i=0; i < num_ults; i++) {
+        ABT_thread_join(threads[i]);
+        ABT_thread_free(&threads[i]);
+        failed = failed || args[i].failed;
+    }
+    if(failed)
+        throw std::runtime_error("concurrent read-modify-write failed");
+    if(DB.fetch_and_add(counter, 0) != (int64_t)num_ults*num_keys)
+        throw std::runtime_error("concurrent fetch_and_add lost updates");
+    if(DB.append(log, std::string()) != (hg_size_t)num_ults*num_keys)
+        throw std::runtime_error("concurrent append lost updates");
+    DB.erase(counter);
+    DB.erase(log);
+    std::cout << "concurrent_test OK" << std::endl;
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    return sdskv_test_run_client(argc, argv, 1,
+        [](sdskv::client&, std::vector<sdskv::database>& dbs,
+           uint32_t num_keys) {
+            compare_and_swap_test(dbs[0], num_keys);
+            compare_and_swap_packed_test(dbs[0], num_keys);
+            fetch_and_add_test(dbs[0], num_keys);
+            append_test(dbs[0], num_keys);
+            concurrent_test(dbs[0], num_keys);
+        });
+}
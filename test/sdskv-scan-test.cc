@@ -0,0 +1,102 @@
+/*
+ * (C) 2015 The University of Chicago
+ * 
+ * See COPYRIGHT in top-level directory.
+ */
+
+#include <stdio.h>
+#include <assert.h>
+#include <unistd.h>
+#include <margo.h>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <map>
+
+#include "sdskv-test-util.h"
+
+static int scan_test(const std::vector<sdskv::database>& shards,
+                     sdskv_partitioner_type_t type, uint32_t num_keys);
+
+static int scan_test(const std::vector<sdskv::database>& shards,
+                     sdskv_partitioner_type_t type, uint32_t num_keys) {
+
+    std::cout << "============== scan_test (" << type << ") ==============" << std::endl;
+    sdskv::distributed_database DDB(shards, type);
+    if(type == SDSKV_PARTITION_RANGE)
+        DDB.set_ranges(std::vector<std::string>{ "M" });
+
+    std::map<std::string, std::string> reference;
+    for(unsigned i=0; i < num_keys; i++) {
+        auto k = gen_random_string(16);
+        auto v = gen_random_string(32);
+        reference[k] = v;
+    }
+    std::vector<std::string> keys, values;
+    for(auto& p : reference) {
+        keys.push_back(p.first);
+        values.push_back(p.second);
+    }
+    DDB.put_multi(keys, values);
+
+    /* full scan, with pages smaller than the number of keys per shard */
+    {
+        sdskv::ordered_scan scan(DDB, "", "", 3, 16, 32);
+        std::string k, v;
+        auto it = reference.begin();
+        while(scan.next(k, v)) {
+            if(it == reference.end() || k != it->first || v != it->second)
+                throw std::runtime_error("full scan returned a wrong pair");
+            ++it;
+        }
+        if(it != reference.end())
+            throw std::runtime_error("full scan missed some pairs");
+    }
+
+    /* scan starting after the middle key, with small size hints
+     * to exercise the retry on SDSKV_ERR_SIZE */
+    {
+        auto start = std::next(reference.begin(), reference.size() / 2);
+        sdskv::ordered_scan scan(DDB, start->first, "", 4, 1, 1);
+        std::string k, v;
+        auto it = std::next(start);
+        while(scan.next(k, v)) {
+            if(it == reference.end() || k != it->first || v != it->second)
+                throw std::runtime_error("scan from a start key returned a wrong pair");
+            ++it;
+        }
+        if(it != reference.end())
+            throw std::runtime_error("scan from a start key missed some pairs");
+    }
+
+    /* prefix scan, which for range partitioning only contacts one shard */
+    {
+        std::string prefix = reference.begin()->first.substr(0, 1);
+        sdskv::ordered_scan scan(DDB, "", prefix, 2, 16, 32);
+        std::string k, v;
+        auto it = reference.lower_bound(prefix);
+        while(scan.next(k, v)) {
+            if(it == reference.end() || k != it->first || v != it->second)
+                throw std::runtime_error("prefix scan returned a wrong pair");
+            ++it;
+        }
+        if(it != reference.end() && it->first.compare(0, prefix.size(), prefix) == 0)
+            throw std::runtime_error("prefix scan missed some pairs");
+    }
+
+    DDB.erase_multi(keys);
+
+    std::cout << "scan_test: ok" << std::endl;
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    return sdskv_test_run_client(argc, argv, 2,
+        [](sdskv::client&, std::vector<sdskv::database>& dbs,
+           uint32_t num_keys) {
+            scan_test(dbs, SDSKV_PARTITION_JUMP_HASH, num_keys);
+            scan_test(dbs, SDSKV_PARTITION_RANGE, num_keys);
+        });
+}
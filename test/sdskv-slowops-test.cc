@@ -0,0 +1,133 @@
+/*
+ * (C) 2015 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <margo.h>
+#include <json/json.h>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "sdskv-test-util.h"
+
+/* Runs a provider whose slow operation threshold is so low that every
+ * request is logged, and checks that sdskv_get_slow_ops returns the most
+ * recent ones with their details, and that all of them were appended to
+ * the log file. Also checks that invalid settings are rejected. */
+
+#define NUM_REQUESTS 10
+#define KEYS_PER_REQUEST 5
+#define BUFFER_SIZE 4
+
+static const char* bad_configs[]
+    = {"{ \"slow_ops\" : { \"total_threshold_ms\" : -1 } }",
+       "{ \"slow_ops\" : { \"buffer_size\" : 0 } }",
+       "{ \"slow_ops\" : { \"path\" : 1 } }"};
+
+static int run_test(sdskv_provider_handle_t kvph,
+                    sdskv_database_id_t     db_id,
+                    const char*             log_path)
+{
+    int ret;
+
+    for (unsigned i = 0; i < NUM_REQUESTS; i++) {
+        std::string            keys;
+        std::vector<hg_size_t> ksizes;
+        for (unsigned j = 0; j < KEYS_PER_REQUEST; j++) {
+            std::string k = "request-" + std::to_string(i) + "-key-"
+                          + std::to_string(j);
+            keys += k;
+            ksizes.push_back(k.size());
+        }
+        ret = sdskv_put_packed(kvph, db_id, ksizes.size(), keys.data(),
+                               ksizes.data(), keys.data(), ksizes.data());
+        CHECK(ret == SDSKV_SUCCESS, "Error: sdskv_put_packed() returned %d\n",
+              ret);
+    }
+
+    char* str = NULL;
+    ret       = sdskv_get_slow_ops(kvph, &str);
+    CHECK(ret == SDSKV_SUCCESS, "Error: sdskv_get_slow_ops() returned %d\n",
+          ret);
+    printf("%s\n", str);
+
+    Json::Value  slow_ops;
+    Json::Reader reader;
+    bool         parsed = reader.parse(str, slow_ops);
+    free(str);
+    CHECK(parsed, "Error: sdskv_get_slow_ops() returned invalid JSON\n");
+
+    /* the open request and the puts were all slow */
+    uint64_t total = slow_ops["total"].asUInt64();
+    CHECK(total >= NUM_REQUESTS, "Error: only %lu slow requests\n",
+          (unsigned long)total);
+    const Json::Value& ops = slow_ops["ops"];
+    CHECK(ops.size() == BUFFER_SIZE, "Error: %u requests in the log\n",
+          ops.size());
+    CHECK(slow_ops["dropped"].asUInt64() == total - BUFFER_SIZE,
+          "Error: unexpected number of dropped requests\n");
+
+    /* the last one is the last put */
+    const Json::Value& last = ops[BUFFER_SIZE - 1];
+    std::string        prefix
+        = "request-" + std::to_string(NUM_REQUESTS - 1) + "-key-0";
+    CHECK(last["rpc"].asString() == "put_packed",
+          "Error: last slow request is a %s\n", last["rpc"].asString().c_str());
+    CHECK(last["database"].asString() == "slowops-test-db",
+          "Error: wrong database for the last slow request\n");
+    CHECK(last["key_prefix"].asString() == prefix,
+          "Error: wrong key prefix %s\n",
+          last["key_prefix"].asString().c_str());
+    CHECK(last["num_keys"].asUInt64() == KEYS_PER_REQUEST,
+          "Error: wrong number of keys\n");
+    CHECK(last["bytes"].asUInt64() > 2 * prefix.size(),
+          "Error: wrong number of bytes\n");
+    CHECK(last["ret"].asInt() == SDSKV_SUCCESS
+              && last["total_ms"].asDouble() > 0
+              && last["total_ms"].asDouble() >= last["engine_ms"].asDouble(),
+          "Error: inconsistent slow request\n");
+
+    /* the file has every slow request */
+    std::ifstream file(log_path);
+    std::string   line;
+    uint64_t      lines = 0;
+    while (std::getline(file, line)) {
+        Json::Value entry;
+        CHECK(reader.parse(line, entry) && entry.isMember("rpc"),
+              "Error: invalid line in %s: %s\n", log_path, line.c_str());
+        lines += 1;
+    }
+    CHECK(lines >= total, "Error: %lu lines in %s, expected %lu\n",
+          (unsigned long)lines, log_path, (unsigned long)total);
+
+    return 0;
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc != 3) {
+        fprintf(stderr, "Usage: %s <protocol> <log file>\n", argv[0]);
+        fprintf(stderr, "  Example: %s na+sm /tmp/slow-ops.log\n", argv[0]);
+        return (-1);
+    }
+
+    std::string config
+        = "{ \"slow_ops\" : { \"total_threshold_ms\" : 0.000001,"
+          "  \"buffer_size\" : "
+        + std::to_string(BUFFER_SIZE) + ", \"path\" : \"" + argv[2] + "\" },"
+        + "  \"databases\" : [ {"
+          "    \"name\" : \"slowops-test-db\", \"type\" : \"map\" } ] }";
+
+    sdskv_test_provider env;
+    if (env.init(argv[1], -1, true) != 0
+        || env.reject_configs(bad_configs, sizeof(bad_configs) / sizeof(char*))
+               != 0
+        || env.start(config.c_str(), "slowops-test-db", false) != 0)
+        return (-1);
+    return run_test(env.kvph, env.db_id, argv[2]);
+}
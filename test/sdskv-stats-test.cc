@@ -0,0 +1,116 @@
+/*
+ * (C) 2015 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <margo.h>
+#include <json/json.h>
+#include <string>
+#include <vector>
+
+#include "sdskv-test-util.h"
+
+/* Sends requests to a provider and checks that sdskv_get_stats reports
+ * them, for the provider and for the database, along with the errors. */
+
+#define NUM_REQUESTS 20
+
+static int check_op(const Json::Value& stats,
+                    const char*        name,
+                    uint64_t           count,
+                    uint64_t           errors)
+{
+    CHECK(stats.isMember(name), "Error: no statistics for %s\n", name);
+    const Json::Value& op = stats[name];
+    CHECK(op["count"].asUInt64() == count,
+          "Error: expected %lu %s requests, got %lu\n",
+          (unsigned long)count, name, (unsigned long)op["count"].asUInt64());
+    CHECK(op["errors"].asUInt64() == errors,
+          "Error: expected %lu %s errors, got %lu\n",
+          (unsigned long)errors, name, (unsigned long)op["errors"].asUInt64());
+    const Json::Value& total = op["total"];
+    CHECK(total["p50_us"].asDouble() <= total["p99_us"].asDouble()
+              && total["p99_us"].asDouble() <= total["p999_us"].asDouble()
+              && total["p999_us"].asDouble() <= total["max_us"].asDouble()
+              && total["max_us"].asDouble() > 0,
+          "Error: inconsistent latencies for %s\n", name);
+    return 0;
+}
+
+static int run_test(sdskv_provider_handle_t kvph, sdskv_database_id_t db_id)
+{
+    int ret;
+
+    std::string            keys, values;
+    std::vector<hg_size_t> ksizes, vsizes;
+    for (unsigned i = 0; i < 10; i++) {
+        std::string k = "key" + std::to_string(i);
+        std::string v = "value" + std::to_string(i);
+        keys += k;
+        values += v;
+        ksizes.push_back(k.size());
+        vsizes.push_back(v.size());
+    }
+    for (unsigned i = 0; i < NUM_REQUESTS; i++) {
+        ret = sdskv_put_packed(kvph, db_id, ksizes.size(), keys.data(),
+                               ksizes.data(), values.data(), vsizes.data());
+        CHECK(ret == SDSKV_SUCCESS, "Error: sdskv_put_packed() returned %d\n",
+              ret);
+        size_t                 num = ksizes.size();
+        std::vector<char>      rvalues(values.size() + 64);
+        std::vector<hg_size_t> rsizes(num);
+        ret = sdskv_get_packed(kvph, db_id, &num, keys.data(), ksizes.data(),
+                               rvalues.size(), rvalues.data(), rsizes.data());
+        CHECK(ret == SDSKV_SUCCESS, "Error: sdskv_get_packed() returned %d\n",
+              ret);
+    }
+
+    /* one failing request */
+    sdskv_database_id_t unknown;
+    ret = sdskv_open(kvph, "no-such-db", &unknown);
+    CHECK(ret == SDSKV_ERR_DB_NAME, "Error: sdskv_open() returned %d\n", ret);
+
+    char* str = NULL;
+    ret       = sdskv_get_stats(kvph, &str);
+    CHECK(ret == SDSKV_SUCCESS, "Error: sdskv_get_stats() returned %d\n", ret);
+    printf("%s\n", str);
+
+    Json::Value  stats;
+    Json::Reader reader;
+    bool         parsed = reader.parse(str, stats);
+    free(str);
+    CHECK(parsed, "Error: sdskv_get_stats() returned invalid JSON\n");
+
+    const Json::Value& rpcs = stats["rpcs"];
+    if (check_op(rpcs, "put_packed", NUM_REQUESTS, 0) != 0) return -1;
+    if (check_op(rpcs, "get_packed", NUM_REQUESTS, 0) != 0) return -1;
+    if (check_op(rpcs, "open", 1, 1) != 0) return -1;
+    CHECK(rpcs["put_packed"].isMember("bulk"),
+          "Error: no bulk phase reported for put_packed\n");
+
+    const Json::Value& db = stats["databases"]["stats-test-db"];
+    if (check_op(db, "put_packed", NUM_REQUESTS, 0) != 0) return -1;
+    if (check_op(db, "get_packed", NUM_REQUESTS, 0) != 0) return -1;
+    CHECK(!db.isMember("open"), "Error: open reported for a database\n");
+
+    return 0;
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc != 2) {
+        fprintf(stderr, "Usage: %s <protocol>\n", argv[0]);
+        fprintf(stderr, "  Example: %s na+sm\n", argv[0]);
+        return (-1);
+    }
+
+    sdskv_test_provider env;
+    if (env.init(argv[1], -1, true) != 0
+        || env.start((const char*)NULL, "stats-test-db", true) != 0)
+        return (-1);
+    return run_test(env.kvph, env.db_id);
+}
@@ -0,0 +1,54 @@
+/*
+ * (C) 2015 The University of Chicago
+ * 
+ * See COPYRIGHT in top-level directory.
+ */
+
+#include <stdio.h>
+#include <assert.h>
+#include <unistd.h>
+#include <margo.h>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <map>
+
+#include "sdskv-test-util.h"
+
+static int sync_test(sdskv::database& DB, uint32_t num_keys);
+
+static int sync_test(sdskv::database& DB, uint32_t num_keys) {
+
+    std::cout << "============== sync_test ==============" << std::endl;
+    std::map<std::string, std::string> reference;
+    for(unsigned i=0; i < num_keys; i++) {
+        auto k = gen_random_string(16);
+        auto v = gen_random_string(32);
+        reference[k] = v;
+        DB.put(k, v);
+    }
+    DB.sync();
+    for(auto& p : reference) {
+        std::string v;
+        DB.get(p.first, v);
+        if(v != p.second)
+            throw std::runtime_error("value does not match after sync");
+    }
+    /* syncing with nothing to flush is fine too */
+    DB.sync();
+    std::vector<std::string> keys;
+    for(auto& p : reference) keys.push_back(p.first);
+    DB.erase_multi(keys);
+    std::cout << "sync_test OK" << std::endl;
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    return sdskv_test_run_client(argc, argv, 1,
+        [](sdskv::client&, std::vector<sdskv::database>& dbs,
+           uint32_t num_keys) {
+            sync_test(dbs[0], num_keys);
+        });
+}
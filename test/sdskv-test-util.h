@@ -0,0 +1,250 @@
+/*
+ * (C) 2015 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+
+#ifndef SDSKV_TEST_UTIL_H
+#define SDSKV_TEST_UTIL_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <margo.h>
+#include <functional>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "sdskv-server.h"
+#include "sdskv-client.h"
+#include "sdskv-client.hpp"
+
+/* Fixtures shared by the tests: sdskv_test_provider sets up a provider and
+ * a client in the same process, for tests that need to configure the
+ * provider; sdskv_test_run_client runs a test against databases of
+ * servers started by test-util.sh (see test_run_with_servers). */
+
+#define CHECK(cond, ...)                  \
+    do {                                  \
+        if (!(cond)) {                    \
+            fprintf(stderr, __VA_ARGS__); \
+            return -1;                    \
+        }                                 \
+    } while (0)
+
+static inline std::string gen_random_string(size_t len)
+{
+    static const char alphanum[]
+        = "0123456789"
+          "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
+          "abcdefghijklmnopqrstuvwxyz";
+    std::string s(len, ' ');
+    for (unsigned i = 0; i < len; ++i) {
+        s[i] = alphanum[rand() % (sizeof(alphanum) - 1)];
+    }
+    return s;
+}
+
+class sdskv_test_provider {
+  public:
+    margo_instance_id       mid        = MARGO_INSTANCE_NULL;
+    margo_instance_id       client_mid = MARGO_INSTANCE_NULL;
+    hg_addr_t               addr       = HG_ADDR_NULL; /* in client_mid */
+    sdskv_provider_t        provider   = NULL;
+    sdskv_database_id_t     db_id      = 0;
+    sdskv_client_t          kvcl       = SDSKV_CLIENT_NULL;
+    sdskv_provider_handle_t kvph       = SDSKV_PROVIDER_HANDLE_NULL;
+    /* config of the database attached by start, which sets its name and
+     * type */
+    sdskv_config_t attach_config = SDSKV_CONFIG_DEFAULT;
+
+    sdskv_test_provider()                           = default;
+    sdskv_test_provider(const sdskv_test_provider&) = delete;
+    sdskv_test_provider& operator=(const sdskv_test_provider&) = delete;
+
+    ~sdskv_test_provider()
+    {
+        stop();
+        if (client_mid != mid && client_mid != MARGO_INSTANCE_NULL)
+            margo_finalize(client_mid);
+        if (mid != MARGO_INSTANCE_NULL) margo_finalize(mid);
+    }
+
+    /* initializes margo, with rpc_threads handler execution streams; the
+     * client shares the provider's margo instance, so that its calls are
+     * dispatched directly to the provider (see sdskv-local.h), unless
+     * rpc_client is true: it then gets its own instance and sends RPCs */
+    int init(const char* protocol, int rpc_threads = -1,
+             bool rpc_client = false)
+    {
+        mid = margo_init(protocol, MARGO_SERVER_MODE, 0, rpc_threads);
+        if (mid == MARGO_INSTANCE_NULL) {
+            fprintf(stderr, "Error: margo_init()\n");
+            return -1;
+        }
+        client_mid = mid;
+        if (rpc_client) {
+            client_mid = margo_init(protocol, MARGO_CLIENT_MODE, 1, 0);
+            if (client_mid == MARGO_INSTANCE_NULL) {
+                fprintf(stderr, "Error: margo_init() for the client\n");
+                return -1;
+            }
+        }
+        return 0;
+    }
+
+    /* checks that providers can't be registered with any of the configs */
+    int reject_configs(const char* const* configs, size_t num)
+    {
+        struct sdskv_provider_init_info args = SDSKV_PROVIDER_INIT_INFO_INIT;
+        for (size_t i = 0; i < num; i++) {
+            sdskv_provider_t p;
+            args.json_config = configs[i];
+            int ret          = sdskv_provider_register(mid, 2, &args, &p);
+            CHECK(ret == SDSKV_ERR_CONFIG,
+                  "Error: invalid config accepted (%d): %s\n", ret, configs[i]);
+        }
+        return 0;
+    }
+
+    /* registers provider 1 with args, creates a client with a handle to it,
+     * and opens db_name: if attach is true, it is first attached as a map
+     * database, otherwise it must be created by the JSON config */
+    int start(const struct sdskv_provider_init_info& args,
+              const char*                            db_name,
+              bool                                   attach)
+    {
+        struct sdskv_provider_init_info a = args;
+        int ret = sdskv_provider_register(mid, 1, &a, &provider);
+        CHECK(ret == SDSKV_SUCCESS,
+              "Error: sdskv_provider_register() returned %d\n", ret);
+        if (attach) {
+            sdskv_config_t db_config = attach_config;
+            db_config.db_name        = db_name;
+            db_config.db_type        = KVDB_MAP;
+            ret = sdskv_provider_attach_database(provider, &db_config, &db_id);
+            CHECK(ret == SDSKV_SUCCESS,
+                  "Error: sdskv_provider_attach_database() returned %d\n",
+                  ret);
+        }
+        ret = sdskv_client_init(client_mid, &kvcl);
+        CHECK(ret == SDSKV_SUCCESS, "Error: sdskv_client_init() returned %d\n",
+              ret);
+        CHECK(lookup_self() == 0, "Error: can't look up the provider\n");
+        ret = sdskv_provider_handle_create(kvcl, addr, 1, &kvph);
+        CHECK(ret == SDSKV_SUCCESS,
+              "Error: sdskv_provider_handle_create() returned %d\n", ret);
+        if (!attach) {
+            ret = sdskv_open(kvph, db_name, &db_id);
+            CHECK(ret == SDSKV_SUCCESS, "Error: sdskv_open() returned %d\n",
+                  ret);
+        }
+        return 0;
+    }
+
+    int start(const char* json_config, const char* db_name, bool attach)
+    {
+        struct sdskv_provider_init_info args = SDSKV_PROVIDER_INIT_INFO_INIT;
+        args.json_config                     = json_config;
+        return start(args, db_name, attach);
+    }
+
+    /* releases the client and destroys the provider, leaving margo up */
+    void stop()
+    {
+        if (kvph != SDSKV_PROVIDER_HANDLE_NULL)
+            sdskv_provider_handle_release(kvph);
+        if (addr != HG_ADDR_NULL) margo_addr_free(client_mid, addr);
+        if (kvcl != SDSKV_CLIENT_NULL) sdskv_client_finalize(kvcl);
+        if (provider) sdskv_provider_destroy(provider);
+        kvph     = SDSKV_PROVIDER_HANDLE_NULL;
+        addr     = HG_ADDR_NULL;
+        kvcl     = SDSKV_CLIENT_NULL;
+        provider = NULL;
+    }
+
+  private:
+    /* sets addr to the address of mid, as seen from client_mid */
+    int lookup_self()
+    {
+        if (client_mid == mid)
+            return margo_addr_self(mid, &addr) == HG_SUCCESS ? 0 : -1;
+        hg_addr_t self;
+        char      str[256];
+        hg_size_t size = sizeof(str);
+        if (margo_addr_self(mid, &self) != HG_SUCCESS) return -1;
+        hg_return_t hret = margo_addr_to_string(mid, str, &size, self);
+        margo_addr_free(mid, self);
+        if (hret != HG_SUCCESS) return -1;
+        return margo_addr_lookup(client_mid, str, &addr) == HG_SUCCESS ? 0
+                                                                       : -1;
+    }
+};
+
+/* Parses "<server_addr> <provider_id> <db_name>" for each of num_servers
+ * servers followed by <num_keys>, opens the databases, and calls test on
+ * them. The servers are shut down afterwards, even if test throws. */
+static inline int sdskv_test_run_client(
+    int                                                 argc,
+    char*                                               argv[],
+    unsigned                                            num_servers,
+    const std::function<void(sdskv::client&,
+                             std::vector<sdskv::database>&,
+                             uint32_t)>&                test)
+{
+    if (argc != (int)(3 * num_servers + 2)) {
+        fprintf(stderr, "Usage: %s", argv[0]);
+        for (unsigned i = 0; i < num_servers; i++)
+            fprintf(stderr, " <server_addr> <provider_id> <db_name>");
+        fprintf(stderr, " <num_keys>\n");
+        fprintf(stderr, "  Example: %s tcp://localhost:1234 1 foo 1000\n",
+                argv[0]);
+        return -1;
+    }
+
+    /* initialize Margo using the transport portion of the server
+     * address (i.e., the part before the first : character if present) */
+    std::string addr = argv[1];
+    std::string protocol = addr.substr(0, addr.find(':'));
+    margo_instance_id mid
+        = margo_init(protocol.c_str(), MARGO_SERVER_MODE, 0, 0);
+    if (mid == MARGO_INSTANCE_NULL) {
+        fprintf(stderr, "Error: margo_init()\n");
+        return -1;
+    }
+
+    int                    ret = 0;
+    std::vector<hg_addr_t> addrs;
+    {
+        sdskv::client                       kvcl(mid);
+        std::vector<sdskv::provider_handle> handles;
+        std::vector<sdskv::database>        databases;
+        try {
+            for (unsigned i = 0; i < num_servers; i++) {
+                hg_addr_t svr_addr;
+                if (margo_addr_lookup(mid, argv[3 * i + 1], &svr_addr)
+                    != HG_SUCCESS)
+                    throw std::runtime_error("margo_addr_lookup failed");
+                addrs.push_back(svr_addr);
+                handles.emplace_back(kvcl, svr_addr,
+                                     (uint16_t)atoi(argv[3 * i + 2]));
+                databases.push_back(
+                    kvcl.open(handles.back(), argv[3 * i + 3]));
+            }
+            test(kvcl, databases, atoi(argv[3 * num_servers + 1]));
+        } catch (const std::exception& ex) {
+            std::cerr << "Error: " << ex.what() << std::endl;
+            ret = -1;
+        }
+        /* shutdown the servers */
+        for (auto svr_addr : addrs) {
+            kvcl.shutdown(svr_addr);
+            margo_addr_free(mid, svr_addr);
+        }
+    }
+    margo_finalize(mid);
+    return ret;
+}
+
+#endif
@@ -0,0 +1,170 @@
+/*
+ * (C) 2015 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <margo.h>
+#include <json/json.h>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "sdskv-test-util.h"
+
+/* Traces all the requests of a client and of a provider, and checks that
+ * the provider's spans of each request (the request itself and its bulk
+ * transfers) carry the id of the client's span, and that only the spans of
+ * requests about a database carry its id. Also checks that invalid tracing
+ * settings are rejected. */
+
+#define NUM_REQUESTS 10
+
+static const char* provider_config
+    = "{ \"tracing\" : { \"sample_rate\" : 1.0, \"buffer_size\" : 1024 } }";
+
+static const char* bad_configs[]
+    = {"{ \"tracing\" : { \"sample_rate\" : 2.0 } }",
+       "{ \"tracing\" : { \"buffer_size\" : 0 } }",
+       "{ \"tracing\" : 1 }"};
+
+/* maps request ids to the names of their spans */
+typedef std::map<std::string, std::multiset<std::string>> spans_t;
+
+/* with_db gets the names of the spans tagged with a database id */
+static int
+parse_trace(const char* str, spans_t& spans, std::set<std::string>& with_db)
+{
+    Json::Value  trace;
+    Json::Reader reader;
+    CHECK(reader.parse(str, trace), "Error: invalid JSON trace\n");
+    CHECK(trace["traceEvents"].isArray(), "Error: no traceEvents array\n");
+    for (const auto& event : trace["traceEvents"]) {
+        if (event["ph"].asString() != "X") continue;
+        CHECK(event["dur"].asDouble() >= 0, "Error: negative duration\n");
+        spans[event["args"]["request_id"].asString()].insert(
+            event["name"].asString());
+        if (event["args"].isMember("db_id"))
+            with_db.insert(event["name"].asString());
+    }
+    return 0;
+}
+
+static int run_test(sdskv_client_t          kvcl,
+                    sdskv_provider_handle_t kvph,
+                    sdskv_database_id_t     db_id)
+{
+    int ret;
+
+    std::string            keys, values;
+    std::vector<hg_size_t> ksizes, vsizes;
+    for (unsigned i = 0; i < 10; i++) {
+        std::string k = "key" + std::to_string(i);
+        std::string v = "value" + std::to_string(i);
+        keys += k;
+        values += v;
+        ksizes.push_back(k.size());
+        vsizes.push_back(v.size());
+    }
+    for (unsigned i = 0; i < NUM_REQUESTS; i++) {
+        ret = sdskv_put_packed(kvph, db_id, ksizes.size(), keys.data(),
+                               ksizes.data(), values.data(), vsizes.data());
+        CHECK(ret == SDSKV_SUCCESS, "Error: sdskv_put_packed() returned %d\n",
+              ret);
+        size_t                 num = ksizes.size();
+        std::vector<char>      rvalues(values.size() + 64);
+        std::vector<hg_size_t> rsizes(num);
+        ret = sdskv_get_packed(kvph, db_id, &num, keys.data(), ksizes.data(),
+                               rvalues.size(), rvalues.data(), rsizes.data());
+        CHECK(ret == SDSKV_SUCCESS, "Error: sdskv_get_packed() returned %d\n",
+              ret);
+        size_t num_dbs;
+        ret = sdskv_count_databases(kvph, &num_dbs);
+        CHECK(ret == SDSKV_SUCCESS,
+              "Error: sdskv_count_databases() returned %d\n", ret);
+    }
+
+    char* str = NULL;
+    ret       = sdskv_client_get_trace(kvcl, &str);
+    CHECK(ret == SDSKV_SUCCESS, "Error: sdskv_client_get_trace() returned %d\n",
+          ret);
+    spans_t               client_spans;
+    std::set<std::string> client_with_db;
+    ret = parse_trace(str, client_spans, client_with_db);
+    free(str);
+    if (ret != 0) return ret;
+
+    ret = sdskv_get_trace(kvph, &str);
+    CHECK(ret == SDSKV_SUCCESS, "Error: sdskv_get_trace() returned %d\n", ret);
+    printf("%s\n", str);
+    spans_t               server_spans;
+    std::set<std::string> server_with_db;
+    ret = parse_trace(str, server_spans, server_with_db);
+    free(str);
+    if (ret != 0) return ret;
+
+    unsigned num_puts = 0, num_gets = 0, num_counts = 0;
+    for (const auto& p : client_spans) {
+        const auto& names = p.second;
+        CHECK(names.size() == 1, "Error: %lu client spans for request %s\n",
+              (unsigned long)names.size(), p.first.c_str());
+        auto it = server_spans.find(p.first);
+        CHECK(it != server_spans.end(),
+              "Error: request %s was not traced by the provider\n",
+              p.first.c_str());
+        if (names.count("sdskv_put_packed")) {
+            CHECK(it->second.count("put_packed") == 1
+                      && it->second.count("bulk_pull") >= 1,
+                  "Error: missing provider spans for put_packed\n");
+            num_puts += 1;
+        } else if (names.count("sdskv_get_packed")) {
+            CHECK(it->second.count("get_packed") == 1
+                      && it->second.count("bulk_push") >= 1,
+                  "Error: missing provider spans for get_packed\n");
+            num_gets += 1;
+        } else if (names.count("sdskv_count_databases")) {
+            CHECK(it->second.count("count_databases") == 1,
+                  "Error: missing provider span for count_databases\n");
+            num_counts += 1;
+        }
+    }
+    CHECK(num_puts == NUM_REQUESTS && num_gets == NUM_REQUESTS
+              && num_counts == NUM_REQUESTS,
+          "Error: expected %d traced puts, gets and counts, got %u, %u and "
+          "%u\n",
+          NUM_REQUESTS, num_puts, num_gets, num_counts);
+    CHECK(client_with_db.count("sdskv_put_packed")
+              && server_with_db.count("put_packed"),
+          "Error: put_packed spans are not tagged with the database\n");
+    CHECK(!client_with_db.count("sdskv_count_databases")
+              && !server_with_db.count("count_databases"),
+          "Error: count_databases spans are tagged with a database\n");
+    return 0;
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc != 2) {
+        fprintf(stderr, "Usage: %s <protocol>\n", argv[0]);
+        fprintf(stderr, "  Example: %s na+sm\n", argv[0]);
+        return (-1);
+    }
+
+    sdskv_test_provider env;
+    if (env.init(argv[1], -1, true) != 0
+        || env.reject_configs(bad_configs, sizeof(bad_configs) / sizeof(char*))
+               != 0
+        || env.start(provider_config, "trace-test-db", true) != 0)
+        return (-1);
+    int ret = sdskv_client_enable_tracing(env.kvcl, 1.0, 1024);
+    if (ret != SDSKV_SUCCESS) {
+        fprintf(stderr, "Error: sdskv_client_enable_tracing() returned %d\n",
+                ret);
+        return (-1);
+    }
+    return run_test(env.kvcl, env.kvph, env.db_id);
+}
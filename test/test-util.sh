@@ -66,3 +66,51 @@ function find_db_name ()
     test_db_type=${SDSKV_TEST_DB_TYPE:-"map"}
     test_db_full="${TMPBASE}/${test_db_name}:${test_db_type}"
 }
+
+# runs a test program that starts its own provider, passing it the
+# transport followed by the remaining arguments, then cleans up and exits
+# with the status of the test
+function test_run_local ()
+{
+    program=$1
+    shift
+
+    run_to 20 $program ${SDSKV_TEST_TRANSPORT:-"na+sm"} "$@"
+    ret=$?
+
+    echo cleaning up $TMPBASE
+    rm -rf $TMPBASE
+    exit $ret
+}
+
+# starts num_servers servers with one database each, runs a test program
+# with "<address> 1 <database>" for each of them followed by the remaining
+# arguments, then cleans up and exits with the status of the test
+function test_run_with_servers ()
+{
+    num_servers=$1
+    program=$2
+    shift 2
+
+    find_db_name
+    server_args=""
+    for i in $(seq 1 $num_servers); do
+        db_name=$test_db_name
+        if [ $num_servers -gt 1 ]; then
+            db_name=${test_db_name}$i
+        fi
+        test_start_server 2 20 "${TMPBASE}/${db_name}:${test_db_type}"
+        server_args="$server_args $svr_addr 1 $db_name"
+    done
+
+    sleep 1
+
+    run_to 20 $program $server_args "$@"
+    ret=$?
+
+    wait
+
+    echo cleaning up $TMPBASE
+    rm -rf $TMPBASE
+    exit $ret
+}